@@ -1,21 +1,33 @@
-
 #pragma once
 
 #include <cstddef> // For std::size_t and std::ptrdiff_t.
 
+#include <limits>
+#include <new>
+#include <type_traits>
+
 namespace memwa
 {
 
+class Allocator;
+
 // ----------------------------------------------------------------------------
 
-/** @class Allocator This template class adapts a Memwa allocator for STL containers.
-It provides all the allocator functions consumed by STL containers.
+/** @class AllocatorAdapter This template class adapts a Memwa allocator for STL containers.
+It provides all the functions std::allocator_traits needs, and holds nothing but a pointer to the allocator,
+so it adds no overhead over calling the allocator through a raw pointer.
 
+AllocatorType may be memwa::Allocator or any class derived from it, or memwa::SizedAllocators. Containers
+rebind the adapter to their node types, and a rebound adapter uses the same allocator. Give node based
+containers such as std::list, std::map, and std::unordered_map a SizedAllocators, so each node type gets a
+TinyObjectAllocator or PoolAllocator of exactly its size. A PoolAllocator or TinyObjectAllocator used directly
+only suits containers which ask for chunks of just its object size. Each chunk is allocated with alignof(T),
+so the allocator's alignment must be at least that big.
  */
-template < typename T, class AllocatorType >
-class Allocator
+template < typename T, class AllocatorType = memwa::Allocator >
+class AllocatorAdapter
 {
-public : 
+public :
 
     /** This directive tells the compiler to optimize for fast copying of this allocator-adapter when an STL container is copied,
      rather than re-allocating all the elements in the container and then copying them.
@@ -29,40 +41,49 @@ public :
      */
     using propagate_on_container_swap = std::true_type;
 
-#if __cplusplus > 201402L
     /** This directive tells compiler that some allocator-adapter classes are not equal to others even if they are for the
-     same object type and allocator type because an object allocated by one allocator may not be released by another. This
-     directive is only used for version C++2017 or later.
+     same object type and allocator type because an object allocated by one allocator may not be released by another.
      */
     using is_always_equal = std::false_type;
-#endif
 
     typedef T value_type;
     typedef value_type * pointer;
     typedef const value_type * const_pointer;
-    typedef value_type & reference;
-    typedef const value_type & const_reference;
     typedef std::size_t size_type;
     typedef std::ptrdiff_t difference_type;
 
     template < typename U >
     struct rebind
     {
-        typedef Allocator< U > other;
+        typedef AllocatorAdapter< U, AllocatorType > other;
     };
 
-    inline explicit Allocator( AllocatorType * allocator = nullptr ) :
-        allocator_( allocator )
+    /// Makes an adapter with no allocator. Call set before a container allocates anything.
+    inline AllocatorAdapter() noexcept :
+        allocator_( nullptr )
     {}
 
-    inline ~Allocator() {}
+    inline explicit AllocatorAdapter( AllocatorType * allocator ) noexcept :
+        allocator_( allocator )
+    {}
 
-    inline explicit Allocator( Allocator const & that ) :
-        allocator_( that.allocator_ ) {}
+    inline AllocatorAdapter( const AllocatorAdapter & that ) noexcept :
+        allocator_( that.allocator_ )
+    {}
 
+    /// Makes an adapter for a rebound type, such as a container's node type, which uses the same allocator.
     template < typename U >
-    inline explicit Allocator( Allocator< U > const & that ) :
-        allocator_( that.allocator_ ) {}
+    inline AllocatorAdapter( const AllocatorAdapter< U, AllocatorType > & that ) noexcept :
+        allocator_( that.get() )
+    {}
+
+    inline AllocatorAdapter & operator = ( const AllocatorAdapter & that ) noexcept
+    {
+        allocator_ = that.allocator_;
+        return *this;
+    }
+
+    inline ~AllocatorAdapter() {}
 
     /// Allows code to set allocator pointer in case it was not set by constructor.
     inline void set( AllocatorType * allocator )
@@ -73,67 +94,71 @@ public :
         }
     }
 
-    inline const AllocatorType * get() const
+    inline AllocatorType * get() const noexcept
     {
         return allocator_;
     }
 
-    inline pointer address( reference r )
-    {
-        return &r;
-    }
-
-    inline const_pointer address( const_reference r )
-    {
-        return &r;
-    }
-
-    inline pointer allocate( size_type objectCount, typename std::allocator< void >::const_pointer hint = nullptr )
+    /** Allocates space for objectCount objects. This throws bad_alloc if the allocator can't provide it, and
+     invalid_argument if the allocator can't provide chunks of this size or alignment.
+     */
+    inline pointer allocate( size_type objectCount, const void * hint = nullptr )
     {
-        void * place = allocator_->Allocate( objectCount * sizeof (T), hint ) );
-        return reinterpret_cast< pointer >( place  );
+        if ( ( std::numeric_limits< size_type >::max() / sizeof(T) ) < objectCount )
+        {
+            throw std::bad_alloc();
+        }
+#if __cplusplus > 201402L
+        void * place = allocator_->Allocate( objectCount * sizeof(T), static_cast< std::align_val_t >( alignof(T) ), hint );
+#else
+        void * place = allocator_->Allocate( objectCount * sizeof(T), alignof(T), hint );
+#endif
+        if ( nullptr == place )
+        {
+            throw std::bad_alloc();
+        }
+        return static_cast< pointer >( place );
     }
 
-    inline void deallocate( pointer p, size_type bytes )
+    inline void deallocate( pointer p, size_type objectCount )
     {
-        ::operator allocator_->Deallocate( p, bytes ); 
+        allocator_->Release( p, objectCount * sizeof(T) );
     }
 
     inline size_type max_size() const
     {
-        return allocator_->GetMaxSize( sizeof(T) );
+        const unsigned long long maxCount = allocator_->GetMaxSize( sizeof(T) );
+        const size_type maxSize = std::numeric_limits< size_type >::max() / sizeof(T);
+        return ( maxCount < maxSize ) ? static_cast< size_type >( maxCount ) : maxSize;
     }
 
-    inline void construct( pointer p, const T & t ) const
+    /// Copies of a container use the same allocator as the original.
+    inline AllocatorAdapter select_on_container_copy_construction() const noexcept
     {
-        new ( p ) T( t );
+        return *this;
     }
 
-    inline void destroy( pointer p ) const
-    {
-        p->~T();
-    }
+private:
 
-    inline bool operator == ( Allocator const & that ) const
-    {
-        return ( allocator_ == that.allocator_ );
-    }
+    AllocatorType * allocator_;
 
-    inline bool operator != ( Allocator const & that )
-    {
-        return ( allocator_ != that.allocator_ );
-    }
+};
 
-    static inline Allocator< AllocatorType > select_on_container_copy_construction( const Allocator< AllocatorType > & that ) const
-    {
-        return Allocator< AllocatorType >( that.allocator_ );
-    }
+// ----------------------------------------------------------------------------
 
-private:
+template < typename T, typename U, class AllocatorType >
+inline bool operator == ( const AllocatorAdapter< T, AllocatorType > & left, const AllocatorAdapter< U, AllocatorType > & right ) noexcept
+{
+    return ( left.get() == right.get() );
+}
 
-    AllocatorType * allocator_;
+// ----------------------------------------------------------------------------
 
-};
+template < typename T, typename U, class AllocatorType >
+inline bool operator != ( const AllocatorAdapter< T, AllocatorType > & left, const AllocatorAdapter< U, AllocatorType > & right ) noexcept
+{
+    return ( left.get() != right.get() );
+}
 
 // ----------------------------------------------------------------------------
 
@@ -7,6 +7,7 @@ namespace memwa
 {
 
 	class AllocatorManager;
+	class BlockSource;
 
 	namespace impl
 	{
@@ -20,8 +21,6 @@ namespace memwa
  - Write an exception class that inherits from std::bad_alloc.
  - Write logger allocator.
  - Write class that conforms to std::allocator requirements.
- - Add sourceAllocator pointer to struct AllocatorParameters.
- - Allow ManagerImpl to maintain multiple common allocator blocks.
  - Create containers that use PoolBlock or TinyBlock for internal use.
  */
 
@@ -66,6 +65,25 @@ public:
 
 #endif
 
+	/** Allocates several chunks of the same size at once. Allocators which keep blocks of same-size
+	 chunks fill the whole array with one pass through their blocks, and thread-safe allocators lock
+	 only once for the whole array.
+	 @param places Array of at least count pointers which receives the chunks.
+	 @param count Number of chunks to allocate.
+	 @param size Number of bytes in each chunk.
+	 @param hint Address of recently allocated chunk so allocator can attempt to allocate chunks within same block.
+	 @note Either all the chunks are allocated or none are, in which case this throws.
+	 */
+	virtual void AllocateBulk( void ** places, std::size_t count, std::size_t size, const void * hint = nullptr );
+
+	/** Releases several chunks of the same size at once.
+	 @param places Array of chunks owned by this allocator.
+	 @param count Number of chunks in array.
+	 @param size Number of bytes in each chunk.
+	 @return True if every chunk was released, false if any was not.
+	 */
+	virtual bool ReleaseBulk( void ** places, std::size_t count, std::size_t size );
+
 #if __cplusplus > 201402L
 	// This code is for C++ 2017.
 
@@ -129,6 +147,8 @@ public:
 
 	const static std::size_t MaxAlignment = 32;
 	static const std::size_t CommonBlockSize = 1024;
+	/// Value for tinyShards which makes one shard for each CPU.
+	static const unsigned int OneShardPerCpu = ~0u;
 
 	enum AllocatorType
 	{
@@ -136,6 +156,16 @@ public:
 		Stack,
 		Pool,
 		Tiny, ///< For allocating objects from 1 through 128 bytes.
+		SizeClass, ///< For allocating objects of any size from 1 through 4096 bytes. Ignores objectSize.
+		Frame, ///< For chunks which live for a fixed number of frames. Ignores objectSize.
+	};
+
+	/// Kinds of headers a Stack allocator puts after each chunk to find the chunk before it.
+	enum StackHeader
+	{
+		Full, ///< Address and size of previous chunk. Release checks the size and the order of each chunk.
+		Compact, ///< 16-bit offset of previous chunk, or 32-bit offset if blocks are bigger than 64 KB.
+		Headerless, ///< No header. Release trusts the caller's size, which is only checked by assertions.
 	};
 
 	struct AllocatorParameters
@@ -149,13 +179,96 @@ public:
 #else
 		std::size_t alignment;
 #endif
+		/** Maximum number of free chunks each thread may cache for a Pool allocator in a multithreaded
+		 manager. Cached chunks are allocated and released without taking the allocator's lock. Zero
+		 disables the cache, and this is ignored by other types of allocators.
+		 */
+		unsigned int threadCacheSize = 0;
+		/** True if a Pool allocator in a multithreaded manager should keep its free chunks in a lock-free
+		 stack instead of locking for each call. This requires alignment of at least the size of a pointer,
+		 and may not be combined with threadCacheSize.
+		 */
+		bool lockFree = false;
+		/** True if each block of a Pool, Stack, or Tiny allocator should start at an address which is a
+		 multiple of the smallest power of two at least as big as the block. The allocator then finds the
+		 block owning a chunk by masking the chunk's address, so Release and HasAddress take constant time
+		 no matter how many blocks it has. Ignored by Linear allocators.
+		 */
+		bool alignedBlocks = false;
+		/** Most empty blocks a Pool, Stack, or Tiny allocator keeps after their last chunk is released,
+		 instead of destroying them right away. This stops a program which allocates and releases around
+		 a block boundary from making and destroying a block every few calls. Kept blocks are released by
+		 TrimEmptyBlocks, which the manager also calls when any allocator runs out of memory. Stack
+		 allocators always keep at least one. Ignored by Linear allocators and lock-free Pool allocators,
+		 whose blocks never become empty.
+		 */
+		unsigned int retainedEmptyBlocks = 0;
+		/** True if a Pool allocator should track free chunks with a bitmap kept at the end of each
+		 block, instead of a free list stored inside released chunks. Releasing a chunk then never writes to
+		 it, each block hands out its lowest free chunk first, and objects may be smaller than a pointer. The
+		 bitmap takes room from the chunks, so the block must hold at least one object and its bitmap. This
+		 may not be combined with lockFree, remoteFree, or threadCacheSize, and is ignored by other types
+		 of allocators.
+		 */
+		bool bitmapBlocks = false;
+		/** True if a Pool allocator in a multithreaded manager should give each thread which allocates its
+		 own blocks. A thread allocates from and releases into its own blocks without locking, and chunks
+		 released by other threads are pushed onto a lock-free list which the owner takes back all at once
+		 when it runs out of free chunks. Blocks are always aligned, and the first chunk of each block is
+		 kept to find the owner. This requires alignment of at least the size of a pointer and at least two
+		 objects per block, may not be combined with lockFree, threadCacheSize, or bitmapBlocks, and is
+		 ignored by other types of allocators.
+		 */
+		bool remoteFree = false;
+		/** True if a Tiny allocator should make blocks of blockSize bytes with 16-bit stealth indexes,
+		 instead of blocks of exactly 255 objects with 8-bit indexes. A block may then hold up to 65535
+		 objects, so a block size which is a multiple of the page size, such as 4096 or 65536, needs far
+		 fewer blocks for the same number of objects. Objects of one byte can't hold a 16-bit index, so
+		 they still use blocks of 255 objects. A SizeClass allocator passes this to its Tiny allocators,
+		 and other types of allocators ignore it.
+		 */
+		bool wideTinyBlocks = false;
+		/** Number of shards a Tiny allocator in a multithreaded manager splits its blocks into. Each shard
+		 has its own lock, and a thread allocates from the shard for the CPU it runs on, so many threads may
+		 allocate and release at once without waiting for each other. Zero disables sharding, OneShardPerCpu
+		 makes one shard for each CPU, and no more than 256 shards are made. Blocks are always aligned, and
+		 the first chunk of each block is kept to find its shard. This may not be combined with
+		 wideTinyBlocks, and is ignored by other types of allocators and by single-threaded managers.
+		 */
+		unsigned int tinyShards = 0;
+		/** Provides memory for each block, or nullptr to get blocks from malloc. See BlockSource.hpp for
+		 sources which get blocks from mmap or from another allocator. The source must outlive the
+		 allocator. The manager's own internal blocks always come from malloc.
+		 */
+		BlockSource * blockSource = nullptr;
+		/** Number of frames a Frame allocator keeps chunks for, from 2 through 16. A chunk is released
+		 when AdvanceFrame is called this many times after it was allocated. Other types of allocators
+		 ignore this.
+		 */
+		unsigned int frameCount = 2;
+		/** Kind of header a Stack allocator puts after each chunk. Full headers take 16 bytes on 64-bit
+		 systems, Compact headers take 2 or 4 bytes, and Headerless adds no bytes to a chunk. Release still
+		 throws if a chunk is released out of order with Full or Compact headers, but only Full headers find
+		 a wrong size. Compact may not be used with blocks bigger than 4 GB. Other types of allocators
+		 ignore this.
+		 */
+		StackHeader stackHeader = Full;
 	};
 
+	/** Creates the only manager. This allocates no memory and needs no static constructors to have run,
+	 so it may be called by a replacement operator new or malloc at any time.
+	 @return True if this made the manager, false if the manager already exists.
+	 */
 	static bool CreateManager( bool multithreaded, std::size_t internalBlockSize = CommonBlockSize );
 
 	static bool DestroyManager( bool releaseAll );
 
-	static Allocator * CreateAllocator( const AllocatorParameters & allocatorInfo );
+	/** Makes an allocator of the type and with the parameters given. If blockSource is a HugePageBlockSource,
+	 blockSize is rounded up to fill whole huge pages, or for wide tiny blocks, as many whole huge pages as
+	 the block can fill. Tiny allocators without wideTinyBlocks or with objects under 32 bytes, and SizeClass
+	 allocators, which pick their own small blocks, throw std::invalid_argument.
+	 */
+	static Allocator * CreateAllocator( const AllocatorParameters & parameters );
 
 	/** Destroys the allocator made by CreateAllocator function.
 	 @param allocator Pointer to object derived from allocator interface class, must have been made by
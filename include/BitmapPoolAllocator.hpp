@@ -0,0 +1,72 @@
+#pragma once
+
+#include "PoolAllocator.hpp"
+
+#include <cstddef> // For std::size_t.
+
+namespace memwa
+{
+
+class AllocatorManager;
+
+extern template class AnyPoolAllocator< BitmapBlock, BitmapBlock >;
+
+/** @class BitmapPoolAllocator
+ A pool allocator whose blocks track free chunks with a bitmap instead of a free list stored inside
+ the chunks. Releasing a chunk never writes to it, and each block always hands out its lowest free
+ chunk, so chunks stay packed toward the start of each block even after much churn. It shares all of
+ its code with PoolAllocator through AnyPoolAllocator, but has no FastAllocate or FastRelease.
+
+ # Usage Patterns
+ You can use BitmapPoolAllocator for:
+ - Objects that are all the same size.
+ - Objects that are allocated and released in any order.
+ - Programs which care more about locality and not touching freed memory than about the fastest release.
+ */
+class BitmapPoolAllocator : public AnyPoolAllocator< BitmapBlock, BitmapBlock >
+{
+protected:
+
+	BitmapPoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+		bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source );
+
+	virtual ~BitmapPoolAllocator();
+
+private:
+
+	friend class memwa::AllocatorManager;
+
+	BitmapPoolAllocator() = delete;
+	BitmapPoolAllocator( const BitmapPoolAllocator & ) = delete;
+	BitmapPoolAllocator( BitmapPoolAllocator && ) = delete;
+	BitmapPoolAllocator & operator = ( const BitmapPoolAllocator & ) = delete;
+	BitmapPoolAllocator & operator = ( BitmapPoolAllocator && ) = delete;
+
+};
+
+extern template class AnyThreadSafePoolAllocator< BitmapPoolAllocator >;
+
+// ----------------------------------------------------------------------------
+
+class ThreadSafeBitmapPoolAllocator : public AnyThreadSafePoolAllocator< BitmapPoolAllocator >
+{
+private:
+
+	friend class memwa::AllocatorManager;
+
+	ThreadSafeBitmapPoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+		bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source );
+
+	virtual ~ThreadSafeBitmapPoolAllocator();
+
+	ThreadSafeBitmapPoolAllocator() = delete;
+	ThreadSafeBitmapPoolAllocator( const ThreadSafeBitmapPoolAllocator & ) = delete;
+	ThreadSafeBitmapPoolAllocator( ThreadSafeBitmapPoolAllocator && ) = delete;
+	ThreadSafeBitmapPoolAllocator & operator = ( const ThreadSafeBitmapPoolAllocator & ) = delete;
+	ThreadSafeBitmapPoolAllocator & operator = ( ThreadSafeBitmapPoolAllocator && ) = delete;
+
+};
+
+// ----------------------------------------------------------------------------
+
+} // end project namespace
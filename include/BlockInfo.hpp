@@ -3,12 +3,15 @@
 
 #include <cassert>
 #include <cstddef> // For std::size_t.
+#include <cstdint> // For std::uintptr_t.
 
 	#include <iostream>
 #ifdef MEMWA_DEBUGGING_ALLOCATORS
 #endif
 
 #include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
 #include <vector>
 
 namespace memwa
@@ -18,8 +21,11 @@ namespace memwa
 	class LinearBlock;
 	class StackBlock;
 	class PoolBlock;
+	class BitmapBlock;
 	class ListBlock;
 	class TinyBlock;
+	class WideTinyBlock;
+	class BlockSource;
 //};
 
 // ----------------------------------------------------------------------------
@@ -32,27 +38,47 @@ struct BlockInfo
 	typedef typename Blocks::iterator BlocksIter;
 	typedef typename Blocks::const_iterator BlocksCIter;
 
+	/// Maps address of each aligned block to its position within blocks_.
+	typedef std::unordered_map< std::uintptr_t, std::size_t > Index;
+	typedef typename Index::iterator IndexIter;
+
 //	typedef typename BlockInfo< BlockType > MyType;
 
-	BlockInfo( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment ) :
+	/** This constructor is used by LinearAllocator and StackAllocator.
+	 @param blockAlignment Power of two each block's address is a multiple of, or zero if blocks are not
+	  aligned. If blocks are aligned, the block owning an address is found in constant time.
+	 @param retainedEmptyBlocks Most empty blocks kept after their last chunk is released, instead of
+	  destroying them right away.
+	 @param source Provides memory for each block, or nullptr to use malloc.
+	 */
+	BlockInfo( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment, std::size_t blockAlignment,
+		unsigned int retainedEmptyBlocks, BlockSource * source ) :
 		blockSize_( blockSize ),
 		alignment_( alignment ),
+		blockAlignment_( blockAlignment ),
+		source_( source ),
+		retainedEmptyBlocks_( retainedEmptyBlocks ),
+		emptyCount_( 0 ),
 		blocks_(),
+		index_(),
 		recent_()
 	{
+		assert( ( 0 == blockAlignment ) || ( blockSize <= blockAlignment ) );
 		try
 		{
 			blocks_.reserve( initialBlocks );
 			for ( unsigned int ii = 0; ii < initialBlocks; ++ii )
 			{
-				BlockType block( blockSize_, alignment_ );
+				BlockType block( blockSize_, alignment_, blockAlignment_, source_ );
 				blocks_.push_back( block );
 			}
 			if ( initialBlocks != 1 )
 			{
 				std::sort( blocks_.begin(), blocks_.end() );
 			}
+			IndexAllBlocks();
 			recent_ = blocks_.begin();
+			emptyCount_ = initialBlocks;
 		}
 		catch ( ... )
 		{
@@ -62,27 +88,36 @@ struct BlockInfo
 	}
 
 	/// This constructor is used by PoolAllocator and TinyBlockAllocator.
-	BlockInfo( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment ) :
+	BlockInfo( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+		std::size_t blockAlignment, unsigned int retainedEmptyBlocks, BlockSource * source ) :
 		blockSize_( blockSize ),
 		alignment_( alignment ),
+		blockAlignment_( blockAlignment ),
+		source_( source ),
+		retainedEmptyBlocks_( retainedEmptyBlocks ),
+		emptyCount_( 0 ),
 		blocks_(),
+		index_(),
 		recent_()
 	{
 //	    std::cout << __FUNCTION__ << " : " << __LINE__ << std::endl;
-		const unsigned int objectsPerPool = blockSize / objectSize;
+		assert( ( 0 == blockAlignment ) || ( blockSize <= blockAlignment ) );
+		const unsigned int objectsPerPool = BlockType::GetObjectsPerBlock( blockSize, objectSize );
 		try
 		{
 			blocks_.reserve( initialBlocks );
 			for ( unsigned int ii = 0; ii < initialBlocks; ++ii )
 			{
-				BlockType block( blockSize_, objectSize, alignment, objectsPerPool );
+				BlockType block( blockSize_, objectSize, alignment, objectsPerPool, blockAlignment_, source_ );
 				blocks_.push_back( block );
 			}
 			if ( initialBlocks != 1 )
 			{
 				std::sort( blocks_.begin(), blocks_.end() );
 			}
+			IndexAllBlocks();
 			recent_ = blocks_.begin();
+			emptyCount_ = initialBlocks;
 //	    	std::cout << __FUNCTION__ << " : " << __LINE__ << std::endl;
 		}
 		catch ( ... )
@@ -103,9 +138,11 @@ struct BlockInfo
 		for ( BlocksIter it( blocks_.begin() ); it != end; ++it )
 		{
 			BlockType & block = *it;
-			block.Destroy();
+			block.Destroy( blockSize_, blockAlignment_, source_ );
 		}
 		blocks_.clear();
+		index_.clear();
+		emptyCount_ = 0;
 	}
 
 	void * Allocate( std::size_t size, const void * hint )
@@ -122,8 +159,7 @@ struct BlockInfo
 			BlocksIter it = GetBlock( hint );
 			if ( it != end )
 			{
-				BlockType & block = *it;
-				void * p = block.Allocate( size, blockSize_, alignment_ );
+				void * p = AllocateFromBlock( *it, size );
 				if ( nullptr != p )
 				{
 					recent_ = it;
@@ -135,8 +171,7 @@ struct BlockInfo
 		// Check most recently used block next.
 		if ( recent_ != end )
 		{
-			BlockType & block = *recent_;
-			void * p = block.Allocate( size, blockSize_, alignment_ );
+			void * p = AllocateFromBlock( *recent_, size );
 			if ( nullptr != p )
 			{
 				return p;
@@ -148,8 +183,7 @@ struct BlockInfo
 		BlocksIter it( begin );
 		while ( it != end )
 		{
-			BlockType & block = *it;
-			void * p = block.Allocate( size, blockSize_, alignment_ );
+			void * p = AllocateFromBlock( *it, size );
 			if ( nullptr != p )
 			{
 				recent_ = it;
@@ -159,11 +193,10 @@ struct BlockInfo
 		}
 
 		// Now try to create a new block and insert it into container.
-		BlockType block( blockSize_, alignment_ );
+		BlockType block( blockSize_, alignment_, blockAlignment_, source_ );
 		void * p = block.Allocate( size, blockSize_, alignment_ );
 		assert( nullptr != p );
-		it = std::lower_bound( begin, end, block );
-		recent_ = blocks_.insert( it, block );
+		recent_ = InsertBlock( block );
 		return p;
 	}
 
@@ -176,10 +209,9 @@ struct BlockInfo
 			if ( block.HasAddress( place, blockSize_ ) )
 			{
 				const bool success = block.Release( place, size, blockSize_, alignment_ );
-				if ( success && block.IsEmpty( alignment_ ) )
+				if ( success && block.IsEmpty( alignment_ ) && !KeepEmptyBlock() )
 				{
-					block.Destroy();
-					blocks_.erase( recent_ );
+					DestroyBlock( recent_ );
 					recent_ = blocks_.end();
 				}
 				return success;
@@ -193,11 +225,10 @@ struct BlockInfo
 		}	
 		BlockType & block = *it;
 		const bool success = block.Release( place, size, blockSize_, alignment_ );
-		if ( success && block.IsEmpty( alignment_ ) )
+		if ( success && block.IsEmpty( alignment_ ) && !KeepEmptyBlock() )
 		{
 			const bool resetRecent = ( it == recent_ );
-			block.Destroy();
-			blocks_.erase( it );
+			DestroyBlock( it );
 			if ( resetRecent || ( blocks_.size() == 0 ) || ( blocks_.end() < recent_ ) )
 			{
 				recent_ = blocks_.end();
@@ -241,6 +272,10 @@ struct BlockInfo
 
 	BlocksIter GetBlock( const void * place )
 	{
+		if ( 0 != blockAlignment_ )
+		{
+			return GetAlignedBlock( place );
+		}
 		const BlocksIter end( blocks_.end() );
 		BlocksIter here( blocks_.begin() );
 		BlocksIter it;
@@ -269,6 +304,10 @@ struct BlockInfo
 	        }
 	    }
 
+	    if ( here == end )
+	    {
+	        return end;
+	    }
 	    const BlockType & block = *here;
 	    if ( block.HasAddress( place, blockSize_ ) )
 	    {
@@ -285,6 +324,146 @@ struct BlockInfo
 		return cit;
 	}
 
+	/** Finds block owning place by masking the address down to the block alignment and looking up the
+	 result in the index. This takes constant time no matter how many blocks there are, and never reads
+	 from place, so it is safe to call with addresses this does not own.
+	 */
+	BlocksIter GetAlignedBlock( const void * place )
+	{
+		assert( 0 != blockAlignment_ );
+		const std::uintptr_t start = reinterpret_cast< std::uintptr_t >( place ) & ~( blockAlignment_ - 1 );
+		const IndexIter found( index_.find( start ) );
+		if ( found == index_.end() )
+		{
+			return blocks_.end();
+		}
+		const BlocksIter it( blocks_.begin() + found->second );
+		assert( reinterpret_cast< std::uintptr_t >( it->GetAddress() ) == start );
+		// The place may be in the padding between the end of the block and the next aligned address.
+		if ( !it->HasAddress( place, blockSize_ ) )
+		{
+			return blocks_.end();
+		}
+		return it;
+	}
+
+	static std::uintptr_t GetBlockKey( const BlockType & block )
+	{
+		return reinterpret_cast< std::uintptr_t >( block.GetAddress() );
+	}
+
+	/// Updates position of every block from first to end within index. Never throws since each block already has a key.
+	/// Only called after many blocks moved at once, since InsertBlock and DestroyBlock move at most one block.
+	void IndexBlocks( BlocksIter first )
+	{
+		if ( 0 == blockAlignment_ )
+		{
+			return;
+		}
+		const BlocksIter begin( blocks_.begin() );
+		const BlocksIter end( blocks_.end() );
+		for ( BlocksIter it( first ); it != end; ++it )
+		{
+			const IndexIter found( index_.find( GetBlockKey( *it ) ) );
+			assert( found != index_.end() );
+			found->second = static_cast< std::size_t >( it - begin );
+		}
+	}
+
+	/// Adds every block to index. Only called when index is empty.
+	void IndexAllBlocks()
+	{
+		if ( 0 == blockAlignment_ )
+		{
+			return;
+		}
+		assert( index_.empty() );
+		index_.reserve( blocks_.size() );
+		const BlocksIter end( blocks_.end() );
+		for ( BlocksIter it( blocks_.begin() ); it != end; ++it )
+		{
+			assert( GetBlockKey( *it ) % blockAlignment_ == 0 );
+			index_.emplace( GetBlockKey( *it ), 0 );
+		}
+		IndexBlocks( blocks_.begin() );
+	}
+
+	/** Inserts block into container. Aligned blocks are found through the index instead of by a binary
+	 search, so they are appended and only the new block is indexed. Other blocks are kept sorted by address.
+	 */
+	BlocksIter InsertBlock( const BlockType & block )
+	{
+		if ( 0 == blockAlignment_ )
+		{
+			const BlocksIter it( std::lower_bound( blocks_.begin(), blocks_.end(), block ) );
+			return blocks_.insert( it, block );
+		}
+		assert( GetBlockKey( block ) % blockAlignment_ == 0 );
+		index_.emplace( GetBlockKey( block ), blocks_.size() );
+		try
+		{
+			blocks_.push_back( block );
+		}
+		catch ( ... )
+		{
+			index_.erase( GetBlockKey( block ) );
+			throw;
+		}
+		return blocks_.end() - 1;
+	}
+
+	/// Allocates from block, and stops counting it as empty if it was a kept empty block.
+	void * AllocateFromBlock( BlockType & block, std::size_t size )
+	{
+		const bool wasEmpty = ( 0 != emptyCount_ ) && block.IsEmpty( alignment_ );
+		void * p = block.Allocate( size, blockSize_, alignment_ );
+		if ( wasEmpty && ( nullptr != p ) )
+		{
+			--emptyCount_;
+		}
+		return p;
+	}
+
+	/** Decides whether to keep a block whose last chunk was just released. Keeping a few empty blocks
+	 means a program which allocates and releases around a block boundary reuses them, instead of making
+	 and destroying a block every few calls. Kept blocks are destroyed by TrimEmptyBlocks.
+	 @return True if block is kept, false if caller should destroy it.
+	 */
+	bool KeepEmptyBlock()
+	{
+		if ( emptyCount_ < retainedEmptyBlocks_ )
+		{
+			++emptyCount_;
+			return true;
+		}
+		return false;
+	}
+
+	/** Destroys block, and removes it from container and index. Aligned blocks need not stay sorted, so the
+	 last block moves into its place and is the only one reindexed. Other blocks after it shift down.
+	 @return Iterator to the block now at the destroyed block's place, which was not there before.
+	 */
+	BlocksIter DestroyBlock( BlocksIter it )
+	{
+		if ( 0 == blockAlignment_ )
+		{
+			it->Destroy( blockSize_, blockAlignment_, source_ );
+			return blocks_.erase( it );
+		}
+		index_.erase( GetBlockKey( *it ) );
+		it->Destroy( blockSize_, blockAlignment_, source_ );
+		const BlocksIter last( blocks_.end() - 1 );
+		if ( it != last )
+		{
+			*it = *last;
+			const IndexIter found( index_.find( GetBlockKey( *it ) ) );
+			assert( found != index_.end() );
+			found->second = static_cast< std::size_t >( it - blocks_.begin() );
+		}
+		blocks_.pop_back();
+		return it;
+	}
+
 	bool TrimEmptyBlocks()
 	{
 		bool foundAny = false;
@@ -297,7 +476,8 @@ struct BlockInfo
 			BlockType & block = *it;
 			if ( block.IsEmpty( alignment_ ) )
 			{
-				block.Destroy();
+				index_.erase( GetBlockKey( block ) );
+				block.Destroy( blockSize_, blockAlignment_, source_ );
 				foundAny = true;
 			}
 			else
@@ -307,7 +487,9 @@ struct BlockInfo
 		}
 		temp.swap( blocks_ );
 		temp.shrink_to_fit();
+		IndexBlocks( blocks_.begin() );
 		recent_ = blocks_.end();
+		emptyCount_ = 0;
 
 		return foundAny;
 	}
@@ -316,11 +498,38 @@ struct BlockInfo
 	{
 		assert( nullptr != this );
 
+		std::size_t emptyCount = 0;
 		const BlocksCIter end( blocks_.end() );
 		for ( BlocksCIter it( blocks_.begin() ); it != end; ++it )
 		{
 			const BlockType & block = *it;
 			assert( !block.IsCorrupt( blockSize_, alignment_ ) );
+			if ( block.IsEmpty( alignment_ ) )
+			{
+				++emptyCount;
+			}
+		}
+		assert( emptyCount == emptyCount_ );
+		assert( !IsIndexCorrupt() );
+		return false;
+	}
+
+	/// Checks that every aligned block is in the index at its position within the container.
+	bool IsIndexCorrupt() const
+	{
+		if ( 0 == blockAlignment_ )
+		{
+			assert( index_.empty() );
+			return false;
+		}
+		assert( index_.size() == blocks_.size() );
+		const BlocksCIter begin( blocks_.begin() );
+		const BlocksCIter end( blocks_.end() );
+		for ( BlocksCIter it( begin ); it != end; ++it )
+		{
+			const typename Index::const_iterator found( index_.find( GetBlockKey( *it ) ) );
+			assert( found != index_.end() );
+			assert( found->second == static_cast< std::size_t >( it - begin ) );
 		}
 		return false;
 	}
@@ -357,6 +566,7 @@ struct BlockInfo
 			<< '\t' << "Alignment: " << alignment_
 			<< '\t' << "Recent Block: " << recentIndex
 			<< '\t' << "Block Count: " << blocks_.size()
+			<< '\t' << "Empty Blocks: " << emptyCount_
 			<< '\t' << "Capacity: " << blocks_.capacity()
 			<< std::endl;
 
@@ -377,14 +587,453 @@ struct BlockInfo
 	std::size_t blockSize_;
 	/// Byte alignment of allocations. (e.g. - 1, 2, 4, 8, 16, or 32.)
 	std::size_t alignment_;
+	/// Power of two each block's address is a multiple of, or zero if blocks are not aligned.
+	std::size_t blockAlignment_;
+	/// Provides memory for each block, or nullptr if blocks come from malloc.
+	BlockSource * source_;
+	/// Most empty blocks kept after their last chunk is released.
+	unsigned int retainedEmptyBlocks_;
+	/// Number of empty blocks in container.
+	unsigned int emptyCount_;
 	/// Container of memory blocks.
 	Blocks blocks_;
+	/// Positions of aligned blocks within container. Empty if blocks are not aligned.
+	Index index_;
 	/// Iterator to mostly recently used block to allocate memory.
 	BlocksIter recent_;
 };
 
 // ----------------------------------------------------------------------------
 
+/// Position within a LinearAllocator's blocks, to which it can later rewind.
+struct LinearMarker
+{
+	/// Number of blocks allocated from when marker was made.
+	std::size_t usedBlocks_;
+	/// Next free spot within the last of those blocks, or nullptr if no block was used.
+	const unsigned char * freeSpot_;
+};
+
+// ----------------------------------------------------------------------------
+
+/** Keeps blocks for LinearAllocator. Chunks are allocated from the most recently used block until it
+ is full, then from an empty block, and then from a new block, but never again from a block used before
+ the current one. The blocks are listed in the order they were used, so rewinding to a marker only
+ touches blocks used since the marker was made.
+ */
+template < class BlockType >
+struct AnyLinearBlockInfo : BlockInfo< BlockType >
+{
+
+	typedef BlockInfo< BlockType > BaseClass;
+	typedef typename BaseClass::BlocksIter BlocksIter;
+
+	typedef std::vector< const unsigned char * > Addresses;
+
+	AnyLinearBlockInfo( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment, std::size_t blockAlignment,
+		unsigned int retainedEmptyBlocks, BlockSource * source ) :
+		BaseClass( initialBlocks, blockSize, alignment, blockAlignment, retainedEmptyBlocks, source ),
+		used_()
+	{
+		// No block is used until the first allocation.
+		BaseClass::recent_ = BaseClass::blocks_.end();
+	}
+
+	~AnyLinearBlockInfo() {}
+
+	void Destroy()
+	{
+		used_.clear();
+		BaseClass::Destroy();
+	}
+
+	/// Allocates chunk at the free spot of the most recently used block. Unlike other allocators, this ignores hints.
+	void * Allocate( std::size_t size, const void * hint )
+	{
+		(void)hint;
+		if ( BaseClass::blockSize_ < size )
+		{
+			throw std::bad_alloc();
+		}
+
+		const BlocksIter end( BaseClass::blocks_.end() );
+		if ( ( BaseClass::recent_ == end ) && !used_.empty() )
+		{
+			// TrimEmptyBlocks forgets the recent block, but it still has the last used block.
+			BaseClass::recent_ = BaseClass::GetBlock( used_.back() );
+			assert( BaseClass::recent_ != end );
+		}
+		if ( BaseClass::recent_ != end )
+		{
+			void * p = BaseClass::recent_->Allocate( size, BaseClass::blockSize_, BaseClass::alignment_ );
+			if ( nullptr != p )
+			{
+				return p;
+			}
+		}
+
+		if ( used_.size() == used_.capacity() )
+		{
+			used_.reserve( 2 * used_.size() + 1 );
+		}
+		if ( 0 != BaseClass::emptyCount_ )
+		{
+			for ( BlocksIter it( BaseClass::blocks_.begin() ); it != end; ++it )
+			{
+				if ( it->IsEmpty( BaseClass::alignment_ ) )
+				{
+					void * p = BaseClass::AllocateFromBlock( *it, size );
+					assert( nullptr != p );
+					used_.push_back( it->GetAddress() );
+					BaseClass::recent_ = it;
+					return p;
+				}
+			}
+		}
+
+		BlockType block( BaseClass::blockSize_, BaseClass::alignment_, BaseClass::blockAlignment_, BaseClass::source_ );
+		void * p = block.Allocate( size, BaseClass::blockSize_, BaseClass::alignment_ );
+		assert( nullptr != p );
+		BaseClass::recent_ = BaseClass::InsertBlock( block );
+		used_.push_back( block.GetAddress() );
+		return p;
+	}
+
+	LinearMarker GetMarker() const
+	{
+		LinearMarker marker = { used_.size(), nullptr };
+		if ( !used_.empty() )
+		{
+			const typename BaseClass::BlocksCIter it( BaseClass::GetBlock( used_.back() ) );
+			assert( it != BaseClass::blocks_.end() );
+			marker.freeSpot_ = it->GetFreeSpot();
+		}
+		return marker;
+	}
+
+	/** Releases every chunk allocated after marker was made. Markers made after this one become invalid.
+	 @param keepBlocks True to keep blocks emptied by this for later allocations, false to destroy them.
+	 @return False if marker is past the current position, in which case nothing is released.
+	 */
+	bool RewindTo( const LinearMarker & marker, bool keepBlocks )
+	{
+		if ( used_.size() < marker.usedBlocks_ )
+		{
+			return false;
+		}
+		if ( 0 != marker.usedBlocks_ )
+		{
+			const BlocksIter it( BaseClass::GetBlock( used_[ marker.usedBlocks_ - 1 ] ) );
+			assert( it != BaseClass::blocks_.end() );
+			const unsigned char * start = it->GetAddress();
+			if ( ( marker.freeSpot_ < start ) || ( start + BaseClass::blockSize_ < marker.freeSpot_ )
+				|| ( it->GetFreeSpot() < marker.freeSpot_ ) )
+			{
+				return false;
+			}
+		}
+
+		while ( marker.usedBlocks_ < used_.size() )
+		{
+			EmptyBlock( BaseClass::GetBlock( used_.back() ), keepBlocks );
+			used_.pop_back();
+		}
+		BaseClass::recent_ = BaseClass::blocks_.end();
+		if ( 0 != marker.usedBlocks_ )
+		{
+			const BlocksIter it( BaseClass::GetBlock( used_.back() ) );
+			it->Rewind( marker.freeSpot_ );
+			if ( it->IsEmpty( BaseClass::alignment_ ) )
+			{
+				EmptyBlock( it, keepBlocks );
+				used_.pop_back();
+			}
+		}
+		return true;
+	}
+
+	/// Empties a block which was used after a marker, and destroys it unless it is kept.
+	void EmptyBlock( BlocksIter it, bool keepBlocks )
+	{
+		assert( it != BaseClass::blocks_.end() );
+		it->Reset( BaseClass::alignment_ );
+		assert( it->IsEmpty( BaseClass::alignment_ ) );
+		if ( keepBlocks )
+		{
+			++BaseClass::emptyCount_;
+		}
+		else
+		{
+			BaseClass::DestroyBlock( it );
+		}
+	}
+
+	bool IsCorrupt() const
+	{
+		assert( used_.size() <= BaseClass::blocks_.size() );
+		return BaseClass::IsCorrupt();
+	}
+
+	/// Addresses of blocks which have chunks, in the order they were first used.
+	Addresses used_;
+
+};
+
+// ----------------------------------------------------------------------------
+
+/** Keeps blocks for StackAllocator as a segmented stack. Chunks are allocated only from the top segment,
+ which is the block most recently pushed onto the stack, and released only from it, so allocating or
+ releasing does not depend on how many blocks there are. When the top segment is full, a spare block is
+ pushed as the new top, and when the last chunk of the top segment is released, it is popped so the segment
+ below becomes the top again. Blocks are kept in stack order instead of sorted by address: the segments come
+ first, from the bottom of the stack to the top, and the spares follow them. Pushing or popping a segment
+ only moves the boundary between them, and destroying a block moves the last block into its place, so
+ neither searches for a block or shifts the others. At least one popped segment is kept as a spare, so
+ allocating and releasing back and forth across a segment boundary does not make and destroy a block every
+ time.
+ */
+template < class BlockType >
+struct AnyStackBlockInfo : BlockInfo< BlockType >
+{
+
+	typedef BlockInfo< BlockType > BaseClass;
+	typedef typename BaseClass::BlocksIter BlocksIter;
+	typedef typename BaseClass::BlocksCIter BlocksCIter;
+
+	/// @param headerSize Bytes of header after each chunk. See impl::HotStackBlock for the kinds of headers.
+	AnyStackBlockInfo( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment, std::size_t blockAlignment,
+		unsigned int retainedEmptyBlocks, BlockSource * source, std::size_t headerSize ) :
+		BaseClass( initialBlocks, blockSize, alignment, blockAlignment, ( 0 == retainedEmptyBlocks ) ? 1 : retainedEmptyBlocks,
+			source ),
+		headerSize_( headerSize ),
+		usedCount_( 0 )
+	{
+		// No segment is pushed until the first allocation, so each block starts out as a spare.
+		BaseClass::recent_ = BaseClass::blocks_.end();
+	}
+
+	~AnyStackBlockInfo() {}
+
+	void Destroy()
+	{
+		usedCount_ = 0;
+		BaseClass::Destroy();
+		BaseClass::recent_ = BaseClass::blocks_.end();
+	}
+
+	/// Allocates chunk from the top segment, or from a newly pushed segment if the top is full. Unlike BlockInfo, this ignores hints.
+	void * Allocate( std::size_t size, const void * hint )
+	{
+		(void)hint;
+		if ( BaseClass::blockSize_ < BlockType::GetBytesNeeded( size, BaseClass::alignment_, headerSize_ ) )
+		{
+			throw std::bad_alloc();
+		}
+
+		if ( 0 != usedCount_ )
+		{
+			void * p = BaseClass::recent_->Allocate( size, BaseClass::blockSize_, BaseClass::alignment_, headerSize_ );
+			if ( nullptr != p )
+			{
+				return p;
+			}
+		}
+
+		// The first spare, if there is one, sits right above the top segment.
+		if ( usedCount_ < BaseClass::blocks_.size() )
+		{
+			const BlocksIter it( BaseClass::blocks_.begin() + usedCount_ );
+			void * p = it->Allocate( size, BaseClass::blockSize_, BaseClass::alignment_, headerSize_ );
+			assert( nullptr != p );
+			--BaseClass::emptyCount_;
+			++usedCount_;
+			BaseClass::recent_ = it;
+			return p;
+		}
+
+		BlockType block( BaseClass::blockSize_, BaseClass::alignment_, BaseClass::blockAlignment_, BaseClass::source_ );
+		void * p = block.Allocate( size, BaseClass::blockSize_, BaseClass::alignment_, headerSize_ );
+		assert( nullptr != p );
+		try
+		{
+			AppendBlock( block );
+		}
+		catch ( ... )
+		{
+			block.Destroy( BaseClass::blockSize_, BaseClass::blockAlignment_, BaseClass::source_ );
+			throw std::bad_alloc();
+		}
+		++usedCount_;
+		BaseClass::recent_ = BaseClass::blocks_.end() - 1;
+		return p;
+	}
+
+	/** Releases chunk from the top segment, and pops that segment if the chunk was its last one.
+	 @return False if no block owns place.
+	 */
+	bool Release( void * place, std::size_t size )
+	{
+		if ( !IsInTopSegment( place ) )
+		{
+			return false;
+		}
+		const bool success = BaseClass::recent_->Release( place, size, BaseClass::blockSize_, BaseClass::alignment_, headerSize_ );
+		if ( success && BaseClass::recent_->IsEmpty( BaseClass::alignment_ ) )
+		{
+			PopSegment();
+		}
+		return success;
+	}
+
+	/// Resizes the top chunk of the top segment.
+	bool Resize( void * place, std::size_t oldSize, std::size_t newSize )
+	{
+		if ( BaseClass::blockSize_ < newSize )
+		{
+			return false;
+		}
+		if ( !IsInTopSegment( place ) )
+		{
+			return false;
+		}
+		const bool success = BaseClass::recent_->Resize( place, oldSize, newSize, BaseClass::blockSize_, BaseClass::alignment_,
+			headerSize_ );
+		return success;
+	}
+
+	/** Checks that place is in the top segment.
+	 @return False if no block owns place.
+	 @throw std::invalid_argument if place is in a block below the top segment, since only the most recently
+	  allocated chunk may be released or resized.
+	 */
+	bool IsInTopSegment( const void * place ) const
+	{
+		if ( ( 0 != usedCount_ ) && BaseClass::recent_->HasAddress( place, BaseClass::blockSize_ ) )
+		{
+			return true;
+		}
+		if ( !HasAddress( place ) )
+		{
+			return false;
+		}
+		throw std::invalid_argument( "Error found by StackAllocator. The requested place is in a block below the top of the stack." );
+	}
+
+	/** Returns true if any block owns place. Blocks are in stack order rather than sorted, so this checks
+	 each block unless blocks are aligned. Only HasAddress and misused Release or Resize calls need this.
+	 */
+	bool HasAddress( const void * place ) const
+	{
+		if ( 0 != BaseClass::blockAlignment_ )
+		{
+			return BaseClass::HasAddress( place );
+		}
+		const BlocksCIter end( BaseClass::blocks_.end() );
+		for ( BlocksCIter it( BaseClass::blocks_.begin() ); it != end; ++it )
+		{
+			if ( it->HasAddress( place, BaseClass::blockSize_ ) )
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/// Adds block after every other block, which keeps the stack order and never shifts a block.
+	void AppendBlock( const BlockType & block )
+	{
+		if ( 0 != BaseClass::blockAlignment_ )
+		{
+			// Aligned blocks are always appended and indexed.
+			BaseClass::InsertBlock( block );
+			return;
+		}
+		BaseClass::blocks_.push_back( block );
+	}
+
+	/** Destroys block, and moves the last block into its place. Only called for the block just above the
+	 top segment, so the block moved is a spare, and the segments stay in order.
+	 */
+	void DestroyBlock( BlocksIter it )
+	{
+		assert( it == BaseClass::blocks_.begin() + usedCount_ );
+		if ( 0 != BaseClass::blockAlignment_ )
+		{
+			// This also reindexes the block moved into its place.
+			BaseClass::DestroyBlock( it );
+			return;
+		}
+		it->Destroy( BaseClass::blockSize_, BaseClass::blockAlignment_, BaseClass::source_ );
+		const BlocksIter last( BaseClass::blocks_.end() - 1 );
+		if ( it != last )
+		{
+			*it = *last;
+		}
+		BaseClass::blocks_.pop_back();
+	}
+
+	/// Removes the empty top segment, and keeps it as a spare or destroys it.
+	void PopSegment()
+	{
+		assert( 0 != usedCount_ );
+		assert( BaseClass::recent_->IsEmpty( BaseClass::alignment_ ) );
+		--usedCount_;
+		// The popped segment is now the first spare, so keeping it needs no change to the container.
+		if ( !BaseClass::KeepEmptyBlock() )
+		{
+			DestroyBlock( BaseClass::recent_ );
+		}
+		BaseClass::recent_ = ( 0 == usedCount_ ) ? BaseClass::blocks_.end() : BaseClass::blocks_.begin() + ( usedCount_ - 1 );
+	}
+
+	bool TrimEmptyBlocks()
+	{
+		// Only the spares are empty, and removing them keeps the segments in order.
+		const bool foundAny = BaseClass::TrimEmptyBlocks();
+		assert( BaseClass::blocks_.size() == usedCount_ );
+		// TrimEmptyBlocks forgets the recent block, but the top segment is still on the stack.
+		if ( 0 != usedCount_ )
+		{
+			BaseClass::recent_ = BaseClass::blocks_.end() - 1;
+		}
+		return foundAny;
+	}
+
+	bool IsCorrupt() const
+	{
+		const BlocksCIter begin( BaseClass::blocks_.begin() );
+		const BlocksCIter end( BaseClass::blocks_.end() );
+		assert( usedCount_ <= BaseClass::blocks_.size() );
+		for ( BlocksCIter it( begin ); it != end; ++it )
+		{
+			assert( !it->IsCorrupt( BaseClass::blockSize_, BaseClass::alignment_, headerSize_ ) );
+			// Every block is either a segment with chunks or an empty spare above the segments.
+			const bool isSegment = ( static_cast< std::size_t >( it - begin ) < usedCount_ );
+			assert( isSegment != it->IsEmpty( BaseClass::alignment_ ) );
+			(void)isSegment;
+		}
+		assert( BaseClass::emptyCount_ == BaseClass::blocks_.size() - usedCount_ );
+		if ( 0 == usedCount_ )
+		{
+			assert( BaseClass::recent_ == end );
+		}
+		else
+		{
+			assert( BaseClass::recent_ == begin + ( usedCount_ - 1 ) );
+		}
+		assert( !BaseClass::IsIndexCorrupt() );
+		return false;
+	}
+
+	/// Bytes of header after each chunk.
+	std::size_t headerSize_;
+	/// Number of blocks which have chunks. These come first in blocks_, from the bottom of the stack to the top.
+	std::size_t usedCount_;
+
+};
+
+// ----------------------------------------------------------------------------
+
 template < class BlockType >
 struct AnyPoolBlockInfo : BlockInfo< BlockType >
 {
@@ -394,15 +1043,40 @@ struct AnyPoolBlockInfo : BlockInfo< BlockType >
 	typedef typename BaseClass::BlocksIter BlocksIter;
 	typedef typename BaseClass::BlocksCIter BlocksCIter;
 
-	AnyPoolBlockInfo( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment ) :
-		BaseClass( initialBlocks, blockSize, objectSize, alignment ),
-		objectSize_( objectSize )
+	/// Positions of blocks within blocks_.
+	typedef std::vector< std::size_t > Positions;
+
+	AnyPoolBlockInfo( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+		std::size_t blockAlignment, unsigned int retainedEmptyBlocks, BlockSource * source ) :
+		BaseClass( initialBlocks, blockSize, objectSize, alignment, blockAlignment, retainedEmptyBlocks, source ),
+		objectSize_( objectSize ),
+		partial_()
 	{
 //    	std::cout << __FUNCTION__ << " : " << __LINE__ << std::endl;
+		try
+		{
+			partial_.reserve( BaseClass::blocks_.size() );
+		}
+		catch ( ... )
+		{
+			BaseClass::Destroy();
+			throw std::bad_alloc();
+		}
+		const BlocksIter end( BaseClass::blocks_.end() );
+		for ( BlocksIter it( BaseClass::blocks_.begin() ); it != end; ++it )
+		{
+			ListBlock( *it );
+		}
 	}
 
 	~AnyPoolBlockInfo() {}
 
+	void Destroy()
+	{
+		partial_.clear();
+		BaseClass::Destroy();
+	}
+
 	void * Allocate( const void * hint )
 	{
 
@@ -415,7 +1089,7 @@ struct AnyPoolBlockInfo : BlockInfo< BlockType >
 			{
 				BlockType & block = *it;
 				assert( !block.IsCorrupt( BaseClass::blockSize_, BaseClass::alignment_, objectSize_ ) );
-				void * p = block.Allocate();
+				void * p = AllocateFromBlock( block );
 				if ( nullptr != p )
 				{
 					assert( !block.IsCorrupt( BaseClass::blockSize_, BaseClass::alignment_, objectSize_ ) );
@@ -431,7 +1105,7 @@ struct AnyPoolBlockInfo : BlockInfo< BlockType >
 		{
 			BlockType & block = *( BaseClass::recent_ );
 			assert( !block.IsCorrupt( BaseClass::blockSize_, BaseClass::alignment_, objectSize_ ) );
-			void * p = block.Allocate();
+			void * p = AllocateFromBlock( block );
 			assert( !block.IsCorrupt( BaseClass::blockSize_, BaseClass::alignment_, objectSize_ ) );
 			if ( nullptr != p )
 			{
@@ -439,32 +1113,31 @@ struct AnyPoolBlockInfo : BlockInfo< BlockType >
 			}
 		}
 
-		// Now search through all existing blocks to see if any can allocate.
-		BlocksIter begin( BaseClass::blocks_.begin() );
-		BlocksIter it( begin );
-		while ( it != end )
+		// Now get a block from the list of blocks with free chunks instead of searching all blocks.
+		BlocksIter it( FindListedBlock() );
+		if ( it != end )
 		{
 			BlockType & block = *it;
+			void * p = AllocateFromBlock( block );
+			assert( nullptr != p );
 			assert( !block.IsCorrupt( BaseClass::blockSize_, BaseClass::alignment_, objectSize_ ) );
-			void * p = block.Allocate();
-			assert( !block.IsCorrupt( BaseClass::blockSize_, BaseClass::alignment_, objectSize_ ) );
-			if ( nullptr != p )
-			{
-				BaseClass::recent_ = it;
-				return p;
-			}
-			++it;
+			BaseClass::recent_ = it;
+			return p;
 		}
 
 		// Now try to create a new block and insert it into container.
-		const unsigned int objectsPerPool = BaseClass::blockSize_ / objectSize_;
-		BlockType block( BaseClass::blockSize_, objectSize_, BaseClass::alignment_, objectsPerPool );
+		ReserveListedBlock();
+		const unsigned int objectsPerPool = BlockType::GetObjectsPerBlock( BaseClass::blockSize_, objectSize_ );
+		BlockType block( BaseClass::blockSize_, objectSize_, BaseClass::alignment_, objectsPerPool, BaseClass::blockAlignment_, BaseClass::source_ );
 		assert( !block.IsCorrupt( BaseClass::blockSize_, BaseClass::alignment_, objectSize_ ) );
-		void * p = block.Allocate();
+		void * p = block.Allocate( objectSize_ );
 		assert( nullptr != p );
 		assert( !block.IsCorrupt( BaseClass::blockSize_, BaseClass::alignment_, objectSize_ ) );
-		it = std::lower_bound( begin, end, block );
-		BaseClass::recent_ = BaseClass::blocks_.insert( it, block );
+		BaseClass::recent_ = InsertBlock( block );
+		if ( !BaseClass::recent_->IsFull() )
+		{
+			ListBlock( *( BaseClass::recent_ ) );
+		}
 		return p;
 	}
 
@@ -479,12 +1152,16 @@ struct AnyPoolBlockInfo : BlockInfo< BlockType >
 				assert( !block.IsCorrupt( BaseClass::blockSize_, BaseClass::alignment_, objectSize_ ) );
 				const bool success = block.Release( place );
 				assert( !block.IsCorrupt( BaseClass::blockSize_, BaseClass::alignment_, objectSize_ ) );
-				if ( success && block.IsEmpty() )
+				if ( success && block.IsEmpty() && !BaseClass::KeepEmptyBlock() )
 				{
-					block.Destroy();
-					BaseClass::blocks_.erase( BaseClass::recent_ );
+					UnlistBlock( block );
+					DestroyBlock( BaseClass::recent_ );
 					BaseClass::recent_ = BaseClass::blocks_.end();
 				}
+				else if ( success && !block.IsListed() )
+				{
+					ListBlock( block );
+				}
 				return success;
 			}
 		}
@@ -498,19 +1175,125 @@ struct AnyPoolBlockInfo : BlockInfo< BlockType >
 		assert( !block.IsCorrupt( BaseClass::blockSize_, BaseClass::alignment_, objectSize_ ) );
 		const bool success = block.Release( place );
 		assert( !block.IsCorrupt( BaseClass::blockSize_, BaseClass::alignment_, objectSize_ ) );
-		if ( success && block.IsEmpty() )
+		if ( success && block.IsEmpty() && !BaseClass::KeepEmptyBlock() )
 		{
 			const bool resetRecent = ( it == BaseClass::recent_ );
-			block.Destroy();
-			BaseClass::blocks_.erase( it );
+			UnlistBlock( block );
+			DestroyBlock( it );
 			if ( resetRecent || ( BaseClass::blocks_.size() == 0 ) || ( BaseClass::blocks_.end() < BaseClass::recent_ ) )
 			{
 				BaseClass::recent_ = BaseClass::blocks_.end();
 			}
 		}
+		else if ( success && !block.IsListed() )
+		{
+			ListBlock( block );
+		}
 		return success;
 	}
 
+	/** Allocates count chunks and places them into the array. Fills the hinted block first, then the
+	 most recently used block, then other blocks, and makes new blocks only if needed. If it can't make
+	 a new block, this releases the chunks it already allocated and throws std::bad_alloc.
+	 */
+	void AllocateBulk( void ** places, std::size_t count, const void * hint )
+	{
+		std::size_t filled = 0;
+		try
+		{
+			FillBulk( places, count, hint, filled );
+		}
+		catch ( ... )
+		{
+			ReleaseBulk( places, filled );
+			throw std::bad_alloc();
+		}
+	}
+
+	/** Does the work of AllocateBulk for this and for derived pools, which release chunks their own way.
+	 @param filled Gets number of chunks placed into the array so far, so the caller can release them if
+	  this throws because it can't make a new block.
+	 */
+	void FillBulk( void ** places, std::size_t count, const void * hint, std::size_t & filled )
+	{
+		// Check hint first.
+		if ( nullptr != hint )
+		{
+			BlocksIter it = BaseClass::GetBlock( hint );
+			if ( it != BaseClass::blocks_.end() )
+			{
+				const std::size_t got = FillFromBlock( *it, places, count );
+				if ( 0 != got )
+				{
+					filled += got;
+					BaseClass::recent_ = it;
+				}
+			}
+		}
+
+		// Check most recently used block next.
+		if ( ( filled < count ) && ( BaseClass::recent_ != BaseClass::blocks_.end() ) )
+		{
+			filled += FillFromBlock( *( BaseClass::recent_ ), places + filled, count - filled );
+		}
+
+		// Now take free chunks from blocks in the list of blocks with free chunks.
+		while ( filled < count )
+		{
+			BlocksIter it( FindListedBlock() );
+			if ( it == BaseClass::blocks_.end() )
+			{
+				break;
+			}
+			filled += FillFromBlock( *it, places + filled, count - filled );
+			BaseClass::recent_ = it;
+		}
+
+		// Now create as many new blocks as needed.
+		const unsigned int objectsPerPool = BlockType::GetObjectsPerBlock( BaseClass::blockSize_, objectSize_ );
+		while ( filled < count )
+		{
+			ReserveListedBlock();
+			BlockType block( BaseClass::blockSize_, objectSize_, BaseClass::alignment_, objectsPerPool, BaseClass::blockAlignment_, BaseClass::source_ );
+			try
+			{
+				BaseClass::recent_ = InsertBlock( block );
+			}
+			catch ( ... )
+			{
+				block.Destroy( BaseClass::blockSize_, BaseClass::blockAlignment_, BaseClass::source_ );
+				throw;
+			}
+			filled += FillFromBlock( *( BaseClass::recent_ ), places + filled, count - filled );
+			if ( !BaseClass::recent_->IsFull() )
+			{
+				ListBlock( *( BaseClass::recent_ ) );
+			}
+		}
+	}
+
+	/** Releases count chunks from the array. Consecutive chunks are often in the same block, so this
+	 only searches for a block when a chunk is not in the most recently used block.
+	 @return True if all were released, false if any chunk was not in a block.
+	 */
+	bool ReleaseBulk( void ** places, std::size_t count )
+	{
+		bool allReleased = true;
+		for ( std::size_t ii = 0; ii < count; ++ii )
+		{
+			void * place = places[ ii ];
+			if ( ( BaseClass::recent_ == BaseClass::blocks_.end() ) || !BaseClass::recent_->HasAddress( place, BaseClass::blockSize_ ) )
+			{
+				BaseClass::recent_ = BaseClass::GetBlock( place );
+			}
+			if ( !Release( place ) )
+			{
+				allReleased = false;
+			}
+		}
+		return allReleased;
+	}
+
 	bool TrimEmptyBlocks()
 	{
 		bool foundAny = false;
@@ -523,7 +1306,8 @@ struct AnyPoolBlockInfo : BlockInfo< BlockType >
 			BlockType & block = *it;
 			if ( block.IsEmpty() )
 			{
-				block.Destroy();
+				BaseClass::index_.erase( BaseClass::GetBlockKey( block ) );
+				block.Destroy( BaseClass::blockSize_, BaseClass::blockAlignment_, BaseClass::source_ );
 				foundAny = true;
 			}
 			else
@@ -533,7 +1317,22 @@ struct AnyPoolBlockInfo : BlockInfo< BlockType >
 		}
 		temp.swap( BaseClass::blocks_ );
 		temp.shrink_to_fit();
+		BaseClass::IndexBlocks( BaseClass::blocks_.begin() );
 		BaseClass::recent_ = BaseClass::blocks_.end();
+		BaseClass::emptyCount_ = 0;
+
+		// Destroyed blocks were all listed, and the others moved, so rebuild list from blocks which remain.
+		partial_.clear();
+		const BlocksIter begin( BaseClass::blocks_.begin() );
+		end = BaseClass::blocks_.end();
+		for ( BlocksIter it( begin ); it != end; ++it )
+		{
+			if ( it->IsListed() )
+			{
+				it->SetListPosition( static_cast< unsigned int >( partial_.size() ) );
+				partial_.push_back( static_cast< std::size_t >( it - begin ) );
+			}
+		}
 
 		return foundAny;
 	}
@@ -542,17 +1341,197 @@ struct AnyPoolBlockInfo : BlockInfo< BlockType >
 	{
 		assert( nullptr != this );
 
+		std::size_t emptyCount = 0;
 		const BlocksCIter end( BaseClass::blocks_.end() );
 		for ( BlocksCIter it( BaseClass::blocks_.begin() ); it != end; ++it )
 		{
 			const BlockType & block = *it;
 			assert( !block.IsCorrupt( BaseClass::blockSize_, BaseClass::alignment_, objectSize_ ) );
+			if ( block.IsEmpty() )
+			{
+				++emptyCount;
+			}
+		}
+		assert( emptyCount == BaseClass::emptyCount_ );
+		assert( !BaseClass::IsIndexCorrupt() );
+		assert( !IsListCorrupt() );
+		return false;
+	}
+
+	/// Checks that every block with free chunks is listed exactly once, and the list never needs to grow on release.
+	bool IsListCorrupt() const
+	{
+		assert( BaseClass::blocks_.size() <= partial_.capacity() );
+		std::size_t listedCount = 0;
+		const BlocksCIter begin( BaseClass::blocks_.begin() );
+		const BlocksCIter end( BaseClass::blocks_.end() );
+		for ( BlocksCIter it( begin ); it != end; ++it )
+		{
+			const BlockType & block = *it;
+			if ( block.IsListed() )
+			{
+				++listedCount;
+				assert( block.GetListPosition() < partial_.size() );
+				assert( partial_[ block.GetListPosition() ] == static_cast< std::size_t >( it - begin ) );
+			}
+			else
+			{
+				assert( block.IsFull() );
+			}
 		}
+		assert( listedCount == partial_.size() );
 		return false;
 	}
 
+	/** Provides a block with free chunks from the list, or end if every block is full. Full blocks are
+	 removed from the list lazily here, and listed again when a chunk in them is released. The list holds
+	 each block's position within the container, so this never searches for a block.
+	 */
+	BlocksIter FindListedBlock()
+	{
+		while ( !partial_.empty() )
+		{
+			assert( partial_.back() < BaseClass::blocks_.size() );
+			BlocksIter it( BaseClass::blocks_.begin() + partial_.back() );
+			BlockType & block = *it;
+			assert( block.IsListed() );
+			if ( !block.IsFull() )
+			{
+				return it;
+			}
+			block.Unlist();
+			partial_.pop_back();
+		}
+		return BaseClass::blocks_.end();
+	}
+
+	/// Returns true if a chunk can be allocated without making a new block.
+	bool HasFreeChunk()
+	{
+		if ( ( BaseClass::recent_ != BaseClass::blocks_.end() ) && !BaseClass::recent_->IsFull() )
+		{
+			return true;
+		}
+		return ( FindListedBlock() != BaseClass::blocks_.end() );
+	}
+
+	/// Adds block to list of blocks with free chunks. Never throws since the list has room for every block.
+	void ListBlock( BlockType & block )
+	{
+		assert( !block.IsListed() );
+		assert( partial_.size() < partial_.capacity() );
+		assert( ( BaseClass::blocks_.data() <= &block ) && ( &block < BaseClass::blocks_.data() + BaseClass::blocks_.size() ) );
+		block.SetListPosition( static_cast< unsigned int >( partial_.size() ) );
+		partial_.push_back( static_cast< std::size_t >( &block - BaseClass::blocks_.data() ) );
+	}
+
+	/** Removes block from list of blocks with free chunks. Called just before the block is destroyed. The
+	 block knows its own position, and the last listed block moves into that position, so this never searches
+	 the list or the container.
+	 */
+	void UnlistBlock( BlockType & block )
+	{
+		if ( !block.IsListed() )
+		{
+			return;
+		}
+		const unsigned int position = block.GetListPosition();
+		assert( position < partial_.size() );
+		assert( partial_[ position ] == static_cast< std::size_t >( &block - BaseClass::blocks_.data() ) );
+		block.Unlist();
+		const std::size_t last = partial_.back();
+		partial_.pop_back();
+		if ( position < partial_.size() )
+		{
+			partial_[ position ] = last;
+			BaseClass::blocks_[ last ].SetListPosition( position );
+		}
+	}
+
+	/** Inserts block into container. Blocks which are not aligned are kept sorted, so the blocks after the
+	 new one shift up, and their places in the list shift with them. Aligned blocks are appended, so none move.
+	 */
+	BlocksIter InsertBlock( const BlockType & block )
+	{
+		const BlocksIter it( BaseClass::InsertBlock( block ) );
+		const BlocksIter end( BaseClass::blocks_.end() );
+		for ( BlocksIter moved( it + 1 ); moved != end; ++moved )
+		{
+			if ( moved->IsListed() )
+			{
+				++partial_[ moved->GetListPosition() ];
+			}
+		}
+		return it;
+	}
+
+	/** Destroys block, which the caller already removed from the list, and keeps the list pointing at the
+	 blocks which moved. Blocks which are not aligned shift down. For aligned blocks, only the last block
+	 moves into the destroyed block's place.
+	 */
+	BlocksIter DestroyBlock( BlocksIter it )
+	{
+		assert( !it->IsListed() );
+		const BlocksIter result( BaseClass::DestroyBlock( it ) );
+		const BlocksIter begin( BaseClass::blocks_.begin() );
+		const BlocksIter end( BaseClass::blocks_.end() );
+		if ( 0 != BaseClass::blockAlignment_ )
+		{
+			if ( ( result != end ) && result->IsListed() )
+			{
+				partial_[ result->GetListPosition() ] = static_cast< std::size_t >( result - begin );
+			}
+			return result;
+		}
+		for ( BlocksIter moved( result ); moved != end; ++moved )
+		{
+			if ( moved->IsListed() )
+			{
+				--partial_[ moved->GetListPosition() ];
+			}
+		}
+		return result;
+	}
+
+	/// Makes sure the list has room for one more block. Called before a new block is added.
+	void ReserveListedBlock()
+	{
+		if ( partial_.capacity() <= BaseClass::blocks_.size() )
+		{
+			partial_.reserve( 2 * BaseClass::blocks_.size() + 1 );
+		}
+	}
+
+	/// Allocates from block, and stops counting it as empty if it was a kept empty block.
+	void * AllocateFromBlock( BlockType & block )
+	{
+		if ( ( 0 != BaseClass::emptyCount_ ) && block.IsEmpty() )
+		{
+			--BaseClass::emptyCount_;
+		}
+		return block.Allocate( objectSize_ );
+	}
+
+	/// Allocates up to count chunks from the block, and returns how many it allocated.
+	std::size_t FillFromBlock( BlockType & block, void ** places, std::size_t count )
+	{
+		std::size_t ii = 0;
+		for ( ; ii < count; ++ii )
+		{
+			void * p = AllocateFromBlock( block );
+			if ( nullptr == p )
+			{
+				break;
+			}
+			places[ ii ] = p;
+		}
+		return ii;
+	}
+
 	/// Size of each object maintained by the allocator.
 	std::size_t objectSize_;
+	/// Positions within blocks_ of blocks which may have free chunks. Has room for every block so release never allocates.
+	Positions partial_;
 
 };
 
@@ -567,8 +1546,9 @@ struct TinyBlockPoolInfo : AnyPoolBlockInfo< BlockType >
 	typedef typename BaseClass::BlocksIter BlocksIter;
 	typedef typename BaseClass::BlocksCIter BlocksCIter;
 
-	TinyBlockPoolInfo( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment ) :
-		BaseClass( initialBlocks, blockSize, objectSize, alignment )
+	TinyBlockPoolInfo( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+		std::size_t blockAlignment, unsigned int retainedEmptyBlocks, BlockSource * source ) :
+		BaseClass( initialBlocks, blockSize, objectSize, alignment, blockAlignment, retainedEmptyBlocks, source )
 	{
 //		std::cout << __FUNCTION__ << " : " << __LINE__ << std::endl;
 	}
@@ -587,8 +1567,7 @@ struct TinyBlockPoolInfo : AnyPoolBlockInfo< BlockType >
 			if ( it != end )
 			{
 				assert( BaseClass::blocks_.size() != 0 );
-				BlockType & block = *it;
-				void * p = block.Allocate( BaseClass::objectSize_ );
+				void * p = BaseClass::AllocateFromBlock( *it );
 				if ( nullptr != p )
 				{
 					BaseClass::recent_ = it;
@@ -602,8 +1581,7 @@ struct TinyBlockPoolInfo : AnyPoolBlockInfo< BlockType >
 		if ( BaseClass::recent_ != end )
 		{
 			assert( BaseClass::blocks_.size() != 0 );
-			BlockType & block = *( BaseClass::recent_ );
-			void * p = block.Allocate( BaseClass::objectSize_ );
+			void * p = BaseClass::AllocateFromBlock( *( BaseClass::recent_ ) );
 			if ( nullptr != p )
 			{
 				assert( !IsCorrupt() );
@@ -611,30 +1589,28 @@ struct TinyBlockPoolInfo : AnyPoolBlockInfo< BlockType >
 			}
 		}
 
-		// Now search through all existing blocks to see if any can allocate.
-		BlocksIter begin( BaseClass::blocks_.begin() );
-		BlocksIter it( begin );
-		while ( it != end )
+		// Now get a block from the list of blocks with free chunks instead of searching all blocks.
+		BlocksIter it( BaseClass::FindListedBlock() );
+		if ( it != end )
 		{
-			assert( BaseClass::blocks_.size() != 0 );
-			BlockType & block = *it;
-			void * p = block.Allocate( BaseClass::objectSize_ );
-			if ( nullptr != p )
-			{
-				BaseClass::recent_ = it;
-				assert( !IsCorrupt() );
-				return p;
-			}
-			++it;
+			void * p = BaseClass::AllocateFromBlock( *it );
+			assert( nullptr != p );
+			BaseClass::recent_ = it;
+			assert( !IsCorrupt() );
+			return p;
 		}
 
 		// Now try to create a new block and insert it into container.
-		const unsigned int objectsPerPool = BaseClass::blockSize_ / BaseClass::objectSize_;
-		BlockType block( BaseClass::blockSize_, BaseClass::objectSize_, BaseClass::alignment_, objectsPerPool );
+		BaseClass::ReserveListedBlock();
+		const unsigned int objectsPerPool = BlockType::GetObjectsPerBlock( BaseClass::blockSize_, BaseClass::objectSize_ );
+		BlockType block( BaseClass::blockSize_, BaseClass::objectSize_, BaseClass::alignment_, objectsPerPool, BaseClass::blockAlignment_, BaseClass::source_ );
 		void * p = block.Allocate( BaseClass::objectSize_ );
 		assert( nullptr != p );
-		it = std::lower_bound( begin, end, block );
-		BaseClass::recent_ = BaseClass::blocks_.insert( it, block );
+		BaseClass::recent_ = BaseClass::InsertBlock( block );
+		if ( !BaseClass::recent_->IsFull() )
+		{
+			BaseClass::ListBlock( *( BaseClass::recent_ ) );
+		}
 		assert( !IsCorrupt() );
 		return p;
 	}
@@ -649,12 +1625,16 @@ struct TinyBlockPoolInfo : AnyPoolBlockInfo< BlockType >
 			if ( block.HasAddress( place, BaseClass::blockSize_ ) )
 			{
 				block.Release( place, BaseClass::objectSize_ );
-				if ( block.IsEmpty() )
+				if ( block.IsEmpty() && !BaseClass::KeepEmptyBlock() )
 				{
-					block.Destroy();
-					BaseClass::blocks_.erase( BaseClass::recent_ );
+					BaseClass::UnlistBlock( block );
+					BaseClass::DestroyBlock( BaseClass::recent_ );
 					BaseClass::recent_ = BaseClass::blocks_.end();
 				}
+				else if ( !block.IsListed() )
+				{
+					BaseClass::ListBlock( block );
+				}
 				assert( !IsCorrupt() );
 				return true;
 			}
@@ -668,20 +1648,66 @@ struct TinyBlockPoolInfo : AnyPoolBlockInfo< BlockType >
 		}
 		BlockType & block = *it;
 		block.Release( place, BaseClass::objectSize_ );
-		if ( block.IsEmpty() )
+		if ( block.IsEmpty() && !BaseClass::KeepEmptyBlock() )
 		{
 			const bool resetRecent = ( it == BaseClass::recent_ );
-			block.Destroy();
-			BaseClass::blocks_.erase( it );
+			BaseClass::UnlistBlock( block );
+			BaseClass::DestroyBlock( it );
 			if ( resetRecent || ( BaseClass::blocks_.size() == 0 ) || ( BaseClass::recent_ > BaseClass::blocks_.end() ) )
 			{
 				BaseClass::recent_ = BaseClass::blocks_.end();
 			}
 		}
+		else if ( !block.IsListed() )
+		{
+			BaseClass::ListBlock( block );
+		}
 		assert( !IsCorrupt() );
 		return true;
 	}
 
+	/** Allocates count chunks and places them into the array. Fills the hinted block first, then the
+	 most recently used block, then other blocks, and makes new blocks only if needed. If it can't make
+	 a new block, this releases the chunks it already allocated and throws std::bad_alloc.
+	 */
+	void AllocateBulk( void ** places, std::size_t count, const void * hint )
+	{
+		assert( !IsCorrupt() );
+		std::size_t filled = 0;
+		try
+		{
+			BaseClass::FillBulk( places, count, hint, filled );
+		}
+		catch ( ... )
+		{
+			ReleaseBulk( places, filled );
+			throw std::bad_alloc();
+		}
+		assert( !IsCorrupt() );
+	}
+
+	/** Releases count chunks from the array. Consecutive chunks are often in the same block, so this
+	 only searches for a block when a chunk is not in the most recently used block.
+	 @return True if all were released, false if any chunk was not in a block.
+	 */
+	bool ReleaseBulk( void ** places, std::size_t count )
+	{
+		bool allReleased = true;
+		for ( std::size_t ii = 0; ii < count; ++ii )
+		{
+			void * place = places[ ii ];
+			if ( ( BaseClass::recent_ == BaseClass::blocks_.end() ) || !BaseClass::recent_->HasAddress( place, BaseClass::blockSize_ ) )
+			{
+				BaseClass::recent_ = BaseClass::GetBlock( place );
+			}
+			if ( !Release( place ) )
+			{
+				allReleased = false;
+			}
+		}
+		return allReleased;
+	}
+
 	bool IsCorrupt() const
 	{
 		assert( nullptr != this );
@@ -692,12 +1718,20 @@ struct TinyBlockPoolInfo : AnyPoolBlockInfo< BlockType >
 			assert( begin <= BaseClass::recent_ );
 			assert( BaseClass::recent_ < end );
 		}
+		std::size_t emptyCount = 0;
 		for ( BlocksCIter it( begin ); it != end; ++it )
 		{
 			const BlockType & block = *it;
 			assert( !block.IsDestroyed() );
 			assert( !block.IsCorrupt( BaseClass::objectSize_ ) );
+			if ( block.IsEmpty() )
+			{
+				++emptyCount;
+			}
 		}
+		assert( emptyCount == BaseClass::emptyCount_ );
+		assert( !BaseClass::IsIndexCorrupt() );
+		assert( !BaseClass::IsListCorrupt() );
 		return false;
 	}
 
@@ -705,12 +1739,14 @@ struct TinyBlockPoolInfo : AnyPoolBlockInfo< BlockType >
 
 // ----------------------------------------------------------------------------
 
-typedef BlockInfo< LinearBlock > LinearBlockInfo;
-typedef BlockInfo< StackBlock > StackBlockInfo;
+typedef AnyLinearBlockInfo< LinearBlock > LinearBlockInfo;
+typedef AnyStackBlockInfo< StackBlock > StackBlockInfo;
 typedef BlockInfo< ListBlock > ListBlockInfo;
 
 typedef AnyPoolBlockInfo< PoolBlock > PoolBlockInfo;
+typedef AnyPoolBlockInfo< BitmapBlock > BitmapBlockInfo;
 typedef TinyBlockPoolInfo< TinyBlock > TinyBlockInfo;
+typedef TinyBlockPoolInfo< WideTinyBlock > WideTinyBlockInfo;
 
 // ----------------------------------------------------------------------------
 
@@ -0,0 +1,307 @@
+
+#pragma once
+
+#include <cstddef> // For std::size_t.
+
+#include <atomic>
+#include <mutex>
+
+namespace memwa
+{
+
+class Allocator;
+
+// ----------------------------------------------------------------------------
+
+/** @class BlockSource
+ Provides the memory for each block used by an allocator. An allocator gets its blocks from the source
+ in AllocatorParameters::blockSource, or from malloc if that is nullptr. A source may be shared by many
+ allocators, and must be thread-safe if any of them are used by more than one thread. A source must
+ outlive every allocator which uses it.
+
+ # Usage Patterns
+ You can derive from BlockSource for:
+ - Backing allocators with memory from the operating system instead of malloc.
+ - Backing allocators with chunks from another Memwa allocator.
+ - Backing allocators with memory the program already owns.
+ */
+class BlockSource
+{
+public:
+
+	/** Allocates memory for a block.
+	 @param blockSize Number of bytes in block.
+	 @param blockAlignment Power of two the block's address must be a multiple of, or zero for default alignment.
+	 @return Pointer to block, or nullptr if there is not enough memory.
+	 */
+	virtual void * AllocateBlock( std::size_t blockSize, std::size_t blockAlignment ) = 0;
+
+	/** Releases a block made by AllocateBlock.
+	 @param block Address returned by AllocateBlock.
+	 @param blockSize Same number of bytes passed to AllocateBlock.
+	 @param blockAlignment Same alignment passed to AllocateBlock.
+	 */
+	virtual void ReleaseBlock( void * block, std::size_t blockSize, std::size_t blockAlignment ) = 0;
+
+	virtual ~BlockSource();
+
+protected:
+
+	BlockSource();
+
+private:
+
+	BlockSource( const BlockSource & ) = delete;
+	BlockSource( BlockSource && ) = delete;
+	BlockSource & operator = ( const BlockSource & ) = delete;
+	BlockSource & operator = ( BlockSource && ) = delete;
+
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class MallocBlockSource
+ Gets blocks from malloc, or from posix_memalign or _aligned_malloc if a block needs more alignment than
+ malloc provides. This is what allocators use when AllocatorParameters::blockSource is nullptr.
+ */
+class MallocBlockSource : public BlockSource
+{
+public:
+
+	MallocBlockSource();
+
+	virtual ~MallocBlockSource();
+
+	virtual void * AllocateBlock( std::size_t blockSize, std::size_t blockAlignment ) override;
+
+	virtual void ReleaseBlock( void * block, std::size_t blockSize, std::size_t blockAlignment ) override;
+
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class MmapBlockSource
+ Gets each block directly from the operating system with mmap, or VirtualAlloc on Windows. Each block
+ takes a whole number of pages, and its pages are returned to the operating system as soon as it is
+ released, so nothing is kept by the C library's heap. This suits allocators with big blocks, or ones
+ which make and destroy blocks rarely, since each call costs a system call.
+ */
+class MmapBlockSource : public BlockSource
+{
+public:
+
+	MmapBlockSource();
+
+	virtual ~MmapBlockSource();
+
+	virtual void * AllocateBlock( std::size_t blockSize, std::size_t blockAlignment ) override;
+
+	virtual void ReleaseBlock( void * block, std::size_t blockSize, std::size_t blockAlignment ) override;
+
+	/// Provides number of bytes in each page of memory.
+	static std::size_t GetPageSize();
+
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class HugePageBlockSource
+ Gets each block from the operating system backed by 2 MB pages, so traversing a big pool misses the TLB
+ far less often. It first asks for explicit huge pages with MAP_HUGETLB. If the machine has no huge pages
+ reserved, it maps memory aligned to 2 MB and asks the kernel with madvise( MADV_HUGEPAGE ) to back it
+ with transparent huge pages, and if even that fails it keeps the ordinary pages. Each time MAP_HUGETLB
+ fails, this skips it for twice as many later blocks as before, up to MaxHugeTlbBackoff, so huge pages
+ reserved or freed later still get used without a failing system call for every block. On Windows it
+ tries VirtualAlloc with MEM_LARGE_PAGES, which needs the SeLockMemoryPrivilege, and falls back to
+ ordinary pages.
+
+ Each block takes a whole number of huge pages, so use RoundBlockSize to pick a blockSize which wastes
+ none of them. AllocatorManager::CreateAllocator does that for allocators which use this source. The
+ counts show how many blocks got each kind of page.
+ */
+class HugePageBlockSource : public MmapBlockSource
+{
+public:
+
+	/// Number of bytes in each huge page.
+	static const std::size_t HugePageSize = 2 * 1024 * 1024;
+	/// Most blocks skipped before asking for explicit huge pages again after asking failed.
+	static const std::size_t MaxHugeTlbBackoff = 256;
+
+	HugePageBlockSource();
+
+	virtual ~HugePageBlockSource();
+
+	virtual void * AllocateBlock( std::size_t blockSize, std::size_t blockAlignment ) override;
+
+	virtual void ReleaseBlock( void * block, std::size_t blockSize, std::size_t blockAlignment ) override;
+
+	/// Provides smallest multiple of HugePageSize which is at least blockSize.
+	static std::size_t RoundBlockSize( std::size_t blockSize );
+
+	/// Provides number of blocks allocated from explicit huge pages, such as with MAP_HUGETLB.
+	std::size_t GetHugeTlbBlockCount() const
+	{
+		return hugeTlbBlocks_.load( std::memory_order_relaxed );
+	}
+
+	/** Provides number of blocks for which madvise( MADV_HUGEPAGE ) succeeded. This counts requests, not
+	 huge pages. The kernel backs them with transparent huge pages only if the settings in
+	 /sys/kernel/mm/transparent_hugepage allow it and enough contiguous memory is free, which AnonHugePages
+	 in /proc/self/smaps shows.
+	 */
+	std::size_t GetAdvisedBlockCount() const
+	{
+		return advisedBlocks_.load( std::memory_order_relaxed );
+	}
+
+	/// Provides number of blocks which only got ordinary pages.
+	std::size_t GetSmallPageBlockCount() const
+	{
+		return smallPageBlocks_.load( std::memory_order_relaxed );
+	}
+
+private:
+
+	/** Provides true if this block should ask for explicit huge pages.
+	 @param blockNumber Gets number of this request for a block, which is passed to HugeTlbFailed.
+	 */
+	bool ShouldTryHugeTlb( std::size_t & blockNumber );
+
+	/// Skips explicit huge pages for the next few blocks after asking for them failed.
+	void HugeTlbFailed( std::size_t blockNumber );
+
+	/// Number of blocks allocated from explicit huge pages.
+	std::atomic< std::size_t > hugeTlbBlocks_;
+	/// Number of blocks for which madvise( MADV_HUGEPAGE ) succeeded.
+	std::atomic< std::size_t > advisedBlocks_;
+	/// Number of blocks which only got ordinary pages.
+	std::atomic< std::size_t > smallPageBlocks_;
+	/// Number of requests for blocks so far.
+	std::atomic< std::size_t > blockRequests_;
+	/// Number of the first request which may ask for explicit huge pages again.
+	std::atomic< std::size_t > nextHugeTlbTry_;
+	/// Number of blocks to skip after the next failure to get explicit huge pages.
+	std::atomic< std::size_t > hugeTlbBackoff_;
+
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class AllocatorBlockSource
+ Gets each block as a chunk from another Memwa allocator, such as a PoolAllocator whose objects are as
+ big as the blocks. The parent must be able to allocate chunks of the block size, and must support the
+ block alignment if blocks are aligned. The parent must be thread-safe if any allocator using this
+ source is used by more than one thread.
+ */
+class AllocatorBlockSource : public BlockSource
+{
+public:
+
+	explicit AllocatorBlockSource( Allocator * parent );
+
+	virtual ~AllocatorBlockSource();
+
+	/// Returns nullptr instead of throwing if the parent runs out of memory.
+	virtual void * AllocateBlock( std::size_t blockSize, std::size_t blockAlignment ) override;
+
+	virtual void ReleaseBlock( void * block, std::size_t blockSize, std::size_t blockAlignment ) override;
+
+	Allocator * GetParent() const
+	{
+		return parent_;
+	}
+
+private:
+
+	/// Allocator which provides each block.
+	Allocator * parent_;
+
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class RegionBlockSource
+ Carves blocks from memory the program already owns, such as a static array, a buffer on the stack, or
+ a region mapped at startup, so allocators using it never ask the heap for blocks. Released blocks are
+ merged with free neighbors and reused. The list of free ranges is kept inside the free memory itself,
+ so this never allocates memory for its own use.
+
+ The region may grow in two bounded ways. The program may give it more memory with AddRegion, or it may
+ be made with a growth source from which it gets chunks of growthSize bytes when it runs out, until it
+ has gotten maxGrowth bytes in all. Chunks from the growth source are released when this is destroyed.
+
+ Every block starts on a multiple of Granularity bytes and takes a multiple of Granularity bytes. This
+ locks a mutex for each call, so it may be shared by allocators in different threads.
+ */
+class RegionBlockSource : public BlockSource
+{
+public:
+
+	/// Alignment and size of smallest free range. Blocks take whole multiples of this.
+	static const std::size_t Granularity = 16;
+
+	/** Makes a source which carves blocks from one region.
+	 @param region Start of memory owned by the program. It must outlive this.
+	 @param regionSize Number of bytes in region.
+	 @param growthSource Provides more memory when the regions are used up, or nullptr for no growth.
+	 @param growthSize Smallest number of bytes to get from growthSource at once.
+	 @param maxGrowth Most bytes to get from growthSource in all.
+	 */
+	RegionBlockSource( void * region, std::size_t regionSize, BlockSource * growthSource = nullptr,
+		std::size_t growthSize = 0, std::size_t maxGrowth = 0 );
+
+	/// Releases any chunks gotten from the growth source.
+	virtual ~RegionBlockSource();
+
+	virtual void * AllocateBlock( std::size_t blockSize, std::size_t blockAlignment ) override;
+
+	virtual void ReleaseBlock( void * block, std::size_t blockSize, std::size_t blockAlignment ) override;
+
+	/** Adds another region from which to carve blocks.
+	 @param region Start of memory owned by the program. It must outlive this.
+	 @param regionSize Number of bytes in region. Bytes before the first multiple of Granularity and
+	  after the last one are not used.
+	 */
+	void AddRegion( void * region, std::size_t regionSize );
+
+	/// Provides number of bytes not used by any block.
+	std::size_t GetFreeBytes() const;
+
+	/// Provides number of bytes gotten from the growth source.
+	std::size_t GetGrowthBytes() const;
+
+private:
+
+	/// Header at start of each free range.
+	struct FreeRange;
+	/// Header at start of each chunk from the growth source.
+	struct GrowthChunk;
+
+	/// Puts a range in the address-ordered free list, merging it with neighbors it touches.
+	void AddFreeRange( unsigned char * place, std::size_t rangeSize );
+
+	/// Takes an aligned block from the first free range big enough to hold it, or returns nullptr.
+	void * CarveBlock( std::size_t blockSize, std::size_t blockAlignment );
+
+	/// Gets a chunk from the growth source big enough for the block. Returns false if it can't.
+	bool Grow( std::size_t blockSize, std::size_t blockAlignment );
+
+	mutable std::mutex mutex_;
+	/// Free range with lowest address.
+	FreeRange * free_;
+	/// Chunks gotten from growth source, which are released when this is destroyed.
+	GrowthChunk * chunks_;
+	BlockSource * growthSource_;
+	std::size_t growthSize_;
+	std::size_t maxGrowth_;
+	/// Number of bytes gotten from the growth source.
+	std::size_t growthBytes_;
+	/// Number of bytes in all free ranges.
+	std::size_t freeBytes_;
+
+};
+
+// ----------------------------------------------------------------------------
+
+} // end project namespace
@@ -0,0 +1,168 @@
+
+#pragma once
+
+#include "AllocatorManager.hpp"
+
+#include "BlockInfo.hpp"
+
+#include <cstddef> // For std::size_t.
+
+#include <mutex>
+#include <vector>
+
+namespace memwa
+{
+
+class AllocatorManager;
+class LinearBlock;
+
+/** @class FrameAllocator
+ This allocator keeps several arenas of linear blocks, one for each of the most recent frames. Chunks are
+ allocated from the current frame's arena by moving a pointer, with no bookkeeping for each chunk, and
+ are never released one at a time. AdvanceFrame makes the oldest arena current and releases every chunk
+ in it, so a chunk lives until AdvanceFrame is called frameCount times after it was allocated. The blocks
+ of each arena are kept, so later frames reuse memory which is likely still in the CPU cache.
+
+ # Usage Patterns
+ - Data made during one tick of a simulation loop and read during the next tick.
+ - Double-buffered or triple-buffered data passed between stages of a pipeline.
+ */
+class FrameAllocator : public Allocator
+{
+public:
+
+	/// Most arenas an allocator may have.
+	static const unsigned int MaxFrameCount = 16;
+
+	/** Allocates a chunk of memory from the current frame.
+	 @param size Number of bytes to allocate.
+	 @return Pointer to chunk of memory of at least size bytes.
+	 */
+	virtual void * Allocate( std::size_t size, const void * hint = nullptr ) override;
+
+#if __cplusplus > 201402L
+	// This code is for C++ 2017.
+
+	virtual void * Allocate( std::size_t size, std::align_val_t alignment, const void * hint = nullptr ) override;
+
+#else
+
+	virtual void * Allocate( std::size_t size, std::size_t alignment, const void * hint = nullptr ) override;
+
+#endif
+
+	virtual unsigned long long GetMaxSize( std::size_t objectSize ) const override;
+
+	/// Returns true if a block of memory managed by this object owns the chunk at the place
+	virtual bool HasAddress( void * place ) const override;
+
+	/// Deletes any blocks that have zero allocations.
+	virtual bool TrimEmptyBlocks() override;
+
+	/// Returns true if any memory block was corrupted.
+	virtual bool IsCorrupt() const override;
+
+	virtual float GetFragmentationPercent() const override;
+
+	/** Makes the oldest frame current, and releases every chunk allocated in it. This takes time in
+	 proportion to the number of blocks that frame used, and keeps those blocks for the new frame.
+	 */
+	virtual void AdvanceFrame();
+
+	/// Provides number of frames whose chunks are kept.
+	unsigned int GetFrameCount() const
+	{
+		return static_cast< unsigned int >( frames_.size() );
+	}
+
+protected:
+
+	/** Creates allocator with an arena for each frame. This will throw a bad_alloc exception if it
+	 can't pre-allocate the number of blocks requested.
+	 @param initialBlocks Number of blocks to pre-allocate for each frame.
+	 @param blockSize Number of bytes in each block. Should be multiple of alignment.
+	 @param alignment Byte boundaries to align allocations. Must be power of two.
+	 @param frameCount Number of frames, from 2 through MaxFrameCount.
+	 @param source Provides memory for each block, or nullptr to use malloc.
+	 */
+	FrameAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment, unsigned int frameCount,
+		BlockSource * source );
+
+	virtual ~FrameAllocator();
+
+private:
+
+	friend class memwa::AllocatorManager;
+
+	typedef std::vector< LinearBlockInfo > Frames;
+
+	FrameAllocator() = delete;
+	FrameAllocator( const FrameAllocator & ) = delete;
+	FrameAllocator( FrameAllocator && ) = delete;
+	FrameAllocator & operator = ( const FrameAllocator & ) = delete;
+	FrameAllocator & operator = ( FrameAllocator && ) = delete;
+
+	/// Goes through each frame to delete its blocks.
+	virtual void Destroy();
+
+	/// Arenas for each frame. The vector never grows after it is made, so each arena stays in place.
+	Frames frames_;
+	/// Position of current frame within frames_.
+	unsigned int current_;
+
+};
+
+// ----------------------------------------------------------------------------
+
+class ThreadSafeFrameAllocator : public FrameAllocator
+{
+public:
+
+	virtual void * Allocate( std::size_t size, const void * hint = nullptr ) override;
+
+#if __cplusplus > 201402L
+	// This code is for C++ 2017.
+
+	virtual void * Allocate( std::size_t size, std::align_val_t alignment, const void * hint = nullptr ) override;
+
+#else
+
+	virtual void * Allocate( std::size_t size, std::size_t alignment, const void * hint = nullptr ) override;
+
+#endif
+
+	/// Returns true if a block of memory managed by this object owns the chunk at the place
+	virtual bool HasAddress( void * place ) const override;
+
+	/// Deletes any blocks that have zero allocations.
+	virtual bool TrimEmptyBlocks() override;
+
+	/// Returns true if any memory block was corrupted.
+	virtual bool IsCorrupt() const override;
+
+	virtual float GetFragmentationPercent() const override;
+
+	virtual void AdvanceFrame() override;
+
+private:
+
+	friend class memwa::AllocatorManager;
+
+	ThreadSafeFrameAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment,
+		unsigned int frameCount, BlockSource * source );
+
+	virtual ~ThreadSafeFrameAllocator();
+
+	ThreadSafeFrameAllocator() = delete;
+	ThreadSafeFrameAllocator( const ThreadSafeFrameAllocator & ) = delete;
+	ThreadSafeFrameAllocator( ThreadSafeFrameAllocator && ) = delete;
+	ThreadSafeFrameAllocator & operator = ( const ThreadSafeFrameAllocator & ) = delete;
+	ThreadSafeFrameAllocator & operator = ( ThreadSafeFrameAllocator && ) = delete;
+
+	mutable std::mutex mutex_;
+
+};
+
+// ----------------------------------------------------------------------------
+
+} // end project namespace
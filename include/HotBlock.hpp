@@ -0,0 +1,527 @@
+
+#pragma once
+
+#include <cassert>
+#include <climits> // For UCHAR_MAX and UINT_MAX.
+#include <cstddef> // For std::size_t.
+#include <cstdint> // For std::uintptr_t.
+#include <cstring> // For std::memcpy.
+
+namespace memwa
+{
+
+namespace impl
+{
+
+// ----------------------------------------------------------------------------
+
+/** Rounds bytes up to a multiple of alignment the same way CalculateAlignedSize does, but inline.
+ @param alignment Must be a power of two.
+ */
+inline std::size_t AlignSize( std::size_t bytes, std::size_t alignment )
+{
+	if ( 0 == bytes )
+	{
+		return alignment;
+	}
+	return ( bytes + alignment - 1 ) & ~( alignment - 1 );
+}
+
+// ----------------------------------------------------------------------------
+
+/** @class HotLinearBlock
+ Holds the fields of a LinearBlock, and allocates from it with inline code. LinearBlock derives from this, so
+ LinearAllocator can allocate from its most recently used block within its own header, without a virtual call
+ and without seeing the rest of LinearBlock.
+ */
+class HotLinearBlock
+{
+public:
+
+	/** Allocates a chunk at the free spot, after padding the free spot to the alignment.
+	 @param alignment Must be a power of two.
+	 @return Pointer to chunk, or nullptr if the block does not have enough bytes left.
+	 */
+	void * Allocate( std::size_t bytes, std::size_t blockSize, std::size_t alignment )
+	{
+		const std::size_t padding = ( 0 - reinterpret_cast< std::uintptr_t >( freeSpot_ ) ) & ( alignment - 1 );
+		const std::size_t bytesAvailable = static_cast< std::size_t >( ( block_ + blockSize ) - freeSpot_ );
+		if ( ( bytesAvailable < padding ) || ( bytesAvailable - padding < bytes ) )
+		{
+			return nullptr;
+		}
+
+		unsigned char * p = freeSpot_ + padding;
+		freeSpot_ = p + bytes;
+		assert( p < freeSpot_ );
+		assert( freeSpot_ <= block_ + blockSize );
+		assert( reinterpret_cast< std::uintptr_t >( p ) % alignment == 0 );
+		return p;
+	}
+
+protected:
+
+	HotLinearBlock() = default;
+
+	explicit HotLinearBlock( unsigned char * block ) :
+		block_( block ),
+		freeSpot_( block )
+	{
+	}
+
+	/// Pointer to base of entire memory page allocated.
+	unsigned char * block_;
+	/// Pointer to next free spot within this block.
+	unsigned char * freeSpot_;
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class HotStackBlock
+ Holds the fields of a StackBlock, and allocates and releases its top chunk with inline code. StackBlock derives
+ from this, so StackAllocator can use its most recently used block within its own header. Releasing anything but
+ the top chunk, or a chunk of the wrong size, is left to StackBlock::Release since that throws an exception.
+
+ @par Chunk Headers
+ Each chunk ends with a header that tells where it starts, so a release can be checked against it. The header
+ size chosen by the allocator is passed to each function. A full header is a ChunkInfo with the address and size
+ of the chunk. A compact header is the offset of the chunk from the start of the block, in 2 bytes if the block
+ is at most 64 KB and 4 bytes otherwise. A chunk without a header trusts the size passed to Release, and only
+ debug builds check it. The header is counted before rounding up to the alignment, so a 24 byte chunk with an
+ 8 byte alignment takes 40 bytes with a full header, 32 with a compact one, and 24 with none.
+ */
+class HotStackBlock
+{
+public:
+
+	/// A few bytes of memory in each chunk stores the size of the previous chunk.
+	struct ChunkInfo
+	{
+		const bool IsValid( const unsigned char * block, std::size_t blockSize, const std::size_t alignment ) const;
+		unsigned char * prevChunk_;
+		std::size_t prevChunkSize_;
+	};
+
+	/// Sizes of header StackAllocator may put after each chunk.
+	static const std::size_t FullHeaderSize = sizeof(ChunkInfo);
+	static const std::size_t WideHeaderSize = sizeof(std::uint32_t);
+	static const std::size_t NarrowHeaderSize = sizeof(std::uint16_t);
+	static const std::size_t NoHeaderSize = 0;
+
+	/// Returns number of bytes a chunk takes within a block, including its header.
+	static std::size_t GetBytesNeeded( const std::size_t bytes, const std::size_t alignment, const std::size_t headerSize )
+	{
+		return AlignSize( bytes + headerSize, alignment );
+	}
+
+	/// Returns true if this memory block has no allocations.
+	bool IsEmpty( const std::size_t alignment ) const
+	{
+		assert( 0 != alignment );
+		(void)alignment;
+		return ( block_ == freeSpot_ );
+	}
+
+	/** Allocates a chunk of particular size.
+	 @param alignment Must be a power of two.
+	 @param headerSize Bytes of header after each chunk. See Chunk Headers above.
+	 @return Pointer to chunk, or nullptr if the block does not have enough bytes left.
+	 */
+	void * Allocate( const std::size_t bytes, const std::size_t blockSize, const std::size_t alignment,
+		const std::size_t headerSize = FullHeaderSize )
+	{
+		assert( 0 != alignment );
+		assert( 0 != blockSize );
+		assert( 0 != bytes );
+
+		const std::size_t bytesNeeded = GetBytesNeeded( bytes, alignment, headerSize );
+		const std::size_t bytesAvailable = static_cast< std::size_t >( ( block_ + blockSize ) - freeSpot_ );
+		if ( bytesAvailable < bytesNeeded )
+		{
+			return nullptr;
+		}
+
+		unsigned char * p = freeSpot_;
+		freeSpot_ += bytesNeeded;
+		WriteHeader( p, headerSize );
+		assert( reinterpret_cast< std::uintptr_t >( p ) % alignment == 0 );
+		return p;
+	}
+
+	/// Returns true if place is the most recently allocated chunk in this block, and was allocated with the same size.
+	bool IsTopChunk( const void * place, const std::size_t bytes, const std::size_t alignment,
+		const std::size_t headerSize = FullHeaderSize ) const
+	{
+		const std::size_t bytesNeeded = GetBytesNeeded( bytes, alignment, headerSize );
+		if ( static_cast< std::size_t >( freeSpot_ - block_ ) < bytesNeeded )
+		{
+			return false;
+		}
+		const unsigned char * top = freeSpot_ - bytesNeeded;
+		return ( top == place ) && ( ( NoHeaderSize == headerSize ) || ( GetChunkBefore( freeSpot_, headerSize ) == top ) );
+	}
+
+	/// Returns true if place is the first chunk in this block, so releasing it would leave the block empty.
+	bool IsFirstChunk( const void * place ) const
+	{
+		return ( block_ == place );
+	}
+
+	/// Releases the most recently allocated chunk. Call only after IsTopChunk returns true for place.
+	void ReleaseTopChunk( void * place )
+	{
+		assert( block_ != freeSpot_ );
+		assert( ( block_ <= place ) && ( place < freeSpot_ ) );
+		freeSpot_ = static_cast< unsigned char * >( place );
+	}
+
+protected:
+
+	explicit HotStackBlock( unsigned char * block ) :
+		block_( block ),
+		freeSpot_( block )
+	{
+	}
+
+	/// Returns start of the chunk whose header ends at end, as stored in that header. Chunks must have headers.
+	unsigned char * GetChunkBefore( const unsigned char * end, const std::size_t headerSize ) const
+	{
+		assert( NoHeaderSize != headerSize );
+		assert( block_ + headerSize <= end );
+		const unsigned char * header = end - headerSize;
+		if ( FullHeaderSize == headerSize )
+		{
+			return reinterpret_cast< const ChunkInfo * >( header )->prevChunk_;
+		}
+		if ( WideHeaderSize == headerSize )
+		{
+			std::uint32_t offset;
+			std::memcpy( &offset, header, sizeof(offset) );
+			return block_ + offset;
+		}
+		assert( NarrowHeaderSize == headerSize );
+		std::uint16_t offset;
+		std::memcpy( &offset, header, sizeof(offset) );
+		return block_ + offset;
+	}
+
+	/// Writes header of chunk which starts at chunk and ends at the free spot.
+	void WriteHeader( unsigned char * chunk, const std::size_t headerSize )
+	{
+		unsigned char * header = freeSpot_ - headerSize;
+		if ( FullHeaderSize == headerSize )
+		{
+			ChunkInfo * info = reinterpret_cast< ChunkInfo * >( header );
+			info->prevChunk_ = chunk;
+			info->prevChunkSize_ = static_cast< std::size_t >( freeSpot_ - chunk );
+		}
+		else if ( WideHeaderSize == headerSize )
+		{
+			const std::uint32_t offset = static_cast< std::uint32_t >( chunk - block_ );
+			std::memcpy( header, &offset, sizeof(offset) );
+		}
+		else if ( NarrowHeaderSize == headerSize )
+		{
+			const std::uint16_t offset = static_cast< std::uint16_t >( chunk - block_ );
+			std::memcpy( header, &offset, sizeof(offset) );
+		}
+		else
+		{
+			assert( NoHeaderSize == headerSize );
+		}
+	}
+
+	/// Pointer to base of entire memory page allocated.
+	unsigned char * block_;
+	/// Pointer to next free spot within this block.
+	unsigned char * freeSpot_;
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class HotPoolBlock
+ Holds the fields of a PoolBlock, and allocates and releases its chunks with inline code. PoolBlock derives from
+ this, so PoolAllocator can use its most recently used block within its own header. Chunks that were never handed
+ out are allocated by bumping a pointer through the untouched part of the block, and released chunks form an
+ intrusive singly linked list.
+ */
+class HotPoolBlock
+{
+public:
+
+	/// List position of a block which is not in its pool's list.
+	static const unsigned int NotListed = UINT_MAX;
+
+	/// Provides number of chunks which fit in a block of blockSize bytes.
+	static unsigned int GetObjectsPerBlock( std::size_t blockSize, std::size_t objectSize )
+	{
+		return static_cast< unsigned int >( blockSize / objectSize );
+	}
+
+	bool IsEmpty() const
+	{
+		return ( 0 == objectCount_ );
+	}
+
+	bool IsFull() const
+	{
+		return ( ( free_ == nullptr ) && ( 0 == unusedCount_ ) );
+	}
+
+	unsigned int GetInUseCount() const
+	{
+		return objectCount_;
+	}
+
+	std::size_t * GetAddress() const
+	{
+		return block_;
+	}
+
+	/// Returns true if block is in its pool's list of blocks which may have free chunks.
+	bool IsListed() const
+	{
+		return ( NotListed != listPosition_ );
+	}
+
+	/// Provides position of block within its pool's list, so it can be removed without searching the list.
+	unsigned int GetListPosition() const
+	{
+		return listPosition_;
+	}
+
+	void SetListPosition( unsigned int position )
+	{
+		listPosition_ = position;
+	}
+
+	void Unlist()
+	{
+		listPosition_ = NotListed;
+	}
+
+	bool HasAddress( const void * place, std::size_t blockSize ) const
+	{
+		assert( block_ != nullptr );
+		const unsigned char * const b = reinterpret_cast< const unsigned char * >( block_ );
+		const unsigned char * const p = reinterpret_cast< const unsigned char * >( place );
+		return ( b <= p ) && ( p < b + blockSize );
+	}
+
+	/** Allocates a chunk from the free list, or from the untouched part of the block if the list is empty.
+	 @param objectSize Number of bytes in each chunk.
+	 @return Pointer to chunk, or nullptr if every chunk is in use.
+	 */
+	void * Allocate( std::size_t objectSize )
+	{
+		assert( block_ != nullptr );
+		if ( nullptr != free_ )
+		{
+			void * p = free_;
+			free_ = reinterpret_cast< std::size_t * >( *free_ );
+			++objectCount_;
+			return p;
+		}
+		if ( 0 == unusedCount_ )
+		{
+			return nullptr;
+		}
+		void * p = unused_;
+		unused_ += objectSize;
+		--unusedCount_;
+		++objectCount_;
+		return p;
+	}
+
+	bool Release( void * place )
+	{
+		assert( block_ != nullptr );
+		assert( place != nullptr );
+		std::size_t * p = reinterpret_cast< std::size_t * >( place );
+		*p = reinterpret_cast< std::size_t >( free_ );
+		free_ = p;
+		--objectCount_;
+		return true;
+	}
+
+protected:
+
+	HotPoolBlock( std::size_t * block, unsigned int objectsPerPool ) :
+		block_( block ),
+		free_( nullptr ),
+		unused_( reinterpret_cast< unsigned char * >( block ) ),
+		objectCount_( 0 ),
+		unusedCount_( objectsPerPool ),
+		listPosition_( NotListed )
+	{
+	}
+
+	/// Pointer to block allocated to hold from 1 to N objects.
+	std::size_t * block_;
+	/// Pointer to next free chunk in pool.
+	std::size_t * free_;
+	/// Pointer to first chunk that was never allocated. All chunks after it were never allocated either.
+	unsigned char * unused_;
+	/// Number of objects allocated so far.
+	unsigned int objectCount_;
+	/// Number of chunks that were never allocated.
+	unsigned int unusedCount_;
+	/// Position of block in its pool's list of blocks which may have free chunks, or NotListed.
+	unsigned int listPosition_;
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class HotTinyBlock
+ Holds the fields of a TinyBlock, and allocates and releases its chunks with inline code. TinyBlock derives from
+ this, so TinyObjectAllocator can use its most recently used block within its own header. The first byte of each
+ released chunk holds the stealth index of the next released chunk, and chunks at or above untouched_ were never
+ allocated.
+ */
+class HotTinyBlock
+{
+public:
+
+	/// List position of a block which is not in its pool's list.
+	static const unsigned int NotListed = UINT_MAX;
+
+	/// Provides number of chunks which fit in a block of blockSize bytes.
+	static unsigned int GetObjectsPerBlock( std::size_t blockSize, std::size_t objectSize )
+	{
+		return static_cast< unsigned int >( blockSize / objectSize );
+	}
+
+	bool IsEmpty() const
+	{
+		return ( UCHAR_MAX == freeSpotCount_ );
+	}
+
+	bool IsFull() const
+	{
+		return ( 0 == freeSpotCount_ );
+	}
+
+	unsigned int GetInUseCount() const
+	{
+		return ( UCHAR_MAX - freeSpotCount_ );
+	}
+
+	unsigned char * GetAddress() const
+	{
+		return block_;
+	}
+
+	/// Returns true if block is in its pool's list of blocks which may have free chunks.
+	bool IsListed() const
+	{
+		return ( NotListed != listPosition_ );
+	}
+
+	/// Provides position of block within its pool's list, so it can be removed without searching the list.
+	unsigned int GetListPosition() const
+	{
+		return listPosition_;
+	}
+
+	void SetListPosition( unsigned int position )
+	{
+		listPosition_ = position;
+	}
+
+	void Unlist()
+	{
+		listPosition_ = NotListed;
+	}
+
+	/// Returns true if chunk at address place is inside this block.
+	bool HasAddress( const void * place, std::size_t blockSize ) const
+	{
+		const unsigned char * const here = static_cast< const unsigned char * >( place );
+		return ( block_ <= here ) && ( here < block_ + blockSize );
+	}
+
+	/** Allocates a chunk in constant time, and never throws.
+	 @return Pointer to chunk, or nullptr if every chunk is in use.
+	 */
+	void * Allocate( std::size_t objectSize )
+	{
+		assert( nullptr != block_ );
+		assert( objectSize <= UCHAR_MAX );
+		if ( IsFull() )
+		{
+			return nullptr;
+		}
+
+		unsigned char * pResult = block_ + ( freeSpot_ * objectSize );
+		if ( freeSpot_ == untouched_ )
+		{
+			// Chunk was never allocated, so it has no stealth index. The next chunk was never allocated either.
+			++untouched_;
+			freeSpot_ = untouched_;
+		}
+		else
+		{
+			freeSpot_ = *pResult;
+		}
+		--freeSpotCount_;
+		return pResult;
+	}
+
+	/** Releases a chunk in constant time, and never throws. For efficiency, this assumes the address is within
+	 the block and aligned along the correct byte boundary.
+	 */
+	void Release( void * place, std::size_t objectSize )
+	{
+		assert( nullptr != block_ );
+		assert( nullptr != place );
+		assert( objectSize <= UCHAR_MAX );
+		unsigned char * toRelease = static_cast< unsigned char * >( place );
+		assert( toRelease >= block_ );
+		const std::size_t offset = static_cast< std::size_t >( toRelease - block_ );
+		assert( offset % objectSize == 0 );
+		assert( offset / objectSize < untouched_ );
+		const unsigned char index = static_cast< unsigned char >( offset / objectSize );
+
+#if defined(DEBUG) || defined(_DEBUG)
+		// Releasing the same chunk twice makes the linked-list of stealth indexes loop, and makes freeSpotCount_ wrong.
+		if ( 0 < freeSpotCount_ )
+		{
+			assert( freeSpot_ != index );
+		}
+#endif
+
+		*toRelease = freeSpot_;
+		freeSpot_ = index;
+		// Truncation check
+		assert( freeSpot_ == offset / objectSize );
+		++freeSpotCount_;
+	}
+
+protected:
+
+	explicit HotTinyBlock( unsigned char * block ) :
+		block_( block ),
+		freeSpot_( 0 ),
+		freeSpotCount_( UCHAR_MAX ),
+		untouched_( 0 ),
+		listPosition_( NotListed )
+	{
+	}
+
+	/// Pointer to array of allocated chunks.
+	unsigned char * block_;
+	/// Index of first empty chunk.
+	unsigned char freeSpot_;
+	/// Count of empty chunks.
+	unsigned char freeSpotCount_;
+	/// Index of first chunk which was never allocated.
+	unsigned char untouched_;
+	/// Position of block in its pool's list of blocks which may have free chunks, or NotListed.
+	unsigned int listPosition_;
+};
+
+// ----------------------------------------------------------------------------
+
+} // end internal namespace
+
+} // end project namespace
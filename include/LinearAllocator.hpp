@@ -4,6 +4,7 @@
 #include "AllocatorManager.hpp"
 
 #include "BlockInfo.hpp"
+#include "HotBlock.hpp"
 
 #include <cstddef> // For std::size_t.
 
@@ -23,11 +24,16 @@ class LinearBlock;
  - Objects that are allocated once and never released.
  - Allocating a stack for a local thread. The stack is allocated all at once, and released all at once.
  - The many objects that are allocated at the start of a program and never released.
+ - Scratch memory for each request a server handles. Call GetMarker when the request starts, and
+   RewindTo or Reset when it ends to release every chunk allocated for it at once.
  */
 class LinearAllocator : public Allocator
 {
 public:
 
+	/// Position within this allocator's blocks, to which RewindTo can return.
+	typedef LinearMarker Marker;
+
 	/** Allocates a chunk of memory from a block.
 	 @param size Number of bytes to allocate.
 	 @return Pointer to chunk of memory of at least size bytes, or nullptr if it could not allocate.
@@ -45,6 +51,24 @@ public:
 
 #endif
 
+	/** Does the same as Allocate( size ), but inline. It bumps the free spot of the most recently used block
+	 without a virtual call, and only calls Allocate when that block is full. Thread-safe allocators always
+	 call Allocate.
+	 */
+	inline void * FastAllocate( std::size_t size )
+	{
+		impl::HotLinearBlock * block = hot_;
+		if ( ( nullptr != block ) && ( size <= info_.blockSize_ ) )
+		{
+			void * place = block->Allocate( size, info_.blockSize_, info_.alignment_ );
+			if ( nullptr != place )
+			{
+				return place;
+			}
+		}
+		return Allocate( size );
+	}
+
 	virtual unsigned long long GetMaxSize( std::size_t objectSize ) const override;
 
 	bool HasAddress( void * place, std::size_t alignment ) const;
@@ -60,6 +84,21 @@ public:
 
 	virtual float GetFragmentationPercent() const override;
 
+	/// Provides current position, so RewindTo can later release every chunk allocated after now.
+	virtual Marker GetMarker() const;
+
+	/** Releases every chunk allocated after the marker was made, in time proportional to the number of
+	 blocks used since then. Markers made after this one become invalid.
+	 @param keepBlocks True to keep blocks emptied by this for later allocations, false to destroy them.
+	 @return False if marker is past the current position, in which case nothing is released.
+	 */
+	virtual bool RewindTo( const Marker & marker, bool keepBlocks = true );
+
+	/** Releases every chunk this allocated. All markers become invalid.
+	 @param keepBlocks True to keep every block for later allocations, false to destroy all of them.
+	 */
+	virtual void Reset( bool keepBlocks = true );
+
 #ifdef DEBUGGING_ALLOCATORS
 	/// Used only for debugging. Dumps info about each block to stdout.
 	void OutputContents() const;
@@ -81,10 +120,18 @@ protected:
 	 @return True for success. False if alignment is invalid, blockSize is not a multiple of alignment, or
 	  initialBlocks is zero.
 	 */
-	LinearAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment );
+	LinearAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment, BlockSource * source );
 
 	virtual ~LinearAllocator();
 
+	/** Points hot_ to the most recently used block, so FastAllocate can use it. Called at the end of every
+	 function which may move, empty, or destroy blocks.
+	 */
+	void SetHotBlock();
+
+	/// False if many threads share this allocator, so FastAllocate must always lock.
+	bool hotEnabled_;
+
 private:
 
 	friend class memwa::AllocatorManager;
@@ -100,6 +147,9 @@ private:
 
 	LinearBlockInfo info_;
 
+	/// Most recently used block, or nullptr if there is none or FastAllocate may not use it.
+	impl::HotLinearBlock * hot_;
+
 };
 
 class ThreadSafeLinearAllocator : public LinearAllocator
@@ -134,11 +184,17 @@ public:
 
 	virtual float GetFragmentationPercent() const override;
 
+	virtual Marker GetMarker() const override;
+
+	virtual bool RewindTo( const Marker & marker, bool keepBlocks = true ) override;
+
+	virtual void Reset( bool keepBlocks = true ) override;
+
 private:
 
 	friend class memwa::AllocatorManager;
 
-	ThreadSafeLinearAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment );
+	ThreadSafeLinearAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment, BlockSource * source );
 
 	virtual ~ThreadSafeLinearAllocator();
 
@@ -0,0 +1,81 @@
+
+#pragma once
+
+#if __cplusplus > 201402L
+// This code is for C++ 2017.
+
+#include <cstddef> // For std::size_t.
+
+#include <memory_resource>
+
+namespace memwa
+{
+
+class Allocator;
+
+// ----------------------------------------------------------------------------
+
+/** @class MemoryResource
+ Adapts any Memwa allocator, such as a LinearAllocator, StackAllocator, PoolAllocator, TinyObjectAllocator,
+ or any of their thread-safe variants, to the std::pmr::memory_resource interface. This lets pmr::vector,
+ pmr::list, pmr::map, and other containers which take a polymorphic_allocator get their memory from Memwa
+ without any custom allocator types. Each allocation calls the aligned Allocate overload, which throws an
+ invalid_argument exception if the container needs more alignment than the allocator provides. Each
+ deallocation calls the sized Release overload, so the allocator never needs to search for a chunk's size.
+
+ The adapter does not own the allocator, which must outlive the adapter and any container using it. The
+ adapter adds no locking, so it is thread-safe only if the allocator is thread-safe.
+
+ # Usage Patterns
+ - A PoolAllocator or TinyObjectAllocator whose object size matches the nodes of a pmr::list or pmr::map.
+ - A LinearAllocator or FrameAllocator for containers which are filled and then thrown away at once.
+ - A StackAllocator for containers whose elements are released in the reverse order they were made.
+ */
+class MemoryResource final : public std::pmr::memory_resource
+{
+public:
+
+	/** Makes an adapter for the allocator. This throws an invalid_argument exception if allocator is nullptr.
+	 @param allocator Allocator which provides every chunk. It must outlive this.
+	 */
+	explicit MemoryResource( Allocator * allocator );
+
+	virtual ~MemoryResource();
+
+	/// Provides the allocator which this adapts.
+	Allocator * GetAllocator() const
+	{
+		return allocator_;
+	}
+
+protected:
+
+	/// Allocates a chunk, or throws bad_alloc if the allocator can't provide one.
+	virtual void * do_allocate( std::size_t bytes, std::size_t alignment ) override;
+
+	/// Releases a chunk. Allocators which can't release single chunks, such as LinearAllocator, ignore this.
+	virtual void do_deallocate( void * place, std::size_t bytes, std::size_t alignment ) override;
+
+	/** Returns true if that is this adapter, or is another adapter for the same allocator, since chunks
+	 made by either can be released by the other.
+	 */
+	virtual bool do_is_equal( const std::pmr::memory_resource & that ) const noexcept override;
+
+private:
+
+	MemoryResource() = delete;
+	MemoryResource( const MemoryResource & ) = delete;
+	MemoryResource( MemoryResource && ) = delete;
+	MemoryResource & operator = ( const MemoryResource & ) = delete;
+	MemoryResource & operator = ( MemoryResource && ) = delete;
+
+	/// Allocator which provides every chunk.
+	Allocator * allocator_;
+
+};
+
+// ----------------------------------------------------------------------------
+
+} // end project namespace
+
+#endif
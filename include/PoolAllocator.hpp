@@ -4,24 +4,29 @@
 #include "AllocatorManager.hpp"
 
 #include "BlockInfo.hpp"
+#include "HotBlock.hpp"
+#include "ThreadCache.hpp"
 
 #include <cstddef> // For std::size_t.
+#include <cstdint>
 
+#include <atomic>
 #include <mutex>
+#include <unordered_set>
+#include <vector>
 
 namespace memwa
 {
 
 class AllocatorManager;
 
-/** @class PoolAllocator
-
- # Usage Patterns
- You can use PoolAllocator for:
- - Objects that are all the same size.
- - Objects that are allocated and released in any order.
+/** @class AnyPoolAllocator
+ Holds the parts of a pool allocator which are the same for every kind of block. BlockType subdivides
+ each block into chunks, and HotBlockType is the part of it which FastAllocate and FastRelease may use
+ inline. PoolAllocator and BitmapPoolAllocator are instantiations of this for their own blocks.
  */
-class PoolAllocator : public Allocator
+template < class BlockType, class HotBlockType >
+class AnyPoolAllocator : public Allocator
 {
 public:
 
@@ -46,6 +51,7 @@ public:
 	/** Releases a chunk of memory.
 	 @param place Address of chunk owned by this memory handler.
 	 @param size Number of bytes in chunk.
+	 @return False if place is not a chunk of this allocator, or if the chunk was already released.
 	 */
 	virtual bool Release( void * place, std::size_t size ) override;
 
@@ -60,6 +66,12 @@ public:
 
 #endif
 
+	/// Allocates chunks with one pass through the blocks.
+	virtual void AllocateBulk( void ** places, std::size_t count, std::size_t size, const void * hint = nullptr ) override;
+
+	/// Releases chunks, and only searches for a block when a chunk is not in the same block as the previous chunk.
+	virtual bool ReleaseBulk( void ** places, std::size_t count, std::size_t size ) override;
+
 	virtual unsigned long long GetMaxSize( std::size_t objectSize ) const override;
 
 	/// Returns true if a block of memory managed by this object owns the chunk at the place
@@ -73,6 +85,105 @@ public:
 
 	virtual float GetFragmentationPercent() const override;
 
+protected:
+
+	/** Creates allocator.
+	 @param alignedBlocks True if each block is aligned to its size so the block owning a chunk is found in constant time.
+	 @param retainedEmptyBlocks Most empty blocks kept for reuse instead of being destroyed right away.
+	 @param source Provides memory for each block, or nullptr to use malloc.
+	 */
+	AnyPoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+		bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source );
+
+	/// The destructor will delete all blocks if the destroy flag is set.
+	virtual ~AnyPoolAllocator();
+
+	/// Goes through container of blocks to delete each one.
+	virtual void Destroy() override;
+
+	/** Points hot_ to the most recently used block, so FastAllocate and FastRelease can use it. Called at the end
+	 of every function which may move or destroy blocks.
+	 */
+	void SetHotBlock();
+
+	AnyPoolBlockInfo< BlockType > info_;
+
+	/// Most recently used block, or nullptr if there is none or FastAllocate and FastRelease may not use it.
+	HotBlockType * hot_;
+
+	/// False if many threads share this allocator, or if the derived class has no FastAllocate and FastRelease.
+	bool hotEnabled_;
+
+private:
+
+	AnyPoolAllocator() = delete;
+	AnyPoolAllocator( const AnyPoolAllocator & ) = delete;
+	AnyPoolAllocator( AnyPoolAllocator && ) = delete;
+	AnyPoolAllocator & operator = ( const AnyPoolAllocator & ) = delete;
+	AnyPoolAllocator & operator = ( AnyPoolAllocator && ) = delete;
+
+};
+
+extern template class AnyPoolAllocator< PoolBlock, impl::HotPoolBlock >;
+
+// ----------------------------------------------------------------------------
+
+/** @class PoolAllocator
+
+ # Usage Patterns
+ You can use PoolAllocator for:
+ - Objects that are all the same size.
+ - Objects that are allocated and released in any order.
+ */
+class PoolAllocator : public AnyPoolAllocator< PoolBlock, impl::HotPoolBlock >
+{
+public:
+
+	/** Does the same as Allocate( size ), but inline. It takes a chunk from the most recently used block without
+	 a virtual call, and only calls Allocate when that block is full. Thread-safe allocators always call Allocate.
+	 */
+	inline void * FastAllocate( std::size_t size )
+	{
+		impl::HotPoolBlock * block = hot_;
+		if ( ( nullptr != block ) && ( size <= info_.objectSize_ ) )
+		{
+			const bool wasEmpty = block->IsEmpty();
+			void * place = block->Allocate( info_.objectSize_ );
+			if ( nullptr != place )
+			{
+				if ( wasEmpty )
+				{
+					// Every empty block is counted as kept, so this one no longer is.
+					--info_.emptyCount_;
+				}
+				return place;
+			}
+		}
+		return Allocate( size );
+	}
+
+	/** Does the same as Release( place, size ), but inline. It releases a chunk into the most recently used block
+	 without a virtual call, and only calls Release for chunks in other blocks, or if the block would be destroyed.
+	 */
+	inline bool FastRelease( void * place, std::size_t size )
+	{
+		impl::HotPoolBlock * block = hot_;
+		if ( ( nullptr != block ) && block->HasAddress( place, info_.blockSize_ ) && block->IsListed()
+			&& ( size <= info_.objectSize_ ) && ( info_.objectSize_ < size + info_.alignment_ ) )
+		{
+			if ( 1 < block->GetInUseCount() )
+			{
+				return block->Release( place );
+			}
+			if ( info_.emptyCount_ < info_.retainedEmptyBlocks_ )
+			{
+				++info_.emptyCount_;
+				return block->Release( place );
+			}
+		}
+		return Release( place, size );
+	}
+
 #ifdef MEMWA_DEBUGGING_ALLOCATORS
 
 	/// Used only for debugging. Dumps info about each block to stdout.
@@ -82,10 +193,9 @@ public:
 
 protected:
 
-	/// Creates allocator.
-	PoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment );
+	PoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+		bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source );
 
-	/// The destructor will delete all blocks if the destroy flag is set.
 	virtual ~PoolAllocator();
 
 private:
@@ -98,18 +208,15 @@ private:
 	PoolAllocator & operator = ( const PoolAllocator & ) = delete;
 	PoolAllocator & operator = ( PoolAllocator && ) = delete;
 
-	/// Goes through container of blocks to delete each one.
-	void Destroy();
-
-	void * Allocate( std::size_t size, std::size_t alignment );
-
-	PoolBlockInfo info_;
-
 };
 
 // ----------------------------------------------------------------------------
 
-class ThreadSafePoolAllocator : public PoolAllocator
+/** @class AnyThreadSafePoolAllocator
+ Wraps each call to PoolType in a lock, and turns off FastAllocate and FastRelease since they never lock.
+ */
+template < class PoolType >
+class AnyThreadSafePoolAllocator : public PoolType
 {
 public:
 
@@ -147,6 +254,12 @@ public:
 
 #endif
 
+	/// Locks only once to allocate all the chunks.
+	virtual void AllocateBulk( void ** places, std::size_t count, std::size_t size, const void * hint = nullptr ) override;
+
+	/// Locks only once to release all the chunks.
+	virtual bool ReleaseBulk( void ** places, std::size_t count, std::size_t size ) override;
+
 	/// Returns true if a block of memory managed by this object owns the chunk at the place
 	virtual bool HasAddress( void * place ) const override;
 
@@ -158,20 +271,384 @@ public:
 
 	virtual float GetFragmentationPercent() const override;
 
+protected:
+
+	AnyThreadSafePoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+		bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source );
+
+	virtual ~AnyThreadSafePoolAllocator();
+
+	mutable std::mutex mutex_;
+
 private:
 
-	friend class memwa::AllocatorManager;
+	AnyThreadSafePoolAllocator() = delete;
+	AnyThreadSafePoolAllocator( const AnyThreadSafePoolAllocator & ) = delete;
+	AnyThreadSafePoolAllocator( AnyThreadSafePoolAllocator && ) = delete;
+	AnyThreadSafePoolAllocator & operator = ( const AnyThreadSafePoolAllocator & ) = delete;
 
-	ThreadSafePoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment );
+};
+
+extern template class AnyThreadSafePoolAllocator< PoolAllocator >;
+
+// ----------------------------------------------------------------------------
+
+class ThreadSafePoolAllocator : public AnyThreadSafePoolAllocator< PoolAllocator >
+{
+protected:
+
+	ThreadSafePoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+		bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source );
 
 	virtual ~ThreadSafePoolAllocator();
 
+private:
+
+	friend class memwa::AllocatorManager;
+
 	ThreadSafePoolAllocator() = delete;
 	ThreadSafePoolAllocator( const ThreadSafePoolAllocator & ) = delete;
 	ThreadSafePoolAllocator( ThreadSafePoolAllocator && ) = delete;
 	ThreadSafePoolAllocator & operator = ( const ThreadSafePoolAllocator & ) = delete;
 
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class ThreadCachedPoolAllocator
+ A ThreadSafePoolAllocator which keeps a magazine of free chunks for each thread. Allocate pops a
+ chunk from the calling thread's magazine and Release pushes one onto it, so neither takes the mutex
+ in the common case. The mutex is only taken to refill an empty magazine or to return half of a full
+ magazine to the shared blocks, so each lock is amortized over many allocations.
+
+ # Usage Patterns
+ You can use ThreadCachedPoolAllocator for:
+ - Objects that are all the same size.
+ - Objects that are allocated and released often by many threads.
+
+ @note Chunks cached in a magazine still count as in use by their blocks, so a block can't be
+  trimmed until the magazines holding its chunks are flushed. A thread's magazine is flushed when
+  the thread exits, or when that thread calls TrimEmptyBlocks.
+ @note Release does not check if a chunk belongs to this allocator, since that needs the lock. Releasing
+  a chunk from anywhere else is undefined behavior, since the next Allocate may hand it out. Debug builds
+  assert that each released chunk belongs to this allocator.
+ */
+class ThreadCachedPoolAllocator : public ThreadSafePoolAllocator, public impl::MagazineOwner
+{
+public:
+
+	virtual void * Allocate( std::size_t size, const void * hint = nullptr ) override;
+
+#if __cplusplus > 201402L
+	// This code is for C++ 2017.
+
+	virtual void * Allocate( std::size_t size, std::align_val_t alignment, const void * hint = nullptr ) override;
+
+#else
+
+	virtual void * Allocate( std::size_t size, std::size_t alignment, const void * hint = nullptr ) override;
+
+#endif
+
+	virtual bool Release( void * place, std::size_t size ) override;
+
+#if __cplusplus > 201402L
+	// This code is for C++ 2017.
+
+	virtual bool Release( void * place, std::size_t size, std::align_val_t alignment ) override;
+
+#else
+
+	virtual bool Release( void * place, std::size_t size, std::size_t alignment ) override;
+
+#endif
+
+	/// Takes chunks from the calling thread's magazine first, and locks once to allocate the rest.
+	virtual void AllocateBulk( void ** places, std::size_t count, std::size_t size, const void * hint = nullptr ) override;
+
+	/// Puts chunks into the calling thread's magazine, and locks once to release any that don't fit.
+	virtual bool ReleaseBulk( void ** places, std::size_t count, std::size_t size ) override;
+
+	/// Flushes the calling thread's magazine and then deletes any blocks that have zero allocations.
+	virtual bool TrimEmptyBlocks() override;
+
+	/// Returns every chunk in the magazine to the shared blocks.
+	virtual void FlushMagazine( impl::Magazine & magazine ) override;
+
+private:
+
+	friend class memwa::AllocatorManager;
+
+	/** Creates allocator.
+	 @param magazineSize Maximum number of chunks each thread may cache.
+	 */
+	ThreadCachedPoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize,
+		std::size_t alignment, bool alignedBlocks, unsigned int retainedEmptyBlocks, unsigned int magazineSize, BlockSource * source );
+
+	virtual ~ThreadCachedPoolAllocator();
+
+	/// Detaches the magazines of every thread, and then deletes all blocks.
+	virtual void Destroy() override;
+
+	ThreadCachedPoolAllocator() = delete;
+	ThreadCachedPoolAllocator( const ThreadCachedPoolAllocator & ) = delete;
+	ThreadCachedPoolAllocator( ThreadCachedPoolAllocator && ) = delete;
+	ThreadCachedPoolAllocator & operator = ( const ThreadCachedPoolAllocator & ) = delete;
+
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class LockFreePoolAllocator
+ A ThreadSafePoolAllocator which keeps every free chunk, from all its blocks, in a single lock-free
+ stack. Allocate and Release pop and push chunks with a compare-and-swap on a tagged head pointer,
+ so they never take the mutex unless every chunk is in use and a new block must be made. The tag
+ is incremented by each pop, which prevents the ABA problem.
+
+ # Usage Patterns
+ You can use LockFreePoolAllocator for:
+ - Objects that are all the same size.
+ - Objects that are allocated and released often by many threads.
+
+ @note Blocks give their chunks to the free stack a batch at a time, so a block is only written to as
+  its chunks are needed. Chunks on the free stack never return to their blocks, since another thread
+  may read them at any time, so once a block gives out a chunk it is kept until the allocator is
+  destroyed. TrimEmptyBlocks only releases blocks which never gave out a chunk.
+ @note Release does not check if a chunk belongs to this allocator, since that needs the lock. Releasing
+  a chunk from anywhere else is undefined behavior, since it goes onto the free stack and is handed out by
+  a later Allocate. Debug builds assert that each released chunk belongs to this allocator.
+ */
+class LockFreePoolAllocator : public ThreadSafePoolAllocator
+{
+public:
+
+	virtual void * Allocate( std::size_t size, const void * hint = nullptr ) override;
+
+#if __cplusplus > 201402L
+	// This code is for C++ 2017.
+
+	virtual void * Allocate( std::size_t size, std::align_val_t alignment, const void * hint = nullptr ) override;
+
+#else
+
+	virtual void * Allocate( std::size_t size, std::size_t alignment, const void * hint = nullptr ) override;
+
+#endif
+
+	virtual bool Release( void * place, std::size_t size ) override;
+
+#if __cplusplus > 201402L
+	// This code is for C++ 2017.
+
+	virtual bool Release( void * place, std::size_t size, std::align_val_t alignment ) override;
+
+#else
+
+	virtual bool Release( void * place, std::size_t size, std::size_t alignment ) override;
+
+#endif
+
+	/// Pops each chunk from the free stack.
+	virtual void AllocateBulk( void ** places, std::size_t count, std::size_t size, const void * hint = nullptr ) override;
+
+	/// Links the chunks together and pushes them onto the free stack at once.
+	virtual bool ReleaseBulk( void ** places, std::size_t count, std::size_t size ) override;
+
+	/// Releases only blocks which never gave a chunk to the free stack, since the others are never empty.
+	virtual bool TrimEmptyBlocks() override;
+
+private:
+
+	friend class memwa::AllocatorManager;
+
+	LockFreePoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+		bool alignedBlocks, BlockSource * source );
+
+	virtual ~LockFreePoolAllocator();
+
+	virtual void Destroy() override;
+
+	LockFreePoolAllocator() = delete;
+	LockFreePoolAllocator( const LockFreePoolAllocator & ) = delete;
+	LockFreePoolAllocator( LockFreePoolAllocator && ) = delete;
+	LockFreePoolAllocator & operator = ( const LockFreePoolAllocator & ) = delete;
+
+	/// Pops a chunk from the free stack without locking. Returns nullptr if the stack is empty.
+	void * PopChunk();
+
+	/// Pushes a chain of chunks already linked from first to last onto the free stack without locking.
+	void PushChunks( void * first, void * last );
+
+	/** Takes a batch of free chunks from the blocks, pushes all but one onto the free stack, and returns
+	 that one. Makes a new block if no block has a free chunk. Caller must hold the mutex.
+	 */
+	void * TakeBlockChunks();
+
+	/// Head of free stack. Lower bits hold the address of the top chunk, and upper bits hold the tag.
+	std::atomic< std::uint64_t > head_;
+
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class RemoteFreePoolAllocator
+ A multithreaded pool allocator where each thread which allocates owns its own blocks. A thread
+ allocates from its own blocks and releases chunks into them without taking any lock. A chunk released
+ by any other thread is pushed onto a lock-free list of remote chunks kept by the owning thread, and the
+ owner takes the whole list at once the next time its blocks have no free chunk. Threads which only
+ release chunks therefore never touch the blocks used by the threads which allocate them.
+
+ The first chunk of each block in use holds a pointer to the block's owner, and every block is aligned
+ to its size, so the owner of any chunk is found by masking the chunk's address. When a thread exits,
+ its blocks are kept and given to the next thread which needs blocks of its own.
+
+ # Usage Patterns
+ You can use RemoteFreePoolAllocator for:
+ - Objects that are all the same size.
+ - Producer threads which allocate objects that consumer threads release.
+
+ @note The mutex is only taken when a block starts or stops being used, when a thread first allocates,
+  and by functions which inspect the blocks, such as HasAddress or IsCorrupt.
+ @note TrimEmptyBlocks, IsCorrupt, and GetFragmentationPercent only see the blocks of the calling thread
+  and of threads which exited, since the blocks of other threads may be changing without any lock.
+ @note Release does not check if a chunk belongs to this allocator, so releasing a foreign chunk is
+  undefined behavior instead of being reported by the return value.
+ */
+class RemoteFreePoolAllocator : public Allocator, public impl::MagazineOwner
+{
+public:
+
+	virtual void * Allocate( std::size_t size, const void * hint = nullptr ) override;
+
+#if __cplusplus > 201402L
+	// This code is for C++ 2017.
+
+	virtual void * Allocate( std::size_t size, std::align_val_t alignment, const void * hint = nullptr ) override;
+
+#else
+
+	virtual void * Allocate( std::size_t size, std::size_t alignment, const void * hint = nullptr ) override;
+
+#endif
+
+	/// Releases chunk into the calling thread's blocks if it owns them, or onto the owner's remote list if not.
+	virtual bool Release( void * place, std::size_t size ) override;
+
+#if __cplusplus > 201402L
+	// This code is for C++ 2017.
+
+	virtual bool Release( void * place, std::size_t size, std::align_val_t alignment ) override;
+
+#else
+
+	virtual bool Release( void * place, std::size_t size, std::size_t alignment ) override;
+
+#endif
+
+	virtual unsigned long long GetMaxSize( std::size_t objectSize ) const override;
+
+	/// Returns true if a block of memory managed by this object owns the chunk at the place
+	virtual bool HasAddress( void * place ) const override;
+
+	/// Takes back remote chunks, and then deletes empty blocks of the calling thread and of exited threads.
+	virtual bool TrimEmptyBlocks() override;
+
+	/// Returns true if any memory block was corrupted.
+	virtual bool IsCorrupt() const override;
+
+	virtual float GetFragmentationPercent() const override;
+
+	/// Gives up the heap of a thread which exited so another thread may own its blocks.
+	virtual void FlushMagazine( impl::Magazine & magazine ) override;
+
+private:
+
+	friend class memwa::AllocatorManager;
+
+	/** @struct Heap Blocks owned by one thread, and the chunks other threads released from them.
+	 Only the owning thread touches the blocks, or any thread holding the mutex if no thread owns them.
+	 The owning thread finds its heap as the ThreadState of its magazine.
+	 */
+	struct Heap : public impl::ThreadState
+	{
+		Heap( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+			std::size_t blockAlignment, unsigned int retainedEmptyBlocks, BlockSource * source );
+
+		/// Blocks owned by this heap.
+		PoolBlockInfo info_;
+		/// Chunks released by other threads, linked through their first bytes. Pushed by any thread, taken by the owner.
+		std::atomic< void * > remote_;
+		/// True while a thread owns this heap. Guarded by mutex.
+		bool owned_;
+	};
+
+	typedef std::vector< Heap * > Heaps;
+	typedef Heaps::iterator HeapsIter;
+	typedef Heaps::const_iterator HeapsCIter;
+
+	/// Addresses of blocks whose first chunk holds a pointer to their heap.
+	typedef std::unordered_set< std::uintptr_t > BlockAddresses;
+
+	RemoteFreePoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+		unsigned int retainedEmptyBlocks, BlockSource * source );
+
+	virtual ~RemoteFreePoolAllocator();
+
+	/// Deletes all blocks of every heap.
+	virtual void Destroy() override;
+
+	RemoteFreePoolAllocator() = delete;
+	RemoteFreePoolAllocator( const RemoteFreePoolAllocator & ) = delete;
+	RemoteFreePoolAllocator( RemoteFreePoolAllocator && ) = delete;
+	RemoteFreePoolAllocator & operator = ( const RemoteFreePoolAllocator & ) = delete;
+	RemoteFreePoolAllocator & operator = ( RemoteFreePoolAllocator && ) = delete;
+
+	/// Provides heap owned by the calling thread, or nullptr if it has never allocated.
+	Heap * FindThreadHeap();
+
+	/// Provides heap owned by the calling thread, and gives it one if it has none.
+	Heap * GetThreadHeap();
+
+	/** Allocates from the heap. Takes back remote chunks only if no block has a free chunk, and gives
+	 the first chunk of any block which was empty to the heap.
+	 */
+	void * AllocateFromHeap( Heap & heap, const void * hint );
+
+	/// Releases chunk into the heap, and releases first chunk of its block once no other chunk is in use.
+	bool ReleaseToHeap( Heap & heap, void * place );
+
+	/// Pushes chunk onto remote list of heap without locking.
+	void PushRemoteChunk( Heap & heap, void * place );
+
+	/// Releases every chunk on remote list into heap.
+	void TakeRemoteChunks( Heap & heap );
+
+	/// Provides address of block which may own place.
+	void * GetBlockStart( const void * place ) const
+	{
+		return reinterpret_cast< void * >( reinterpret_cast< std::uintptr_t >( place ) & ~( blockAlignment_ - 1 ) );
+	}
+
+	/// Number of bytes in each block.
+	std::size_t blockSize_;
+	/// Number of bytes in each chunk.
+	std::size_t objectSize_;
+	/// Byte alignment of each chunk.
+	std::size_t alignment_;
+	/// Power of two each block's address is a multiple of.
+	std::size_t blockAlignment_;
+	/// Most empty blocks each heap keeps.
+	unsigned int retainedEmptyBlocks_;
+	/// Provides memory for blocks of every heap.
+	BlockSource * source_;
+	/// Guards heaps_, the owned_ flag of each heap, and blocks of heaps no thread owns.
 	mutable std::mutex mutex_;
+	/// Every heap made by this allocator.
+	Heaps heaps_;
+	/// Guards addresses_. Never held while taking mutex_.
+	mutable std::mutex addressMutex_;
+	/// Addresses of every block in use by any heap, so HasAddress never reads another thread's blocks.
+	BlockAddresses addresses_;
 
 };
 
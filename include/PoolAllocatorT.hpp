@@ -0,0 +1,401 @@
+
+#pragma once
+
+#include "BlockSource.hpp"
+#include "ThreadingPolicy.hpp"
+
+#include <cassert>
+#include <cstddef> // For std::size_t.
+#include <cstdint>
+#include <cstring>
+
+#include <limits>
+#include <new>
+
+namespace memwa
+{
+namespace impl
+{
+
+// ----------------------------------------------------------------------------
+
+/// Header at the start of each block of a PoolAllocatorT.
+struct PoolBlockHeader
+{
+	/// Most recently released chunk, whose first bytes point to the next free chunk.
+	void * free_;
+	/// First chunk that was never allocated. All chunks after it were never allocated either.
+	unsigned char * unused_;
+	/// Previous block in the same list.
+	PoolBlockHeader * prev_;
+	/// Next block in the same list.
+	PoolBlockHeader * next_;
+	/// Number of chunks in use.
+	unsigned int objectCount_;
+	/// Number of chunks that were never allocated.
+	unsigned int unusedCount_;
+};
+
+// ----------------------------------------------------------------------------
+
+} // end internal namespace
+
+// ----------------------------------------------------------------------------
+
+/** @class PoolAllocatorT
+ A pool allocator whose object size, alignment, block size, and threading are fixed at compile time. It does
+ the same job as PoolAllocator, but has no virtual functions and no runtime checks of its parameters, which
+ are checked by static_assert instead. Allocate and Release are defined in this header, so the compiler can
+ inline them and fold every size into a constant.
+
+ Each block starts on a multiple of BlockSize, so Release finds the block owning a chunk by masking the
+ chunk's address, and never searches. The first chunks of each block hold its header. Blocks with free
+ chunks are kept in one list and full blocks in another, so Allocate always takes a chunk from the first
+ block in a list. One empty block is kept after its last chunk is released, so a program which allocates
+ and releases around a block boundary does not make and destroy a block every few calls.
+
+ This does not need an AllocatorManager, and the manager never trims its blocks.
+
+ @param ObjectSize Number of bytes in each object.
+ @param Alignment Byte boundaries to align chunks. Must be a power of two from 1 through 32.
+ @param BlockSize Number of bytes in each block. Must be a power of two big enough for the header and at
+  least two chunks.
+ @param ThreadingPolicy SingleThreaded or MultiThreaded.
+
+ # Usage Patterns
+ - Objects of one type whose size is known when the program is compiled.
+ - Hot paths where the cost of a virtual call and a runtime size check matters.
+ */
+template < std::size_t ObjectSize, std::size_t Alignment = sizeof(void *), std::size_t BlockSize = 4096,
+	class ThreadingPolicy = SingleThreaded >
+class PoolAllocatorT : private ThreadingPolicy
+{
+public:
+
+	/// Number of bytes in each chunk. This is the object size rounded up to the alignment, and is big enough to hold a pointer.
+	static constexpr std::size_t ChunkSize =
+		( ( ( ObjectSize < sizeof(void *) ) ? sizeof(void *) : ObjectSize ) + Alignment - 1 ) & ~( Alignment - 1 );
+	/// Number of bytes at start of each block used by its header.
+	static constexpr std::size_t HeaderSize = ( ( sizeof(impl::PoolBlockHeader) + ChunkSize - 1 ) / ChunkSize ) * ChunkSize;
+
+	static_assert( 0 < ObjectSize, "PoolAllocatorT needs an object size greater than zero." );
+	static_assert( ( 0 < Alignment ) && ( Alignment <= 32 ), "PoolAllocatorT alignment must be from 1 through 32." );
+	static_assert( ( Alignment & ( Alignment - 1 ) ) == 0, "PoolAllocatorT alignment must be a power of 2." );
+	static_assert( ( BlockSize & ( BlockSize - 1 ) ) == 0, "PoolAllocatorT block size must be a power of 2." );
+	static_assert( HeaderSize + 2 * ChunkSize <= BlockSize, "PoolAllocatorT block size must hold its header and at least two chunks." );
+
+	/// Number of chunks in each block.
+	static constexpr std::size_t ObjectsPerBlock = ( BlockSize - HeaderSize ) / ChunkSize;
+
+	static_assert( ObjectsPerBlock <= std::numeric_limits< unsigned int >::max(), "PoolAllocatorT block size holds too many chunks." );
+
+	/** Creates allocator. This will throw a bad_alloc exception if it can't pre-allocate the number of blocks requested.
+	 @param initialBlocks Number of blocks to pre-allocate.
+	 @param source Provides memory for each block, or nullptr to use malloc. It must outlive this.
+	 */
+	explicit PoolAllocatorT( unsigned int initialBlocks = 0, BlockSource * source = nullptr ) :
+		ThreadingPolicy(),
+		source_( ( nullptr == source ) ? GetDefaultSource() : source ),
+		available_( nullptr ),
+		full_( nullptr ),
+		emptyCount_( 0 )
+	{
+		try
+		{
+			for ( unsigned int ii = 0; ii < initialBlocks; ++ii )
+			{
+				MakeBlock();
+			}
+		}
+		catch ( ... )
+		{
+			Destroy();
+			throw;
+		}
+	}
+
+	/// Releases every block, even if some chunks were not released.
+	~PoolAllocatorT()
+	{
+		Destroy();
+	}
+
+	/** Allocates a chunk of ObjectSize bytes. This throws bad_alloc if the block source runs out of memory.
+	 @return Pointer to chunk aligned on Alignment bytes.
+	 */
+	void * Allocate()
+	{
+		typename ThreadingPolicy::Lock lock( *this );
+		impl::PoolBlockHeader * block = available_;
+		if ( nullptr == block )
+		{
+			block = MakeBlock();
+		}
+		if ( 0 == block->objectCount_ )
+		{
+			--emptyCount_;
+		}
+		void * place = block->free_;
+		if ( nullptr != place )
+		{
+			std::memcpy( &block->free_, place, sizeof(void *) );
+		}
+		else
+		{
+			place = block->unused_;
+			block->unused_ += ChunkSize;
+			--block->unusedCount_;
+		}
+		++block->objectCount_;
+		if ( ObjectsPerBlock == block->objectCount_ )
+		{
+			Unlink( available_, block );
+			Link( full_, block );
+		}
+		return place;
+	}
+
+	/** Releases a chunk made by Allocate. Passing a chunk from anywhere else is undefined behavior.
+	 @return False if place is nullptr, and true otherwise.
+	 */
+	bool Release( void * place )
+	{
+		if ( nullptr == place )
+		{
+			return false;
+		}
+		impl::PoolBlockHeader * block = GetBlock( place );
+		typename ThreadingPolicy::Lock lock( *this );
+		assert( 0 < block->objectCount_ );
+		if ( ObjectsPerBlock == block->objectCount_ )
+		{
+			Unlink( full_, block );
+			Link( available_, block );
+		}
+		std::memcpy( place, &block->free_, sizeof(void *) );
+		block->free_ = place;
+		--block->objectCount_;
+		if ( 0 == block->objectCount_ )
+		{
+			if ( 0 < emptyCount_ )
+			{
+				Unlink( available_, block );
+				DestroyBlock( block );
+			}
+			else
+			{
+				++emptyCount_;
+			}
+		}
+		return true;
+	}
+
+	/// Returns true if a block of this allocator holds the chunk at the place. This searches every block.
+	bool HasAddress( const void * place ) const
+	{
+		typename ThreadingPolicy::Lock lock( *this );
+		return ( ListHasAddress( available_, place ) || ListHasAddress( full_, place ) );
+	}
+
+	/// Destroys blocks which have no chunks in use. Returns true if any were destroyed.
+	bool TrimEmptyBlocks()
+	{
+		typename ThreadingPolicy::Lock lock( *this );
+		bool trimmedAny = false;
+		impl::PoolBlockHeader * block = available_;
+		while ( nullptr != block )
+		{
+			impl::PoolBlockHeader * next = block->next_;
+			if ( 0 == block->objectCount_ )
+			{
+				Unlink( available_, block );
+				DestroyBlock( block );
+				--emptyCount_;
+				trimmedAny = true;
+			}
+			block = next;
+		}
+		return trimmedAny;
+	}
+
+	/// Returns true if any block was corrupted.
+	bool IsCorrupt() const
+	{
+		typename ThreadingPolicy::Lock lock( *this );
+		std::size_t emptyCount = 0;
+		for ( const impl::PoolBlockHeader * block = available_; nullptr != block; block = block->next_ )
+		{
+			if ( ( ObjectsPerBlock <= block->objectCount_ ) || IsBlockCorrupt( block ) )
+			{
+				return true;
+			}
+			if ( 0 == block->objectCount_ )
+			{
+				++emptyCount;
+			}
+		}
+		for ( const impl::PoolBlockHeader * block = full_; nullptr != block; block = block->next_ )
+		{
+			if ( ( ObjectsPerBlock != block->objectCount_ ) || IsBlockCorrupt( block ) )
+			{
+				return true;
+			}
+		}
+		return ( emptyCount != emptyCount_ );
+	}
+
+	/// Provides number of blocks, and how many of them have no chunks in use.
+	void GetBlockCounts( std::size_t & blockCount, std::size_t & emptyCount ) const
+	{
+		typename ThreadingPolicy::Lock lock( *this );
+		blockCount = 0;
+		for ( const impl::PoolBlockHeader * block = available_; nullptr != block; block = block->next_ )
+		{
+			++blockCount;
+		}
+		for ( const impl::PoolBlockHeader * block = full_; nullptr != block; block = block->next_ )
+		{
+			++blockCount;
+		}
+		emptyCount = emptyCount_;
+	}
+
+private:
+
+	PoolAllocatorT( const PoolAllocatorT & ) = delete;
+	PoolAllocatorT( PoolAllocatorT && ) = delete;
+	PoolAllocatorT & operator = ( const PoolAllocatorT & ) = delete;
+	PoolAllocatorT & operator = ( PoolAllocatorT && ) = delete;
+
+	static BlockSource * GetDefaultSource()
+	{
+		static MallocBlockSource source;
+		return &source;
+	}
+
+	/// Finds block owning chunk by masking the chunk's address, since every block starts on a multiple of BlockSize.
+	static impl::PoolBlockHeader * GetBlock( void * place )
+	{
+		const std::uintptr_t address = reinterpret_cast< std::uintptr_t >( place );
+		return reinterpret_cast< impl::PoolBlockHeader * >( address & ~static_cast< std::uintptr_t >( BlockSize - 1 ) );
+	}
+
+	static void Link( impl::PoolBlockHeader * & head, impl::PoolBlockHeader * block )
+	{
+		block->prev_ = nullptr;
+		block->next_ = head;
+		if ( nullptr != head )
+		{
+			head->prev_ = block;
+		}
+		head = block;
+	}
+
+	static void Unlink( impl::PoolBlockHeader * & head, impl::PoolBlockHeader * block )
+	{
+		if ( nullptr != block->prev_ )
+		{
+			block->prev_->next_ = block->next_;
+		}
+		else
+		{
+			assert( head == block );
+			head = block->next_;
+		}
+		if ( nullptr != block->next_ )
+		{
+			block->next_->prev_ = block->prev_;
+		}
+	}
+
+	static bool ListHasAddress( const impl::PoolBlockHeader * block, const void * place )
+	{
+		const unsigned char * const p = static_cast< const unsigned char * >( place );
+		for ( ; nullptr != block; block = block->next_ )
+		{
+			const unsigned char * const start = reinterpret_cast< const unsigned char * >( block );
+			if ( ( start + HeaderSize <= p ) && ( p < start + BlockSize ) )
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/// Returns true if the counts of a block don't match its free list.
+	static bool IsBlockCorrupt( const impl::PoolBlockHeader * block )
+	{
+		const unsigned char * const start = reinterpret_cast< const unsigned char * >( block );
+		if ( ( block->unused_ < start + HeaderSize ) || ( start + BlockSize < block->unused_ ) )
+		{
+			return true;
+		}
+		std::size_t freeCount = 0;
+		for ( const void * place = block->free_; nullptr != place; ++freeCount )
+		{
+			const unsigned char * const p = static_cast< const unsigned char * >( place );
+			if ( ( p < start + HeaderSize ) || ( block->unused_ <= p ) || ( ( p - start ) % ChunkSize != 0 )
+				|| ( ObjectsPerBlock < freeCount ) )
+			{
+				return true;
+			}
+			std::memcpy( &place, place, sizeof(void *) );
+		}
+		return ( block->objectCount_ + block->unusedCount_ + freeCount != ObjectsPerBlock );
+	}
+
+	/// Makes an empty block and puts it first in the list of available blocks.
+	impl::PoolBlockHeader * MakeBlock()
+	{
+		void * place = source_->AllocateBlock( BlockSize, BlockSize );
+		if ( nullptr == place )
+		{
+			throw std::bad_alloc();
+		}
+		impl::PoolBlockHeader * block = new ( place ) impl::PoolBlockHeader;
+		block->free_ = nullptr;
+		block->unused_ = static_cast< unsigned char * >( place ) + HeaderSize;
+		block->objectCount_ = 0;
+		block->unusedCount_ = static_cast< unsigned int >( ObjectsPerBlock );
+		Link( available_, block );
+		++emptyCount_;
+		return block;
+	}
+
+	void DestroyBlock( impl::PoolBlockHeader * block )
+	{
+		block->~PoolBlockHeader();
+		source_->ReleaseBlock( block, BlockSize, BlockSize );
+	}
+
+	void Destroy()
+	{
+		impl::PoolBlockHeader * lists[] = { available_, full_ };
+		for ( impl::PoolBlockHeader * block : lists )
+		{
+			while ( nullptr != block )
+			{
+				impl::PoolBlockHeader * next = block->next_;
+				DestroyBlock( block );
+				block = next;
+			}
+		}
+		available_ = nullptr;
+		full_ = nullptr;
+		emptyCount_ = 0;
+	}
+
+	/// Provides memory for each block.
+	BlockSource * source_;
+	/// Blocks with at least one free chunk.
+	impl::PoolBlockHeader * available_;
+	/// Blocks with no free chunks.
+	impl::PoolBlockHeader * full_;
+	/// Number of blocks with no chunks in use.
+	std::size_t emptyCount_;
+
+};
+
+// ----------------------------------------------------------------------------
+
+} // end project namespace
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "AllocatorManager.hpp"
+
+#include <cstddef> // For std::size_t.
+
+namespace memwa
+{
+
+class AllocatorManager;
+
+/** @class SizeClassAllocator
+ A general purpose allocator for small chunks of any size. It rounds each request up to one of a fixed
+ table of size classes, from 8 through 4096 bytes, and passes it to an allocator made just for that
+ class. Small classes are served by TinyObjectAllocators and bigger ones by PoolAllocators. The class
+ for a size is found with a single table lookup, so routing a call costs no searching or branching.
+
+ It does not lock, since its table of allocators never changes after it is made. In a multithreaded
+ manager, each class's allocator is thread-safe instead.
+
+ # Usage Patterns
+ You can use SizeClassAllocator for:
+ - Objects of many different sizes, such as strings and small vectors.
+ - Objects that are allocated and released in any order.
+ - Replacing malloc for every small allocation within one part of a program.
+ */
+class SizeClassAllocator : public Allocator
+{
+public:
+
+	/// Number of size classes.
+	static const std::size_t ClassCount = 32;
+	/// Largest size this allocator will allocate.
+	static const std::size_t MaxObjectSize = 4096;
+	/// Largest size class served by a TinyObjectAllocator. Bigger classes use PoolAllocators.
+	static const std::size_t MaxTinyClassSize = 64;
+
+	/** Provides size of the class which holds chunks of the given size.
+	 @param size Number of bytes requested. Must not be more than MaxObjectSize.
+	 */
+	static std::size_t GetClassSize( std::size_t size );
+
+	/** Allocates a chunk from the allocator for the size class of the requested size.
+	 @param size Number of bytes to allocate.
+	 @param hint Address of recently allocated chunk so allocator can attempt to allocate next chunk within same block.
+	 @return Pointer to chunk of memory of at least size bytes.
+	 */
+	virtual void * Allocate( std::size_t size, const void * hint = nullptr ) override;
+
+#if __cplusplus > 201402L
+	// This code is for C++ 2017.
+
+	virtual void * Allocate( std::size_t size, std::align_val_t alignment, const void * hint = nullptr ) override;
+
+#else
+
+	virtual void * Allocate( std::size_t size, std::size_t alignment, const void * hint = nullptr ) override;
+
+#endif
+
+	/** Releases a chunk of memory.
+	 @param place Address of chunk owned by this allocator.
+	 @param size Number of bytes requested when the chunk was allocated.
+	 */
+	virtual bool Release( void * place, std::size_t size ) override;
+
+#if __cplusplus > 201402L
+	// This code is for C++ 2017.
+
+	virtual bool Release( void * place, std::size_t size, std::align_val_t alignment ) override;
+
+#else
+
+	virtual bool Release( void * place, std::size_t size, std::size_t alignment ) override;
+
+#endif
+
+	/// Passes all the chunks to the allocator for their size class at once.
+	virtual void AllocateBulk( void ** places, std::size_t count, std::size_t size, const void * hint = nullptr ) override;
+
+	/// Passes all the chunks to the allocator for their size class at once.
+	virtual bool ReleaseBulk( void ** places, std::size_t count, std::size_t size ) override;
+
+#if __cplusplus > 201402L
+	// This code is for C++ 2017.
+
+	virtual bool Resize( void * place, std::size_t oldSize, std::size_t newSize, std::align_val_t alignment ) override;
+
+#else
+
+	virtual bool Resize( void * place, std::size_t oldSize, std::size_t newSize, std::size_t alignment ) override;
+
+#endif
+
+	/// Returns true if the chunk can hold newSize bytes, which is when both sizes are in the same size class.
+	virtual bool Resize( void * place, std::size_t oldSize, std::size_t newSize ) override;
+
+	virtual unsigned long long GetMaxSize( std::size_t objectSize ) const override;
+
+	/// Returns true if the allocator of any size class owns the chunk at the place.
+	virtual bool HasAddress( void * place ) const override;
+
+	/// Deletes any blocks that have zero allocations from every size class.
+	virtual bool TrimEmptyBlocks() override;
+
+	/// Returns true if the allocator of any size class was corrupted.
+	virtual bool IsCorrupt() const override;
+
+	/// Provides average fragmentation of the size classes.
+	virtual float GetFragmentationPercent() const override;
+
+protected:
+
+	/** Creates an allocator for each size class.
+	 @param blockSize Least number of bytes in each block of a PoolAllocator, and number of bytes in each
+	  block of a TinyObjectAllocator if wideTinyBlocks is true.
+	 @param wideTinyBlocks True if TinyObjectAllocators should use blocks of blockSize bytes.
+	 */
+	SizeClassAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment, bool alignedBlocks,
+		unsigned int retainedEmptyBlocks, bool wideTinyBlocks, BlockSource * source );
+
+	/// Destroys the allocator of each size class, and releases their blocks only if Destroy was called.
+	virtual ~SizeClassAllocator();
+
+	/// Destroys the allocator of each size class and releases their blocks.
+	virtual void Destroy() override;
+
+private:
+
+	friend class memwa::AllocatorManager;
+
+	SizeClassAllocator() = delete;
+	SizeClassAllocator( const SizeClassAllocator & ) = delete;
+	SizeClassAllocator( SizeClassAllocator && ) = delete;
+	SizeClassAllocator & operator = ( const SizeClassAllocator & ) = delete;
+	SizeClassAllocator & operator = ( SizeClassAllocator && ) = delete;
+
+	/// Provides index of size class for the size, or throws if size is too big.
+	static std::size_t GetClassIndex( std::size_t size );
+
+	/// Destroys allocators for each size class, and releases their memory if releaseMemory is true.
+	void DestroyClasses( bool releaseMemory );
+
+	/// Allocator for each size class.
+	Allocator * classes_[ ClassCount ];
+
+	std::size_t alignment_;
+
+};
+
+// ----------------------------------------------------------------------------
+
+} // end project namespace
@@ -0,0 +1,108 @@
+
+#pragma once
+
+#include "AllocatorManager.hpp"
+
+#include <cstddef> // For std::size_t.
+
+#include <atomic>
+#include <mutex>
+
+namespace memwa
+{
+
+// ----------------------------------------------------------------------------
+
+/** @class SizedAllocators
+ Makes one allocator for each chunk size asked of it, so an AllocatorAdapter can give node based containers
+ such as std::list, std::map, and std::unordered_map an allocator whose objects are exactly as big as their
+ nodes. A container rebinds its adapter from its element type to its node type, and every rebound adapter
+ points to the same SizedAllocators, so the node size never needs to be known in advance. The allocator for
+ a size is made the first time a chunk of that size is asked for. Sizes up to MaxTinyObjectSize get a
+ TinyObjectAllocator, and bigger ones get a PoolAllocator. Chunks bigger than MaxObjectSize, such as the
+ bucket arrays of a big unordered_map, come from the system with the same alignment as the other chunks.
+
+ Finding the allocator for a size takes a single table lookup. Allocators are made under a lock, so this
+ may be shared by many threads if the manager is multithreaded. The manager must outlive this.
+ */
+class SizedAllocators
+{
+public:
+
+	/// Largest chunk given its own allocator. Bigger chunks come from the system.
+	static const std::size_t MaxObjectSize = 256;
+	/// Largest chunk served by a TinyObjectAllocator. Bigger chunks use PoolAllocators.
+	static const std::size_t MaxTinyObjectSize = 64;
+
+	/** Keeps parameters to make each allocator. This throws an invalid_argument exception if the alignment is
+	 not a power of two from 1 through AllocatorManager::MaxAlignment.
+	 @param parameters Used to make each allocator, except type and objectSize are set for each size. For a
+	  PoolAllocator, alignment is raised to at least the size of a pointer, and blockSize is rounded down to a
+	  multiple of the aligned object size.
+	 */
+	explicit SizedAllocators( const AllocatorManager::AllocatorParameters & parameters );
+
+	/// Destroys every allocator this made, and releases their blocks.
+	~SizedAllocators();
+
+	/** Allocates a chunk from the allocator for its size, making that allocator if needed.
+	 @param size Number of bytes to allocate.
+	 @param alignment Byte boundaries to align chunk. Must not be more than the alignment in parameters.
+	 @return Pointer to chunk of memory of at least size bytes.
+	 */
+#if __cplusplus > 201402L
+	// This code is for C++ 2017.
+
+	void * Allocate( std::size_t size, std::align_val_t alignment, const void * hint = nullptr );
+
+#else
+
+	void * Allocate( std::size_t size, std::size_t alignment, const void * hint = nullptr );
+
+#endif
+
+	/** Releases a chunk of memory.
+	 @param place Address of chunk made by Allocate.
+	 @param size Same number of bytes passed to Allocate.
+	 @return True if the chunk was released.
+	 */
+	bool Release( void * place, std::size_t size );
+
+	unsigned long long GetMaxSize( std::size_t objectSize ) const;
+
+	/** Provides allocator for chunks of the given size, making it if needed.
+	 @return Pointer to allocator, or nullptr if size is bigger than MaxObjectSize.
+	 */
+	Allocator * GetAllocator( std::size_t size );
+
+	/// Returns true if an allocator made by this owns the chunk at the place.
+	bool HasAddress( void * place ) const;
+
+	/// Returns true if any allocator made by this was corrupted.
+	bool IsCorrupt() const;
+
+private:
+
+	SizedAllocators() = delete;
+	SizedAllocators( const SizedAllocators & ) = delete;
+	SizedAllocators( SizedAllocators && ) = delete;
+	SizedAllocators & operator = ( const SizedAllocators & ) = delete;
+	SizedAllocators & operator = ( SizedAllocators && ) = delete;
+
+	/// Makes allocator for chunks of alignedSize bytes under the lock, unless another thread just made it.
+	Allocator * MakeAllocator( std::size_t alignedSize );
+
+	/// Parameters used to make each allocator.
+	AllocatorManager::AllocatorParameters parameters_;
+	/// Alignment from parameters_ as a number of bytes.
+	std::size_t alignment_;
+	/// Allocator for each aligned size, at the index of that size minus one.
+	std::atomic< Allocator * > allocators_[ MaxObjectSize ];
+	/// Held while making an allocator.
+	std::mutex mutex_;
+
+};
+
+// ----------------------------------------------------------------------------
+
+} // end project namespace
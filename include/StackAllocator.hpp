@@ -4,6 +4,7 @@
 #include "AllocatorManager.hpp"
 
 #include "BlockInfo.hpp"
+#include "HotBlock.hpp"
 
 #include <cstddef> // For std::size_t.
 
@@ -18,7 +19,9 @@ class AllocatorManager;
 /** @class StackAllocator
  This memory handler allocates chunks using stack-like behavior; which means it allocates in a linear
  order and expects to release them in reverse order. Since it is not a general purpose allocator, it
- can allocate and release very quickly.
+ can allocate and release very quickly. Its blocks form a segmented stack, so chunks are only allocated
+ from and released to the block at the top, and releasing a chunk from any block below the top throws.
+ Pushing or popping a block never searches for it, so it takes the same time no matter how many blocks there are.
 
  # Usage Patterns
  You can use StackAllocator for:
@@ -65,6 +68,41 @@ public:
 
 #endif
 
+	/** Does the same as Allocate( size ), but inline. It pushes a chunk onto the top segment without a
+	 virtual call, and only calls Allocate when that segment is full. Thread-safe allocators always call
+	 Allocate.
+	 */
+	inline void * FastAllocate( std::size_t size )
+	{
+		impl::HotStackBlock * block = hot_;
+		if ( ( nullptr != block ) && ( 0 != size ) && ( size <= info_.blockSize_ ) )
+		{
+			// The top segment always has chunks, so it is never counted as an empty block.
+			void * place = block->Allocate( size, info_.blockSize_, info_.alignment_, info_.headerSize_ );
+			if ( nullptr != place )
+			{
+				return place;
+			}
+		}
+		return Allocate( size );
+	}
+
+	/** Does the same as Release( place, size ), but inline. It pops the top chunk of the top segment without
+	 a virtual call. It calls Release for any other chunk, so misordered releases still throw, and for the
+	 last chunk in the segment, so the segment is popped.
+	 */
+	inline bool FastRelease( void * place, std::size_t size )
+	{
+		impl::HotStackBlock * block = hot_;
+		if ( ( nullptr != block ) && ( 0 != size ) && block->IsTopChunk( place, size, info_.alignment_, info_.headerSize_ )
+			&& !block->IsFirstChunk( place ) )
+		{
+			block->ReleaseTopChunk( place );
+			return true;
+		}
+		return Release( place, size );
+	}
+
 #if __cplusplus > 201402L
 	// This code is for C++ 2017.
 
@@ -102,12 +140,26 @@ public:
 
 protected:
 
-	/// Creates allocator.
-	StackAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment );
+	/** Creates allocator.
+	 @param alignedBlocks True if each block is aligned to its size so the block owning a chunk is found in constant time.
+	 @param retainedEmptyBlocks Most empty blocks kept for reuse instead of being destroyed right away.
+	 @param source Provides memory for each block, or nullptr to use malloc.
+	 @param header Kind of header put after each chunk.
+	 */
+	StackAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment, bool alignedBlocks,
+		unsigned int retainedEmptyBlocks, BlockSource * source, AllocatorManager::StackHeader header );
 
 	/// The destructor will delete all blocks if the destroy flag is set.
 	virtual ~StackAllocator();
 
+	/** Points hot_ to the most recently used block, so FastAllocate and FastRelease can use it. Called at
+	 the end of every function which may move or destroy blocks.
+	 */
+	void SetHotBlock();
+
+	/// False if many threads share this allocator, so FastAllocate and FastRelease must always lock.
+	bool hotEnabled_;
+
 private:
 
 	friend class memwa::AllocatorManager;
@@ -123,6 +175,9 @@ private:
 
 	StackBlockInfo info_;
 
+	/// Most recently used block, or nullptr if there is none or FastAllocate and FastRelease may not use it.
+	impl::HotStackBlock * hot_;
+
 };
 
 // ----------------------------------------------------------------------------
@@ -195,7 +250,8 @@ private:
 
 	friend class memwa::AllocatorManager;
 
-	ThreadSafeStackAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment );
+	ThreadSafeStackAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment, bool alignedBlocks,
+		unsigned int retainedEmptyBlocks, BlockSource * source, AllocatorManager::StackHeader header );
 
 	virtual ~ThreadSafeStackAllocator();
 
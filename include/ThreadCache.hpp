@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef> // For std::size_t.
+
+#include <atomic>
+#include <vector>
+
+namespace memwa
+{
+namespace impl
+{
+
+class MagazineOwner;
+
+// ----------------------------------------------------------------------------
+
+/** @struct ThreadState Base of any state an owner keeps for each thread besides its cached chunks.
+ The owner makes it for a thread, and gives it up in FlushMagazine when the thread exits.
+ */
+struct ThreadState
+{
+protected:
+
+	ThreadState() {}
+
+	~ThreadState() {}
+
+};
+
+// ----------------------------------------------------------------------------
+
+/** @struct Magazine A bounded stack of free chunks cached by one thread for one allocator.
+ Only the thread which owns the magazine pushes or pops chunks, so those operations need no lock.
+ The owner pointer is cleared when the allocator is destroyed so the thread will never return
+ chunks to an allocator that no longer exists.
+ */
+struct Magazine
+{
+
+	explicit Magazine( MagazineOwner * owner, unsigned int capacity );
+
+	~Magazine();
+
+	bool IsEmpty() const
+	{
+		return ( 0 == count_ );
+	}
+
+	bool IsFull() const
+	{
+		return ( capacity_ == count_ );
+	}
+
+	void Push( void * place )
+	{
+		chunks_[ count_++ ] = place;
+	}
+
+	void * Pop()
+	{
+		return chunks_[ --count_ ];
+	}
+
+	/// Allocator which provided the chunks in this magazine, or nullptr if that allocator is gone.
+	std::atomic< MagazineOwner * > owner_;
+	/// Number of chunks currently in magazine.
+	unsigned int count_;
+	/// Maximum number of chunks the magazine can hold.
+	unsigned int capacity_;
+	/// Array of cached chunks.
+	void ** chunks_;
+	/// State the owner keeps for the thread which holds this magazine, or nullptr if none.
+	ThreadState * state_;
+
+private:
+
+	Magazine( const Magazine & ) = delete;
+	Magazine( Magazine && ) = delete;
+	Magazine & operator = ( const Magazine & ) = delete;
+	Magazine & operator = ( Magazine && ) = delete;
+
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class MagazineOwner Base class for allocators which keep a magazine of free chunks for each thread.
+ Each thread gets its own magazine the first time it uses the allocator. When the thread exits, any
+ chunks remaining in its magazine are flushed back to the allocator. An owner with a capacity of zero
+ uses its magazines only to keep a ThreadState for each thread, and to learn when each thread exits.
+ Magazines are tracked under a single process-wide lock, but that lock is only taken when a magazine
+ is created, when a thread exits, or when an allocator is destroyed - never when allocating or
+ releasing a chunk.
+ */
+class MagazineOwner
+{
+public:
+
+	/** Returns every chunk in the magazine to the allocator's blocks. The derived class is responsible
+	 for any locking needed to access its blocks.
+	 */
+	virtual void FlushMagazine( Magazine & magazine ) = 0;
+
+protected:
+
+	explicit MagazineOwner( unsigned int capacity );
+
+	virtual ~MagazineOwner();
+
+	/// Provides the calling thread's magazine for this owner, and makes one if the thread has none.
+	Magazine * GetMagazine();
+
+	/// Flushes the calling thread's magazine for this owner if it has one.
+	bool FlushThreadMagazine();
+
+	/// Prevents all threads from ever flushing their magazines to this owner. Safe to call more than once.
+	void DetachMagazines();
+
+	unsigned int GetMagazineCapacity() const
+	{
+		return capacity_;
+	}
+
+private:
+
+	friend class ThreadMagazines;
+
+	typedef std::vector< Magazine * > Magazines;
+
+	MagazineOwner( const MagazineOwner & ) = delete;
+	MagazineOwner( MagazineOwner && ) = delete;
+	MagazineOwner & operator = ( const MagazineOwner & ) = delete;
+	MagazineOwner & operator = ( MagazineOwner && ) = delete;
+
+	/// Magazines of all threads which use this owner. Guarded by process-wide magazine lock.
+	Magazines magazines_;
+	/// Number of chunks each magazine can hold.
+	unsigned int capacity_;
+
+};
+
+// ----------------------------------------------------------------------------
+
+} // end internal namespace
+
+} // end project namespace
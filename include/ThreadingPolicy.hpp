@@ -0,0 +1,65 @@
+
+#pragma once
+
+#include <mutex>
+
+namespace memwa
+{
+
+// ----------------------------------------------------------------------------
+
+/** @class SingleThreaded
+ Threading policy for compile-time allocators such as PoolAllocatorT which are used by only one thread at a
+ time. Its lock does nothing, so the compiler removes it from every call, and it takes no space since the
+ allocator derives from it.
+ */
+class SingleThreaded
+{
+protected:
+
+	class Lock
+	{
+	public:
+
+		explicit Lock( const SingleThreaded & )
+		{
+		}
+
+	};
+
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class MultiThreaded
+ Threading policy for compile-time allocators such as PoolAllocatorT which are shared by many threads. Each
+ call locks a mutex kept by the allocator.
+ */
+class MultiThreaded
+{
+protected:
+
+	class Lock
+	{
+	public:
+
+		explicit Lock( const MultiThreaded & policy ) :
+			guard_( policy.mutex_ )
+		{
+		}
+
+	private:
+
+		std::lock_guard< std::mutex > guard_;
+
+	};
+
+private:
+
+	mutable std::mutex mutex_;
+
+};
+
+// ----------------------------------------------------------------------------
+
+} // end project namespace
@@ -4,10 +4,14 @@
 #include "AllocatorManager.hpp"
 
 #include "BlockInfo.hpp"
+#include "HotBlock.hpp"
 
+#include <climits> // For UCHAR_MAX.
 #include <cstddef> // For std::size_t.
+#include <cstdint> // For std::uintptr_t.
 
 #include <mutex>
+#include <vector>
 
 // ----------------------------------------------------------------------------
 
@@ -16,14 +20,14 @@ namespace memwa
 
 class AllocatorManager;
 
-/** @class TinyObjectAllocator
-
- # Usage Patterns
- You can use TinyObjectAllocator for:
- - Objects that are all the same size.
- - Objects that are allocated and released in any order.
+/** @class AnyTinyObjectAllocator
+ Holds the parts of a tiny object allocator which are the same for every kind of tiny block. BlockType
+ subdivides each block into chunks, BlockInfoType keeps the blocks, and HotBlockType is the part of a
+ block which FastAllocate and FastRelease may use inline. TinyObjectAllocator and WideTinyObjectAllocator
+ are instantiations of this for their own blocks.
  */
-class TinyObjectAllocator : public memwa::Allocator
+template < class BlockType, class BlockInfoType, class HotBlockType >
+class AnyTinyObjectAllocator : public memwa::Allocator
 {
 public:
 
@@ -61,6 +65,12 @@ public:
 
 #endif
 
+    /// Allocates chunks with one pass through the blocks.
+    virtual void AllocateBulk( void ** places, std::size_t count, std::size_t size, const void * hint = nullptr ) override;
+
+    /// Releases chunks, and only searches for a block when a chunk is not in the same block as the previous chunk.
+    virtual bool ReleaseBulk( void ** places, std::size_t count, std::size_t size ) override;
+
     virtual unsigned long long GetMaxSize( std::size_t objectSize ) const override;
 
     /// Returns true if a block of memory managed by this object owns the chunk at the place
@@ -74,6 +84,108 @@ public:
 
     virtual float GetFragmentationPercent() const override;
 
+protected:
+
+    /** Creates allocator.
+     @param blockSize Number of bytes asked for in each block. BlockType::GetBlockSize decides how many are used.
+     @param alignedBlocks True if each block is aligned to a power of two so the block owning a chunk is found in constant time.
+     @param retainedEmptyBlocks Most empty blocks kept for reuse instead of being destroyed right away.
+     @param source Provides memory for each block, or nullptr to use malloc.
+     */
+    AnyTinyObjectAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+        bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source );
+
+    /// The destructor will delete all blocks if the destroy flag is set.
+    virtual ~AnyTinyObjectAllocator();
+
+    /// Goes through container of blocks to delete each one.
+    virtual void Destroy() override;
+
+    /** Points hot_ to the most recently used block, so FastAllocate and FastRelease can use it. Called at the end
+     of every function which may move or destroy blocks.
+     */
+    void SetHotBlock();
+
+    BlockInfoType info_;
+
+    /// Most recently used block, or nullptr if there is none or FastAllocate and FastRelease may not use it.
+    HotBlockType * hot_;
+
+    /// False if many threads share this allocator, or if the derived class has no FastAllocate and FastRelease.
+    bool hotEnabled_;
+
+private:
+
+    AnyTinyObjectAllocator() = delete;
+    AnyTinyObjectAllocator( const AnyTinyObjectAllocator & ) = delete;
+    AnyTinyObjectAllocator( AnyTinyObjectAllocator && ) = delete;
+    AnyTinyObjectAllocator & operator = ( const AnyTinyObjectAllocator & ) = delete;
+    AnyTinyObjectAllocator & operator = ( AnyTinyObjectAllocator && ) = delete;
+
+};
+
+extern template class AnyTinyObjectAllocator< TinyBlock, TinyBlockInfo, impl::HotTinyBlock >;
+
+// ----------------------------------------------------------------------------
+
+/** @class TinyObjectAllocator
+
+ # Usage Patterns
+ You can use TinyObjectAllocator for:
+ - Objects that are all the same size.
+ - Objects that are allocated and released in any order.
+ */
+class TinyObjectAllocator : public AnyTinyObjectAllocator< TinyBlock, TinyBlockInfo, impl::HotTinyBlock >
+{
+public:
+
+    /** Does the same as Allocate( size ), but inline. It takes a chunk from the most recently used block without
+     a virtual call, and only calls Allocate when that block is full. Thread-safe allocators always call Allocate.
+     */
+    inline void * FastAllocate( std::size_t size )
+    {
+        impl::HotTinyBlock * block = hot_;
+        if ( ( nullptr != block ) && ( size <= info_.objectSize_ ) )
+        {
+            const bool wasEmpty = block->IsEmpty();
+            void * place = block->Allocate( info_.objectSize_ );
+            if ( nullptr != place )
+            {
+                if ( wasEmpty )
+                {
+                    // Every empty block is counted as kept, so this one no longer is.
+                    --info_.emptyCount_;
+                }
+                return place;
+            }
+        }
+        return Allocate( size );
+    }
+
+    /** Does the same as Release( place, size ), but inline. It releases a chunk into the most recently used block
+     without a virtual call, and only calls Release for chunks in other blocks, or if the block would be destroyed.
+     */
+    inline bool FastRelease( void * place, std::size_t size )
+    {
+        impl::HotTinyBlock * block = hot_;
+        if ( ( nullptr != block ) && block->HasAddress( place, info_.blockSize_ ) && block->IsListed()
+            && ( size <= info_.objectSize_ ) && ( info_.objectSize_ < size + info_.alignment_ ) )
+        {
+            if ( 1 < block->GetInUseCount() )
+            {
+                block->Release( place, info_.objectSize_ );
+                return true;
+            }
+            if ( info_.emptyCount_ < info_.retainedEmptyBlocks_ )
+            {
+                ++info_.emptyCount_;
+                block->Release( place, info_.objectSize_ );
+                return true;
+            }
+        }
+        return Release( place, size );
+    }
+
 #ifdef MEMWA_DEBUGGING_ALLOCATORS
 
     /// Used only for debugging. Dumps info about each block to stdout.
@@ -83,15 +195,14 @@ public:
 
 protected:
 
-    /// Creates allocator.
-    TinyObjectAllocator( unsigned int initialBlocks, std::size_t objectSize, std::size_t alignment );
+    /** Creates allocator.
+     @param blockSize Not used, since each block always holds UCHAR_MAX objects.
+     */
+    TinyObjectAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+        bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source );
 
-    /// The destructor will delete all blocks if the destroy flag is set.
     virtual ~TinyObjectAllocator();
 
-    /// Goes through container of blocks to delete each one.
-    virtual void Destroy() override;
-
 private:
 
     friend class memwa::AllocatorManager;
@@ -102,15 +213,15 @@ private:
     TinyObjectAllocator & operator = ( const TinyObjectAllocator & ) = delete;
     TinyObjectAllocator & operator = ( TinyObjectAllocator && ) = delete;
 
-    void * Allocate( std::size_t size, std::size_t alignment );
-
-    TinyBlockInfo info_;
-
 };
 
 // ----------------------------------------------------------------------------
 
-class ThreadSafeTinyObjectAllocator : public TinyObjectAllocator
+/** @class AnyThreadSafeTinyObjectAllocator
+ Wraps each call to TinyType in a lock, and turns off FastAllocate and FastRelease since they never lock.
+ */
+template < class TinyType >
+class AnyThreadSafeTinyObjectAllocator : public TinyType
 {
 public:
 
@@ -148,6 +259,12 @@ public:
 
 #endif
 
+    /// Locks only once to allocate all the chunks.
+    virtual void AllocateBulk( void ** places, std::size_t count, std::size_t size, const void * hint = nullptr ) override;
+
+    /// Locks only once to release all the chunks.
+    virtual bool ReleaseBulk( void ** places, std::size_t count, std::size_t size ) override;
+
     /// Returns true if a block of memory managed by this object owns the chunk at the place
     virtual bool HasAddress( void * place ) const override;
 
@@ -159,22 +276,198 @@ public:
 
     virtual float GetFragmentationPercent() const override;
 
+protected:
+
+    AnyThreadSafeTinyObjectAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+        bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source );
+
+    virtual ~AnyThreadSafeTinyObjectAllocator();
+
+    virtual void Destroy() override;
+
+    mutable std::mutex mutex_;
+
+private:
+
+    AnyThreadSafeTinyObjectAllocator() = delete;
+    AnyThreadSafeTinyObjectAllocator( const AnyThreadSafeTinyObjectAllocator & ) = delete;
+    AnyThreadSafeTinyObjectAllocator( AnyThreadSafeTinyObjectAllocator && ) = delete;
+    AnyThreadSafeTinyObjectAllocator & operator = ( const AnyThreadSafeTinyObjectAllocator & ) = delete;
+
+};
+
+extern template class AnyThreadSafeTinyObjectAllocator< TinyObjectAllocator >;
+
+// ----------------------------------------------------------------------------
+
+class ThreadSafeTinyObjectAllocator : public AnyThreadSafeTinyObjectAllocator< TinyObjectAllocator >
+{
 private:
 
     friend class memwa::AllocatorManager;
 
-    ThreadSafeTinyObjectAllocator( unsigned int initialBlocks, std::size_t objectSize, std::size_t alignment );
+    ThreadSafeTinyObjectAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+        bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source );
 
     virtual ~ThreadSafeTinyObjectAllocator();
 
-    virtual void Destroy() override;
-
     ThreadSafeTinyObjectAllocator() = delete;
     ThreadSafeTinyObjectAllocator( const ThreadSafeTinyObjectAllocator & ) = delete;
     ThreadSafeTinyObjectAllocator( ThreadSafeTinyObjectAllocator && ) = delete;
     ThreadSafeTinyObjectAllocator & operator = ( const ThreadSafeTinyObjectAllocator & ) = delete;
 
-    mutable std::mutex mutex_;
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class ShardedTinyObjectAllocator
+ A multithreaded tiny object allocator split into one shard per CPU. Each shard has its own blocks and
+ its own mutex, and a thread allocates from the shard of the CPU it is running on, so threads on
+ different CPUs almost never wait for the same lock. The CPU is read from the thread's restartable
+ sequences area on Linux, or from sched_getcpu if the area is not registered.
+
+ Every block is aligned to a power of two, and the first chunk of each block in use holds the index
+ of the shard which owns it, so Release finds the owning shard by masking the chunk's address. The
+ first chunk is released once no other chunk of its block is in use.
+
+ # Usage Patterns
+ You can use ShardedTinyObjectAllocator for:
+ - Objects that are all the same size.
+ - Tiny objects allocated and released by many threads at once.
+
+ @note Release reads the first byte of the block holding the chunk before taking any lock, so releasing
+  a chunk which did not come from this allocator is undefined behavior instead of being reported by the
+  return value.
+ */
+class ShardedTinyObjectAllocator : public memwa::Allocator
+{
+public:
+
+    /// Most shards an allocator may have, since the shard index is stored in one byte.
+    static const unsigned int MaxShardCount = UCHAR_MAX + 1;
+
+    /// Allocates a chunk from the shard of the calling thread's CPU.
+    virtual void * Allocate( std::size_t size, const void * hint = nullptr ) override;
+
+#if __cplusplus > 201402L
+    // This code is for C++ 2017.
+
+    virtual void * Allocate( std::size_t size, std::align_val_t alignment, const void * hint = nullptr ) override;
+
+#else
+
+    virtual void * Allocate( std::size_t size, std::size_t alignment, const void * hint = nullptr ) override;
+
+#endif
+
+    /// Releases chunk into the shard which owns its block, no matter which CPU the calling thread is on.
+    virtual bool Release( void * place, std::size_t size ) override;
+
+#if __cplusplus > 201402L
+    // This code is for C++ 2017.
+
+    virtual bool Release( void * place, std::size_t size, std::align_val_t alignment ) override;
+
+#else
+
+    virtual bool Release( void * place, std::size_t size, std::size_t alignment ) override;
+
+#endif
+
+    /// Locks the shard of the calling thread's CPU only once to allocate all the chunks.
+    virtual void AllocateBulk( void ** places, std::size_t count, std::size_t size, const void * hint = nullptr ) override;
+
+    /// Locks a shard only once for each run of chunks owned by the same shard.
+    virtual bool ReleaseBulk( void ** places, std::size_t count, std::size_t size ) override;
+
+    virtual unsigned long long GetMaxSize( std::size_t objectSize ) const override;
+
+    /// Returns true if a block of memory managed by this object owns the chunk at the place
+    virtual bool HasAddress( void * place ) const override;
+
+    /// Deletes any blocks that have zero allocations from every shard.
+    virtual bool TrimEmptyBlocks() override;
+
+    /// Returns true if any memory block was corrupted.
+    virtual bool IsCorrupt() const override;
+
+    virtual float GetFragmentationPercent() const override;
+
+    /// Provides number of shards.
+    unsigned int GetShardCount() const
+    {
+        return static_cast< unsigned int >( shards_.size() );
+    }
+
+private:
+
+    friend class memwa::AllocatorManager;
+
+    /// Blocks used by threads running on one CPU.
+    struct Shard
+    {
+        Shard( unsigned int initialBlocks, std::size_t objectSize, std::size_t alignment, std::size_t blockAlignment,
+            unsigned int retainedEmptyBlocks, BlockSource * source );
+
+        mutable std::mutex mutex_;
+        TinyBlockInfo info_;
+        /// Keeps the next shard off the cache lines of this shard's mutex.
+        unsigned char padding_[ 64 ];
+    };
+
+    typedef std::vector< Shard * > Shards;
+    typedef Shards::iterator ShardsIter;
+    typedef Shards::const_iterator ShardsCIter;
+
+    /** Creates allocator.
+     @param initialBlocks Number of blocks made at first, spread across the shards.
+     @param retainedEmptyBlocks Most empty blocks each shard keeps for reuse.
+     @param shardCount Number of shards, or AllocatorManager::OneShardPerCpu for one shard per CPU. No
+      more than MaxShardCount shards are made.
+     @param source Provides memory for each block of every shard, or nullptr to use malloc.
+     */
+    ShardedTinyObjectAllocator( unsigned int initialBlocks, std::size_t objectSize, std::size_t alignment,
+        unsigned int retainedEmptyBlocks, unsigned int shardCount, BlockSource * source );
+
+    virtual ~ShardedTinyObjectAllocator();
+
+    /// Deletes all blocks of every shard.
+    virtual void Destroy() override;
+
+    ShardedTinyObjectAllocator() = delete;
+    ShardedTinyObjectAllocator( const ShardedTinyObjectAllocator & ) = delete;
+    ShardedTinyObjectAllocator( ShardedTinyObjectAllocator && ) = delete;
+    ShardedTinyObjectAllocator & operator = ( const ShardedTinyObjectAllocator & ) = delete;
+    ShardedTinyObjectAllocator & operator = ( ShardedTinyObjectAllocator && ) = delete;
+
+    /// Provides index of shard for the CPU the calling thread is running on.
+    unsigned int GetShardIndex() const;
+
+    /** Allocates from the shard, which must be locked. The first chunk of a block is never given to the
+     caller, but keeps the shard index instead.
+     */
+    void * AllocateFromShard( Shard & shard, unsigned int index, const void * hint );
+
+    /// Releases chunk into the shard, which must be locked, and releases the first chunk of its block if no other chunk is in use.
+    bool ReleaseToShard( Shard & shard, void * place );
+
+    /// Provides shard which owns block holding the chunk, or nullptr if place can't be a chunk from this allocator.
+    Shard * FindOwner( void * place ) const;
+
+    /// Provides address of block which may own place.
+    unsigned char * GetBlockStart( const void * place ) const
+    {
+        return reinterpret_cast< unsigned char * >( reinterpret_cast< std::uintptr_t >( place ) & ~( blockAlignment_ - 1 ) );
+    }
+
+    /// Number of bytes in each chunk.
+    std::size_t objectSize_;
+    /// Byte alignment of each chunk.
+    std::size_t alignment_;
+    /// Power of two each block's address is a multiple of.
+    std::size_t blockAlignment_;
+    /// Every shard, made when the allocator is made. The container never changes after that.
+    Shards shards_;
 
 };
 
@@ -0,0 +1,78 @@
+
+#pragma once
+
+#include "TinyObjectAllocator.hpp"
+
+#include <cstddef> // For std::size_t.
+
+// ----------------------------------------------------------------------------
+
+namespace memwa
+{
+
+class AllocatorManager;
+
+extern template class AnyTinyObjectAllocator< WideTinyBlock, WideTinyBlockInfo, WideTinyBlock >;
+
+/** @class WideTinyObjectAllocator
+ A tiny object allocator whose blocks use 16-bit stealth indexes, so each block may hold up to 65535
+ objects instead of exactly 255. Blocks are as big as the requested block size - usually a multiple of
+ the page size such as 4 KB or 64 KB - so the allocator keeps far fewer blocks than TinyObjectAllocator
+ for the same number of objects, and finds the block owning a chunk with a much shorter search. It shares
+ all of its code with TinyObjectAllocator through AnyTinyObjectAllocator, but has no FastAllocate or FastRelease.
+
+ # Usage Patterns
+ You can use WideTinyObjectAllocator for:
+ - Objects that are all the same size, and at least two bytes.
+ - Objects that are allocated and released in any order.
+ - Programs which make so many tiny objects that TinyObjectAllocator would need many thousands of blocks.
+ */
+class WideTinyObjectAllocator : public AnyTinyObjectAllocator< WideTinyBlock, WideTinyBlockInfo, WideTinyBlock >
+{
+protected:
+
+    /** Creates allocator.
+     @param blockSize Number of bytes in each block. Each block holds as many objects as fit in it.
+     */
+    WideTinyObjectAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+        bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source );
+
+    virtual ~WideTinyObjectAllocator();
+
+private:
+
+    friend class memwa::AllocatorManager;
+
+    WideTinyObjectAllocator() = delete;
+    WideTinyObjectAllocator( const WideTinyObjectAllocator & ) = delete;
+    WideTinyObjectAllocator( WideTinyObjectAllocator && ) = delete;
+    WideTinyObjectAllocator & operator = ( const WideTinyObjectAllocator & ) = delete;
+    WideTinyObjectAllocator & operator = ( WideTinyObjectAllocator && ) = delete;
+
+};
+
+extern template class AnyThreadSafeTinyObjectAllocator< WideTinyObjectAllocator >;
+
+// ----------------------------------------------------------------------------
+
+class ThreadSafeWideTinyObjectAllocator : public AnyThreadSafeTinyObjectAllocator< WideTinyObjectAllocator >
+{
+private:
+
+    friend class memwa::AllocatorManager;
+
+    ThreadSafeWideTinyObjectAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+        bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source );
+
+    virtual ~ThreadSafeWideTinyObjectAllocator();
+
+    ThreadSafeWideTinyObjectAllocator() = delete;
+    ThreadSafeWideTinyObjectAllocator( const ThreadSafeWideTinyObjectAllocator & ) = delete;
+    ThreadSafeWideTinyObjectAllocator( ThreadSafeWideTinyObjectAllocator && ) = delete;
+    ThreadSafeWideTinyObjectAllocator & operator = ( const ThreadSafeWideTinyObjectAllocator & ) = delete;
+
+};
+
+// ----------------------------------------------------------------------------
+
+} // end project namespace
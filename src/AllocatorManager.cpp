@@ -5,12 +5,20 @@
 #include "LinearAllocator.hpp"
 #include "StackAllocator.hpp"
 #include "PoolAllocator.hpp"
+#include "BitmapPoolAllocator.hpp"
+#include "BitmapBlock.hpp"
 #include "TinyObjectAllocator.hpp"
 #include "TinyBlock.hpp"
+#include "WideTinyObjectAllocator.hpp"
+#include "WideTinyBlock.hpp"
+#include "SizeClassAllocator.hpp"
+#include "FrameAllocator.hpp"
+#include "BlockSource.hpp"
 
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
+#include <cstdint>
 
 #include <algorithm>
 #include <stdexcept>
@@ -21,7 +29,17 @@ namespace memwa
 namespace impl
 {
 
-ManagerImpl * ManagerImpl::impl_ = nullptr;
+std::atomic< ManagerImpl * > ManagerImpl::impl_( nullptr );
+
+std::mutex ManagerImpl::createMutex_;
+
+namespace
+{
+
+/// Holds the manager, so making it never calls operator new or malloc.
+alignas( ManagerImpl ) unsigned char managerStorage[ sizeof(ManagerImpl) ];
+
+} // end anonymous namespace
 
 // ----------------------------------------------------------------------------
 
@@ -83,6 +101,87 @@ std::size_t CalculateAlignedSize( std::size_t bytes, std::size_t alignment )
 
 // ----------------------------------------------------------------------------
 
+std::size_t CalculateBlockAlignment( std::size_t blockSize )
+{
+	std::size_t blockAlignment = 1;
+	while ( blockAlignment < blockSize )
+	{
+		blockAlignment *= 2;
+	}
+	return blockAlignment;
+}
+
+// ----------------------------------------------------------------------------
+
+#if defined(unix) || defined(__unix__) || defined(__unix)
+
+void * AllocateSystemBlock( std::size_t blockSize, std::size_t blockAlignment )
+{
+	if ( blockAlignment <= sizeof(void *) )
+	{
+		return std::malloc( blockSize );
+	}
+	void * block = nullptr;
+	if ( ::posix_memalign( &block, blockAlignment, blockSize ) != 0 )
+	{
+		return nullptr;
+	}
+	return block;
+}
+
+// ----------------------------------------------------------------------------
+
+void ReleaseSystemBlock( void * block )
+{
+	std::free( block );
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+
+#if defined(_WIN64) || defined(_WIN64)
+
+void * AllocateSystemBlock( std::size_t blockSize, std::size_t blockAlignment )
+{
+	// Every block comes from _aligned_malloc so ReleaseBlock can always call _aligned_free.
+	return _aligned_malloc( blockSize, std::max( blockAlignment, GetMaxSupportedAlignment() ) );
+}
+
+// ----------------------------------------------------------------------------
+
+void ReleaseSystemBlock( void * block )
+{
+	_aligned_free( block );
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+
+void * AllocateBlock( std::size_t blockSize, std::size_t blockAlignment, BlockSource * source )
+{
+	if ( nullptr == source )
+	{
+		return AllocateSystemBlock( blockSize, blockAlignment );
+	}
+	return source->AllocateBlock( blockSize, blockAlignment );
+}
+
+// ----------------------------------------------------------------------------
+
+void ReleaseBlock( void * block, std::size_t blockSize, std::size_t blockAlignment, BlockSource * source )
+{
+	if ( nullptr == source )
+	{
+		ReleaseSystemBlock( block );
+		return;
+	}
+	source->ReleaseBlock( block, blockSize, blockAlignment );
+}
+
+// ----------------------------------------------------------------------------
+
 bool GetConsistentAlignment( std::size_t alignment )
 {
     const unsigned int chunkCount = 16;
@@ -140,29 +239,32 @@ std::size_t GetMaxSupportedAlignment()
 
 bool ManagerImpl::CreateManager( bool multithreaded, std::size_t internalBlockSize )
 {
-	if ( impl_ != nullptr )
+	LockGuard guard( createMutex_ );
+	if ( impl_.load( std::memory_order_relaxed ) != nullptr )
 	{
 		return false;
 	}
-	impl_ = new ManagerImpl( multithreaded, internalBlockSize );
-	const bool success = ( impl_ != nullptr );
-	return success;
+	ManagerImpl * impl = new ( managerStorage ) ManagerImpl( multithreaded, internalBlockSize );
+	impl_.store( impl, std::memory_order_release );
+	return true;
 }
 
 // ----------------------------------------------------------------------------
 
 bool ManagerImpl::DestroyManager( bool releaseAll )
 {
-	if ( impl_ == nullptr )
+	LockGuard guard( createMutex_ );
+	ManagerImpl * impl = impl_.load( std::memory_order_relaxed );
+	if ( impl == nullptr )
 	{
 		return false;
 	}
 	if ( releaseAll )
 	{
-		impl_->ReleaseAllocators();
+		impl->ReleaseAllocators();
 	}
-	delete impl_;
-	impl_ = nullptr;
+	impl->~ManagerImpl();
+	impl_.store( nullptr, std::memory_order_release );
 	return true;
 }
 
@@ -175,9 +277,8 @@ ManagerImpl::ManagerImpl( bool multithreaded, std::size_t internalBlockSize ) :
 	oldHandler_( std::set_new_handler( &NewHandler ) ),
 	blockSize_( internalBlockSize ),
 	alignment_( defaultAlignment ),
-	common_( blockSize_, alignment_ )
+	common_()
 {
-	allocators_.reserve( 4 );
 }
 
 // ----------------------------------------------------------------------------
@@ -207,8 +308,17 @@ void ManagerImpl::ReleaseAllocators()
 void * ManagerImpl::Allocate( std::size_t bytes )
 {
 	LockGuard guard( mutex_ );
-	void * p = common_.Allocate( bytes, blockSize_, alignment_ );
-	assert( p != nullptr );
+	void * p = common_.empty() ? nullptr : common_.back().Allocate( bytes, blockSize_, alignment_ );
+	if ( nullptr == p )
+	{
+		// The last block is full, or the first block is not made yet, so start another one.
+		common_.push_back( LinearBlock( blockSize_, alignment_ ) );
+		p = common_.back().Allocate( bytes, blockSize_, alignment_ );
+		if ( nullptr == p )
+		{
+			throw std::bad_alloc();
+		}
+	}
 	return p;
 }
 
@@ -321,19 +431,25 @@ bool ManagerImpl::TrimEmptyBlocks( Allocator * allocator )
 
 void ManagerImpl::NewHandler()
 {
-	assert( nullptr != impl_ );
-	impl_->TrimEmptyBlocks();
+	ManagerImpl * impl = impl_.load( std::memory_order_acquire );
+	assert( nullptr != impl );
+	// A new_handler which can't make memory available must throw, or operator new would call it forever.
+	if ( !impl->TrimEmptyBlocks() )
+	{
+		throw std::bad_alloc();
+	}
 }
 
 // ----------------------------------------------------------------------------
 
 void CheckInitializationParameters( const AllocatorManager::AllocatorParameters & info )
 {
-	if ( ( info.alignment == 0 ) || ( AllocatorManager::MaxAlignment < info.alignment ) )
+	const std::size_t alignment = GetAlignmentSize( info.alignment );
+	if ( ( alignment == 0 ) || ( AllocatorManager::MaxAlignment < alignment ) )
 	{
 		throw std::invalid_argument( "Memory alignment must be greater than zero and not greater than 32." );
 	}
-	if ( ( info.alignment & ( info.alignment - 1 ) ) != 0 )
+	if ( ( alignment & ( alignment - 1 ) ) != 0 )
 	{
 		throw std::invalid_argument( "Memory alignment must be a power of 2." );
 	}
@@ -341,17 +457,56 @@ void CheckInitializationParameters( const AllocatorManager::AllocatorParameters
 	{
 		throw std::invalid_argument( "Number of memory blocks may not be zero!" );
 	}
+	if ( ( info.type == AllocatorManager::AllocatorType::Frame )
+		&& ( ( info.frameCount < 2 ) || ( FrameAllocator::MaxFrameCount < info.frameCount ) ) )
+	{
+		throw std::invalid_argument( "Number of frames must be at least 2 and not greater than 16." );
+	}
 	if ( info.type != AllocatorManager::AllocatorType::Tiny )
 	{
 		if ( info.blockSize < 255 )
 		{
 			throw std::invalid_argument( "Memory block size should be bigger than 255 bytes." );
 		}
-		if ( ( info.alignment != 1 ) && ( info.blockSize % info.alignment != 0 ) )
+		if ( ( alignment != 1 ) && ( info.blockSize % alignment != 0 ) )
 		{
 			throw std::invalid_argument( "Memory block size must be a multiple of alignment." );
 		}
 	}
+	if ( ( info.type == AllocatorManager::AllocatorType::Stack ) && ( info.stackHeader == AllocatorManager::Compact )
+		&& ( UINT32_MAX < info.blockSize ) )
+	{
+		throw std::invalid_argument( "Compact stack headers may not be used with blocks bigger than 4 GB." );
+	}
+	if ( ( info.type == AllocatorManager::AllocatorType::Pool ) && info.bitmapBlocks
+		&& ( 0 == BitmapBlock::GetObjectsPerBlock( info.blockSize, CalculateAlignedSize( info.objectSize, alignment ) ) ) )
+	{
+		throw std::invalid_argument( "Bitmap blocks must have room for at least one object and its bitmap." );
+	}
+	if ( dynamic_cast< HugePageBlockSource * >( info.blockSource ) != nullptr )
+	{
+		// These allocators pick their own small blocks, so each block would waste most of a huge page. A wide
+		// tiny block holds at most MaxObjectsPerBlock objects, so smaller objects can't fill one huge page either.
+		const std::size_t alignedSize = CalculateAlignedSize( info.objectSize, alignment );
+		const bool fillsHugePage = ( HugePageBlockSource::HugePageSize <= ( WideTinyBlock::MaxObjectsPerBlock + 1 ) * alignedSize );
+		if ( ( info.type == AllocatorManager::AllocatorType::SizeClass ) || ( ( info.type == AllocatorManager::AllocatorType::Tiny )
+			&& ( !info.wideTinyBlocks || !fillsHugePage ) ) )
+		{
+			throw std::invalid_argument(
+				"HugePageBlockSource may only be used by Tiny allocators with wideTinyBlocks and objects of at least 32 bytes, and not by SizeClass allocators." );
+		}
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+void CheckWideTinyBlockSize( std::size_t blockSize, std::size_t alignedSize )
+{
+	const std::size_t objectsPerPool = blockSize / alignedSize;
+	if ( ( objectsPerPool < 2 ) || ( WideTinyBlock::MaxObjectsPerBlock < objectsPerPool ) )
+	{
+		throw std::invalid_argument( "WideTinyObjectAllocator needs a block size which holds from 2 through 65535 objects." );
+	}
 }
 
 // ----------------------------------------------------------------------------
@@ -415,6 +570,51 @@ bool Allocator::Release( void * place, std::size_t size, std::size_t alignment )
 
 // ----------------------------------------------------------------------------
 
+void Allocator::AllocateBulk( void ** places, std::size_t count, std::size_t size, const void * hint )
+{
+	std::size_t ii = 0;
+	try
+	{
+		for ( ; ii < count; ++ii )
+		{
+			void * place = Allocate( size, hint );
+			if ( nullptr == place )
+			{
+				throw std::bad_alloc();
+			}
+			places[ ii ] = place;
+			hint = place;
+		}
+	}
+	catch ( ... )
+	{
+		// Release in reverse order so allocators which release only from the top can release them all.
+		while ( 0 < ii )
+		{
+			--ii;
+			Release( places[ ii ], size );
+		}
+		throw;
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+bool Allocator::ReleaseBulk( void ** places, std::size_t count, std::size_t size )
+{
+	bool allReleased = true;
+	for ( std::size_t ii = 0; ii < count; ++ii )
+	{
+		if ( !Release( places[ ii ], size ) )
+		{
+			allReleased = false;
+		}
+	}
+	return allReleased;
+}
+
+// ----------------------------------------------------------------------------
+
 #if __cplusplus > 201402L
 bool Allocator::Resize( void * place, std::size_t oldSize, std::size_t newSize, std::align_val_t alignment )
 #else
@@ -455,7 +655,7 @@ bool AllocatorManager::DestroyManager( bool releaseAll )
 
 // ----------------------------------------------------------------------------
 
-Allocator * AllocatorManager::CreateAllocator( const AllocatorParameters & info )
+Allocator * AllocatorManager::CreateAllocator( const AllocatorParameters & parameters )
 {
 	memwa::impl::ManagerImpl * impl = memwa::impl::ManagerImpl::GetManager();
 	if ( nullptr == impl )
@@ -463,8 +663,29 @@ Allocator * AllocatorManager::CreateAllocator( const AllocatorParameters & info
 		throw std::logic_error( "Error! The AllocatorManager::CreateManager must be called before AllocatorManager::CreateAllocator." );
 	}
 
-	memwa::impl::CheckInitializationParameters( info );
-	const std::size_t alignedSize = memwa::impl::CalculateAlignedSize( info.objectSize, info.alignment );
+	memwa::impl::CheckInitializationParameters( parameters );
+	const std::size_t alignment = memwa::impl::GetAlignmentSize( parameters.alignment );
+	const std::size_t alignedSize = memwa::impl::CalculateAlignedSize( parameters.objectSize, alignment );
+	AllocatorParameters info( parameters );
+	if ( dynamic_cast< HugePageBlockSource * >( info.blockSource ) != nullptr )
+	{
+		// Each block maps whole huge pages anyway, so let the allocator use as much of them as it can.
+		info.blockSize = HugePageBlockSource::RoundBlockSize( info.blockSize );
+		if ( info.type == AllocatorType::Pool )
+		{
+			info.blockSize -= info.blockSize % alignedSize;
+		}
+		else if ( info.type == AllocatorType::Tiny )
+		{
+			// A wide tiny block can't hold more than MaxObjectsPerBlock objects, so give it only as many huge
+			// pages as it can fill. CheckInitializationParameters made sure it fills all but part of one object
+			// of at least one page.
+			const std::size_t mostBytes = WideTinyBlock::MaxObjectsPerBlock * alignedSize;
+			const std::size_t hugePageSize = HugePageBlockSource::HugePageSize;
+			const std::size_t filledPages = std::max( mostBytes / hugePageSize, std::size_t( 1 ) );
+			info.blockSize = std::min( std::min( info.blockSize, filledPages * hugePageSize ), mostBytes );
+		}
+	}
 
 	Allocator * allocator = nullptr;
 	if ( impl->IsMultithreaded() )
@@ -474,7 +695,8 @@ Allocator * AllocatorManager::CreateAllocator( const AllocatorParameters & info
 			case AllocatorType::Stack :
 			{
 				void * place = impl->Allocate( sizeof(ThreadSafeStackAllocator) + sizeof(void *) );
-				allocator = new ( place ) ThreadSafeStackAllocator( info.initialBlocks, info.blockSize, info.alignment );
+				allocator = new ( place ) ThreadSafeStackAllocator( info.initialBlocks, info.blockSize, alignment, info.alignedBlocks,
+					info.retainedEmptyBlocks, info.blockSource, info.stackHeader );
 				break;
 			}
 			case AllocatorType::Pool :
@@ -483,24 +705,84 @@ Allocator * AllocatorManager::CreateAllocator( const AllocatorParameters & info
 				{
 					throw std::invalid_argument( "Blocksize should be an exact multiple of objectSize for ThreadSafePoolAllocator." );
 				}
+				if ( info.bitmapBlocks )
+				{
+					if ( info.lockFree || info.remoteFree || ( 0 < info.threadCacheSize ) )
+					{
+						throw std::invalid_argument( "ThreadSafeBitmapPoolAllocator may not be combined with lockFree, remoteFree, or a thread cache." );
+					}
+					void * place = impl->Allocate( sizeof(ThreadSafeBitmapPoolAllocator) + sizeof(void *) );
+					allocator = new ( place ) ThreadSafeBitmapPoolAllocator( info.initialBlocks, info.blockSize, alignedSize, alignment,
+						info.alignedBlocks, info.retainedEmptyBlocks, info.blockSource );
+					break;
+				}
 				if ( alignedSize < sizeof(void *) )
 				{
 					throw std::invalid_argument(
 						"ThreadSafePoolAllocator should not be used to allocate object sizes smaller than a pointer. Use ThreadSafeTinyObjectAllocator instead." );
 				}
-				if ( info.alignment < 4 )
+				if ( alignment < 4 )
 				{
 					throw std::invalid_argument(
 						"ThreadSafePoolAllocator should not be used if alignment is smaller than 4 bytes. Use ThreadSafeTinyObjectAllocator instead." );
 				}
+				if ( info.remoteFree )
+				{
+					if ( info.lockFree || ( 0 < info.threadCacheSize ) )
+					{
+						throw std::invalid_argument( "RemoteFreePoolAllocator may not be combined with lockFree or a thread cache." );
+					}
+					if ( alignment < sizeof(void *) )
+					{
+						throw std::invalid_argument( "RemoteFreePoolAllocator requires alignment of at least the size of a pointer." );
+					}
+					if ( info.blockSize < 2 * alignedSize )
+					{
+						throw std::invalid_argument( "RemoteFreePoolAllocator requires room for at least two objects in each block." );
+					}
+					void * place = impl->Allocate( sizeof(RemoteFreePoolAllocator) + sizeof(void *) );
+					allocator = new ( place ) RemoteFreePoolAllocator( info.initialBlocks, info.blockSize, alignedSize, alignment,
+						info.retainedEmptyBlocks, info.blockSource );
+					break;
+				}
+				if ( info.lockFree )
+				{
+					if ( 0 < info.threadCacheSize )
+					{
+						throw std::invalid_argument( "LockFreePoolAllocator may not be combined with a thread cache." );
+					}
+					if ( alignment < sizeof(void *) )
+					{
+						throw std::invalid_argument( "LockFreePoolAllocator requires alignment of at least the size of a pointer." );
+					}
+					void * place = impl->Allocate( sizeof(LockFreePoolAllocator) + sizeof(void *) );
+					allocator = new ( place ) LockFreePoolAllocator( info.initialBlocks, info.blockSize, alignedSize, alignment, info.alignedBlocks,
+						info.blockSource );
+					break;
+				}
+				if ( 0 < info.threadCacheSize )
+				{
+					void * place = impl->Allocate( sizeof(ThreadCachedPoolAllocator) + sizeof(void *) );
+					allocator = new ( place ) ThreadCachedPoolAllocator( info.initialBlocks, info.blockSize, alignedSize,
+						alignment, info.alignedBlocks, info.retainedEmptyBlocks, info.threadCacheSize, info.blockSource );
+					break;
+				}
 				void * place = impl->Allocate( sizeof(ThreadSafePoolAllocator) + sizeof(void *) );
-				allocator = new ( place ) ThreadSafePoolAllocator( info.initialBlocks, info.blockSize, alignedSize, info.alignment );
+				allocator = new ( place ) ThreadSafePoolAllocator( info.initialBlocks, info.blockSize, alignedSize, alignment, info.alignedBlocks,
+					info.retainedEmptyBlocks, info.blockSource );
 				break;
 			}
 			case AllocatorType::Linear :
 			{
 				void * place = impl->Allocate( sizeof(ThreadSafeLinearAllocator) + sizeof(void *) );
-				allocator = new ( place ) ThreadSafeLinearAllocator( info.initialBlocks, info.blockSize, info.alignment );
+				allocator = new ( place ) ThreadSafeLinearAllocator( info.initialBlocks, info.blockSize, alignment, info.blockSource );
+				break;
+			}
+			case AllocatorType::Frame :
+			{
+				void * place = impl->Allocate( sizeof(ThreadSafeFrameAllocator) + sizeof(void *) );
+				allocator = new ( place ) ThreadSafeFrameAllocator( info.initialBlocks, info.blockSize, alignment, info.frameCount,
+					info.blockSource );
 				break;
 			}
 			case AllocatorType::Tiny :
@@ -510,8 +792,35 @@ Allocator * AllocatorManager::CreateAllocator( const AllocatorParameters & info
 					throw std::invalid_argument(
 						"ThreadSafeTinyObjectAllocator should not be used if objectSize is greater than 256 bytes. Use ThreadSafePoolAllocator instead." );
 				}
+				if ( 0 != info.tinyShards )
+				{
+					if ( info.wideTinyBlocks )
+					{
+						throw std::invalid_argument( "ShardedTinyObjectAllocator may not be combined with wideTinyBlocks." );
+					}
+					void * place = impl->Allocate( sizeof(ShardedTinyObjectAllocator) + sizeof(void *) );
+					allocator = new ( place ) ShardedTinyObjectAllocator( info.initialBlocks, alignedSize, alignment,
+						info.retainedEmptyBlocks, info.tinyShards, info.blockSource );
+					break;
+				}
+				if ( info.wideTinyBlocks && ( WideTinyBlock::MinObjectSize <= alignedSize ) )
+				{
+					memwa::impl::CheckWideTinyBlockSize( info.blockSize, alignedSize );
+					void * place = impl->Allocate( sizeof(ThreadSafeWideTinyObjectAllocator) + sizeof(void *) );
+					allocator = new ( place ) ThreadSafeWideTinyObjectAllocator( info.initialBlocks, info.blockSize, alignedSize, alignment,
+						info.alignedBlocks, info.retainedEmptyBlocks, info.blockSource );
+					break;
+				}
 				void * place = impl->Allocate( sizeof(ThreadSafeTinyObjectAllocator) + sizeof(void *) );
-				allocator = new ( place ) ThreadSafeTinyObjectAllocator( info.initialBlocks, alignedSize, info.alignment );
+				allocator = new ( place ) ThreadSafeTinyObjectAllocator( info.initialBlocks, info.blockSize, alignedSize, alignment,
+					info.alignedBlocks, info.retainedEmptyBlocks, info.blockSource );
+				break;
+			}
+			case AllocatorType::SizeClass :
+			{
+				void * place = impl->Allocate( sizeof(SizeClassAllocator) + sizeof(void *) );
+				allocator = new ( place ) SizeClassAllocator( info.initialBlocks, info.blockSize, alignment, info.alignedBlocks,
+					info.retainedEmptyBlocks, info.wideTinyBlocks, info.blockSource );
 				break;
 			}
 			default:
@@ -527,7 +836,8 @@ Allocator * AllocatorManager::CreateAllocator( const AllocatorParameters & info
 			case AllocatorType::Stack :
 			{
 				void * place = impl->Allocate( sizeof(StackAllocator) + sizeof(void *) );
-				allocator = new ( place ) StackAllocator( info.initialBlocks, info.blockSize, info.alignment );
+				allocator = new ( place ) StackAllocator( info.initialBlocks, info.blockSize, alignment, info.alignedBlocks,
+					info.retainedEmptyBlocks, info.blockSource, info.stackHeader );
 				break;
 			}
 			case AllocatorType::Pool :
@@ -536,24 +846,39 @@ Allocator * AllocatorManager::CreateAllocator( const AllocatorParameters & info
 				{
 					throw std::invalid_argument( "Blocksize should be an exact multiple of objectSize for PoolAllocator." );
 				}
+				if ( info.bitmapBlocks )
+				{
+					void * place = impl->Allocate( sizeof(BitmapPoolAllocator) + sizeof(void *) );
+					allocator = new ( place ) BitmapPoolAllocator( info.initialBlocks, info.blockSize, alignedSize, alignment,
+						info.alignedBlocks, info.retainedEmptyBlocks, info.blockSource );
+					break;
+				}
 				if ( alignedSize < sizeof(void *) )
 				{
 					throw std::invalid_argument(
 						"PoolAllocator should not be used to allocate object sizes smaller than a pointer. Use TinyObjectAllocator instead." );
 				}
-				if ( info.alignment < 4 )
+				if ( alignment < 4 )
 				{
 					throw std::invalid_argument(
 						"PoolAllocator should not be used if alignment is smaller than 4 bytes. Use TinyObjectAllocator instead." );
 				}
 				void * place = impl->Allocate( sizeof(PoolAllocator) + sizeof(void *) );
-				allocator = new ( place ) PoolAllocator( info.initialBlocks, info.blockSize, alignedSize, info.alignment );
+				allocator = new ( place ) PoolAllocator( info.initialBlocks, info.blockSize, alignedSize, alignment, info.alignedBlocks,
+					info.retainedEmptyBlocks, info.blockSource );
 				break;
 			}
 			case AllocatorType::Linear :
 			{
 				void * place = impl->Allocate( sizeof(LinearAllocator) + sizeof(void *) );
-				allocator = new ( place ) LinearAllocator( info.initialBlocks, info.blockSize, info.alignment );
+				allocator = new ( place ) LinearAllocator( info.initialBlocks, info.blockSize, alignment, info.blockSource );
+				break;
+			}
+			case AllocatorType::Frame :
+			{
+				void * place = impl->Allocate( sizeof(FrameAllocator) + sizeof(void *) );
+				allocator = new ( place ) FrameAllocator( info.initialBlocks, info.blockSize, alignment, info.frameCount,
+					info.blockSource );
 				break;
 			}
 			case AllocatorType::Tiny :
@@ -563,8 +888,24 @@ Allocator * AllocatorManager::CreateAllocator( const AllocatorParameters & info
 					throw std::invalid_argument(
 						"TinyObjectAllocator should not be used if objectSize is greater than 256 bytes. Use PoolAllocator instead." );
 				}
+				if ( info.wideTinyBlocks && ( WideTinyBlock::MinObjectSize <= alignedSize ) )
+				{
+					memwa::impl::CheckWideTinyBlockSize( info.blockSize, alignedSize );
+					void * place = impl->Allocate( sizeof(WideTinyObjectAllocator) + sizeof(void *) );
+					allocator = new ( place ) WideTinyObjectAllocator( info.initialBlocks, info.blockSize, alignedSize, alignment,
+						info.alignedBlocks, info.retainedEmptyBlocks, info.blockSource );
+					break;
+				}
 				void * place = impl->Allocate( sizeof(TinyObjectAllocator) + sizeof(void *) );
-				allocator = new ( place ) TinyObjectAllocator( info.initialBlocks, alignedSize, info.alignment );
+				allocator = new ( place ) TinyObjectAllocator( info.initialBlocks, info.blockSize, alignedSize, alignment,
+					info.alignedBlocks, info.retainedEmptyBlocks, info.blockSource );
+				break;
+			}
+			case AllocatorType::SizeClass :
+			{
+				void * place = impl->Allocate( sizeof(SizeClassAllocator) + sizeof(void *) );
+				allocator = new ( place ) SizeClassAllocator( info.initialBlocks, info.blockSize, alignment, info.alignedBlocks,
+					info.retainedEmptyBlocks, info.wideTinyBlocks, info.blockSource );
 				break;
 			}
 			default:
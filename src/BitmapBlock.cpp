@@ -0,0 +1,300 @@
+
+#include "BitmapBlock.hpp"
+
+#include "ManagerImpl.hpp"
+
+#include <cassert>
+
+#include <iostream>
+#include <stdexcept>
+
+#if defined( __AVX2__ ) || defined( __SSE2__ ) || defined( _M_X64 )
+	#include <immintrin.h>
+#endif
+
+#if defined( _MSC_VER )
+	#include <intrin.h>
+#endif
+
+namespace memwa
+{
+
+namespace
+{
+
+// ----------------------------------------------------------------------------
+
+/// Provides number of words needed to hold one bit for each chunk.
+unsigned int GetWordCount( unsigned int objectsPerPool )
+{
+	return ( objectsPerPool + BitmapBlock::BitsPerWord - 1 ) / BitmapBlock::BitsPerWord;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Provides offset of bitmap from start of block, just past the chunks and aligned for its words.
+std::size_t GetBitmapOffset( std::size_t chunkBytes )
+{
+	const std::size_t wordSize = sizeof(std::uint64_t);
+	return ( ( chunkBytes + wordSize - 1 ) / wordSize ) * wordSize;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Provides index of lowest set bit. The word must not be zero.
+unsigned int FindLowestBit( std::uint64_t word )
+{
+	assert( 0 != word );
+#if defined( _MSC_VER )
+	unsigned long index = 0;
+	_BitScanForward64( &index, word );
+	return static_cast< unsigned int >( index );
+#else
+	return static_cast< unsigned int >( __builtin_ctzll( word ) );
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned int CountBits( std::uint64_t word )
+{
+	unsigned int count = 0;
+	for ( ; 0 != word; word &= word - 1 )
+	{
+		++count;
+	}
+	return count;
+}
+
+// ----------------------------------------------------------------------------
+
+} // end anonymous namespace
+
+// ----------------------------------------------------------------------------
+
+BitmapBlock::BitmapBlock( std::size_t blockSize, std::size_t alignedSize, std::size_t alignment, unsigned int objectsPerPool,
+	std::size_t blockAlignment, BlockSource * source ) :
+	block_( reinterpret_cast< unsigned char * >( impl::AllocateBlock( blockSize, blockAlignment, source ) ) ),
+	bitmap_( nullptr ),
+	objectSize_( static_cast< unsigned int >( alignedSize ) ),
+	objectsPerPool_( objectsPerPool ),
+	objectCount_( 0 ),
+	lowestFree_( 0 ),
+	listPosition_( NotListed )
+{
+
+	if ( nullptr == block_ )
+	{
+		throw std::bad_alloc();
+	}
+	std::size_t blockPlace = reinterpret_cast< std::size_t >( block_ );
+	assert( blockPlace % alignment == 0 );
+	assert( objectsPerPool == GetObjectsPerBlock( blockSize, alignedSize ) );
+	(void)blockPlace;
+
+	// Mark every chunk as free. Bits past the last chunk stay clear so they are never allocated.
+	bitmap_ = reinterpret_cast< std::uint64_t * >( block_ + GetBitmapOffset( objectsPerPool * alignedSize ) );
+	const unsigned int wordCount = GetWordCount( objectsPerPool );
+	for ( unsigned int ii = 0; ii < wordCount; ++ii )
+	{
+		bitmap_[ ii ] = ~std::uint64_t( 0 );
+	}
+	const unsigned int extraBits = objectsPerPool % BitsPerWord;
+	if ( 0 != extraBits )
+	{
+		bitmap_[ wordCount - 1 ] = ( std::uint64_t( 1 ) << extraBits ) - 1;
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+void BitmapBlock::Destroy( std::size_t blockSize, std::size_t blockAlignment, BlockSource * source )
+{
+	impl::ReleaseBlock( block_, blockSize, blockAlignment, source );
+	block_ = nullptr;
+	bitmap_ = nullptr;
+	objectCount_ = 0;
+	lowestFree_ = 0;
+	listPosition_ = NotListed;
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned int BitmapBlock::GetObjectsPerBlock( std::size_t blockSize, std::size_t objectSize )
+{
+	// Each chunk needs its own bytes plus one bit, so start there and back off until the word-aligned bitmap fits too.
+	std::size_t count = ( blockSize * CHAR_BIT ) / ( objectSize * CHAR_BIT + 1 );
+	while ( ( 0 < count )
+		&& ( blockSize < GetBitmapOffset( count * objectSize ) + GetWordCount( static_cast< unsigned int >( count ) ) * sizeof(std::uint64_t) ) )
+	{
+		--count;
+	}
+	return static_cast< unsigned int >( count );
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned int BitmapBlock::FindNonZeroWord( const std::uint64_t * words, unsigned int count )
+{
+	unsigned int ii = 0;
+#if defined( __AVX2__ )
+	for ( ; ii + 4 <= count; ii += 4 )
+	{
+		const __m256i chunk = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( words + ii ) );
+		if ( !_mm256_testz_si256( chunk, chunk ) )
+		{
+			break;
+		}
+	}
+#elif defined( __SSE2__ ) || defined( _M_X64 )
+	const __m128i zero = _mm_setzero_si128();
+	for ( ; ii + 2 <= count; ii += 2 )
+	{
+		const __m128i chunk = _mm_loadu_si128( reinterpret_cast< const __m128i * >( words + ii ) );
+		if ( _mm_movemask_epi8( _mm_cmpeq_epi8( chunk, zero ) ) != 0xFFFF )
+		{
+			break;
+		}
+	}
+#endif
+	// Find exact word within the group which had a set bit, or check remaining words one at a time.
+	for ( ; ii < count; ++ii )
+	{
+		if ( 0 != words[ ii ] )
+		{
+			return ii;
+		}
+	}
+	return count;
+}
+
+// ----------------------------------------------------------------------------
+
+void * BitmapBlock::Allocate( std::size_t objectSize )
+{
+	assert( block_ != nullptr );
+	assert( objectSize == objectSize_ );
+	(void)objectSize;
+	if ( IsFull() )
+	{
+		return nullptr;
+	}
+	const unsigned int wordCount = GetWordCount( objectsPerPool_ );
+	const unsigned int word = lowestFree_ + FindNonZeroWord( bitmap_ + lowestFree_, wordCount - lowestFree_ );
+	assert( word < wordCount );
+	std::uint64_t & bits = bitmap_[ word ];
+	const unsigned int index = word * BitsPerWord + FindLowestBit( bits );
+	bits &= bits - 1;
+	lowestFree_ = word;
+	++objectCount_;
+	return block_ + static_cast< std::size_t >( index ) * objectSize_;
+}
+
+// ----------------------------------------------------------------------------
+
+bool BitmapBlock::Release( void * place )
+{
+	assert( block_ != nullptr );
+	assert( place != nullptr );
+	const std::size_t offset = reinterpret_cast< unsigned char * >( place ) - block_;
+	const std::size_t index = offset / objectSize_;
+	if ( ( offset % objectSize_ != 0 ) || ( objectsPerPool_ <= index ) )
+	{
+		return false;
+	}
+	const unsigned int word = static_cast< unsigned int >( index / BitsPerWord );
+	const std::uint64_t mask = std::uint64_t( 1 ) << ( index % BitsPerWord );
+	if ( 0 != ( bitmap_[ word ] & mask ) )
+	{
+		return false;
+	}
+	bitmap_[ word ] |= mask;
+	if ( word < lowestFree_ )
+	{
+		lowestFree_ = word;
+	}
+	--objectCount_;
+	return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool BitmapBlock::HasAddress( const void * place, std::size_t blockSize ) const
+{
+	assert( block_ != nullptr );
+	const unsigned char * const p = reinterpret_cast< const unsigned char * >( place );
+	if ( p < block_ )
+	{
+		return false;
+	}
+	if ( block_ + blockSize <= p )
+	{
+		return false;
+	}
+	return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool BitmapBlock::IsBelowAddress( const void * place, std::size_t blockSize ) const
+{
+	assert( block_ != nullptr );
+	const unsigned char * const p = reinterpret_cast< const unsigned char * >( place );
+	const bool isBelow = ( block_ + blockSize <= p );
+	return isBelow;
+}
+
+// ----------------------------------------------------------------------------
+
+bool BitmapBlock::IsCorrupt( std::size_t blockSize, std::size_t alignment, std::size_t objectSize ) const
+{
+	assert( nullptr != this );
+	assert( block_ != nullptr );
+	assert( objectSize == objectSize_ );
+	assert( objectsPerPool_ == GetObjectsPerBlock( blockSize, objectSize ) );
+	assert( objectCount_ <= objectsPerPool_ );
+	assert( reinterpret_cast< std::size_t >( block_ ) % alignment == 0 );
+	assert( reinterpret_cast< unsigned char * >( bitmap_ ) == block_ + GetBitmapOffset( objectsPerPool_ * objectSize ) );
+
+	// Number of set bits must match number of free chunks, and words below lowestFree_ must be empty.
+	const unsigned int wordCount = GetWordCount( objectsPerPool_ );
+	assert( lowestFree_ <= wordCount );
+	unsigned int freeCount = 0;
+	for ( unsigned int ii = 0; ii < wordCount; ++ii )
+	{
+		if ( ii < lowestFree_ )
+		{
+			assert( 0 == bitmap_[ ii ] );
+		}
+		freeCount += CountBits( bitmap_[ ii ] );
+	}
+	assert( freeCount == objectsPerPool_ - objectCount_ );
+
+	// Bits past the last chunk must never be set.
+	const unsigned int extraBits = objectsPerPool_ % BitsPerWord;
+	if ( 0 != extraBits )
+	{
+		assert( 0 == ( bitmap_[ wordCount - 1 ] >> extraBits ) );
+	}
+	(void)freeCount;
+	return false;
+}
+
+// ----------------------------------------------------------------------------
+
+#ifdef DEBUGGING_ALLOCATORS
+
+void BitmapBlock::OutputContents() const
+{
+	std::cout << '\t' << this
+		<< '\t' << " Block: " << reinterpret_cast< const void * >( block_ )
+		<< '\t' << " Lowest Free Word: " << lowestFree_
+		<< '\t' << " In Use: " << objectCount_
+		<< std::endl;
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,136 @@
+
+#pragma once
+
+#include <climits> // For UINT_MAX.
+#include <cstddef> // For std::size_t.
+#include <cstdint>
+
+namespace memwa
+{
+
+class BlockSource;
+
+// ----------------------------------------------------------------------------
+
+/** @class BitmapBlock
+ Subdivides a block into chunks of the same size, and tracks which chunks are free with a bitmap kept
+ inside the block after the last chunk instead of a free list kept inside the chunks. Releasing a chunk never writes to
+ the chunk, so freed memory stays untouched, and a chunk may be smaller than a pointer. Allocation
+ scans the bitmap for the lowest free chunk, so chunks are always handed out from the lowest address
+ available no matter what order they were released in.
+ */
+class BitmapBlock
+{
+public:
+
+	/// List position of a block which is not in its pool's list.
+	static const unsigned int NotListed = UINT_MAX;
+
+	BitmapBlock( std::size_t blockSize, std::size_t alignedSize, std::size_t alignment, unsigned int objectsPerPool,
+		std::size_t blockAlignment = 0, BlockSource * source = nullptr );
+
+	/// Releases the block, which holds its own bitmap. Parameters must be the same ones passed to the constructor.
+	void Destroy( std::size_t blockSize = 0, std::size_t blockAlignment = 0, BlockSource * source = nullptr );
+
+	/// Provides number of chunks which fit in a block of blockSize bytes along with their bitmap.
+	static unsigned int GetObjectsPerBlock( std::size_t blockSize, std::size_t objectSize );
+
+	/** Allocates the free chunk with the lowest address.
+	 @param objectSize Number of bytes in each chunk.
+	 @return Pointer to chunk, or nullptr if every chunk is in use.
+	 */
+	void * Allocate( std::size_t objectSize );
+
+	/** Releases the chunk at place.
+	 @return False if place is not at the start of a chunk, or if the chunk is already free.
+	 */
+	bool Release( void * place );
+
+	bool HasAddress( const void * place, std::size_t blockSize ) const;
+
+	bool IsBelowAddress( const void * place, std::size_t blockSize ) const;
+
+	bool operator < ( const BitmapBlock & that ) const
+	{
+		return ( block_ < that.block_ );
+	}
+
+	bool IsEmpty() const
+	{
+		return ( 0 == objectCount_ );
+	}
+
+	bool IsFull() const
+	{
+		return ( objectsPerPool_ == objectCount_ );
+	}
+
+	unsigned int GetInUseCount() const
+	{
+		return objectCount_;
+	}
+
+#ifdef DEBUGGING_ALLOCATORS
+
+	void OutputContents() const;
+
+#endif
+
+	unsigned char * GetAddress() const
+	{
+		return block_;
+	}
+
+	/// Returns true if block is in its pool's list of blocks which may have free chunks.
+	bool IsListed() const
+	{
+		return ( NotListed != listPosition_ );
+	}
+
+	/// Provides position of block within its pool's list, so it can be removed without searching the list.
+	unsigned int GetListPosition() const
+	{
+		return listPosition_;
+	}
+
+	void SetListPosition( unsigned int position )
+	{
+		listPosition_ = position;
+	}
+
+	void Unlist()
+	{
+		listPosition_ = NotListed;
+	}
+
+	bool IsCorrupt( std::size_t blockSize, std::size_t alignment, std::size_t objectSize ) const;
+
+	/// Number of bits in each word of the bitmap.
+	static const unsigned int BitsPerWord = 64;
+
+	/** Provides index of first non-zero word, or count if all are zero. Uses AVX2 or SSE2 to check
+	 several words at once when the compiler targets them, and checks one word at a time otherwise.
+	 */
+	static unsigned int FindNonZeroWord( const std::uint64_t * words, unsigned int count );
+
+private:
+
+	/// Pointer to block allocated to hold from 1 to N objects.
+	unsigned char * block_;
+	/// One bit for each chunk, which is set if the chunk is free. Stored inside the block after the last chunk.
+	std::uint64_t * bitmap_;
+	/// Number of bytes in each chunk.
+	unsigned int objectSize_;
+	/// Number of chunks in block.
+	unsigned int objectsPerPool_;
+	/// Number of objects allocated so far.
+	unsigned int objectCount_;
+	/// Index of lowest word in bitmap which may have a free chunk. Every word below it is zero.
+	unsigned int lowestFree_;
+	/// Position of block in its pool's list of blocks which may have free chunks, or NotListed.
+	unsigned int listPosition_;
+};
+
+// ----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,40 @@
+#include "BitmapPoolAllocator.hpp"
+
+#include "BitmapBlock.hpp"
+
+namespace memwa
+{
+
+// ----------------------------------------------------------------------------
+
+BitmapPoolAllocator::BitmapPoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+	bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source ) :
+	AnyPoolAllocator( initialBlocks, blockSize, objectSize, alignment, alignedBlocks, retainedEmptyBlocks, source )
+{
+	// Bitmap blocks have no inline functions which could use the hot block.
+	hotEnabled_ = false;
+}
+
+// ----------------------------------------------------------------------------
+
+BitmapPoolAllocator::~BitmapPoolAllocator()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+ThreadSafeBitmapPoolAllocator::ThreadSafeBitmapPoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+	bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source ) :
+	AnyThreadSafePoolAllocator( initialBlocks, blockSize, objectSize, alignment, alignedBlocks, retainedEmptyBlocks, source )
+{
+}
+
+// ----------------------------------------------------------------------------
+
+ThreadSafeBitmapPoolAllocator::~ThreadSafeBitmapPoolAllocator()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+} // end project namespace
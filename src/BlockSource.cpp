@@ -0,0 +1,644 @@
+
+#include "BlockSource.hpp"
+
+#include "ManagerImpl.hpp"
+
+#include <cassert>
+#include <cstdint>
+
+#include <new>
+#include <stdexcept>
+
+#if defined(unix) || defined(__unix__) || defined(__unix)
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+#if defined(_WIN64)
+	#include <windows.h>
+#endif
+
+namespace memwa
+{
+
+namespace
+{
+
+// ----------------------------------------------------------------------------
+
+/// Provides number of bytes in whole pages needed to hold blockSize bytes.
+std::size_t RoundUpToPages( std::size_t blockSize )
+{
+	const std::size_t pageSize = MmapBlockSource::GetPageSize();
+	return ( ( blockSize + pageSize - 1 ) / pageSize ) * pageSize;
+}
+
+#if defined(unix) || defined(__unix__) || defined(__unix)
+
+// ----------------------------------------------------------------------------
+
+/** Maps mapSize bytes at an address which is a multiple of blockAlignment.
+ @param granularity Alignment mmap provides with these flags, and multiple of which mapSize must be.
+ @param flags Flags passed to mmap besides MAP_PRIVATE and MAP_ANONYMOUS.
+ @return Pointer to mapped memory, or nullptr if mmap failed.
+ */
+void * MapAlignedPages( std::size_t mapSize, std::size_t blockAlignment, std::size_t granularity, int flags )
+{
+	flags |= MAP_PRIVATE | MAP_ANONYMOUS;
+	if ( blockAlignment <= granularity )
+	{
+		void * block = ::mmap( nullptr, mapSize, PROT_READ | PROT_WRITE, flags, -1, 0 );
+		return ( MAP_FAILED == block ) ? nullptr : block;
+	}
+
+	// Map enough extra pages to be sure an aligned address is within them, then unmap pages before and after it.
+	const std::size_t extraSize = mapSize + blockAlignment - granularity;
+	void * place = ::mmap( nullptr, extraSize, PROT_READ | PROT_WRITE, flags, -1, 0 );
+	if ( MAP_FAILED == place )
+	{
+		return nullptr;
+	}
+	unsigned char * start = static_cast< unsigned char * >( place );
+	const std::uintptr_t address = reinterpret_cast< std::uintptr_t >( start );
+	const std::uintptr_t aligned = ( address + blockAlignment - 1 ) & ~( static_cast< std::uintptr_t >( blockAlignment ) - 1 );
+	const std::size_t headSize = aligned - address;
+	const std::size_t tailSize = extraSize - headSize - mapSize;
+	if ( 0 != headSize )
+	{
+		::munmap( start, headSize );
+	}
+	if ( 0 != tailSize )
+	{
+		::munmap( start + headSize + mapSize, tailSize );
+	}
+	return start + headSize;
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+
+} // end anonymous namespace
+
+// ----------------------------------------------------------------------------
+
+BlockSource::BlockSource()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+BlockSource::~BlockSource()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+MallocBlockSource::MallocBlockSource() :
+	BlockSource()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+MallocBlockSource::~MallocBlockSource()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+void * MallocBlockSource::AllocateBlock( std::size_t blockSize, std::size_t blockAlignment )
+{
+	return impl::AllocateSystemBlock( blockSize, blockAlignment );
+}
+
+// ----------------------------------------------------------------------------
+
+void MallocBlockSource::ReleaseBlock( void * block, std::size_t blockSize, std::size_t blockAlignment )
+{
+	(void)blockSize;
+	(void)blockAlignment;
+	impl::ReleaseSystemBlock( block );
+}
+
+// ----------------------------------------------------------------------------
+
+MmapBlockSource::MmapBlockSource() :
+	BlockSource()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+MmapBlockSource::~MmapBlockSource()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+#if defined(unix) || defined(__unix__) || defined(__unix)
+
+std::size_t MmapBlockSource::GetPageSize()
+{
+	static const std::size_t pageSize = static_cast< std::size_t >( ::sysconf( _SC_PAGE_SIZE ) );
+	return pageSize;
+}
+
+// ----------------------------------------------------------------------------
+
+void * MmapBlockSource::AllocateBlock( std::size_t blockSize, std::size_t blockAlignment )
+{
+	return MapAlignedPages( RoundUpToPages( blockSize ), blockAlignment, GetPageSize(), 0 );
+}
+
+// ----------------------------------------------------------------------------
+
+void MmapBlockSource::ReleaseBlock( void * block, std::size_t blockSize, std::size_t blockAlignment )
+{
+	(void)blockAlignment;
+	::munmap( block, RoundUpToPages( blockSize ) );
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+
+#if defined(_WIN64)
+
+std::size_t MmapBlockSource::GetPageSize()
+{
+	SYSTEM_INFO info;
+	::GetSystemInfo( &info );
+	return info.dwPageSize;
+}
+
+// ----------------------------------------------------------------------------
+
+void * MmapBlockSource::AllocateBlock( std::size_t blockSize, std::size_t blockAlignment )
+{
+	SYSTEM_INFO info;
+	::GetSystemInfo( &info );
+	const std::size_t mapSize = RoundUpToPages( blockSize );
+	if ( blockAlignment <= info.dwAllocationGranularity )
+	{
+		return ::VirtualAlloc( nullptr, mapSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE );
+	}
+
+	// Windows can't release part of a reservation, so find an aligned address within a bigger reservation,
+	// release it, and reserve just the aligned part. Another thread could take the space in between, so retry.
+	const unsigned int tryCount = 8;
+	for ( unsigned int ii = 0; ii < tryCount; ++ii )
+	{
+		void * place = ::VirtualAlloc( nullptr, mapSize + blockAlignment, MEM_RESERVE, PAGE_NOACCESS );
+		if ( nullptr == place )
+		{
+			return nullptr;
+		}
+		const std::uintptr_t address = reinterpret_cast< std::uintptr_t >( place );
+		const std::uintptr_t aligned = ( address + blockAlignment - 1 ) & ~( static_cast< std::uintptr_t >( blockAlignment ) - 1 );
+		::VirtualFree( place, 0, MEM_RELEASE );
+		void * block = ::VirtualAlloc( reinterpret_cast< void * >( aligned ), mapSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE );
+		if ( nullptr != block )
+		{
+			return block;
+		}
+	}
+	return nullptr;
+}
+
+// ----------------------------------------------------------------------------
+
+void MmapBlockSource::ReleaseBlock( void * block, std::size_t blockSize, std::size_t blockAlignment )
+{
+	(void)blockSize;
+	(void)blockAlignment;
+	::VirtualFree( block, 0, MEM_RELEASE );
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+
+HugePageBlockSource::HugePageBlockSource() :
+	MmapBlockSource(),
+	hugeTlbBlocks_( 0 ),
+	advisedBlocks_( 0 ),
+	smallPageBlocks_( 0 ),
+	blockRequests_( 0 ),
+	nextHugeTlbTry_( 0 ),
+	hugeTlbBackoff_( 1 )
+{
+}
+
+// ----------------------------------------------------------------------------
+
+HugePageBlockSource::~HugePageBlockSource()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+std::size_t HugePageBlockSource::RoundBlockSize( std::size_t blockSize )
+{
+	if ( 0 == blockSize )
+	{
+		return HugePageSize;
+	}
+	return ( ( blockSize + HugePageSize - 1 ) / HugePageSize ) * HugePageSize;
+}
+
+// ----------------------------------------------------------------------------
+
+bool HugePageBlockSource::ShouldTryHugeTlb( std::size_t & blockNumber )
+{
+	blockNumber = blockRequests_.fetch_add( 1, std::memory_order_relaxed );
+	return ( nextHugeTlbTry_.load( std::memory_order_relaxed ) <= blockNumber );
+}
+
+// ----------------------------------------------------------------------------
+
+void HugePageBlockSource::HugeTlbFailed( std::size_t blockNumber )
+{
+	// Threads racing here may lose a doubling or a skip, which only changes when this tries again.
+	const std::size_t backoff = hugeTlbBackoff_.load( std::memory_order_relaxed );
+	nextHugeTlbTry_.store( blockNumber + 1 + backoff, std::memory_order_relaxed );
+	std::size_t nextBackoff = backoff * 2;
+	if ( MaxHugeTlbBackoff < nextBackoff )
+	{
+		nextBackoff = MaxHugeTlbBackoff;
+	}
+	hugeTlbBackoff_.store( nextBackoff, std::memory_order_relaxed );
+}
+
+// ----------------------------------------------------------------------------
+
+#if defined(unix) || defined(__unix__) || defined(__unix)
+
+void * HugePageBlockSource::AllocateBlock( std::size_t blockSize, std::size_t blockAlignment )
+{
+	const std::size_t mapSize = RoundBlockSize( blockSize );
+	void * block = nullptr;
+#if defined(MAP_HUGETLB)
+	std::size_t blockNumber = 0;
+	if ( ShouldTryHugeTlb( blockNumber ) )
+	{
+		int flags = MAP_HUGETLB;
+	#if defined(MAP_HUGE_2MB)
+		flags |= MAP_HUGE_2MB;
+	#endif
+		block = MapAlignedPages( mapSize, blockAlignment, HugePageSize, flags );
+		if ( nullptr != block )
+		{
+			hugeTlbBlocks_.fetch_add( 1, std::memory_order_relaxed );
+			hugeTlbBackoff_.store( 1, std::memory_order_relaxed );
+			return block;
+		}
+		// No huge pages are reserved, or all of them are used, so don't make a failing system call for every block.
+		HugeTlbFailed( blockNumber );
+	}
+#endif
+
+	// Transparent huge pages only back whole huge pages which are aligned to their size.
+	if ( blockAlignment < HugePageSize )
+	{
+		blockAlignment = HugePageSize;
+	}
+	block = MapAlignedPages( mapSize, blockAlignment, GetPageSize(), 0 );
+	if ( nullptr == block )
+	{
+		return nullptr;
+	}
+#if defined(MADV_HUGEPAGE)
+	if ( ::madvise( block, mapSize, MADV_HUGEPAGE ) == 0 )
+	{
+		advisedBlocks_.fetch_add( 1, std::memory_order_relaxed );
+		return block;
+	}
+#endif
+	smallPageBlocks_.fetch_add( 1, std::memory_order_relaxed );
+	return block;
+}
+
+// ----------------------------------------------------------------------------
+
+void HugePageBlockSource::ReleaseBlock( void * block, std::size_t blockSize, std::size_t blockAlignment )
+{
+	(void)blockAlignment;
+	::munmap( block, RoundBlockSize( blockSize ) );
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+
+#if defined(_WIN64)
+
+void * HugePageBlockSource::AllocateBlock( std::size_t blockSize, std::size_t blockAlignment )
+{
+	const std::size_t largePageSize = ::GetLargePageMinimum();
+	std::size_t blockNumber = 0;
+	if ( ( 0 != largePageSize ) && ( blockAlignment <= largePageSize ) && ShouldTryHugeTlb( blockNumber ) )
+	{
+		const std::size_t mapSize = ( ( blockSize + largePageSize - 1 ) / largePageSize ) * largePageSize;
+		void * block = ::VirtualAlloc( nullptr, mapSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE );
+		if ( nullptr != block )
+		{
+			hugeTlbBlocks_.fetch_add( 1, std::memory_order_relaxed );
+			hugeTlbBackoff_.store( 1, std::memory_order_relaxed );
+			return block;
+		}
+		// The process lacks SeLockMemoryPrivilege, or no large pages are free.
+		HugeTlbFailed( blockNumber );
+	}
+	void * block = MmapBlockSource::AllocateBlock( blockSize, blockAlignment );
+	if ( nullptr != block )
+	{
+		smallPageBlocks_.fetch_add( 1, std::memory_order_relaxed );
+	}
+	return block;
+}
+
+// ----------------------------------------------------------------------------
+
+void HugePageBlockSource::ReleaseBlock( void * block, std::size_t blockSize, std::size_t blockAlignment )
+{
+	MmapBlockSource::ReleaseBlock( block, blockSize, blockAlignment );
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+
+AllocatorBlockSource::AllocatorBlockSource( Allocator * parent ) :
+	BlockSource(),
+	parent_( parent )
+{
+	if ( nullptr == parent )
+	{
+		throw std::invalid_argument( "AllocatorBlockSource needs a parent allocator." );
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+AllocatorBlockSource::~AllocatorBlockSource()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+void * AllocatorBlockSource::AllocateBlock( std::size_t blockSize, std::size_t blockAlignment )
+{
+	try
+	{
+		if ( 0 == blockAlignment )
+		{
+			return parent_->Allocate( blockSize );
+		}
+#if __cplusplus > 201402L
+		return parent_->Allocate( blockSize, static_cast< std::align_val_t >( blockAlignment ) );
+#else
+		return parent_->Allocate( blockSize, blockAlignment );
+#endif
+	}
+	catch ( const std::bad_alloc & )
+	{
+		return nullptr;
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+void AllocatorBlockSource::ReleaseBlock( void * block, std::size_t blockSize, std::size_t blockAlignment )
+{
+	(void)blockAlignment;
+	const bool released = parent_->Release( block, blockSize );
+	assert( released );
+	(void)released;
+}
+
+// ----------------------------------------------------------------------------
+
+struct RegionBlockSource::FreeRange
+{
+	/// Number of bytes in range, including this header.
+	std::size_t size_;
+	/// Next free range at a higher address.
+	FreeRange * next_;
+};
+
+// ----------------------------------------------------------------------------
+
+struct RegionBlockSource::GrowthChunk
+{
+	/// Number of bytes gotten from growth source, including this header.
+	std::size_t size_;
+	/// Chunk gotten before this one.
+	GrowthChunk * next_;
+};
+
+// ----------------------------------------------------------------------------
+
+RegionBlockSource::RegionBlockSource( void * region, std::size_t regionSize, BlockSource * growthSource,
+	std::size_t growthSize, std::size_t maxGrowth ) :
+	BlockSource(),
+	mutex_(),
+	free_( nullptr ),
+	chunks_( nullptr ),
+	growthSource_( growthSource ),
+	growthSize_( growthSize ),
+	maxGrowth_( maxGrowth ),
+	growthBytes_( 0 ),
+	freeBytes_( 0 )
+{
+	static_assert( sizeof( FreeRange ) <= Granularity, "A free range header must fit within the smallest range." );
+	static_assert( sizeof( GrowthChunk ) <= Granularity, "A growth chunk header must fit within the smallest range." );
+	if ( ( nullptr == region ) && ( 0 != regionSize ) )
+	{
+		throw std::invalid_argument( "RegionBlockSource region may not be nullptr." );
+	}
+	if ( ( nullptr != growthSource ) && ( ( 0 == growthSize ) || ( maxGrowth < growthSize ) ) )
+	{
+		throw std::invalid_argument( "RegionBlockSource growth limit must be at least the growth size." );
+	}
+	AddRegion( region, regionSize );
+}
+
+// ----------------------------------------------------------------------------
+
+RegionBlockSource::~RegionBlockSource()
+{
+	while ( nullptr != chunks_ )
+	{
+		GrowthChunk * chunk = chunks_;
+		chunks_ = chunk->next_;
+		growthSource_->ReleaseBlock( chunk, chunk->size_, Granularity );
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+void RegionBlockSource::AddRegion( void * region, std::size_t regionSize )
+{
+	const std::uintptr_t address = reinterpret_cast< std::uintptr_t >( region );
+	const std::uintptr_t aligned = ( address + Granularity - 1 ) & ~( static_cast< std::uintptr_t >( Granularity ) - 1 );
+	const std::size_t headSize = aligned - address;
+	if ( regionSize < headSize + Granularity )
+	{
+		return;
+	}
+	const std::size_t rangeSize = ( ( regionSize - headSize ) / Granularity ) * Granularity;
+	std::lock_guard< std::mutex > lock( mutex_ );
+	AddFreeRange( static_cast< unsigned char * >( region ) + headSize, rangeSize );
+}
+
+// ----------------------------------------------------------------------------
+
+void RegionBlockSource::AddFreeRange( unsigned char * place, std::size_t rangeSize )
+{
+	FreeRange * prior = nullptr;
+	FreeRange * next = free_;
+	while ( ( nullptr != next ) && ( reinterpret_cast< unsigned char * >( next ) < place ) )
+	{
+		prior = next;
+		next = next->next_;
+	}
+	assert( ( nullptr == next ) || ( place + rangeSize <= reinterpret_cast< unsigned char * >( next ) ) );
+	assert( ( nullptr == prior ) || ( reinterpret_cast< unsigned char * >( prior ) + prior->size_ <= place ) );
+
+	FreeRange * range = new ( place ) FreeRange;
+	range->size_ = rangeSize;
+	range->next_ = next;
+	if ( ( nullptr != next ) && ( place + rangeSize == reinterpret_cast< unsigned char * >( next ) ) )
+	{
+		range->size_ += next->size_;
+		range->next_ = next->next_;
+	}
+	if ( ( nullptr != prior ) && ( reinterpret_cast< unsigned char * >( prior ) + prior->size_ == place ) )
+	{
+		prior->size_ += range->size_;
+		prior->next_ = range->next_;
+	}
+	else if ( nullptr != prior )
+	{
+		prior->next_ = range;
+	}
+	else
+	{
+		free_ = range;
+	}
+	freeBytes_ += rangeSize;
+}
+
+// ----------------------------------------------------------------------------
+
+void * RegionBlockSource::CarveBlock( std::size_t blockSize, std::size_t blockAlignment )
+{
+	FreeRange ** link = &free_;
+	for ( FreeRange * range = free_; nullptr != range; link = &range->next_, range = range->next_ )
+	{
+		unsigned char * start = reinterpret_cast< unsigned char * >( range );
+		const std::uintptr_t address = reinterpret_cast< std::uintptr_t >( start );
+		const std::uintptr_t aligned = ( address + blockAlignment - 1 ) & ~( static_cast< std::uintptr_t >( blockAlignment ) - 1 );
+		const std::size_t headSize = aligned - address;
+		if ( range->size_ < headSize + blockSize )
+		{
+			continue;
+		}
+		const std::size_t tailSize = range->size_ - headSize - blockSize;
+		*link = range->next_;
+		freeBytes_ -= range->size_;
+		if ( 0 != headSize )
+		{
+			AddFreeRange( start, headSize );
+		}
+		if ( 0 != tailSize )
+		{
+			AddFreeRange( start + headSize + blockSize, tailSize );
+		}
+		return start + headSize;
+	}
+	return nullptr;
+}
+
+// ----------------------------------------------------------------------------
+
+bool RegionBlockSource::Grow( std::size_t blockSize, std::size_t blockAlignment )
+{
+	if ( nullptr == growthSource_ )
+	{
+		return false;
+	}
+	// The chunk header takes Granularity bytes, and at most blockAlignment - Granularity more are skipped to align the block.
+	std::size_t chunkSize = blockSize + blockAlignment;
+	if ( chunkSize < growthSize_ )
+	{
+		chunkSize = ( ( growthSize_ + Granularity - 1 ) / Granularity ) * Granularity;
+	}
+	if ( maxGrowth_ - growthBytes_ < chunkSize )
+	{
+		return false;
+	}
+	void * place = growthSource_->AllocateBlock( chunkSize, Granularity );
+	if ( nullptr == place )
+	{
+		return false;
+	}
+	assert( reinterpret_cast< std::uintptr_t >( place ) % Granularity == 0 );
+	GrowthChunk * chunk = new ( place ) GrowthChunk;
+	chunk->size_ = chunkSize;
+	chunk->next_ = chunks_;
+	chunks_ = chunk;
+	growthBytes_ += chunkSize;
+	AddFreeRange( static_cast< unsigned char * >( place ) + Granularity, chunkSize - Granularity );
+	return true;
+}
+
+// ----------------------------------------------------------------------------
+
+void * RegionBlockSource::AllocateBlock( std::size_t blockSize, std::size_t blockAlignment )
+{
+	assert( ( blockAlignment & ( blockAlignment - 1 ) ) == 0 );
+	blockSize = ( blockSize == 0 ) ? Granularity : ( ( blockSize + Granularity - 1 ) / Granularity ) * Granularity;
+	if ( blockAlignment < Granularity )
+	{
+		blockAlignment = Granularity;
+	}
+	std::lock_guard< std::mutex > lock( mutex_ );
+	void * block = CarveBlock( blockSize, blockAlignment );
+	if ( ( nullptr == block ) && Grow( blockSize, blockAlignment ) )
+	{
+		block = CarveBlock( blockSize, blockAlignment );
+	}
+	return block;
+}
+
+// ----------------------------------------------------------------------------
+
+void RegionBlockSource::ReleaseBlock( void * block, std::size_t blockSize, std::size_t blockAlignment )
+{
+	(void)blockAlignment;
+	blockSize = ( blockSize == 0 ) ? Granularity : ( ( blockSize + Granularity - 1 ) / Granularity ) * Granularity;
+	std::lock_guard< std::mutex > lock( mutex_ );
+	AddFreeRange( static_cast< unsigned char * >( block ), blockSize );
+}
+
+// ----------------------------------------------------------------------------
+
+std::size_t RegionBlockSource::GetFreeBytes() const
+{
+	std::lock_guard< std::mutex > lock( mutex_ );
+	return freeBytes_;
+}
+
+// ----------------------------------------------------------------------------
+
+std::size_t RegionBlockSource::GetGrowthBytes() const
+{
+	std::lock_guard< std::mutex > lock( mutex_ );
+	return growthBytes_;
+}
+
+// ----------------------------------------------------------------------------
+
+} // end project namespace
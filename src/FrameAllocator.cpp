@@ -0,0 +1,275 @@
+
+#include "FrameAllocator.hpp"
+
+#include "LockGuard.hpp"
+
+#include "BlockInfo.hpp"
+#include "LinearBlock.hpp"
+#include "ManagerImpl.hpp"
+
+#include <cassert>
+
+#include <new>
+#include <stdexcept>
+
+
+namespace memwa
+{
+
+// ----------------------------------------------------------------------------
+
+FrameAllocator::FrameAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment,
+	unsigned int frameCount, BlockSource * source ) :
+	Allocator(),
+	frames_(),
+	current_( 0 )
+{
+	assert( 2 <= frameCount );
+	assert( frameCount <= MaxFrameCount );
+	try
+	{
+		frames_.reserve( frameCount );
+		for ( unsigned int ii = 0; ii < frameCount; ++ii )
+		{
+			frames_.emplace_back( initialBlocks, blockSize, alignment, 0, 0, source );
+		}
+	}
+	catch ( ... )
+	{
+		Destroy();
+		throw std::bad_alloc();
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+FrameAllocator::~FrameAllocator()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+void FrameAllocator::Destroy()
+{
+	for ( LinearBlockInfo & frame : frames_ )
+	{
+		frame.Destroy();
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+#if __cplusplus > 201402L
+void * FrameAllocator::Allocate( std::size_t size, std::align_val_t alignment, const void * hint )
+#else
+void * FrameAllocator::Allocate( std::size_t size, std::size_t alignment, const void * hint )
+#endif
+{
+	if ( impl::GetAlignmentSize( alignment ) > frames_[ current_ ].alignment_ )
+	{
+		throw std::invalid_argument( "Requested alignment size must be less than or equal to initial alignment size." );
+	}
+	void * p = FrameAllocator::Allocate( size, hint );
+	return p;
+}
+
+// ----------------------------------------------------------------------------
+
+void * FrameAllocator::Allocate( std::size_t size, const void * hint )
+{
+	LinearBlockInfo & frame = frames_[ current_ ];
+	if ( frame.blockSize_ < size )
+	{
+		throw std::invalid_argument( "Requested allocation size must be smaller than the memory block size." );
+	}
+	void * p = frame.Allocate( size, hint );
+	if ( nullptr != p )
+	{
+		return p;
+	}
+	// Call this class' function directly since a thread-safe allocator already holds its lock.
+	if ( FrameAllocator::TrimEmptyBlocks() )
+	{
+		p = frame.Allocate( size, hint );
+		if ( nullptr != p )
+		{
+			return p;
+		}
+	}
+	if ( memwa::impl::ManagerImpl::GetManager()->TrimEmptyBlocks( this ) )
+	{
+		p = frame.Allocate( size, hint );
+	}
+	if ( nullptr == p )
+	{
+		throw std::bad_alloc();
+	}
+
+	return p;
+}
+
+// ----------------------------------------------------------------------------
+
+void FrameAllocator::AdvanceFrame()
+{
+	++current_;
+	if ( current_ == frames_.size() )
+	{
+		current_ = 0;
+	}
+	const LinearMarker start = { 0, nullptr };
+	const bool rewound = frames_[ current_ ].RewindTo( start, true );
+	assert( rewound );
+	(void)rewound;
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned long long FrameAllocator::GetMaxSize( std::size_t objectSize ) const
+{
+	const unsigned long long bytesAvailable = memwa::impl::GetTotalAvailableMemory();
+	const unsigned long long maxPossibleObjects = bytesAvailable / objectSize;
+	return maxPossibleObjects;
+}
+
+// ----------------------------------------------------------------------------
+
+bool FrameAllocator::HasAddress( void * place ) const
+{
+	for ( const LinearBlockInfo & frame : frames_ )
+	{
+		if ( frame.HasAddress( place ) )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// ----------------------------------------------------------------------------
+
+bool FrameAllocator::TrimEmptyBlocks()
+{
+	bool trimmedAny = false;
+	for ( LinearBlockInfo & frame : frames_ )
+	{
+		if ( frame.TrimEmptyBlocks() )
+		{
+			trimmedAny = true;
+		}
+	}
+	return trimmedAny;
+}
+
+// ----------------------------------------------------------------------------
+
+bool FrameAllocator::IsCorrupt() const
+{
+	assert( nullptr != this );
+	assert( current_ < frames_.size() );
+	for ( const LinearBlockInfo & frame : frames_ )
+	{
+		if ( frame.IsCorrupt() )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// ----------------------------------------------------------------------------
+
+float FrameAllocator::GetFragmentationPercent() const
+{
+	std::size_t blockCount = 0;
+	std::size_t excessBlocks = 0;
+	for ( const LinearBlockInfo & frame : frames_ )
+	{
+		frame.GetBlockCounts( blockCount, excessBlocks );
+	}
+	if ( 0 == blockCount )
+	{
+		return 0.0F;
+	}
+	const float percent = (float)excessBlocks / (float)blockCount;
+	return percent;
+}
+
+// ----------------------------------------------------------------------------
+
+ThreadSafeFrameAllocator::ThreadSafeFrameAllocator( unsigned int initialBlocks, std::size_t blockSize,
+	std::size_t alignment, unsigned int frameCount, BlockSource * source ) :
+	FrameAllocator( initialBlocks, blockSize, alignment, frameCount, source ),
+	mutex_()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+ThreadSafeFrameAllocator::~ThreadSafeFrameAllocator()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+void * ThreadSafeFrameAllocator::Allocate( std::size_t size, const void * hint )
+{
+	LockGuard guard( mutex_ );
+	return FrameAllocator::Allocate( size, hint );
+}
+
+// ----------------------------------------------------------------------------
+
+#if __cplusplus > 201402L
+void * ThreadSafeFrameAllocator::Allocate( std::size_t size, std::align_val_t alignment, const void * hint )
+#else
+void * ThreadSafeFrameAllocator::Allocate( std::size_t size, std::size_t alignment, const void * hint )
+#endif
+{
+	LockGuard guard( mutex_ );
+	return FrameAllocator::Allocate( size, alignment, hint );
+}
+
+// ----------------------------------------------------------------------------
+
+bool ThreadSafeFrameAllocator::HasAddress( void * place ) const
+{
+	LockGuard guard( mutex_ );
+	return FrameAllocator::HasAddress( place );
+}
+
+// ----------------------------------------------------------------------------
+
+bool ThreadSafeFrameAllocator::TrimEmptyBlocks()
+{
+	LockGuard guard( mutex_ );
+	return FrameAllocator::TrimEmptyBlocks();
+}
+
+// ----------------------------------------------------------------------------
+
+bool ThreadSafeFrameAllocator::IsCorrupt() const
+{
+	LockGuard guard( mutex_ );
+	return FrameAllocator::IsCorrupt();
+}
+
+// ----------------------------------------------------------------------------
+
+float ThreadSafeFrameAllocator::GetFragmentationPercent() const
+{
+	LockGuard guard( mutex_ );
+	return FrameAllocator::GetFragmentationPercent();
+}
+
+// ----------------------------------------------------------------------------
+
+void ThreadSafeFrameAllocator::AdvanceFrame()
+{
+	LockGuard guard( mutex_ );
+	FrameAllocator::AdvanceFrame();
+}
+
+// ----------------------------------------------------------------------------
+
+} // end project namespace
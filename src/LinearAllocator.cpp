@@ -20,9 +20,12 @@ namespace memwa
 
 // ----------------------------------------------------------------------------
 
-LinearAllocator::LinearAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment ) :
+LinearAllocator::LinearAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment,
+	BlockSource * source ) :
 	Allocator(),
-	info_( initialBlocks, blockSize, alignment )
+	hotEnabled_( true ),
+	info_( initialBlocks, blockSize, alignment, 0, 0, source ),
+	hot_( nullptr )
 {
 }
 
@@ -36,18 +39,33 @@ LinearAllocator::~LinearAllocator()
 
 void LinearAllocator::Destroy()
 {
+	hot_ = nullptr;
 	info_.Destroy();
 }
 
 // ----------------------------------------------------------------------------
 
+void LinearAllocator::SetHotBlock()
+{
+	if ( hotEnabled_ && ( info_.recent_ != info_.blocks_.end() ) )
+	{
+		hot_ = &( *info_.recent_ );
+	}
+	else
+	{
+		hot_ = nullptr;
+	}
+}
+
+// ----------------------------------------------------------------------------
+
 #if __cplusplus > 201402L
 void * LinearAllocator::Allocate( std::size_t size, std::align_val_t alignment, const void * hint )
 #else
 void * LinearAllocator::Allocate( std::size_t size, std::size_t alignment, const void * hint )
 #endif
 {
-	if ( alignment > info_.alignment_ )
+	if ( impl::GetAlignmentSize( alignment ) > info_.alignment_ )
 	{
 		throw std::invalid_argument( "Requested alignment size must be less than or equal to initial alignment size." );
 	}
@@ -63,20 +81,13 @@ void * LinearAllocator::Allocate( std::size_t size, const void * hint )
 	{
 		throw std::invalid_argument( "Requested allocation size must be smaller than the memory block size." );
 	}
+	hot_ = nullptr;
 	void * p = info_.Allocate( size, hint );
-	if ( nullptr != p )
-	{
-		return p;
-	}
-	if ( info_.TrimEmptyBlocks() )
+	if ( ( nullptr == p ) && info_.TrimEmptyBlocks() )
 	{
 		p = info_.Allocate( size, hint );
-		if ( nullptr != p )
-		{
-			return p;
-		}
 	}
-	if ( memwa::impl::ManagerImpl::GetManager()->TrimEmptyBlocks( this ) )
+	if ( ( nullptr == p ) && memwa::impl::ManagerImpl::GetManager()->TrimEmptyBlocks( this ) )
 	{
 		p = info_.Allocate( size, hint );
 	}
@@ -84,6 +95,7 @@ void * LinearAllocator::Allocate( std::size_t size, const void * hint )
 	{
 		throw std::bad_alloc();
 	}
+	SetHotBlock();
 
 	return p;
 }
@@ -109,7 +121,9 @@ bool LinearAllocator::HasAddress( void * place ) const
 
 bool LinearAllocator::TrimEmptyBlocks()
 {
+	hot_ = nullptr;
 	const bool trimmedAny = info_.TrimEmptyBlocks();
+	SetHotBlock();
 	return trimmedAny;
 }
 
@@ -139,11 +153,47 @@ float LinearAllocator::GetFragmentationPercent() const
 
 // ----------------------------------------------------------------------------
 
+LinearAllocator::Marker LinearAllocator::GetMarker() const
+{
+	return info_.GetMarker();
+}
+
+// ----------------------------------------------------------------------------
+
+bool LinearAllocator::RewindTo( const Marker & marker, bool keepBlocks )
+{
+	hot_ = nullptr;
+	const bool rewound = info_.RewindTo( marker, keepBlocks );
+	SetHotBlock();
+	return rewound;
+}
+
+// ----------------------------------------------------------------------------
+
+void LinearAllocator::Reset( bool keepBlocks )
+{
+	hot_ = nullptr;
+	const Marker start = { 0, nullptr };
+	const bool rewound = info_.RewindTo( start, keepBlocks );
+	assert( rewound );
+	(void)rewound;
+	if ( !keepBlocks )
+	{
+		// Also destroy blocks which earlier calls emptied and kept.
+		info_.TrimEmptyBlocks();
+	}
+	SetHotBlock();
+}
+
+// ----------------------------------------------------------------------------
+
 ThreadSafeLinearAllocator::ThreadSafeLinearAllocator( unsigned int initialBlocks, std::size_t blockSize,
-	std::size_t alignment ) :
-	LinearAllocator( initialBlocks, blockSize, alignment ),
+	std::size_t alignment, BlockSource * source ) :
+	LinearAllocator( initialBlocks, blockSize, alignment, source ),
 	mutex_()
 {
+	// Calls to FastAllocate must go through the locking function.
+	hotEnabled_ = false;
 }
 
 // ----------------------------------------------------------------------------
@@ -206,4 +256,28 @@ float ThreadSafeLinearAllocator::GetFragmentationPercent() const
 
 // ----------------------------------------------------------------------------
 
+LinearAllocator::Marker ThreadSafeLinearAllocator::GetMarker() const
+{
+	LockGuard guard( mutex_ );
+	return LinearAllocator::GetMarker();
+}
+
+// ----------------------------------------------------------------------------
+
+bool ThreadSafeLinearAllocator::RewindTo( const Marker & marker, bool keepBlocks )
+{
+	LockGuard guard( mutex_ );
+	return LinearAllocator::RewindTo( marker, keepBlocks );
+}
+
+// ----------------------------------------------------------------------------
+
+void ThreadSafeLinearAllocator::Reset( bool keepBlocks )
+{
+	LockGuard guard( mutex_ );
+	LinearAllocator::Reset( keepBlocks );
+}
+
+// ----------------------------------------------------------------------------
+
 } // end project namespace
@@ -15,26 +15,22 @@ namespace memwa
 
 // ----------------------------------------------------------------------------
 
-LinearBlock::LinearBlock( std::size_t blockSize, std::size_t alignment ) :
-	block_( reinterpret_cast< unsigned char * >( std::malloc( blockSize ) ) ),
-	freeSpot_( block_ )
+LinearBlock::LinearBlock( std::size_t blockSize, std::size_t alignment, std::size_t blockAlignment, BlockSource * source ) :
+	impl::HotLinearBlock( reinterpret_cast< unsigned char * >( impl::AllocateBlock( blockSize, blockAlignment, source ) ) )
 {
 	if ( nullptr == block_ )
 	{
 		throw std::bad_alloc();
 	}
-	const std::size_t blockPlace = reinterpret_cast< std::size_t >( block_ );
-	const std::size_t remainder = reinterpret_cast< std::size_t >( blockPlace ) % alignment;
-	const std::size_t padding = ( remainder == 0 ) ? 0 : alignment - remainder;
-	freeSpot_ += padding;
+	freeSpot_ += CalculateBlockPadding( alignment );
 	assert( reinterpret_cast< std::size_t >( freeSpot_ ) % alignment == 0 );
 }
 
 // ----------------------------------------------------------------------------
 
-void LinearBlock::Destroy()
+void LinearBlock::Destroy( std::size_t blockSize, std::size_t blockAlignment, BlockSource * source )
 {
-	std::free( block_ );
+	impl::ReleaseBlock( block_, blockSize, blockAlignment, source );
 	block_ = nullptr;
 }
 
@@ -50,25 +46,28 @@ std::size_t LinearBlock::CalculatePadding( std::size_t alignment ) const
 
 // ----------------------------------------------------------------------------
 
-void * LinearBlock::Allocate( std::size_t bytes, std::size_t blockSize, std::size_t alignment )
+std::size_t LinearBlock::CalculateBlockPadding( std::size_t alignment ) const
 {
-	const unsigned char * const end = block_ + blockSize;
-	const std::size_t freePlace = reinterpret_cast< const std::size_t >( freeSpot_ );
-	const std::size_t padding = CalculatePadding( alignment );
 	const std::size_t blockPlace = reinterpret_cast< const std::size_t >( block_ );
-	const std::size_t bytesAvailable = ( blockPlace + blockSize ) - ( freePlace + padding );
-	const bool hasEnough = ( bytes <= bytesAvailable );
-	if ( !hasEnough )
-	{
-		return nullptr;
-	}
+	const std::size_t remainder = ( blockPlace % alignment );
+	const std::size_t padding = ( remainder == 0 ) ? 0 : alignment - remainder;
+	return padding;
+}
+
+// ----------------------------------------------------------------------------
 
-	unsigned char * p = freeSpot_ + padding;
-	freeSpot_ = p + bytes;
-	assert( p < freeSpot_ );
-	assert( freeSpot_ <= end );
-	assert( reinterpret_cast< const std::size_t >( p ) % alignment == 0 );
-	return p;
+void LinearBlock::Rewind( const unsigned char * place )
+{
+	assert( block_ <= place );
+	assert( place <= freeSpot_ );
+	freeSpot_ = block_ + ( place - block_ );
+}
+
+// ----------------------------------------------------------------------------
+
+void LinearBlock::Reset( std::size_t alignment )
+{
+	freeSpot_ = block_ + CalculateBlockPadding( alignment );
 }
 
 // ----------------------------------------------------------------------------
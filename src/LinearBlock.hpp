@@ -1,16 +1,24 @@
 
 #pragma once
 
+#include "HotBlock.hpp"
+
 #include <cstddef> // For std::size_t.
 
 namespace memwa
 {
+
+class BlockSource;
 //namespace impl
 //{
 
 // ----------------------------------------------------------------------------
 
-class LinearBlock
+/** @class LinearBlock
+ Allocates chunks by bumping a pointer through a block, and never releases a chunk on its own. The fields and
+ the function to allocate are in impl::HotLinearBlock, so LinearAllocator can inline them.
+ */
+class LinearBlock : public impl::HotLinearBlock
 {
 public:
 
@@ -24,13 +32,15 @@ public:
 
 	LinearBlock & operator = ( const LinearBlock & ) = default;
 
-	LinearBlock( std::size_t blockSize, std::size_t alignment );
+	/** Allocates a block of memory.
+	 @param source Provides memory for the block, or nullptr to use malloc.
+	 */
+	LinearBlock( std::size_t blockSize, std::size_t alignment, std::size_t blockAlignment = 0, BlockSource * source = nullptr );
 
 	~LinearBlock() = default;
 
-	void * Allocate( std::size_t bytes, std::size_t blockSize, std::size_t alignment );
-
-	void Destroy();
+	/// Releases the block. Parameters must be the same ones passed to the constructor.
+	void Destroy( std::size_t blockSize = 0, std::size_t blockAlignment = 0, BlockSource * source = nullptr );
 
 	bool HasAddress( const void * place, std::size_t blockSize ) const;
 
@@ -43,13 +53,33 @@ public:
 		return ( block_ < that.block_ );
 	}
 
+	/// Returns true if nothing was allocated since the free spot was at the first aligned address in the block.
 	bool IsEmpty( std::size_t alignment ) const
 	{
-		return ( block_ == freeSpot_ );
+		return ( block_ + CalculateBlockPadding( alignment ) == freeSpot_ );
+	}
+
+	/// Provides address of next free spot within this block.
+	const unsigned char * GetFreeSpot() const
+	{
+		return freeSpot_;
 	}
 
+	/** Releases every chunk allocated at or after place by moving the free spot back to it.
+	 @param place Free spot of this block provided by GetFreeSpot some time before now.
+	 */
+	void Rewind( const unsigned char * place );
+
+	/// Releases every chunk in this block.
+	void Reset( std::size_t alignment );
+
 	bool IsCorrupt( std::size_t blockSize, std::size_t alignment ) const;
 
+	unsigned char * GetAddress() const
+	{
+		return block_;
+	}
+
 	/// Returns the number of available bytes within this block.
 	std::size_t GetFreeBytes( std::size_t blockSize ) const
 	{
@@ -61,10 +91,9 @@ private:
 
 	std::size_t CalculatePadding( std::size_t blockSize ) const;
 
-	/// Pointer to base of entire memory page allocated.
-	unsigned char * block_;
-	/// Pointer to next free spot within this block.
-	unsigned char * freeSpot_;
+	/// Provides number of bytes between start of block and first aligned address.
+	std::size_t CalculateBlockPadding( std::size_t alignment ) const;
+
 };
 
 // ----------------------------------------------------------------------------
@@ -5,6 +5,7 @@
 #include "LockGuard.hpp"
 #include "LinearBlock.hpp"
 
+#include <atomic>
 #include <new>
 #include <vector>
 
@@ -14,6 +15,7 @@ namespace memwa
 {
 
 	class Allocator;
+	class BlockSource;
 
 namespace impl
 {
@@ -28,9 +30,46 @@ std::size_t CalculateAlignmentPadding( std::size_t requestedAlignment );
 /// Provides maximum alignment supported by operating system.
 std::size_t GetMaxSupportedAlignment();
 
+/// Calculates smallest power of two which is at least blockSize, so each block can be aligned to it.
+std::size_t CalculateBlockAlignment( std::size_t blockSize );
+
+/** Allocates memory for a block from the C library's heap.
+ @param blockSize Number of bytes in block.
+ @param blockAlignment Power of two the block's address must be a multiple of, or zero for default alignment.
+ @return Pointer to block, or nullptr if there is not enough memory.
+ */
+void * AllocateSystemBlock( std::size_t blockSize, std::size_t blockAlignment );
+
+/// Releases memory allocated by AllocateSystemBlock.
+void ReleaseSystemBlock( void * block );
+
+/** Allocates memory for a block from the source, or from the C library's heap if source is nullptr.
+ @return Pointer to block, or nullptr if there is not enough memory.
+ */
+void * AllocateBlock( std::size_t blockSize, std::size_t blockAlignment, BlockSource * source );
+
+/// Releases memory allocated by AllocateBlock. Parameters must be the same ones passed to AllocateBlock.
+void ReleaseBlock( void * block, std::size_t blockSize, std::size_t blockAlignment, BlockSource * source );
+
 /// Returns the number of bytes the operating system will allow for allocation.
 unsigned long long GetTotalAvailableMemory();
 
+/// Provides alignment as a number of bytes, whether it is kept as a std::size_t or a std::align_val_t.
+inline std::size_t GetAlignmentSize( std::size_t alignment )
+{
+	return alignment;
+}
+
+#if __cplusplus > 201402L
+// This code is for C++ 2017.
+
+inline std::size_t GetAlignmentSize( std::align_val_t alignment )
+{
+	return static_cast< std::size_t >( alignment );
+}
+
+#endif
+
 // ----------------------------------------------------------------------------
 
 class ManagerImpl
@@ -41,7 +80,7 @@ public:
 
 	static ManagerImpl * GetManager()
 	{
-		return impl_;
+		return impl_.load( std::memory_order_acquire );
 	}
 
 	static bool CreateManager( bool multithreaded, std::size_t internalBlockSize );
@@ -75,7 +114,14 @@ private:
 
 	void ReleaseAllocators();
 
-	static ManagerImpl * impl_;
+	/** Pointer to the only manager. This and the mutex which guards creating and destroying the manager
+	 are constant-initialized, and the manager is made within static storage without allocating any
+	 memory, so it may be made safely even by a replacement operator new which is called before any
+	 static constructors run.
+	 */
+	static std::atomic< ManagerImpl * > impl_;
+
+	static std::mutex createMutex_;
 
 	bool multithreaded_;
 
@@ -90,7 +136,9 @@ private:
 	/// Byte alignment of allocations. (e.g. - 1, 2, 4, 8, 16, or 32.)
 	std::size_t alignment_;
 
-	LinearBlock common_;
+	/// Blocks which hold allocator objects. The first is made by the first call to Allocate, and another
+	/// is added whenever the last one is full.
+	std::vector< LinearBlock > common_;
 
 };
 
@@ -0,0 +1,81 @@
+
+#include "MemoryResource.hpp"
+
+#if __cplusplus > 201402L
+// This code is for C++ 2017.
+
+#include "AllocatorManager.hpp"
+
+#include <new>
+#include <stdexcept>
+#include <typeinfo>
+
+
+namespace memwa
+{
+
+// ----------------------------------------------------------------------------
+
+MemoryResource::MemoryResource( Allocator * allocator ) :
+	std::pmr::memory_resource(),
+	allocator_( allocator )
+{
+	if ( nullptr == allocator )
+	{
+		throw std::invalid_argument( "MemoryResource needs an allocator." );
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+MemoryResource::~MemoryResource()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+void * MemoryResource::do_allocate( std::size_t bytes, std::size_t alignment )
+{
+	void * place = allocator_->Allocate( bytes, static_cast< std::align_val_t >( alignment ) );
+	if ( nullptr == place )
+	{
+		throw std::bad_alloc();
+	}
+	return place;
+}
+
+// ----------------------------------------------------------------------------
+
+void MemoryResource::do_deallocate( void * place, std::size_t bytes, std::size_t alignment )
+{
+	// The aligned Release overloads demand the allocator's own alignment, but containers pass the
+	// alignment of their element type, which may be smaller. Allocate already checked it, so the
+	// chunk is aligned for the allocator and the sized overload releases it the same way. The result
+	// is not checked, since allocators which can't release single chunks, such as LinearAllocator and
+	// FrameAllocator, always return false here.
+	(void)alignment;
+	allocator_->Release( place, bytes );
+}
+
+// ----------------------------------------------------------------------------
+
+bool MemoryResource::do_is_equal( const std::pmr::memory_resource & that ) const noexcept
+{
+	if ( this == &that )
+	{
+		return true;
+	}
+	// Comparing type_info is cheaper than a dynamic_cast, which must search the class hierarchy.
+	if ( typeid( that ) != typeid( MemoryResource ) )
+	{
+		return false;
+	}
+	const MemoryResource & resource = static_cast< const MemoryResource & >( that );
+	return ( resource.allocator_ == allocator_ );
+}
+
+// ----------------------------------------------------------------------------
+
+} // end project namespace
+
+#endif
@@ -2,11 +2,15 @@
 #include "PoolAllocator.hpp"
 
 #include "PoolBlock.hpp"
+#include "BitmapPoolAllocator.hpp"
+#include "BitmapBlock.hpp"
 #include "ManagerImpl.hpp"
 #include "LockGuard.hpp"
 
 #include <cassert>
+#include <cstdint>
 
+#include <algorithm>
 #include <new>
 #include <stdexcept>
 
@@ -18,30 +22,114 @@
 namespace memwa
 {
 
+namespace
+{
+
+#if UINTPTR_MAX == 0xFFFFFFFF
+/// On 32 bit systems, lower half of head holds the address, and upper half holds the tag.
+const unsigned int TagShift = 32;
+#else
+/// On 64 bit systems, user-space addresses fit in lower 48 bits, so upper 16 bits hold the tag.
+const unsigned int TagShift = 48;
+#endif
+
+const std::uint64_t AddressMask = ( std::uint64_t( 1 ) << TagShift ) - 1;
+const std::uint64_t TagIncrement = std::uint64_t( 1 ) << TagShift;
+
+/// Provides the link stored inside a free chunk to the next free chunk.
+inline std::atomic< std::uintptr_t > & GetNextLink( void * chunk )
+{
+	return *reinterpret_cast< std::atomic< std::uintptr_t > * >( chunk );
+}
+
+/// Most chunks the lock-free pool takes from its blocks at once when the free stack runs out.
+const std::size_t RefillChunks = 64;
+
+/// Throws unless chunks aligned to poolAlignment also meet the requested alignment.
+void CheckAllocateAlignment( std::size_t alignment, std::size_t poolAlignment )
+{
+	if ( alignment > poolAlignment )
+	{
+		throw std::invalid_argument( "Requested alignment size must be less than or equal to initial alignment size." );
+	}
+}
+
+/// Throws unless a chunk is released with the alignment the pool was made with.
+void CheckReleaseAlignment( std::size_t alignment, std::size_t poolAlignment )
+{
+	if ( alignment != poolAlignment )
+	{
+		throw std::invalid_argument( "Requested alignment must match initial alignment." );
+	}
+}
+
+/// Provides fraction of blocks which are not needed to hold the chunks in use.
+float CalculateExcessBlocks( std::size_t blockCount, std::size_t objectCount, std::size_t objectsPerBlock )
+{
+	if ( 0 == blockCount )
+	{
+		return 0.0;
+	}
+	std::size_t blocksNeeded = objectCount / objectsPerBlock;
+	if ( objectCount % objectsPerBlock != 0 )
+	{
+		++blocksNeeded;
+	}
+	const std::size_t excessBlocks = blockCount - blocksNeeded;
+	const float percent = (float)excessBlocks / (float)blockCount;
+	return percent;
+}
+
+} // end anonymous namespace
+
 // ----------------------------------------------------------------------------
 
-PoolAllocator::PoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment ) :
+template < class BlockType, class HotBlockType >
+AnyPoolAllocator< BlockType, HotBlockType >::AnyPoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize,
+	std::size_t alignment, bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source ) :
 	Allocator(),
-	info_( initialBlocks, blockSize, objectSize, alignment )
+	info_( initialBlocks, blockSize, objectSize, alignment, alignedBlocks ? impl::CalculateBlockAlignment( blockSize ) : 0,
+		retainedEmptyBlocks, source ),
+	hot_( nullptr ),
+	hotEnabled_( true )
 {
 }
 
 // ----------------------------------------------------------------------------
 
-PoolAllocator::~PoolAllocator()
+template < class BlockType, class HotBlockType >
+AnyPoolAllocator< BlockType, HotBlockType >::~AnyPoolAllocator()
 {
 }
 
 // ----------------------------------------------------------------------------
 
-void PoolAllocator::Destroy()
+template < class BlockType, class HotBlockType >
+void AnyPoolAllocator< BlockType, HotBlockType >::Destroy()
 {
+	hot_ = nullptr;
 	info_.Destroy();
 }
 
 // ----------------------------------------------------------------------------
 
-void * PoolAllocator::Allocate( std::size_t size, const void * hint )
+template < class BlockType, class HotBlockType >
+void AnyPoolAllocator< BlockType, HotBlockType >::SetHotBlock()
+{
+	if ( hotEnabled_ && ( info_.recent_ != info_.blocks_.end() ) )
+	{
+		hot_ = &( *info_.recent_ );
+	}
+	else
+	{
+		hot_ = nullptr;
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+template < class BlockType, class HotBlockType >
+void * AnyPoolAllocator< BlockType, HotBlockType >::Allocate( std::size_t size, const void * hint )
 {
 	const std::size_t alignedSize = memwa::impl::CalculateAlignedSize( size, info_.alignment_ );
 	if ( info_.objectSize_ < alignedSize )
@@ -49,40 +137,40 @@ void * PoolAllocator::Allocate( std::size_t size, const void * hint )
 		throw std::invalid_argument( "Error! Requested size is too large for PoolAllocator." );
 	}
 
+	hot_ = nullptr;
 	void * p = info_.Allocate( hint );
-	if ( nullptr != p )
-	{
-		return p;
-	}
-	memwa::impl::ManagerImpl::GetManager()->TrimEmptyBlocks( this );
-	p = info_.Allocate( hint );
 	if ( nullptr == p )
 	{
-		throw std::bad_alloc();
+		memwa::impl::ManagerImpl::GetManager()->TrimEmptyBlocks( this );
+		p = info_.Allocate( hint );
+		if ( nullptr == p )
+		{
+			throw std::bad_alloc();
+		}
 	}
+	SetHotBlock();
 
 	return p;
 }
 
 // ----------------------------------------------------------------------------
 
+template < class BlockType, class HotBlockType >
 #if __cplusplus > 201402L
-void * PoolAllocator::Allocate( std::size_t size, std::align_val_t alignment, const void * hint )
+void * AnyPoolAllocator< BlockType, HotBlockType >::Allocate( std::size_t size, std::align_val_t alignment, const void * hint )
 #else
-void * PoolAllocator::Allocate( std::size_t size, std::size_t alignment, const void * hint )
+void * AnyPoolAllocator< BlockType, HotBlockType >::Allocate( std::size_t size, std::size_t alignment, const void * hint )
 #endif
 {
-	if ( alignment > info_.alignment_ )
-	{
-		throw std::invalid_argument( "Requested alignment size must be less than or equal to initial alignment size." );
-	}
-	void * p = PoolAllocator::Allocate( size, hint );
+	CheckAllocateAlignment( impl::GetAlignmentSize( alignment ), info_.alignment_ );
+	void * p = AnyPoolAllocator::Allocate( size, hint );
 	return p;
 }
 
 // ----------------------------------------------------------------------------
 
-bool PoolAllocator::Release( void * place, std::size_t size )
+template < class BlockType, class HotBlockType >
+bool AnyPoolAllocator< BlockType, HotBlockType >::Release( void * place, std::size_t size )
 {
 	if ( nullptr == place )
 	{
@@ -92,37 +180,79 @@ bool PoolAllocator::Release( void * place, std::size_t size )
 	{
 		throw std::invalid_argument( "Requested object size does not match pool object size." );
 	}
+	hot_ = nullptr;
 	const bool success = info_.Release( place );
+	SetHotBlock();
 	return success;
 }
 
 // ----------------------------------------------------------------------------
 
+template < class BlockType, class HotBlockType >
 #if __cplusplus > 201402L
-bool PoolAllocator::Release( void * place, std::size_t size, std::align_val_t alignment )
+bool AnyPoolAllocator< BlockType, HotBlockType >::Release( void * place, std::size_t size, std::align_val_t alignment )
 #else
-bool PoolAllocator::Release( void * place, std::size_t size, std::size_t alignment )
+bool AnyPoolAllocator< BlockType, HotBlockType >::Release( void * place, std::size_t size, std::size_t alignment )
 #endif
 {
 	if ( nullptr == place )
 	{
 		return false;
 	}
-	if ( alignment != info_.alignment_ )
+	CheckReleaseAlignment( impl::GetAlignmentSize( alignment ), info_.alignment_ );
+	if ( memwa::impl::CalculateAlignedSize( size, info_.alignment_ ) != info_.objectSize_ )
 	{
-		throw std::invalid_argument( "Requested alignment must match initial alignment." );
+		throw std::invalid_argument( "Requested object size does not match pool object size." );
+	}
+	hot_ = nullptr;
+	const bool success = info_.Release( place );
+	SetHotBlock();
+	return success;
+}
+
+// ----------------------------------------------------------------------------
+
+template < class BlockType, class HotBlockType >
+void AnyPoolAllocator< BlockType, HotBlockType >::AllocateBulk( void ** places, std::size_t count, std::size_t size, const void * hint )
+{
+	const std::size_t alignedSize = memwa::impl::CalculateAlignedSize( size, info_.alignment_ );
+	if ( info_.objectSize_ < alignedSize )
+	{
+		throw std::invalid_argument( "Error! Requested size is too large for PoolAllocator." );
+	}
+
+	hot_ = nullptr;
+	try
+	{
+		info_.AllocateBulk( places, count, hint );
+	}
+	catch ( const std::bad_alloc & )
+	{
+		memwa::impl::ManagerImpl::GetManager()->TrimEmptyBlocks( this );
+		info_.AllocateBulk( places, count, hint );
 	}
+	SetHotBlock();
+}
+
+// ----------------------------------------------------------------------------
+
+template < class BlockType, class HotBlockType >
+bool AnyPoolAllocator< BlockType, HotBlockType >::ReleaseBulk( void ** places, std::size_t count, std::size_t size )
+{
 	if ( memwa::impl::CalculateAlignedSize( size, info_.alignment_ ) != info_.objectSize_ )
 	{
 		throw std::invalid_argument( "Requested object size does not match pool object size." );
 	}
-	const bool success = info_.Release( place );
+	hot_ = nullptr;
+	const bool success = info_.ReleaseBulk( places, count );
+	SetHotBlock();
 	return success;
 }
 
 // ----------------------------------------------------------------------------
 
-unsigned long long PoolAllocator::GetMaxSize( std::size_t objectSize ) const
+template < class BlockType, class HotBlockType >
+unsigned long long AnyPoolAllocator< BlockType, HotBlockType >::GetMaxSize( std::size_t objectSize ) const
 {
 	const unsigned long long bytesAvailable = memwa::impl::GetTotalAvailableMemory();
 	const unsigned long long maxPossibleObjects = bytesAvailable / objectSize;
@@ -131,7 +261,8 @@ unsigned long long PoolAllocator::GetMaxSize( std::size_t objectSize ) const
 
 // ----------------------------------------------------------------------------
 
-bool PoolAllocator::HasAddress( void * place ) const
+template < class BlockType, class HotBlockType >
+bool AnyPoolAllocator< BlockType, HotBlockType >::HasAddress( void * place ) const
 {
 	const bool hasIt = info_.HasAddress( place );
 	return hasIt;
@@ -139,15 +270,19 @@ bool PoolAllocator::HasAddress( void * place ) const
 
 // ----------------------------------------------------------------------------
 
-bool PoolAllocator::TrimEmptyBlocks()
+template < class BlockType, class HotBlockType >
+bool AnyPoolAllocator< BlockType, HotBlockType >::TrimEmptyBlocks()
 {
+	hot_ = nullptr;
 	const bool trimmed = info_.TrimEmptyBlocks();
+	SetHotBlock();
 	return trimmed;
 }
 
 // ----------------------------------------------------------------------------
 
-bool PoolAllocator::IsCorrupt() const
+template < class BlockType, class HotBlockType >
+bool AnyPoolAllocator< BlockType, HotBlockType >::IsCorrupt() const
 {
 	assert( nullptr != this );
 	const bool corrupt = info_.IsCorrupt();
@@ -156,34 +291,43 @@ bool PoolAllocator::IsCorrupt() const
 
 // ----------------------------------------------------------------------------
 
-float PoolAllocator::GetFragmentationPercent() const
+template < class BlockType, class HotBlockType >
+float AnyPoolAllocator< BlockType, HotBlockType >::GetFragmentationPercent() const
 {
-	const unsigned int poolCount = info_.blocks_.size();
-	if ( 0 == poolCount )
-	{
-		return 0.0;
-	}
 	unsigned int objectCount = 0;
-	PoolBlockInfo::BlocksCIter end( info_.blocks_.end() );
-	for ( PoolBlockInfo::BlocksCIter it( info_.blocks_.begin() ); it != end; ++it )
+	typename AnyPoolBlockInfo< BlockType >::BlocksCIter end( info_.blocks_.end() );
+	for ( typename AnyPoolBlockInfo< BlockType >::BlocksCIter it( info_.blocks_.begin() ); it != end; ++it )
 	{
-		const PoolBlock & block = *it;
+		const BlockType & block = *it;
 		objectCount += block.GetInUseCount();
 	}
 
-	const unsigned int objectsPerPool = ( info_.blockSize_ / info_.objectSize_ );
-	std::size_t poolsNeeded = objectCount / objectsPerPool;
-	if ( objectCount % objectsPerPool != 0 )
-	{
-		++poolsNeeded;
-	}
-	const unsigned int excessPools = poolCount - poolsNeeded;
-	const float percent = (float)excessPools / (float)poolCount;
+	const unsigned int objectsPerPool = BlockType::GetObjectsPerBlock( info_.blockSize_, info_.objectSize_ );
+	const float percent = CalculateExcessBlocks( info_.blocks_.size(), objectCount, objectsPerPool );
 	return percent;
 }
 
 // ----------------------------------------------------------------------------
 
+template class AnyPoolAllocator< PoolBlock, impl::HotPoolBlock >;
+template class AnyPoolAllocator< BitmapBlock, BitmapBlock >;
+
+// ----------------------------------------------------------------------------
+
+PoolAllocator::PoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+	bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source ) :
+	AnyPoolAllocator( initialBlocks, blockSize, objectSize, alignment, alignedBlocks, retainedEmptyBlocks, source )
+{
+}
+
+// ----------------------------------------------------------------------------
+
+PoolAllocator::~PoolAllocator()
+{
+}
+
+// ----------------------------------------------------------------------------
+
 #ifdef DEBUGGING_ALLOCATORS
 
 void PoolAllocator::OutputContents() const
@@ -204,99 +348,1007 @@ void PoolAllocator::OutputContents() const
 }
 
 #endif
-
 // ----------------------------------------------------------------------------
 
-ThreadSafePoolAllocator::ThreadSafePoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment ) :
-	PoolAllocator( initialBlocks, blockSize, objectSize, alignment ),
+template < class PoolType >
+AnyThreadSafePoolAllocator< PoolType >::AnyThreadSafePoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize,
+	std::size_t alignment, bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source ) :
+	PoolType( initialBlocks, blockSize, objectSize, alignment, alignedBlocks, retainedEmptyBlocks, source ),
 	mutex_()
 {
+	// Calls to FastAllocate and FastRelease must go through the locking functions.
+	PoolType::hotEnabled_ = false;
 }
 
 // ----------------------------------------------------------------------------
 
-ThreadSafePoolAllocator::~ThreadSafePoolAllocator()
+template < class PoolType >
+AnyThreadSafePoolAllocator< PoolType >::~AnyThreadSafePoolAllocator()
 {
 }
 
 // ----------------------------------------------------------------------------
 
-void * ThreadSafePoolAllocator::Allocate( std::size_t size, const void * hint )
+template < class PoolType >
+void * AnyThreadSafePoolAllocator< PoolType >::Allocate( std::size_t size, const void * hint )
 {
 	LockGuard guard( mutex_ );
     assert( guard.owns_lock() );
-	return PoolAllocator::Allocate( size, hint );
+	return PoolType::Allocate( size, hint );
 }
 
 // ----------------------------------------------------------------------------
 
+template < class PoolType >
 #if __cplusplus > 201402L
-void * ThreadSafePoolAllocator::Allocate( std::size_t size, std::align_val_t alignment, const void * hint )
+void * AnyThreadSafePoolAllocator< PoolType >::Allocate( std::size_t size, std::align_val_t alignment, const void * hint )
 #else
-void * ThreadSafePoolAllocator::Allocate( std::size_t size, std::size_t alignment, const void * hint )
+void * AnyThreadSafePoolAllocator< PoolType >::Allocate( std::size_t size, std::size_t alignment, const void * hint )
 #endif
 {
 	LockGuard guard( mutex_ );
     assert( guard.owns_lock() );
-	return PoolAllocator::Allocate( size, alignment, hint );
+	return PoolType::Allocate( size, alignment, hint );
 }
 
 // ----------------------------------------------------------------------------
 
-bool ThreadSafePoolAllocator::Release( void * place, std::size_t size )
+template < class PoolType >
+bool AnyThreadSafePoolAllocator< PoolType >::Release( void * place, std::size_t size )
 {
 	LockGuard guard( mutex_ );
     assert( guard.owns_lock() );
-	return PoolAllocator::Release( place, size );
+	return PoolType::Release( place, size );
 }
 
 // ----------------------------------------------------------------------------
 
+template < class PoolType >
 #if __cplusplus > 201402L
-bool ThreadSafePoolAllocator::Release( void * place, std::size_t size, std::align_val_t alignment )
+bool AnyThreadSafePoolAllocator< PoolType >::Release( void * place, std::size_t size, std::align_val_t alignment )
 #else
-bool ThreadSafePoolAllocator::Release( void * place, std::size_t size, std::size_t alignment )
+bool AnyThreadSafePoolAllocator< PoolType >::Release( void * place, std::size_t size, std::size_t alignment )
 #endif
 {
 	LockGuard guard( mutex_ );
     assert( guard.owns_lock() );
-	return PoolAllocator::Release( place, size, alignment );
+	return PoolType::Release( place, size, alignment );
+}
+
+// ----------------------------------------------------------------------------
+
+template < class PoolType >
+void AnyThreadSafePoolAllocator< PoolType >::AllocateBulk( void ** places, std::size_t count, std::size_t size, const void * hint )
+{
+	LockGuard guard( mutex_ );
+	assert( guard.owns_lock() );
+	PoolType::AllocateBulk( places, count, size, hint );
 }
 
 // ----------------------------------------------------------------------------
 
-bool ThreadSafePoolAllocator::HasAddress( void * place ) const
+template < class PoolType >
+bool AnyThreadSafePoolAllocator< PoolType >::ReleaseBulk( void ** places, std::size_t count, std::size_t size )
+{
+	LockGuard guard( mutex_ );
+	assert( guard.owns_lock() );
+	return PoolType::ReleaseBulk( places, count, size );
+}
+
+// ----------------------------------------------------------------------------
+
+template < class PoolType >
+bool AnyThreadSafePoolAllocator< PoolType >::HasAddress( void * place ) const
 {
 	LockGuard guard( mutex_ );
     assert( guard.owns_lock() );
-	return PoolAllocator::HasAddress( place );
+	return PoolType::HasAddress( place );
 }
 
 // ----------------------------------------------------------------------------
 
-bool ThreadSafePoolAllocator::TrimEmptyBlocks()
+template < class PoolType >
+bool AnyThreadSafePoolAllocator< PoolType >::TrimEmptyBlocks()
 {
 	LockGuard guard( mutex_ );
     assert( guard.owns_lock() );
-	return PoolAllocator::TrimEmptyBlocks();
+	return PoolType::TrimEmptyBlocks();
 }
 
 // ----------------------------------------------------------------------------
 
-bool ThreadSafePoolAllocator::IsCorrupt() const
+template < class PoolType >
+bool AnyThreadSafePoolAllocator< PoolType >::IsCorrupt() const
 {
 	LockGuard guard( mutex_ );
     assert( guard.owns_lock() );
-	return PoolAllocator::IsCorrupt();
+	return PoolType::IsCorrupt();
 }
 
 // ----------------------------------------------------------------------------
 
-float ThreadSafePoolAllocator::GetFragmentationPercent() const
+template < class PoolType >
+float AnyThreadSafePoolAllocator< PoolType >::GetFragmentationPercent() const
 {
 	LockGuard guard( mutex_ );
     assert( guard.owns_lock() );
-	return PoolAllocator::GetFragmentationPercent();
+	return PoolType::GetFragmentationPercent();
+}
+
+// ----------------------------------------------------------------------------
+
+template class AnyThreadSafePoolAllocator< PoolAllocator >;
+template class AnyThreadSafePoolAllocator< BitmapPoolAllocator >;
+
+// ----------------------------------------------------------------------------
+
+ThreadSafePoolAllocator::ThreadSafePoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+	bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source ) :
+	AnyThreadSafePoolAllocator( initialBlocks, blockSize, objectSize, alignment, alignedBlocks, retainedEmptyBlocks, source )
+{
+}
+
+// ----------------------------------------------------------------------------
+
+ThreadSafePoolAllocator::~ThreadSafePoolAllocator()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+ThreadCachedPoolAllocator::ThreadCachedPoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize,
+	std::size_t alignment, bool alignedBlocks, unsigned int retainedEmptyBlocks, unsigned int magazineSize, BlockSource * source ) :
+	ThreadSafePoolAllocator( initialBlocks, blockSize, objectSize, alignment, alignedBlocks, retainedEmptyBlocks, source ),
+	MagazineOwner( magazineSize )
+{
+}
+
+// ----------------------------------------------------------------------------
+
+ThreadCachedPoolAllocator::~ThreadCachedPoolAllocator()
+{
+	// Must detach before the blocks go away so no thread tries to flush chunks into them.
+	DetachMagazines();
+}
+
+// ----------------------------------------------------------------------------
+
+void ThreadCachedPoolAllocator::Destroy()
+{
+	DetachMagazines();
+	LockGuard guard( mutex_ );
+	PoolAllocator::Destroy();
+}
+
+// ----------------------------------------------------------------------------
+
+void * ThreadCachedPoolAllocator::Allocate( std::size_t size, const void * hint )
+{
+	// The alignment and object size never change after construction, so checking them needs no lock.
+	const std::size_t alignedSize = memwa::impl::CalculateAlignedSize( size, info_.alignment_ );
+	if ( info_.objectSize_ < alignedSize )
+	{
+		throw std::invalid_argument( "Error! Requested size is too large for PoolAllocator." );
+	}
+
+	impl::Magazine * magazine = GetMagazine();
+	if ( !magazine->IsEmpty() )
+	{
+		return magazine->Pop();
+	}
+
+	LockGuard guard( mutex_ );
+	assert( guard.owns_lock() );
+	void * p = PoolAllocator::Allocate( size, hint );
+	// Refill half the magazine so the next several calls from this thread don't need the lock, and the
+	// next few calls to Release won't immediately fill it.
+	const unsigned int refillCount = magazine->capacity_ / 2;
+	try
+	{
+		info_.AllocateBulk( magazine->chunks_, refillCount, p );
+		magazine->count_ = refillCount;
+	}
+	catch ( const std::bad_alloc & )
+	{
+		// Not being able to refill the magazine is not an error since the requested chunk was allocated.
+	}
+	return p;
+}
+
+// ----------------------------------------------------------------------------
+
+#if __cplusplus > 201402L
+void * ThreadCachedPoolAllocator::Allocate( std::size_t size, std::align_val_t alignment, const void * hint )
+#else
+void * ThreadCachedPoolAllocator::Allocate( std::size_t size, std::size_t alignment, const void * hint )
+#endif
+{
+	CheckAllocateAlignment( impl::GetAlignmentSize( alignment ), info_.alignment_ );
+	void * p = ThreadCachedPoolAllocator::Allocate( size, hint );
+	return p;
+}
+
+// ----------------------------------------------------------------------------
+
+bool ThreadCachedPoolAllocator::Release( void * place, std::size_t size )
+{
+	if ( nullptr == place )
+	{
+		return false;
+	}
+	if ( memwa::impl::CalculateAlignedSize( size, info_.alignment_ ) != info_.objectSize_ )
+	{
+		throw std::invalid_argument( "Requested object size does not match pool object size." );
+	}
+	// Checking the owner needs the lock, which the magazine exists to avoid, so only debug builds check it.
+	assert( ThreadSafePoolAllocator::HasAddress( place ) );
+
+	impl::Magazine * magazine = GetMagazine();
+	if ( magazine->IsFull() )
+	{
+		// Return the oldest half of the magazine to the blocks. The newest chunks are most likely
+		// to still be in the cache, so keep those for this thread.
+		const unsigned int flushCount = ( magazine->capacity_ + 1 ) / 2;
+		LockGuard guard( mutex_ );
+		assert( guard.owns_lock() );
+		const bool success = info_.ReleaseBulk( magazine->chunks_, flushCount );
+		assert( success );
+		(void)success;
+		std::copy( magazine->chunks_ + flushCount, magazine->chunks_ + magazine->count_, magazine->chunks_ );
+		magazine->count_ -= flushCount;
+	}
+	magazine->Push( place );
+	return true;
+}
+
+// ----------------------------------------------------------------------------
+
+#if __cplusplus > 201402L
+bool ThreadCachedPoolAllocator::Release( void * place, std::size_t size, std::align_val_t alignment )
+#else
+bool ThreadCachedPoolAllocator::Release( void * place, std::size_t size, std::size_t alignment )
+#endif
+{
+	if ( nullptr == place )
+	{
+		return false;
+	}
+	CheckReleaseAlignment( impl::GetAlignmentSize( alignment ), info_.alignment_ );
+	const bool success = ThreadCachedPoolAllocator::Release( place, size );
+	return success;
+}
+
+// ----------------------------------------------------------------------------
+
+void ThreadCachedPoolAllocator::AllocateBulk( void ** places, std::size_t count, std::size_t size, const void * hint )
+{
+	const std::size_t alignedSize = memwa::impl::CalculateAlignedSize( size, info_.alignment_ );
+	if ( info_.objectSize_ < alignedSize )
+	{
+		throw std::invalid_argument( "Error! Requested size is too large for PoolAllocator." );
+	}
+
+	impl::Magazine * magazine = GetMagazine();
+	std::size_t filled = 0;
+	while ( ( filled < count ) && !magazine->IsEmpty() )
+	{
+		places[ filled++ ] = magazine->Pop();
+	}
+	if ( filled == count )
+	{
+		return;
+	}
+
+	LockGuard guard( mutex_ );
+	assert( guard.owns_lock() );
+	try
+	{
+		PoolAllocator::AllocateBulk( places + filled, count - filled, size, hint );
+	}
+	catch ( ... )
+	{
+		// Put the chunks back so none are lost when this throws.
+		while ( 0 < filled )
+		{
+			magazine->Push( places[ --filled ] );
+		}
+		throw;
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+bool ThreadCachedPoolAllocator::ReleaseBulk( void ** places, std::size_t count, std::size_t size )
+{
+	if ( memwa::impl::CalculateAlignedSize( size, info_.alignment_ ) != info_.objectSize_ )
+	{
+		throw std::invalid_argument( "Requested object size does not match pool object size." );
+	}
+
+	bool allReleased = true;
+	impl::Magazine * magazine = GetMagazine();
+	std::size_t ii = 0;
+	for ( ; ( ii < count ) && !magazine->IsFull(); ++ii )
+	{
+		void * place = places[ ii ];
+		if ( nullptr == place )
+		{
+			allReleased = false;
+			continue;
+		}
+		assert( ThreadSafePoolAllocator::HasAddress( place ) );
+		magazine->Push( place );
+	}
+	if ( ii == count )
+	{
+		return allReleased;
+	}
+
+	LockGuard guard( mutex_ );
+	assert( guard.owns_lock() );
+	if ( !info_.ReleaseBulk( places + ii, count - ii ) )
+	{
+		allReleased = false;
+	}
+	return allReleased;
+}
+
+// ----------------------------------------------------------------------------
+
+bool ThreadCachedPoolAllocator::TrimEmptyBlocks()
+{
+	FlushThreadMagazine();
+	return ThreadSafePoolAllocator::TrimEmptyBlocks();
+}
+
+// ----------------------------------------------------------------------------
+
+void ThreadCachedPoolAllocator::FlushMagazine( impl::Magazine & magazine )
+{
+	LockGuard guard( mutex_ );
+	assert( guard.owns_lock() );
+	const bool success = info_.ReleaseBulk( magazine.chunks_, magazine.count_ );
+	assert( success );
+	(void)success;
+	magazine.count_ = 0;
+}
+
+// ----------------------------------------------------------------------------
+
+LockFreePoolAllocator::LockFreePoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+	bool alignedBlocks, BlockSource * source ) :
+	ThreadSafePoolAllocator( initialBlocks, blockSize, objectSize, alignment, alignedBlocks, 0, source ),
+	head_( 0 )
+{
+	// The initial blocks stay empty until the first Allocate takes a batch of chunks from them.
+}
+
+// ----------------------------------------------------------------------------
+
+LockFreePoolAllocator::~LockFreePoolAllocator()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+void LockFreePoolAllocator::Destroy()
+{
+	LockGuard guard( mutex_ );
+	PoolAllocator::Destroy();
+	head_.store( 0 );
+}
+
+// ----------------------------------------------------------------------------
+
+void * LockFreePoolAllocator::PopChunk()
+{
+	std::uint64_t head = head_.load( std::memory_order_acquire );
+	for ( ;; )
+	{
+		void * chunk = reinterpret_cast< void * >( static_cast< std::uintptr_t >( head & AddressMask ) );
+		if ( nullptr == chunk )
+		{
+			return nullptr;
+		}
+		// Another thread may pop this chunk and write into it before this reads the link. Blocks are
+		// never released while the allocator exists, so the read is safe, and the changed tag makes
+		// the exchange below fail if that happened.
+		const std::uintptr_t next = GetNextLink( chunk ).load( std::memory_order_relaxed );
+		const std::uint64_t newHead = ( ( head & ~AddressMask ) + TagIncrement ) | next;
+		if ( head_.compare_exchange_weak( head, newHead, std::memory_order_acquire, std::memory_order_acquire ) )
+		{
+			return chunk;
+		}
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+void LockFreePoolAllocator::PushChunks( void * first, void * last )
+{
+	assert( nullptr != first );
+	assert( nullptr != last );
+	std::uint64_t head = head_.load( std::memory_order_relaxed );
+	std::uint64_t newHead;
+	do
+	{
+		GetNextLink( last ).store( static_cast< std::uintptr_t >( head & AddressMask ), std::memory_order_relaxed );
+		newHead = ( head & ~AddressMask ) | reinterpret_cast< std::uintptr_t >( first );
+	}
+	while ( !head_.compare_exchange_weak( head, newHead, std::memory_order_release, std::memory_order_relaxed ) );
+}
+
+// ----------------------------------------------------------------------------
+
+void * LockFreePoolAllocator::TakeBlockChunks()
+{
+	// Take only a batch so blocks are still carved lazily, and a refill only touches the chunks it hands out.
+	void * places[ RefillChunks ];
+	const std::size_t objectsPerPool = PoolBlock::GetObjectsPerBlock( info_.blockSize_, info_.objectSize_ );
+	const std::size_t count = std::min( RefillChunks, objectsPerPool );
+	info_.AllocateBulk( places, count, nullptr );
+	for ( std::size_t ii = 0; ii < count; ++ii )
+	{
+		if ( ( reinterpret_cast< std::uintptr_t >( places[ ii ] ) & ~AddressMask ) != 0 )
+		{
+			// A block was placed at an address too high to share the head with a tag.
+			const bool released = info_.ReleaseBulk( places, count );
+			assert( released );
+			(void)released;
+			throw std::bad_alloc();
+		}
+	}
+	for ( std::size_t ii = 2; ii < count; ++ii )
+	{
+		GetNextLink( places[ ii - 1 ] ).store( reinterpret_cast< std::uintptr_t >( places[ ii ] ), std::memory_order_relaxed );
+	}
+	if ( 1 < count )
+	{
+		PushChunks( places[ 1 ], places[ count - 1 ] );
+	}
+	return places[ 0 ];
+}
+
+// ----------------------------------------------------------------------------
+
+void * LockFreePoolAllocator::Allocate( std::size_t size, const void * hint )
+{
+	const std::size_t alignedSize = memwa::impl::CalculateAlignedSize( size, info_.alignment_ );
+	if ( info_.objectSize_ < alignedSize )
+	{
+		throw std::invalid_argument( "Error! Requested size is too large for PoolAllocator." );
+	}
+
+	void * p = PopChunk();
+	if ( nullptr != p )
+	{
+		return p;
+	}
+
+	LockGuard guard( mutex_ );
+	assert( guard.owns_lock() );
+	// Another thread may have made a block while this one waited for the lock.
+	p = PopChunk();
+	if ( nullptr != p )
+	{
+		return p;
+	}
+	try
+	{
+		p = TakeBlockChunks();
+	}
+	catch ( const std::bad_alloc & )
+	{
+		memwa::impl::ManagerImpl::GetManager()->TrimEmptyBlocks( this );
+		p = TakeBlockChunks();
+	}
+	return p;
+}
+
+// ----------------------------------------------------------------------------
+
+#if __cplusplus > 201402L
+void * LockFreePoolAllocator::Allocate( std::size_t size, std::align_val_t alignment, const void * hint )
+#else
+void * LockFreePoolAllocator::Allocate( std::size_t size, std::size_t alignment, const void * hint )
+#endif
+{
+	CheckAllocateAlignment( impl::GetAlignmentSize( alignment ), info_.alignment_ );
+	void * p = LockFreePoolAllocator::Allocate( size, hint );
+	return p;
+}
+
+// ----------------------------------------------------------------------------
+
+bool LockFreePoolAllocator::Release( void * place, std::size_t size )
+{
+	if ( nullptr == place )
+	{
+		return false;
+	}
+	if ( memwa::impl::CalculateAlignedSize( size, info_.alignment_ ) != info_.objectSize_ )
+	{
+		throw std::invalid_argument( "Requested object size does not match pool object size." );
+	}
+	// Checking the owner needs the lock, which the free stack exists to avoid, so only debug builds check it.
+	assert( ThreadSafePoolAllocator::HasAddress( place ) );
+	PushChunks( place, place );
+	return true;
+}
+
+// ----------------------------------------------------------------------------
+
+#if __cplusplus > 201402L
+bool LockFreePoolAllocator::Release( void * place, std::size_t size, std::align_val_t alignment )
+#else
+bool LockFreePoolAllocator::Release( void * place, std::size_t size, std::size_t alignment )
+#endif
+{
+	if ( nullptr == place )
+	{
+		return false;
+	}
+	CheckReleaseAlignment( impl::GetAlignmentSize( alignment ), info_.alignment_ );
+	const bool success = LockFreePoolAllocator::Release( place, size );
+	return success;
+}
+
+// ----------------------------------------------------------------------------
+
+void LockFreePoolAllocator::AllocateBulk( void ** places, std::size_t count, std::size_t size, const void * hint )
+{
+	// Each pop is already lock-free, so just pop them one at a time instead of locking.
+	Allocator::AllocateBulk( places, count, size, hint );
+}
+
+// ----------------------------------------------------------------------------
+
+bool LockFreePoolAllocator::ReleaseBulk( void ** places, std::size_t count, std::size_t size )
+{
+	if ( memwa::impl::CalculateAlignedSize( size, info_.alignment_ ) != info_.objectSize_ )
+	{
+		throw std::invalid_argument( "Requested object size does not match pool object size." );
+	}
+
+	bool allReleased = true;
+	void * first = nullptr;
+	void * last = nullptr;
+	for ( std::size_t ii = 0; ii < count; ++ii )
+	{
+		void * place = places[ ii ];
+		if ( nullptr == place )
+		{
+			allReleased = false;
+			continue;
+		}
+		assert( ThreadSafePoolAllocator::HasAddress( place ) );
+		if ( nullptr == first )
+		{
+			first = place;
+		}
+		else
+		{
+			GetNextLink( last ).store( reinterpret_cast< std::uintptr_t >( place ), std::memory_order_relaxed );
+		}
+		last = place;
+	}
+	if ( nullptr != first )
+	{
+		PushChunks( first, last );
+	}
+	return allReleased;
+}
+
+// ----------------------------------------------------------------------------
+
+bool LockFreePoolAllocator::TrimEmptyBlocks()
+{
+	// No chunk of an empty block was ever pushed onto the free stack, so no other thread can read it.
+	return ThreadSafePoolAllocator::TrimEmptyBlocks();
+}
+
+// ----------------------------------------------------------------------------
+
+RemoteFreePoolAllocator::Heap::Heap( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+	std::size_t blockAlignment, unsigned int retainedEmptyBlocks, BlockSource * source ) :
+	info_( initialBlocks, blockSize, objectSize, alignment, blockAlignment, retainedEmptyBlocks, source ),
+	remote_( nullptr ),
+	owned_( false )
+{
+}
+
+// ----------------------------------------------------------------------------
+
+RemoteFreePoolAllocator::RemoteFreePoolAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize,
+	std::size_t alignment, unsigned int retainedEmptyBlocks, BlockSource * source ) :
+	Allocator(),
+	MagazineOwner( 0 ),
+	blockSize_( blockSize ),
+	objectSize_( objectSize ),
+	alignment_( alignment ),
+	blockAlignment_( impl::CalculateBlockAlignment( blockSize ) ),
+	retainedEmptyBlocks_( retainedEmptyBlocks ),
+	source_( source ),
+	mutex_(),
+	heaps_(),
+	addressMutex_(),
+	addresses_()
+{
+	// The initial blocks go into a heap no thread owns yet, so the first thread to allocate gets them.
+	Heap * heap = new Heap( initialBlocks, blockSize_, objectSize_, alignment_, blockAlignment_, retainedEmptyBlocks_, source_ );
+	try
+	{
+		heaps_.push_back( heap );
+	}
+	catch ( ... )
+	{
+		heap->info_.Destroy();
+		delete heap;
+		throw;
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+RemoteFreePoolAllocator::~RemoteFreePoolAllocator()
+{
+	// Must detach before the heaps go away so no exiting thread tries to give up a heap.
+	DetachMagazines();
+	const HeapsIter end( heaps_.end() );
+	for ( HeapsIter it( heaps_.begin() ); it != end; ++it )
+	{
+		delete *it;
+	}
+	heaps_.clear();
+}
+
+// ----------------------------------------------------------------------------
+
+void RemoteFreePoolAllocator::Destroy()
+{
+	DetachMagazines();
+	LockGuard guard( mutex_ );
+	const HeapsIter end( heaps_.end() );
+	for ( HeapsIter it( heaps_.begin() ); it != end; ++it )
+	{
+		Heap * heap = *it;
+		heap->info_.Destroy();
+		heap->remote_.store( nullptr );
+	}
+	LockGuard addressGuard( addressMutex_ );
+	addresses_.clear();
+}
+
+// ----------------------------------------------------------------------------
+
+RemoteFreePoolAllocator::Heap * RemoteFreePoolAllocator::FindThreadHeap()
+{
+	impl::Magazine * magazine = GetMagazine();
+	return static_cast< Heap * >( magazine->state_ );
+}
+
+// ----------------------------------------------------------------------------
+
+RemoteFreePoolAllocator::Heap * RemoteFreePoolAllocator::GetThreadHeap()
+{
+	impl::Magazine * magazine = GetMagazine();
+	Heap * heap = static_cast< Heap * >( magazine->state_ );
+	if ( nullptr != heap )
+	{
+		return heap;
+	}
+
+	LockGuard guard( mutex_ );
+	assert( guard.owns_lock() );
+	// Take over blocks of an exited thread before making a new heap.
+	const HeapsIter end( heaps_.end() );
+	for ( HeapsIter it( heaps_.begin() ); it != end; ++it )
+	{
+		if ( !( *it )->owned_ )
+		{
+			heap = *it;
+			break;
+		}
+	}
+	if ( nullptr == heap )
+	{
+		heaps_.reserve( heaps_.size() + 1 );
+		heap = new Heap( 0, blockSize_, objectSize_, alignment_, blockAlignment_, retainedEmptyBlocks_, source_ );
+		heaps_.push_back( heap );
+	}
+	heap->owned_ = true;
+	magazine->state_ = heap;
+	return heap;
+}
+
+// ----------------------------------------------------------------------------
+
+void RemoteFreePoolAllocator::FlushMagazine( impl::Magazine & magazine )
+{
+	Heap * heap = static_cast< Heap * >( magazine.state_ );
+	if ( nullptr == heap )
+	{
+		return;
+	}
+	LockGuard guard( mutex_ );
+	assert( guard.owns_lock() );
+	heap->owned_ = false;
+	magazine.state_ = nullptr;
+}
+
+// ----------------------------------------------------------------------------
+
+void RemoteFreePoolAllocator::PushRemoteChunk( Heap & heap, void * place )
+{
+	void * head = heap.remote_.load( std::memory_order_relaxed );
+	do
+	{
+		GetNextLink( place ).store( reinterpret_cast< std::uintptr_t >( head ), std::memory_order_relaxed );
+	}
+	while ( !heap.remote_.compare_exchange_weak( head, place, std::memory_order_release, std::memory_order_relaxed ) );
+}
+
+// ----------------------------------------------------------------------------
+
+void RemoteFreePoolAllocator::TakeRemoteChunks( Heap & heap )
+{
+	// Only the owner takes chunks, and it takes the whole list at once, so a plain exchange has no ABA problem.
+	void * chunk = heap.remote_.exchange( nullptr, std::memory_order_acquire );
+	while ( nullptr != chunk )
+	{
+		void * next = reinterpret_cast< void * >( GetNextLink( chunk ).load( std::memory_order_relaxed ) );
+		const bool success = ReleaseToHeap( heap, chunk );
+		assert( success );
+		(void)success;
+		chunk = next;
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+void * RemoteFreePoolAllocator::AllocateFromHeap( Heap & heap, const void * hint )
+{
+	if ( ( nullptr != heap.remote_.load( std::memory_order_relaxed ) ) && !heap.info_.HasFreeChunk() )
+	{
+		TakeRemoteChunks( heap );
+	}
+
+	void * p = heap.info_.Allocate( hint );
+	assert( nullptr != p );
+	if ( p != GetBlockStart( p ) )
+	{
+		return p;
+	}
+
+	// The block was empty, so its first chunk becomes the pointer other threads use to find this heap.
+	*reinterpret_cast< Heap ** >( p ) = &heap;
+	try
+	{
+		LockGuard guard( addressMutex_ );
+		addresses_.insert( reinterpret_cast< std::uintptr_t >( p ) );
+	}
+	catch ( ... )
+	{
+		heap.info_.Release( p );
+		throw std::bad_alloc();
+	}
+	// The block has at least two chunks, so this allocates from the same block.
+	void * chunk = heap.info_.Allocate( p );
+	assert( nullptr != chunk );
+	assert( GetBlockStart( chunk ) == p );
+	return chunk;
+}
+
+// ----------------------------------------------------------------------------
+
+bool RemoteFreePoolAllocator::ReleaseToHeap( Heap & heap, void * place )
+{
+	if ( !heap.info_.Release( place ) )
+	{
+		return false;
+	}
+	void * start = GetBlockStart( place );
+	const PoolBlockInfo::BlocksIter it( heap.info_.GetBlock( start ) );
+	assert( it != heap.info_.blocks_.end() );
+	if ( 1 == it->GetInUseCount() )
+	{
+		// Only the first chunk is still in use, so no other thread can look for this heap through it.
+		{
+			LockGuard guard( addressMutex_ );
+			addresses_.erase( reinterpret_cast< std::uintptr_t >( start ) );
+		}
+		heap.info_.Release( start );
+	}
+	return true;
+}
+
+// ----------------------------------------------------------------------------
+
+void * RemoteFreePoolAllocator::Allocate( std::size_t size, const void * hint )
+{
+	const std::size_t alignedSize = memwa::impl::CalculateAlignedSize( size, alignment_ );
+	if ( objectSize_ < alignedSize )
+	{
+		throw std::invalid_argument( "Error! Requested size is too large for PoolAllocator." );
+	}
+
+	Heap * heap = GetThreadHeap();
+	void * p = nullptr;
+	try
+	{
+		p = AllocateFromHeap( *heap, hint );
+	}
+	catch ( const std::bad_alloc & )
+	{
+		memwa::impl::ManagerImpl::GetManager()->TrimEmptyBlocks( this );
+		p = AllocateFromHeap( *heap, hint );
+	}
+	return p;
+}
+
+// ----------------------------------------------------------------------------
+
+#if __cplusplus > 201402L
+void * RemoteFreePoolAllocator::Allocate( std::size_t size, std::align_val_t alignment, const void * hint )
+#else
+void * RemoteFreePoolAllocator::Allocate( std::size_t size, std::size_t alignment, const void * hint )
+#endif
+{
+	CheckAllocateAlignment( impl::GetAlignmentSize( alignment ), alignment_ );
+	void * p = RemoteFreePoolAllocator::Allocate( size, hint );
+	return p;
+}
+
+// ----------------------------------------------------------------------------
+
+bool RemoteFreePoolAllocator::Release( void * place, std::size_t size )
+{
+	if ( nullptr == place )
+	{
+		return false;
+	}
+	if ( memwa::impl::CalculateAlignedSize( size, alignment_ ) != objectSize_ )
+	{
+		throw std::invalid_argument( "Requested object size does not match pool object size." );
+	}
+	void * start = GetBlockStart( place );
+	if ( place == start )
+	{
+		// The first chunk of a block is never handed out.
+		return false;
+	}
+	Heap * owner = *reinterpret_cast< Heap ** >( start );
+	if ( owner == FindThreadHeap() )
+	{
+		const bool success = ReleaseToHeap( *owner, place );
+		return success;
+	}
+	PushRemoteChunk( *owner, place );
+	return true;
+}
+
+// ----------------------------------------------------------------------------
+
+#if __cplusplus > 201402L
+bool RemoteFreePoolAllocator::Release( void * place, std::size_t size, std::align_val_t alignment )
+#else
+bool RemoteFreePoolAllocator::Release( void * place, std::size_t size, std::size_t alignment )
+#endif
+{
+	if ( nullptr == place )
+	{
+		return false;
+	}
+	CheckReleaseAlignment( impl::GetAlignmentSize( alignment ), alignment_ );
+	const bool success = RemoteFreePoolAllocator::Release( place, size );
+	return success;
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned long long RemoteFreePoolAllocator::GetMaxSize( std::size_t objectSize ) const
+{
+	const unsigned long long bytesAvailable = memwa::impl::GetTotalAvailableMemory();
+	const unsigned long long maxPossibleObjects = bytesAvailable / objectSize;
+	return maxPossibleObjects;
+}
+
+// ----------------------------------------------------------------------------
+
+bool RemoteFreePoolAllocator::HasAddress( void * place ) const
+{
+	const unsigned char * start = reinterpret_cast< const unsigned char * >( GetBlockStart( place ) );
+	const unsigned char * p = reinterpret_cast< const unsigned char * >( place );
+	if ( ( p == start ) || ( start + blockSize_ <= p ) )
+	{
+		return false;
+	}
+	LockGuard guard( addressMutex_ );
+	assert( guard.owns_lock() );
+	const bool hasIt = ( addresses_.find( reinterpret_cast< std::uintptr_t >( start ) ) != addresses_.end() );
+	return hasIt;
+}
+
+// ----------------------------------------------------------------------------
+
+bool RemoteFreePoolAllocator::TrimEmptyBlocks()
+{
+	bool trimmed = false;
+	Heap * mine = FindThreadHeap();
+	if ( nullptr != mine )
+	{
+		TakeRemoteChunks( *mine );
+		trimmed = mine->info_.TrimEmptyBlocks();
+	}
+
+	LockGuard guard( mutex_ );
+	assert( guard.owns_lock() );
+	const HeapsIter end( heaps_.end() );
+	for ( HeapsIter it( heaps_.begin() ); it != end; ++it )
+	{
+		Heap * heap = *it;
+		if ( !heap->owned_ )
+		{
+			TakeRemoteChunks( *heap );
+			if ( heap->info_.TrimEmptyBlocks() )
+			{
+				trimmed = true;
+			}
+		}
+	}
+	return trimmed;
+}
+
+// ----------------------------------------------------------------------------
+
+bool RemoteFreePoolAllocator::IsCorrupt() const
+{
+	assert( nullptr != this );
+	RemoteFreePoolAllocator * pThis = const_cast< RemoteFreePoolAllocator * >( this );
+	const Heap * mine = pThis->FindThreadHeap();
+	LockGuard guard( mutex_ );
+	assert( guard.owns_lock() );
+	const HeapsCIter end( heaps_.end() );
+	for ( HeapsCIter it( heaps_.begin() ); it != end; ++it )
+	{
+		const Heap * heap = *it;
+		if ( ( heap == mine ) || !heap->owned_ )
+		{
+			assert( !heap->info_.IsCorrupt() );
+		}
+	}
+	return false;
+}
+
+// ----------------------------------------------------------------------------
+
+float RemoteFreePoolAllocator::GetFragmentationPercent() const
+{
+	RemoteFreePoolAllocator * pThis = const_cast< RemoteFreePoolAllocator * >( this );
+	const Heap * mine = pThis->FindThreadHeap();
+	unsigned int poolCount = 0;
+	unsigned int objectCount = 0;
+	LockGuard guard( mutex_ );
+	assert( guard.owns_lock() );
+	const HeapsCIter end( heaps_.end() );
+	for ( HeapsCIter it( heaps_.begin() ); it != end; ++it )
+	{
+		const Heap * heap = *it;
+		if ( ( heap != mine ) && heap->owned_ )
+		{
+			continue;
+		}
+		poolCount += heap->info_.blocks_.size();
+		const PoolBlockInfo::BlocksCIter blocksEnd( heap->info_.blocks_.end() );
+		for ( PoolBlockInfo::BlocksCIter bit( heap->info_.blocks_.begin() ); bit != blocksEnd; ++bit )
+		{
+			objectCount += bit->GetInUseCount();
+		}
+	}
+
+	const unsigned int objectsPerPool = PoolBlock::GetObjectsPerBlock( blockSize_, objectSize_ );
+	const float percent = CalculateExcessBlocks( poolCount, objectCount, objectsPerPool );
+	return percent;
 }
 
 // ----------------------------------------------------------------------------
@@ -13,103 +13,31 @@ namespace memwa
 
 // ----------------------------------------------------------------------------
 
-PoolBlock::PoolBlock( std::size_t blockSize, std::size_t alignedSize, std::size_t alignment, unsigned int objectsPerPool ) :
-	block_( reinterpret_cast< std::size_t * >( std::malloc( blockSize ) ) ),
-	free_( block_ ),
-	objectCount_( 0 )
+PoolBlock::PoolBlock( std::size_t blockSize, std::size_t alignedSize, std::size_t alignment, unsigned int objectsPerPool,
+	std::size_t blockAlignment, BlockSource * source ) :
+	impl::HotPoolBlock( reinterpret_cast< std::size_t * >( impl::AllocateBlock( blockSize, blockAlignment, source ) ), objectsPerPool )
 {
 
 	if ( nullptr == block_ )
 	{
 		throw std::bad_alloc();
 	}
-    std::size_t blockPlace = reinterpret_cast< std::size_t >( block_ );
-    assert( blockPlace % alignment == 0 );
-
-	std::size_t * place;
-	const unsigned char * const end = reinterpret_cast< unsigned char * >( block_ ) + blockSize;
-	unsigned char * here = reinterpret_cast< unsigned char * >( free_ );
-	unsigned char * next = here + alignedSize;
-
-	while ( next < end )
-	{
-		assert( here < end );
-		assert( next < end );
-		place = reinterpret_cast< std::size_t * >( here );
-		*place = reinterpret_cast< std::size_t >( next );
-/*
-		std::cout << '\t' << ii << '\t' << reinterpret_cast< std::size_t >( here )
-			<< '\t' << *place << '\t' << reinterpret_cast< std::size_t >( next ) << std::endl;
-*/
-		here = next;
-		next += alignedSize;
-//		++ii;
-	}
-	assert( here < end );
-	assert( next == end );
-	place = reinterpret_cast< std::size_t * >( here );
-	*place = 0;
-/*
-	std::cout << "\t here: [" << reinterpret_cast< std::size_t >( here )
-		<< "]  *here: [" << *place
-		<< "]  next: [" << reinterpret_cast< std::size_t >( next ) << ']' << std::endl;
-*/
+	std::size_t blockPlace = reinterpret_cast< std::size_t >( block_ );
+	assert( blockPlace % alignment == 0 );
+	assert( objectsPerPool * alignedSize == blockSize );
+	(void)blockPlace;
 }
 
 // ----------------------------------------------------------------------------
 
-void PoolBlock::Destroy()
+void PoolBlock::Destroy( std::size_t blockSize, std::size_t blockAlignment, BlockSource * source )
 {
-    ::free( reinterpret_cast< void * >( block_ ) );
+    impl::ReleaseBlock( block_, blockSize, blockAlignment, source );
 	block_ = nullptr;
 	free_ = nullptr;
-}
-
-// ----------------------------------------------------------------------------
-
-void * PoolBlock::Allocate()
-{
-	assert( block_ != nullptr );
-	if ( IsFull() )
-	{
-		return nullptr;
-	}
-	void * p = free_;
-	std::size_t * place = reinterpret_cast< std::size_t * >( *free_ );
-	free_ = place;
-	++objectCount_;
-	return p;
-}
-
-// ----------------------------------------------------------------------------
-
-bool PoolBlock::Release( void * place )
-{
-	assert( block_ != nullptr );
-	assert( place != nullptr );
-	std::size_t * p = reinterpret_cast< std::size_t * >( place );
-	*p = reinterpret_cast< std::size_t >( free_ );
-	free_ = p;
-	--objectCount_;
-	return true;
-}
-
-// ----------------------------------------------------------------------------
-
-bool PoolBlock::HasAddress( const void * place, std::size_t blockSize ) const
-{
-	assert( block_ != nullptr );
-	if ( place < block_ )
-	{
-		return false;
-	}
-	const unsigned char * const b = reinterpret_cast< const unsigned char * >( block_ );
-	const unsigned char * const p = reinterpret_cast< const unsigned char * >( place );
-	if ( b + blockSize <= p )
-	{
-		return false;
-	}
-	return true;
+	unused_ = nullptr;
+	unusedCount_ = 0;
+	listPosition_ = NotListed;
 }
 
 // ----------------------------------------------------------------------------
@@ -131,35 +59,35 @@ bool PoolBlock::IsCorrupt( std::size_t blockSize, std::size_t alignment, std::si
 	assert( block_ != nullptr );
 	const unsigned int objectsPerPool = blockSize / objectSize;
 	assert( objectsPerPool * objectSize == blockSize );
-	if ( free_ == nullptr )
-	{
-		assert( objectCount_ != 0 );
-		assert( objectsPerPool == objectCount_ );
-	}
-	else
+	assert( objectCount_ + unusedCount_ <= objectsPerPool );
+
+	// Chunks below unused_ were allocated at least once, and chunks at or above it never were.
+	const unsigned char * const start = reinterpret_cast< const unsigned char * >( block_ );
+	(void)start; // Only used by assertions.
+	assert( start <= unused_ );
+	assert( unused_ + unusedCount_ * objectSize == start + blockSize );
+
+	// Every chunk in free list must be unique and within the part of the block that was used.
+	std::size_t * next = free_;
+	unsigned int freeCount = 0;
+	const unsigned int maxFreeCount = ( objectsPerPool - objectCount_ - unusedCount_ );
+	(void)maxFreeCount; // Only used by assertions.
+	while ( next != nullptr )
 	{
-		assert( objectsPerPool > objectCount_ );
-		assert( free_ >= block_ );
-		assert( free_ < block_ + blockSize );
-		std::size_t * next = free_;
-		bool checkedFirst = false;
-		unsigned int freeCount = 0;
-		unsigned int maxFreeCount = ( objectsPerPool - objectCount_ );
-		while ( next != nullptr )
+		const unsigned char * const here = reinterpret_cast< const unsigned char * >( next );
+		(void)here; // Only used by assertions.
+		assert( here >= start );
+		assert( here < unused_ );
+		assert( ( here - start ) % objectSize == 0 );
+		if ( 0 < freeCount )
 		{
-			assert( next >= block_ );
-			assert( next < block_ + blockSize );
-			if ( checkedFirst )
-			{
-				assert( next != free_ );
-			}
-			next = reinterpret_cast< std::size_t * >( *next );
-			checkedFirst = true;
-			++freeCount;
-			assert( freeCount <= maxFreeCount );
+			assert( next != free_ );
 		}
-		assert( freeCount == maxFreeCount );
+		next = reinterpret_cast< std::size_t * >( *next );
+		++freeCount;
+		assert( freeCount <= maxFreeCount );
 	}
+	assert( freeCount == maxFreeCount );
 	return false;
 }
 
@@ -1,26 +1,33 @@
 
 #pragma once
 
+#include "HotBlock.hpp"
+
 #include <cstddef> // For std::size_t.
 
 namespace memwa
 {
 
+class BlockSource;
+
 // ----------------------------------------------------------------------------
 
-class PoolBlock
+/** @class PoolBlock
+ Subdivides a block into chunks of the same size. Chunks that were never handed out are allocated by
+ bumping a pointer through the untouched part of the block, so making a block does not write to every
+ chunk, and pages that are never used are never touched. Released chunks form an intrusive singly
+ linked list, and are reused before any untouched chunks. The fields and the constant time functions
+ are in impl::HotPoolBlock, so PoolAllocator can inline them.
+ */
+class PoolBlock : public impl::HotPoolBlock
 {
 public:
 
-    PoolBlock( std::size_t blockSize, std::size_t alignedSize, std::size_t alignment, unsigned int objectsPerPool );
-
-	void Destroy();
-
-	void * Allocate();
-
-	bool Release( void * place );
+    PoolBlock( std::size_t blockSize, std::size_t alignedSize, std::size_t alignment, unsigned int objectsPerPool,
+		std::size_t blockAlignment = 0, BlockSource * source = nullptr );
 
-	bool HasAddress( const void * place, std::size_t blockSize ) const;
+	/// Releases the block. Parameters must be the same ones passed to the constructor.
+	void Destroy( std::size_t blockSize = 0, std::size_t blockAlignment = 0, BlockSource * source = nullptr );
 
 	bool IsBelowAddress( const void * place, std::size_t blockSize ) const;
 
@@ -29,42 +36,14 @@ public:
 		return ( block_ < that.block_ );
 	}
 
-	bool IsEmpty() const
-	{
-		return ( 0 == objectCount_ );
-	}
-
-	bool IsFull() const
-	{
-		return ( free_ == nullptr );
-	}
-
-	unsigned int GetInUseCount() const
-	{
-		return objectCount_;
-	}
-
 #ifdef DEBUGGING_ALLOCATORS
 
 	void OutputContents() const;
 
 #endif
 
-	std::size_t * GetAddress() const
-	{
-		return block_;
-	}
-
 	bool IsCorrupt( std::size_t blockSize, std::size_t alignment, std::size_t objectSize ) const;
 
-private:
-
-	/// Pointer to block allocated to hold from 1 to N objects.
-	std::size_t * block_;
-	/// Pointer to next free chunk in pool.
-	std::size_t * free_;
-	/// Number of objects allocated so far.
-	unsigned int objectCount_;
 };
 
 // ----------------------------------------------------------------------------
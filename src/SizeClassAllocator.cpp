@@ -0,0 +1,339 @@
+#include "SizeClassAllocator.hpp"
+
+#include "TinyBlock.hpp"
+#include "ManagerImpl.hpp"
+
+#include <cassert>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace memwa
+{
+
+namespace
+{
+
+// ----------------------------------------------------------------------------
+
+/// Size of each class. Four classes per doubling above 64 bytes keep wasted space under 25%.
+constexpr std::size_t SizeClasses[ SizeClassAllocator::ClassCount ] =
+{
+	8, 16, 24, 32, 40, 48, 56, 64,
+	80, 96, 112, 128, 160, 192, 224, 256,
+	320, 384, 448, 512, 640, 768, 896, 1024,
+	1280, 1536, 1792, 2048, 2560, 3072, 3584, 4096,
+};
+
+/// Every size class is a multiple of this, so the lookup table needs one entry per this many bytes.
+constexpr std::size_t ClassGranularity = 8;
+
+/// Number of entries in lookup table.
+constexpr std::size_t LookupCount = SizeClassAllocator::MaxObjectSize / ClassGranularity + 1;
+
+/** Table built at compile time which maps ( size + 7 ) / 8 to index of the smallest size class which
+ can hold size bytes, so finding the class for a size is one shift and one load.
+ */
+struct ClassLookup
+{
+	constexpr ClassLookup() : index_()
+	{
+		std::size_t classIndex = 0;
+		for ( std::size_t ii = 0; ii < LookupCount; ++ii )
+		{
+			while ( SizeClasses[ classIndex ] < ii * ClassGranularity )
+			{
+				++classIndex;
+			}
+			index_[ ii ] = static_cast< unsigned char >( classIndex );
+		}
+	}
+
+	unsigned char index_[ LookupCount ];
+};
+
+constexpr ClassLookup Lookup;
+
+static_assert( SizeClasses[ SizeClassAllocator::ClassCount - 1 ] == SizeClassAllocator::MaxObjectSize,
+	"Largest size class must be MaxObjectSize." );
+static_assert( SizeClassAllocator::MaxTinyClassSize <= TinyBlock::MaxObjectSize,
+	"Tiny size classes must fit within a TinyBlock." );
+
+// ----------------------------------------------------------------------------
+
+} // end anonymous namespace
+
+// ----------------------------------------------------------------------------
+
+std::size_t SizeClassAllocator::GetClassIndex( std::size_t size )
+{
+	if ( MaxObjectSize < size )
+	{
+		throw std::invalid_argument( "Error! Requested size is too large for SizeClassAllocator." );
+	}
+	return Lookup.index_[ ( size + ClassGranularity - 1 ) / ClassGranularity ];
+}
+
+// ----------------------------------------------------------------------------
+
+std::size_t SizeClassAllocator::GetClassSize( std::size_t size )
+{
+	return SizeClasses[ GetClassIndex( size ) ];
+}
+
+// ----------------------------------------------------------------------------
+
+SizeClassAllocator::SizeClassAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment, bool alignedBlocks,
+	unsigned int retainedEmptyBlocks, bool wideTinyBlocks, BlockSource * source ) :
+	Allocator(),
+	classes_(),
+	alignment_( alignment )
+{
+	/* The manager trims each class's allocator directly, so it should not also reach them through
+	 this. Otherwise a thread-safe class allocator which runs out of memory while holding its lock
+	 would ask the manager to trim, and the manager would call back into that same allocator.
+	 */
+	impl::ManagerImpl::GetManager()->RemoveAllocator( this );
+
+	AllocatorManager::AllocatorParameters info;
+	info.initialBlocks = initialBlocks;
+	info.alignedBlocks = alignedBlocks;
+	info.retainedEmptyBlocks = retainedEmptyBlocks;
+	info.blockSource = source;
+	try
+	{
+		for ( std::size_t ii = 0; ii < ClassCount; ++ii )
+		{
+			const std::size_t classSize = SizeClasses[ ii ];
+			info.objectSize = classSize;
+			if ( classSize <= MaxTinyClassSize )
+			{
+				info.type = AllocatorManager::AllocatorType::Tiny;
+				info.alignment = static_cast< decltype( info.alignment ) >( alignment );
+				info.blockSize = blockSize;
+				info.wideTinyBlocks = wideTinyBlocks;
+			}
+			else
+			{
+				// Pool chunks hold a pointer while they are free, so they need at least pointer alignment.
+				info.type = AllocatorManager::AllocatorType::Pool;
+				const std::size_t classAlignment = std::max( alignment, sizeof(void *) );
+				info.alignment = static_cast< decltype( info.alignment ) >( classAlignment );
+				const std::size_t alignedSize = impl::CalculateAlignedSize( classSize, classAlignment );
+				info.blockSize = alignedSize * ( ( blockSize + alignedSize - 1 ) / alignedSize );
+				info.wideTinyBlocks = false;
+			}
+			classes_[ ii ] = AllocatorManager::CreateAllocator( info );
+		}
+	}
+	catch ( ... )
+	{
+		DestroyClasses( true );
+		throw;
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+SizeClassAllocator::~SizeClassAllocator()
+{
+	DestroyClasses( false );
+}
+
+// ----------------------------------------------------------------------------
+
+void SizeClassAllocator::Destroy()
+{
+	DestroyClasses( true );
+}
+
+// ----------------------------------------------------------------------------
+
+void SizeClassAllocator::DestroyClasses( bool releaseMemory )
+{
+	for ( std::size_t ii = 0; ii < ClassCount; ++ii )
+	{
+		if ( nullptr != classes_[ ii ] )
+		{
+			AllocatorManager::DestroyAllocator( classes_[ ii ], releaseMemory );
+			classes_[ ii ] = nullptr;
+		}
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+void * SizeClassAllocator::Allocate( std::size_t size, const void * hint )
+{
+	const std::size_t index = GetClassIndex( size );
+	void * place = classes_[ index ]->Allocate( SizeClasses[ index ], hint );
+	return place;
+}
+
+// ----------------------------------------------------------------------------
+
+#if __cplusplus > 201402L
+void * SizeClassAllocator::Allocate( std::size_t size, std::align_val_t alignment, const void * hint )
+#else
+void * SizeClassAllocator::Allocate( std::size_t size, std::size_t alignment, const void * hint )
+#endif
+{
+	if ( impl::GetAlignmentSize( alignment ) > alignment_ )
+	{
+		throw std::invalid_argument( "Requested alignment size must be less than or equal to initial alignment size." );
+	}
+	void * place = SizeClassAllocator::Allocate( size, hint );
+	return place;
+}
+
+// ----------------------------------------------------------------------------
+
+bool SizeClassAllocator::Release( void * place, std::size_t size )
+{
+	if ( nullptr == place )
+	{
+		return false;
+	}
+	const std::size_t index = GetClassIndex( size );
+	const bool success = classes_[ index ]->Release( place, SizeClasses[ index ] );
+	return success;
+}
+
+// ----------------------------------------------------------------------------
+
+#if __cplusplus > 201402L
+bool SizeClassAllocator::Release( void * place, std::size_t size, std::align_val_t alignment )
+#else
+bool SizeClassAllocator::Release( void * place, std::size_t size, std::size_t alignment )
+#endif
+{
+	if ( nullptr == place )
+	{
+		return false;
+	}
+	if ( impl::GetAlignmentSize( alignment ) != alignment_ )
+	{
+		throw std::invalid_argument( "Requested alignment must match initial alignment." );
+	}
+	const bool success = SizeClassAllocator::Release( place, size );
+	return success;
+}
+
+// ----------------------------------------------------------------------------
+
+void SizeClassAllocator::AllocateBulk( void ** places, std::size_t count, std::size_t size, const void * hint )
+{
+	const std::size_t index = GetClassIndex( size );
+	classes_[ index ]->AllocateBulk( places, count, SizeClasses[ index ], hint );
+}
+
+// ----------------------------------------------------------------------------
+
+bool SizeClassAllocator::ReleaseBulk( void ** places, std::size_t count, std::size_t size )
+{
+	const std::size_t index = GetClassIndex( size );
+	const bool success = classes_[ index ]->ReleaseBulk( places, count, SizeClasses[ index ] );
+	return success;
+}
+
+// ----------------------------------------------------------------------------
+
+#if __cplusplus > 201402L
+bool SizeClassAllocator::Resize( void * place, std::size_t oldSize, std::size_t newSize, std::align_val_t alignment )
+#else
+bool SizeClassAllocator::Resize( void * place, std::size_t oldSize, std::size_t newSize, std::size_t alignment )
+#endif
+{
+	if ( impl::GetAlignmentSize( alignment ) != alignment_ )
+	{
+		throw std::invalid_argument( "Requested alignment must match initial alignment." );
+	}
+	const bool resized = SizeClassAllocator::Resize( place, oldSize, newSize );
+	return resized;
+}
+
+// ----------------------------------------------------------------------------
+
+bool SizeClassAllocator::Resize( void * place, std::size_t oldSize, std::size_t newSize )
+{
+	if ( nullptr == place )
+	{
+		return false;
+	}
+	if ( MaxObjectSize < newSize )
+	{
+		return false;
+	}
+	const bool resized = ( GetClassIndex( oldSize ) == GetClassIndex( newSize ) );
+	return resized;
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned long long SizeClassAllocator::GetMaxSize( std::size_t objectSize ) const
+{
+	const unsigned long long bytesAvailable = memwa::impl::GetTotalAvailableMemory();
+	const unsigned long long maxPossibleObjects = bytesAvailable / GetClassSize( objectSize );
+	return maxPossibleObjects;
+}
+
+// ----------------------------------------------------------------------------
+
+bool SizeClassAllocator::HasAddress( void * place ) const
+{
+	for ( std::size_t ii = 0; ii < ClassCount; ++ii )
+	{
+		if ( classes_[ ii ]->HasAddress( place ) )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// ----------------------------------------------------------------------------
+
+bool SizeClassAllocator::TrimEmptyBlocks()
+{
+	bool trimmed = false;
+	for ( std::size_t ii = 0; ii < ClassCount; ++ii )
+	{
+		if ( classes_[ ii ]->TrimEmptyBlocks() )
+		{
+			trimmed = true;
+		}
+	}
+	return trimmed;
+}
+
+// ----------------------------------------------------------------------------
+
+bool SizeClassAllocator::IsCorrupt() const
+{
+	assert( nullptr != this );
+	for ( std::size_t ii = 0; ii < ClassCount; ++ii )
+	{
+		if ( classes_[ ii ]->IsCorrupt() )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// ----------------------------------------------------------------------------
+
+float SizeClassAllocator::GetFragmentationPercent() const
+{
+	float total = 0.0;
+	for ( std::size_t ii = 0; ii < ClassCount; ++ii )
+	{
+		total += classes_[ ii ]->GetFragmentationPercent();
+	}
+	const float percent = total / ClassCount;
+	return percent;
+}
+
+// ----------------------------------------------------------------------------
+
+} // end project namespace
@@ -0,0 +1,208 @@
+
+#include "SizedAllocators.hpp"
+
+#include "LockGuard.hpp"
+#include "ManagerImpl.hpp"
+
+#include <cassert>
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+
+
+namespace memwa
+{
+
+// ----------------------------------------------------------------------------
+
+SizedAllocators::SizedAllocators( const AllocatorManager::AllocatorParameters & parameters ) :
+	parameters_( parameters ),
+	alignment_( impl::GetAlignmentSize( parameters.alignment ) ),
+	mutex_()
+{
+	if ( ( alignment_ == 0 ) || ( AllocatorManager::MaxAlignment < alignment_ ) || ( ( alignment_ & ( alignment_ - 1 ) ) != 0 ) )
+	{
+		throw std::invalid_argument( "Memory alignment must be a power of 2 and not greater than 32." );
+	}
+	for ( std::atomic< Allocator * > & allocator : allocators_ )
+	{
+		allocator.store( nullptr, std::memory_order_relaxed );
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+SizedAllocators::~SizedAllocators()
+{
+	for ( std::atomic< Allocator * > & slot : allocators_ )
+	{
+		Allocator * allocator = slot.load( std::memory_order_relaxed );
+		if ( nullptr != allocator )
+		{
+			AllocatorManager::DestroyAllocator( allocator, true );
+		}
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+#if __cplusplus > 201402L
+void * SizedAllocators::Allocate( std::size_t size, std::align_val_t alignment, const void * hint )
+#else
+void * SizedAllocators::Allocate( std::size_t size, std::size_t alignment, const void * hint )
+#endif
+{
+	if ( impl::GetAlignmentSize( alignment ) > alignment_ )
+	{
+		throw std::invalid_argument( "Requested alignment size must be less than or equal to initial alignment size." );
+	}
+	// Chunks of zero bytes come from the allocator for the smallest size, so each has its own address.
+	if ( 0 == size )
+	{
+		size = 1;
+	}
+	Allocator * allocator = GetAllocator( size );
+	if ( nullptr == allocator )
+	{
+		// Aligned the same as chunks from the allocators, since the caller may have asked for up to alignment_.
+		void * place = impl::AllocateSystemBlock( size, alignment_ );
+		if ( nullptr == place )
+		{
+			throw std::bad_alloc();
+		}
+		return place;
+	}
+	void * place = allocator->Allocate( size, hint );
+	if ( nullptr == place )
+	{
+		throw std::bad_alloc();
+	}
+	return place;
+}
+
+// ----------------------------------------------------------------------------
+
+bool SizedAllocators::Release( void * place, std::size_t size )
+{
+	if ( nullptr == place )
+	{
+		return false;
+	}
+	if ( MaxObjectSize < size )
+	{
+		impl::ReleaseSystemBlock( place );
+		return true;
+	}
+	if ( 0 == size )
+	{
+		size = 1;
+	}
+	const std::size_t alignedSize = impl::CalculateAlignedSize( size, alignment_ );
+	Allocator * allocator = allocators_[ alignedSize - 1 ].load( std::memory_order_acquire );
+	if ( nullptr == allocator )
+	{
+		return false;
+	}
+	return allocator->Release( place, size );
+}
+
+// ----------------------------------------------------------------------------
+
+Allocator * SizedAllocators::GetAllocator( std::size_t size )
+{
+	if ( MaxObjectSize < size )
+	{
+		return nullptr;
+	}
+	// MaxObjectSize is a multiple of every supported alignment, so aligning a size never makes it too big.
+	const std::size_t alignedSize = ( 0 == size ) ? alignment_ : impl::CalculateAlignedSize( size, alignment_ );
+	Allocator * allocator = allocators_[ alignedSize - 1 ].load( std::memory_order_acquire );
+	if ( nullptr == allocator )
+	{
+		allocator = MakeAllocator( alignedSize );
+	}
+	return allocator;
+}
+
+// ----------------------------------------------------------------------------
+
+Allocator * SizedAllocators::MakeAllocator( std::size_t alignedSize )
+{
+	LockGuard guard( mutex_ );
+	std::atomic< Allocator * > & slot = allocators_[ alignedSize - 1 ];
+	Allocator * allocator = slot.load( std::memory_order_relaxed );
+	if ( nullptr != allocator )
+	{
+		return allocator;
+	}
+
+	AllocatorManager::AllocatorParameters info( parameters_ );
+	info.objectSize = alignedSize;
+	if ( alignedSize <= MaxTinyObjectSize )
+	{
+		info.type = AllocatorManager::AllocatorType::Tiny;
+	}
+	else
+	{
+		// Pool allocators need at least 4 byte alignment, and lock-free or remote-free pools need a pointer's
+		// alignment, so smaller alignments are raised here. That pads each chunk by at most a few bytes, while
+		// CreateAllocator would otherwise reject the first node bigger than MaxTinyObjectSize.
+		const std::size_t poolAlignment = std::max( alignment_, sizeof(void *) );
+		const std::size_t poolSize = impl::CalculateAlignedSize( alignedSize, poolAlignment );
+		info.type = AllocatorManager::AllocatorType::Pool;
+#if __cplusplus > 201402L
+		info.alignment = static_cast< std::align_val_t >( poolAlignment );
+#else
+		info.alignment = poolAlignment;
+#endif
+		info.blockSize -= info.blockSize % poolSize;
+	}
+	allocator = AllocatorManager::CreateAllocator( info );
+	slot.store( allocator, std::memory_order_release );
+	return allocator;
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned long long SizedAllocators::GetMaxSize( std::size_t objectSize ) const
+{
+	const unsigned long long bytesAvailable = memwa::impl::GetTotalAvailableMemory();
+	const unsigned long long maxPossibleObjects = bytesAvailable / objectSize;
+	return maxPossibleObjects;
+}
+
+// ----------------------------------------------------------------------------
+
+bool SizedAllocators::HasAddress( void * place ) const
+{
+	for ( const std::atomic< Allocator * > & slot : allocators_ )
+	{
+		const Allocator * allocator = slot.load( std::memory_order_acquire );
+		if ( ( nullptr != allocator ) && allocator->HasAddress( place ) )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// ----------------------------------------------------------------------------
+
+bool SizedAllocators::IsCorrupt() const
+{
+	assert( nullptr != this );
+	for ( const std::atomic< Allocator * > & slot : allocators_ )
+	{
+		const Allocator * allocator = slot.load( std::memory_order_acquire );
+		if ( ( nullptr != allocator ) && allocator->IsCorrupt() )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// ----------------------------------------------------------------------------
+
+} // end project namespace
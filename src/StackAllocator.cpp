@@ -15,15 +15,45 @@
 
 #include <cstdlib>
 #include <cassert>
+#include <cstdint>
 
 namespace memwa
 {
 
+namespace
+{
+
+// ----------------------------------------------------------------------------
+
+/// Returns number of bytes in the header put after each chunk.
+std::size_t GetHeaderSize( AllocatorManager::StackHeader header, std::size_t blockSize )
+{
+	switch ( header )
+	{
+		case AllocatorManager::Compact :
+			// Offsets within blocks of 64 KB or less fit in 16 bits.
+			return ( blockSize <= UINT16_MAX + 1 ) ? impl::HotStackBlock::NarrowHeaderSize : impl::HotStackBlock::WideHeaderSize;
+		case AllocatorManager::Headerless :
+			return impl::HotStackBlock::NoHeaderSize;
+		default :
+			break;
+	}
+	return impl::HotStackBlock::FullHeaderSize;
+}
+
+// ----------------------------------------------------------------------------
+
+} // end anonymous namespace
+
 // ----------------------------------------------------------------------------
 
-StackAllocator::StackAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment ) :
+StackAllocator::StackAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment, bool alignedBlocks,
+	unsigned int retainedEmptyBlocks, BlockSource * source, AllocatorManager::StackHeader header ) :
 	Allocator(),
-	info_( initialBlocks, blockSize, alignment )
+	hotEnabled_( true ),
+	info_( initialBlocks, blockSize, alignment, alignedBlocks ? impl::CalculateBlockAlignment( blockSize ) : 0, retainedEmptyBlocks,
+		source, GetHeaderSize( header, blockSize ) ),
+	hot_( nullptr )
 {
 }
 
@@ -37,18 +67,35 @@ StackAllocator::~StackAllocator()
 
 void StackAllocator::Destroy()
 {
+	hot_ = nullptr;
 	info_.Destroy();
 }
 
 // ----------------------------------------------------------------------------
 
+void StackAllocator::SetHotBlock()
+{
+	if ( hotEnabled_ && ( info_.recent_ != info_.blocks_.end() ) )
+	{
+		hot_ = &( *info_.recent_ );
+	}
+	else
+	{
+		hot_ = nullptr;
+	}
+}
+
+// ----------------------------------------------------------------------------
+
 void * StackAllocator::Allocate( std::size_t size, const void * hint )
 {
 	if ( info_.blockSize_ < size )
 	{
 		throw std::invalid_argument( "Requested allocation size must be smaller than the memory block size." );
 	}
+	hot_ = nullptr;
 	void * p = info_.Allocate( size, hint );
+	SetHotBlock();
 	return p;
 }
 
@@ -60,7 +107,7 @@ void * StackAllocator::Allocate( std::size_t size, std::align_val_t alignment, c
 void * StackAllocator::Allocate( std::size_t size, std::size_t alignment, const void * hint )
 #endif
 {
-	if ( alignment > info_.alignment_ )
+	if ( impl::GetAlignmentSize( alignment ) > info_.alignment_ )
 	{
 		throw std::invalid_argument( "Requested alignment size must be less than or equal to initial alignment size." );
 	}
@@ -96,7 +143,9 @@ bool StackAllocator::Release( void * place, std::size_t size )
 	{
 		return false;
 	}
+	hot_ = nullptr;
 	const bool success = info_.Release( place, size );
+	SetHotBlock();
 	return success;
 }
 
@@ -112,11 +161,13 @@ bool StackAllocator::Release( void * place, std::size_t size, std::size_t alignm
 	{
 		return false;
 	}
-	if ( alignment > info_.alignment_ )
+	if ( impl::GetAlignmentSize( alignment ) > info_.alignment_ )
 	{
 		throw std::invalid_argument( "Requested alignment size must be less than or equal to initial alignment size." );
 	}
+	hot_ = nullptr;
 	const bool success = info_.Release( place, size );
+	SetHotBlock();
 	return success;
 }
 
@@ -128,7 +179,7 @@ bool StackAllocator::Resize( void * place, std::size_t oldSize, std::size_t newS
 bool StackAllocator::Resize( void * place, std::size_t oldSize, std::size_t newSize, std::size_t alignment )
 #endif
 {
-	if ( alignment > info_.alignment_ )
+	if ( impl::GetAlignmentSize( alignment ) > info_.alignment_ )
 	{
 		throw std::invalid_argument( "Requested alignment size must be less than or equal to initial alignment size." );
 	}
@@ -152,11 +203,9 @@ bool StackAllocator::Resize( void * place, std::size_t oldSize, std::size_t newS
 	{
 		return true;
 	}
-	if ( 0 == newSize )
-	{
-		return info_.Release( place, oldSize );
-	}
-	const bool success = info_.Resize( place, oldSize, newSize );
+	hot_ = nullptr;
+	const bool success = ( 0 == newSize ) ? info_.Release( place, oldSize ) : info_.Resize( place, oldSize, newSize );
+	SetHotBlock();
 	return success;
 }
 
@@ -181,7 +230,9 @@ bool StackAllocator::HasAddress( void * place ) const
 
 bool StackAllocator::TrimEmptyBlocks()
 {
+	hot_ = nullptr;
 	const bool trimmed = info_.TrimEmptyBlocks();
+	SetHotBlock();
 	return trimmed;
 }
 
@@ -232,10 +283,13 @@ void StackAllocator::OutputContents() const
 
 // ----------------------------------------------------------------------------
 
-ThreadSafeStackAllocator::ThreadSafeStackAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment ) :
-	StackAllocator( initialBlocks, blockSize, alignment ),
+ThreadSafeStackAllocator::ThreadSafeStackAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t alignment,
+	bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source, AllocatorManager::StackHeader header ) :
+	StackAllocator( initialBlocks, blockSize, alignment, alignedBlocks, retainedEmptyBlocks, source, header ),
 	mutex_()
 {
+	// Calls to FastAllocate and FastRelease must go through the locking functions.
+	hotEnabled_ = false;
 }
 
 // ----------------------------------------------------------------------------
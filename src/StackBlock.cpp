@@ -13,9 +13,9 @@ namespace memwa
 
 // ----------------------------------------------------------------------------
 
-StackBlock::StackBlock( const std::size_t blockSize, const std::size_t alignment ) :
-	block_( reinterpret_cast< unsigned char * >( std::malloc( blockSize ) ) ),
-	freeSpot_( block_ )
+StackBlock::StackBlock( const std::size_t blockSize, const std::size_t alignment, const std::size_t blockAlignment,
+	BlockSource * source ) :
+	impl::HotStackBlock( reinterpret_cast< unsigned char * >( impl::AllocateBlock( blockSize, blockAlignment, source ) ) )
 {
 	if ( nullptr == block_ )
 	{
@@ -39,113 +39,89 @@ StackBlock::StackBlock( const std::size_t blockSize, const std::size_t alignment
 
 // ----------------------------------------------------------------------------
 
-void StackBlock::Destroy()
+void StackBlock::Destroy( std::size_t blockSize, std::size_t blockAlignment, BlockSource * source )
 {
 //	std::cout << __FUNCTION__ << " : " << __LINE__ << std::endl;
-	std::free( block_ );
+	impl::ReleaseBlock( block_, blockSize, blockAlignment, source );
 	block_ = nullptr;
 	freeSpot_ = nullptr;
 }
 
 // ----------------------------------------------------------------------------
 
-void * StackBlock::Allocate( const std::size_t bytes, const std::size_t blockSize, const std::size_t alignment )
+bool StackBlock::Release( void * place, const std::size_t bytes, const std::size_t blockSize, const std::size_t alignment,
+	const std::size_t headerSize )
 {
 	assert( 0 != alignment );
 	assert( 0 != blockSize );
 	assert( 0 != bytes );
-	assert( !IsCorrupt( blockSize, alignment ) );
-
-//	std::cout << __FUNCTION__ << " : " << __LINE__ << std::endl;
-	const std::size_t bytesNeeded = memwa::impl::CalculateAlignedSize( bytes, alignment ) + sizeof(ChunkInfo);
-	const std::size_t bytesAvailable = ( block_ + blockSize ) - freeSpot_;
-	const bool hasEnough = ( bytesNeeded <= bytesAvailable );
-	if ( !hasEnough )
-	{
-		return nullptr;
-	}
-
-	unsigned char * p = reinterpret_cast< unsigned char * >( freeSpot_ );
-	assert( p != nullptr );
-	assert( p >= block_ );
-	freeSpot_ += bytesNeeded;
-	unsigned char * place = freeSpot_ - sizeof(ChunkInfo);
-	ChunkInfo * chunk = reinterpret_cast< ChunkInfo * >( place );
-	chunk->prevChunkSize_ = bytesNeeded;
-	chunk->prevChunk_ = reinterpret_cast< unsigned char * >( p );
-	assert( chunk->IsValid( block_, blockSize, alignment ) );
-	assert( chunk->prevChunkSize_ + chunk->prevChunk_ == freeSpot_ );
-	assert( reinterpret_cast< std::size_t >( p ) % alignment == 0 );
-	assert( reinterpret_cast< unsigned char * >( chunk ) > p );
-
-	assert( !IsCorrupt( blockSize, alignment ) );
-	return p;
-}
-
-// ----------------------------------------------------------------------------
-
-bool StackBlock::Release( void * place, const std::size_t bytes, const std::size_t blockSize, const std::size_t alignment )
-{
-	assert( 0 != alignment );
-	assert( 0 != blockSize );
-	assert( 0 != bytes );
-	assert( !IsCorrupt( blockSize, alignment ) );
+	assert( !IsCorrupt( blockSize, alignment, headerSize ) );
 
 //	std::cout << __FUNCTION__ << " : " << __LINE__ << std::endl;
 	if ( IsEmpty( alignment ) )
 	{
 		return false;
 	}
-	unsigned char * p = freeSpot_ - sizeof(ChunkInfo);
-	ChunkInfo * chunk = reinterpret_cast< ChunkInfo * >( p );
-	assert( chunk->IsValid( block_, blockSize, alignment ) );
-	assert( chunk->prevChunkSize_ + chunk->prevChunk_ == freeSpot_ );
-	const std::size_t bytesNeeded = memwa::impl::CalculateAlignedSize( bytes, alignment ) + sizeof(ChunkInfo);
-	if ( chunk->prevChunkSize_ != bytesNeeded )
+	const std::size_t bytesNeeded = GetBytesNeeded( bytes, alignment, headerSize );
+	if ( NoHeaderSize == headerSize )
+	{
+		// Without a header, the caller's size is trusted, and only debug builds check it.
+		assert( static_cast< unsigned char * >( place ) + bytesNeeded == freeSpot_ );
+		if ( ( place < block_ ) || ( freeSpot_ <= place ) )
+		{
+			return false;
+		}
+		freeSpot_ = static_cast< unsigned char * >( place );
+		return true;
+	}
+	unsigned char * prevChunk = GetChunkBefore( freeSpot_, headerSize );
+	const std::size_t prevChunkSize = static_cast< std::size_t >( freeSpot_ - prevChunk );
+	if ( prevChunkSize != bytesNeeded )
 	{
 		std::string message( "Error found by StackAllocator. The memory requested to release does not match internal storage of that size. " );
 		char buffer[ 256 ];
 		snprintf( buffer, sizeof(buffer), "  alignment: %lu  bytes requested: %lu  bytes needed with alignment+overhead: %lu  prev chunk size: %lu ",
-			alignment, bytes, bytesNeeded, chunk->prevChunkSize_ );
+			alignment, bytes, bytesNeeded, prevChunkSize );
 		message += buffer;
 //		OutputContents( blockSize, alignment );
 		throw std::invalid_argument( message );
 	}
-	if ( place < chunk->prevChunk_ )
+	if ( place < prevChunk )
 	{
 		std::string message( "Error found by StackAllocator. The requested place to release is not the most recently allocated chunk in its block. " );
 		char buffer[ 256 ];
 		snprintf( buffer, sizeof(buffer), "  place: %lu  prev chunk: %lu ",
-			reinterpret_cast< std::size_t >( place ), reinterpret_cast< std::size_t >( chunk->prevChunk_ ) );
+			reinterpret_cast< std::size_t >( place ), reinterpret_cast< std::size_t >( prevChunk ) );
 		message += buffer;
 //		OutputContents( blockSize, alignment );
 		throw std::invalid_argument( message );
 	}
-	if ( place != chunk->prevChunk_ )
+	if ( place != prevChunk )
 	{
 		std::string message( "Error found by StackAllocator. The requested place to release does not match internal storage of that place. " );
 		char buffer[ 256 ];
 		snprintf( buffer, sizeof(buffer), "   place: %lu  prev chunk: %lu ",
-			reinterpret_cast< std::size_t >( place ), reinterpret_cast< std::size_t >( chunk->prevChunk_ ) );
+			reinterpret_cast< std::size_t >( place ), reinterpret_cast< std::size_t >( prevChunk ) );
 		message += buffer;
 //		OutputContents( blockSize, alignment );
 		throw std::invalid_argument( message );
 	}
-	freeSpot_ = chunk->prevChunk_;
+	freeSpot_ = prevChunk;
 
-	assert( !IsCorrupt( blockSize, alignment ) );
+	assert( !IsCorrupt( blockSize, alignment, headerSize ) );
 	return true;
 }
 
 // ----------------------------------------------------------------------------
 
-bool StackBlock::Resize( void * place, const std::size_t oldSize, const std::size_t newSize, const std::size_t blockSize, const std::size_t alignment )
+bool StackBlock::Resize( void * place, const std::size_t oldSize, const std::size_t newSize, const std::size_t blockSize,
+	const std::size_t alignment, const std::size_t headerSize )
 {
 	assert( 0 != alignment );
 	assert( 0 != blockSize );
 	assert( 0 != oldSize );
 	assert( 0 != newSize );
-	assert( !IsCorrupt( blockSize, alignment ) );
+	assert( !IsCorrupt( blockSize, alignment, headerSize ) );
 
 //	std::cout << __FUNCTION__ << " : " << __LINE__ << std::endl;
 	if ( IsEmpty( alignment ) )
@@ -154,83 +130,62 @@ bool StackBlock::Resize( void * place, const std::size_t oldSize, const std::siz
 		return false;
 	}
 
-	unsigned char * p = freeSpot_ - sizeof(ChunkInfo);
-	ChunkInfo * chunk = reinterpret_cast< ChunkInfo * >( p );
-	assert( chunk->IsValid( block_, blockSize, alignment ) );
-	assert( chunk->prevChunkSize_ + chunk->prevChunk_ == freeSpot_ );
-	if ( place < chunk->prevChunk_ )
+	const std::size_t oldBytesNeeded = GetBytesNeeded( oldSize, alignment, headerSize );
+	unsigned char * prevChunk = nullptr;
+	if ( NoHeaderSize == headerSize )
+	{
+		// Without a header, the caller's size is trusted, and only debug builds check it.
+		assert( static_cast< unsigned char * >( place ) + oldBytesNeeded == freeSpot_ );
+		if ( ( place < block_ ) || ( freeSpot_ <= place ) )
+		{
+			return false;
+		}
+		prevChunk = static_cast< unsigned char * >( place );
+	}
+	else
+	{
+		prevChunk = GetChunkBefore( freeSpot_, headerSize );
+	}
+	if ( place < prevChunk )
 	{
-/*		std::cout << __FUNCTION__ << " : " << __LINE__
-			<< "   prev chunk size : " << chunk->prevChunkSize_
-			<< "   old size : " << oldSize << std::endl;
-		OutputContents( blockSize, alignment );
-*/
 		std::string message( "Error found by StackAllocator. The requested place to resize is not the most recently allocated chunk in its block. " );
 		char buffer[ 256 ];
 		snprintf( buffer, sizeof(buffer), "  place: %lu  prev chunk: %lu ",
-			reinterpret_cast< std::size_t >( place ), reinterpret_cast< std::size_t >( chunk->prevChunk_ ) );
+			reinterpret_cast< std::size_t >( place ), reinterpret_cast< std::size_t >( prevChunk ) );
 		message += buffer;
 		throw std::invalid_argument( message );
 	}
-	if ( place != chunk->prevChunk_ )
+	if ( place != prevChunk )
 	{
-/*
-		std::cout << __FUNCTION__ << " : " << __LINE__
-			<< "   prev chunk size : " << chunk->prevChunkSize_
-			<< "   old size : " << oldSize << std::endl;
-		OutputContents( blockSize, alignment );
-*/
 		std::string message( "Error found by StackAllocator. The requested place to resize does not match internal storage of that place. " );
 		char buffer[ 256 ];
 		snprintf( buffer, sizeof(buffer), "  place: %lu  prev chunk: %lu ",
-			reinterpret_cast< std::size_t >( place ), reinterpret_cast< std::size_t >( chunk->prevChunk_ ) );
+			reinterpret_cast< std::size_t >( place ), reinterpret_cast< std::size_t >( prevChunk ) );
 		message += buffer;
 		throw std::invalid_argument( message );
 	}
-	const std::size_t oldBytesNeeded = memwa::impl::CalculateAlignedSize( oldSize, alignment ) + sizeof(ChunkInfo);
-	if ( chunk->prevChunkSize_ != oldBytesNeeded )
+	const std::size_t prevChunkSize = static_cast< std::size_t >( freeSpot_ - prevChunk );
+	if ( ( NoHeaderSize != headerSize ) && ( prevChunkSize != oldBytesNeeded ) )
 	{
-/*		std::cout << __FUNCTION__ << " : " << __LINE__
-			<< "   prev chunk size : " << chunk->prevChunkSize_
-			<< "   old bytes needed : " << oldBytesNeeded
-			<< "   old size : " << oldSize << std::endl;
-		OutputContents( blockSize, alignment );
-*/
 		std::string message( "Error found by StackAllocator. The memory requested to resize does not match internal storage of that size. " );
 		char buffer[ 256 ];
 		snprintf( buffer, sizeof(buffer), "  alignment: %lu  bytes requested: %lu  bytes needed with alignment+overhead: %lu  prev chunk size: %lu ",
-			alignment, oldSize, oldBytesNeeded, chunk->prevChunkSize_ );
+			alignment, oldSize, oldBytesNeeded, prevChunkSize );
 		message += buffer;
 		throw std::invalid_argument( message );
 	}
 
-	const std::size_t newBytesNeeded = memwa::impl::CalculateAlignedSize( newSize, alignment ) + sizeof(ChunkInfo);
-	if ( oldBytesNeeded < newBytesNeeded )
+	const std::size_t newBytesNeeded = GetBytesNeeded( newSize, alignment, headerSize );
+	const std::size_t bytesAvailable = static_cast< std::size_t >( ( block_ + blockSize ) - prevChunk );
+	if ( bytesAvailable < newBytesNeeded )
 	{
-		const std::size_t byteDifference = freeSpot_ - block_;
-		const std::size_t bytesAvailable = blockSize - byteDifference;
-		const std::size_t neededDifference = newBytesNeeded - oldBytesNeeded;
-		const bool hasEnough = ( neededDifference <= bytesAvailable );
-		if ( !hasEnough )
-		{
-/*			std::cout << __FUNCTION__ << " : " << __LINE__ << "  blockSize: " << blockSize
-				<< "  oldSize: " << oldSize << "  newSize: " << newSize << "  alignment: " << alignment
-				<< "  available: " << bytesAvailable << "  bytesNeeded: " << newBytesNeeded << std::endl;
-			OutputContents( blockSize, alignment );
-*/
-			return false;
-		}
+		return false;
 	}
 
-	freeSpot_ = chunk->prevChunk_ + newBytesNeeded;
-	unsigned char * prevChunk = chunk->prevChunk_;
-	p = freeSpot_ - sizeof(ChunkInfo);
-	chunk = reinterpret_cast< ChunkInfo * >( p );
-	chunk->prevChunk_ = prevChunk;
-	chunk->prevChunkSize_ = newBytesNeeded;
-	assert( chunk->IsValid( block_, blockSize, alignment ) );
+	freeSpot_ = prevChunk + newBytesNeeded;
+	WriteHeader( prevChunk, headerSize );
 
-	assert( !IsCorrupt( blockSize, alignment ) );
+	assert( !IsCorrupt( blockSize, alignment, headerSize ) );
 	return true;
 }
 
@@ -261,11 +216,12 @@ bool StackBlock::HasAddress( const void * chunk, const std::size_t blockSize ) c
 
 // ----------------------------------------------------------------------------
 
-bool StackBlock::HasBytesAvailable( const std::size_t bytes, const std::size_t blockSize, const std::size_t alignment ) const
+bool StackBlock::HasBytesAvailable( const std::size_t bytes, const std::size_t blockSize, const std::size_t alignment,
+	const std::size_t headerSize ) const
 {
 	assert( 0 != alignment );
 	assert( 0 != blockSize );
-	const std::size_t bytesNeeded = memwa::impl::CalculateAlignedSize( bytes, alignment ) + sizeof(ChunkInfo);
+	const std::size_t bytesNeeded = GetBytesNeeded( bytes, alignment, headerSize );
 	const std::size_t bytesAvailable = ( block_ + blockSize ) - freeSpot_;
 	const bool hasEnough = ( bytesNeeded <= bytesAvailable );
 	return hasEnough;
@@ -273,36 +229,24 @@ bool StackBlock::HasBytesAvailable( const std::size_t bytes, const std::size_t b
 
 // ----------------------------------------------------------------------------
 
-bool StackBlock::IsEmpty( const std::size_t alignment ) const
-{
-	assert( 0 != alignment );
-	const bool empty = ( block_ == freeSpot_ );
-	return empty;
-}
-
-// ----------------------------------------------------------------------------
-
-std::size_t StackBlock::GetChunkSize( const unsigned int index, const std::size_t blockSize, const std::size_t alignment ) const
+std::size_t StackBlock::GetChunkSize( const unsigned int index, const std::size_t blockSize, const std::size_t alignment,
+	const std::size_t headerSize ) const
 {
 	assert( 0 != alignment );
 	assert( 0 != blockSize );
-	assert( !IsCorrupt( blockSize, alignment ) );
+	assert( NoHeaderSize != headerSize );
+	assert( !IsCorrupt( blockSize, alignment, headerSize ) );
 
-	if ( block_ == freeSpot_ )
-	{
-		return 0;
-	}
 	unsigned int count = 0;
-	unsigned char * place = freeSpot_ - sizeof(ChunkInfo);
+	unsigned char * place = freeSpot_;
 	while ( place > block_ )
 	{
-		const ChunkInfo * chunk = reinterpret_cast< ChunkInfo * >( place );
-		assert( chunk->IsValid( block_, blockSize, alignment ) );
+		unsigned char * chunk = GetChunkBefore( place, headerSize );
 		if ( index == count )
 		{
-			return chunk->prevChunkSize_ - sizeof(ChunkInfo);
+			return static_cast< std::size_t >( place - chunk ) - headerSize;
 		}
-		place = chunk->prevChunk_ - sizeof(ChunkInfo);
+		place = chunk;
 		++count;
 	}
 	assert( place == block_ ); // pointer to previous chunk may not be before first chunk.
@@ -312,25 +256,18 @@ std::size_t StackBlock::GetChunkSize( const unsigned int index, const std::size_
 
 // ----------------------------------------------------------------------------
 
-unsigned int StackBlock::GetObjectCount( const std::size_t blockSize, const std::size_t alignment ) const
+unsigned int StackBlock::GetObjectCount( const std::size_t blockSize, const std::size_t alignment, const std::size_t headerSize ) const
 {
 	assert( 0 != alignment );
 	assert( 0 != blockSize );
-	assert( !IsCorrupt( blockSize, alignment ) );
+	assert( NoHeaderSize != headerSize );
+	assert( !IsCorrupt( blockSize, alignment, headerSize ) );
 
-	if ( block_ == freeSpot_ )
-	{
-		return 0;
-	}
 	unsigned int count = 0;
 	unsigned char * place = freeSpot_;
 	while ( place > block_ )
 	{
-		place -= sizeof(ChunkInfo);
-		assert( place > block_ );
-		const ChunkInfo * chunk = reinterpret_cast< ChunkInfo * >( place );
-		assert( chunk->IsValid( block_, blockSize, alignment ) );
-		place = chunk->prevChunk_;
+		place = GetChunkBefore( place, headerSize );
 		++count;
 	}
 	assert( place == block_ ); // pointer to previous chunk may not be before first chunk.
@@ -354,20 +291,7 @@ std::size_t StackBlock::GetFreeBytes( const std::size_t blockSize ) const
 
 // ----------------------------------------------------------------------------
 
-unsigned char * StackBlock::GetPreviousPlace( unsigned char * place, const std::size_t blockSize, const std::size_t alignment )
-{
-	assert( 0 != alignment );
-	assert( 0 != blockSize );
-	unsigned char * p = place - sizeof(ChunkInfo);
-	const ChunkInfo * chunk = reinterpret_cast< ChunkInfo * >( p );
-	assert( chunk->IsValid( block_, blockSize, alignment ) );
-	unsigned char * prev = chunk->prevChunk_;
-	return prev;
-}
-
-// ----------------------------------------------------------------------------
-
-bool StackBlock::IsCorrupt( const std::size_t blockSize, const std::size_t alignment ) const
+bool StackBlock::IsCorrupt( const std::size_t blockSize, const std::size_t alignment, const std::size_t headerSize ) const
 {
 	assert( 0 != alignment );
 	assert( 0 != blockSize );
@@ -382,29 +306,24 @@ bool StackBlock::IsCorrupt( const std::size_t blockSize, const std::size_t align
 	}
 	assert( block_ <= freeSpot_ );
 	assert( block_ + blockSize >= freeSpot_ );
+	assert( reinterpret_cast< std::size_t >( freeSpot_ ) % alignment == 0 );
 
-/*
-	const std::size_t remainder = reinterpret_cast< std::size_t >( block_ ) % alignment;
-	const std::size_t padding = ( remainder == 0 ) ? 0 : alignment - remainder;
-	const unsigned char * firstPlace = block_ + padding;
-	assert( firstPlace <= freeSpot_ );
-	const bool empty = ( firstPlace == freeSpot_ );
-*/
 	const bool empty = ( block_ == freeSpot_ );
-
-	if ( !empty )
+	if ( !empty && ( NoHeaderSize != headerSize ) )
 	{
-		const std::size_t byteDifference = freeSpot_ - block_;
-		assert( byteDifference > sizeof(ChunkInfo) );
-		unsigned char * place = freeSpot_;
+		assert( static_cast< std::size_t >( freeSpot_ - block_ ) > headerSize );
+		const unsigned char * place = freeSpot_;
 		while ( place > block_ )
 		{
-			place -= sizeof(ChunkInfo);
-			assert( place > block_ );
-			const ChunkInfo * chunk = reinterpret_cast< ChunkInfo * >( place );
-			assert( chunk->IsValid( block_, blockSize, alignment ) );
-			assert( chunk->prevChunk_ + chunk->prevChunkSize_ <= block_ + blockSize );
-			place = chunk->prevChunk_;
+			if ( FullHeaderSize == headerSize )
+			{
+				assert( reinterpret_cast< const ChunkInfo * >( place - sizeof(ChunkInfo) )->IsValid( block_, blockSize, alignment ) );
+			}
+			const unsigned char * prevChunk = GetChunkBefore( place, headerSize );
+			assert( block_ <= prevChunk );
+			assert( prevChunk + headerSize < place );
+			assert( reinterpret_cast< std::size_t >( prevChunk ) % alignment == 0 );
+			place = prevChunk;
 		}
 		assert( place == block_ ); // pointer to previous chunk may not be before first chunk.
 	}
@@ -415,11 +334,11 @@ bool StackBlock::IsCorrupt( const std::size_t blockSize, const std::size_t align
 
 // #ifdef MEMWA_DEBUGGING_ALLOCATORS
 
-void StackBlock::OutputContents( const std::size_t blockSize, const std::size_t alignment ) const
+void StackBlock::OutputContents( const std::size_t blockSize, const std::size_t alignment, const std::size_t headerSize ) const
 {
 	assert( 0 != alignment );
 	assert( 0 != blockSize );
-	assert( !IsCorrupt( blockSize, alignment ) );
+	assert( !IsCorrupt( blockSize, alignment, headerSize ) );
 
 //	std::cout << __FUNCTION__ << " : " << __LINE__ << std::endl;
 	const bool empty = ( freeSpot_ == block_ );
@@ -430,21 +349,20 @@ void StackBlock::OutputContents( const std::size_t blockSize, const std::size_t
 	std::size_t countedBytes = 0;
 	unsigned int chunkCount = 0;
 
-	if ( !empty )
+	if ( !empty && ( NoHeaderSize != headerSize ) )
 	{
 		unsigned char * place = freeSpot_;
 		while ( place > block_ )
 		{
 			++chunkCount;
-			place -= sizeof(ChunkInfo);
-			const ChunkInfo * chunk = reinterpret_cast< ChunkInfo * >( place );
-			countedBytes += chunk->prevChunkSize_;
-			std::cout << "\t\t  place: " << reinterpret_cast< std::size_t >( chunk )
-				<< " \t chunk: " << reinterpret_cast< std::size_t >( chunk->prevChunk_ )
-				<< " \t chunk size: " << chunk->prevChunkSize_
-				<< " \t object size: " << chunk->prevChunkSize_ - sizeof(ChunkInfo) << std::endl;
-			assert( chunk->IsValid( block_, blockSize, alignment ) );
-			place = chunk->prevChunk_;
+			unsigned char * chunk = GetChunkBefore( place, headerSize );
+			const std::size_t chunkSize = static_cast< std::size_t >( place - chunk );
+			countedBytes += chunkSize;
+			std::cout << "\t\t  place: " << reinterpret_cast< std::size_t >( place - headerSize )
+				<< " \t chunk: " << reinterpret_cast< std::size_t >( chunk )
+				<< " \t chunk size: " << chunkSize
+				<< " \t object size: " << chunkSize - headerSize << std::endl;
+			place = chunk;
 		}
 		assert( place == block_ );
 	}
@@ -472,10 +390,10 @@ const bool StackBlock::ChunkInfo::IsValid( const unsigned char * block, const st
 	assert( this != nullptr );
 	assert( prevChunk_ != nullptr );
 	assert( prevChunk_ >= block );
-	assert( prevChunkSize_ >= sizeof(ChunkInfo) + alignment );
-	assert( prevChunkSize_ < blockSize );
-	const unsigned char * const pThis = reinterpret_cast< const unsigned char * const >( this );
-	assert( prevChunkSize_ + prevChunk_ - sizeof(ChunkInfo) == pThis );
+	assert( prevChunkSize_ > sizeof(ChunkInfo) );
+	assert( prevChunkSize_ % alignment == 0 );
+	assert( prevChunkSize_ <= blockSize );
+	assert( prevChunkSize_ + prevChunk_ - sizeof(ChunkInfo) == reinterpret_cast< const unsigned char * >( this ) );
 	return true;
 }
 
@@ -1,11 +1,15 @@
 
 #pragma once
 
+#include "HotBlock.hpp"
+
 #include <cstddef> // For std::size_t.
 
 namespace memwa
 {
 
+class BlockSource;
+
 // ----------------------------------------------------------------------------
 
 /** @class StackBlock Info about a single block of memory.
@@ -21,36 +25,40 @@ namespace memwa
  each StackBlock. By not storing them here, each act of copying a StackBlock is quicker.
 
  Down at this level, each operation has to be simple and efficient so the memory handler uses as
- few CPU cycles as possible. Each action should be done in constant time.
+ few CPU cycles as possible. Each action should be done in constant time. The fields, and the functions
+ to allocate and release the top chunk, are in impl::HotStackBlock so StackAllocator can inline them.
  */
-class StackBlock
+class StackBlock : public impl::HotStackBlock
 {
 public:
 
 	/** Allocates a block of memory of a given size to match a given alignment.
 	 @param blockSize Number of bytes in each block.
 	 @param alignment Byte boundaries to align allocations. Must be power of two. (e.g. - 1, 2, 4, 8, or 16.)
+	 @param blockAlignment Power of two the block's address must be a multiple of, or zero for default alignment.
+	 @param source Provides memory for the block, or nullptr to use malloc.
 	 This will throw an exception if it can't allocate a block.
 	 */
-	StackBlock( const std::size_t blockSize, const std::size_t alignment );
+	StackBlock( const std::size_t blockSize, const std::size_t alignment, const std::size_t blockAlignment = 0,
+		BlockSource * source = nullptr );
 
-	/// There is no destructor, so the Destroy function releases the block.
-	void Destroy();
-
-	/** Allocates a chunk of particular size.
-	 @return Pointer to chunk, or nullptr.
+	/** There is no destructor, so the Destroy function releases the block. Parameters must be the same
+	 ones passed to the constructor.
 	 */
-	void * Allocate( const std::size_t size, const std::size_t blockSize, const std::size_t alignment );
+	void Destroy( std::size_t blockSize = 0, std::size_t blockAlignment = 0, BlockSource * source = nullptr );
 
 	/** Releases the memory chunk at chunk. This will only release a chunk if the address is within
 	 the block and the chunk is at the top of the block's local stack. It will not release chunks
 	 below the top of the stack. This means chunks should be released in reverse order of how they
-	 were allocated.
+	 were allocated. Chunks without headers are not checked except in debug builds.
+	 @param headerSize Bytes of header after each chunk. See HotStackBlock for the kinds of headers.
 	 @return True if released, false if not.
 	 */
-	bool Release( void * chunk, const std::size_t size, const std::size_t blockSize, const std::size_t alignment );
+	bool Release( void * chunk, const std::size_t size, const std::size_t blockSize, const std::size_t alignment,
+		const std::size_t headerSize = FullHeaderSize );
 
-	bool Resize( void * chunk, const std::size_t oldSize, const std::size_t newSize, const std::size_t blockSize, const std::size_t alignment );
+	bool Resize( void * chunk, const std::size_t oldSize, const std::size_t newSize, const std::size_t blockSize, const std::size_t alignment,
+		const std::size_t headerSize = FullHeaderSize );
 
 	/// Returns true if the chunk is within this memory block.
 	bool HasAddress( const void * chunk, const std::size_t blockSize ) const;
@@ -59,22 +67,24 @@ public:
 	bool IsBelowAddress( const void * chunk, const std::size_t blockSize ) const;
 
 	/// Returns true if this block has enough bytes left to allocate a chunk.
-	bool HasBytesAvailable( const std::size_t bytes, const std::size_t blockSize, const std::size_t alignment ) const;
+	bool HasBytesAvailable( const std::size_t bytes, const std::size_t blockSize, const std::size_t alignment,
+		const std::size_t headerSize = FullHeaderSize ) const;
 
 	bool operator < ( const StackBlock & that ) const
 	{
 		return ( block_ < that.block_ );
 	}
 
-	/// Returns true if this memory block has no allocations.
-	bool IsEmpty( const std::size_t alignment ) const;
-
-	std::size_t GetChunkSize( const unsigned int index, const std::size_t blockSize, const std::size_t alignment ) const;
+	/// Returns size of chunk which is index chunks below the top. Chunks must have headers.
+	std::size_t GetChunkSize( const unsigned int index, const std::size_t blockSize, const std::size_t alignment,
+		const std::size_t headerSize = FullHeaderSize ) const;
 
-	unsigned int GetObjectCount( const std::size_t blockSize, const std::size_t alignment ) const;
+	/// Returns number of chunks in this block. Chunks must have headers.
+	unsigned int GetObjectCount( const std::size_t blockSize, const std::size_t alignment,
+		const std::size_t headerSize = FullHeaderSize ) const;
 
-	/// Returns true if this is corrupt, else false if not corrupt.
-	bool IsCorrupt( std::size_t blockSize, std::size_t alignment ) const;
+	/// Returns true if this is corrupt, else false if not corrupt. Only headers can be checked within a block.
+	bool IsCorrupt( std::size_t blockSize, std::size_t alignment, std::size_t headerSize = FullHeaderSize ) const;
 
 	/// Returns the number of available bytes within this block.
 	std::size_t GetFreeBytes( std::size_t blockSize ) const;
@@ -87,27 +97,10 @@ public:
 // #ifdef MEMWA_DEBUGGING_ALLOCATORS
 
 	/// Used only for debugging. Dumps info on this block to stdout.
-	void OutputContents( std::size_t blockSize, std::size_t alignment ) const;
+	void OutputContents( std::size_t blockSize, std::size_t alignment, std::size_t headerSize = FullHeaderSize ) const;
 
 // #endif
 
-	/// A few bytes of memory in each chunk stores the size of the previous chunk.
-	struct ChunkInfo
-	{
-		const bool IsValid( const unsigned char * block, std::size_t blockSize, const std::size_t alignment ) const;
-		unsigned char * prevChunk_;
-		std::size_t prevChunkSize_;
-	};
-
-private:
-
-	/// Returns address of previous chunk of memory.
-	unsigned char * GetPreviousPlace( unsigned char * chunk, std::size_t blockSize, std::size_t alignment );
-
-	/// Pointer to base of entire memory page allocated.
-	unsigned char * block_;
-	/// Pointer to next free spot within this block.
-	unsigned char * freeSpot_;
 };
 
 // ----------------------------------------------------------------------------
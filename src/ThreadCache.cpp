@@ -0,0 +1,243 @@
+
+#include "ThreadCache.hpp"
+
+#include "LockGuard.hpp"
+
+#include <cassert>
+
+#include <algorithm>
+#include <mutex>
+#include <new>
+
+namespace memwa
+{
+namespace impl
+{
+
+// ----------------------------------------------------------------------------
+
+/** @class ThreadMagazines Container of every magazine used by one thread. Each thread has exactly
+ one of these, and its destructor flushes the magazines back to their owners when the thread exits.
+ */
+class ThreadMagazines
+{
+public:
+
+	ThreadMagazines();
+
+	~ThreadMagazines();
+
+	/// Provides the magazine this thread uses for the owner, or nullptr if this thread has none.
+	Magazine * Find( const MagazineOwner * owner );
+
+	/// Makes a new magazine for the owner, and registers it with both this thread and the owner.
+	Magazine * Add( MagazineOwner * owner );
+
+private:
+
+	typedef std::vector< Magazine * > Magazines;
+	typedef Magazines::iterator MagazinesIter;
+
+	/// Deletes magazines whose owners were destroyed.
+	void RemoveDetached();
+
+	Magazines magazines_;
+
+};
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+/// Guards the magazine containers of every MagazineOwner. Never taken on the allocate or release path.
+std::mutex & GetMagazineMutex()
+{
+	static std::mutex mutex;
+	return mutex;
+}
+
+/// Most recently used magazine of this thread. Checked first so the common case avoids any search.
+thread_local Magazine * recentMagazine = nullptr;
+
+thread_local ThreadMagazines threadMagazines;
+
+} // end anonymous namespace
+
+// ----------------------------------------------------------------------------
+
+Magazine::Magazine( MagazineOwner * owner, unsigned int capacity ) :
+	owner_( owner ),
+	count_( 0 ),
+	capacity_( capacity ),
+	chunks_( new void * [ capacity ] ),
+	state_( nullptr )
+{
+}
+
+// ----------------------------------------------------------------------------
+
+Magazine::~Magazine()
+{
+	delete [] chunks_;
+}
+
+// ----------------------------------------------------------------------------
+
+ThreadMagazines::ThreadMagazines() :
+	magazines_()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+ThreadMagazines::~ThreadMagazines()
+{
+	LockGuard guard( GetMagazineMutex() );
+	const MagazinesIter end( magazines_.end() );
+	for ( MagazinesIter it( magazines_.begin() ); it != end; ++it )
+	{
+		Magazine * magazine = *it;
+		MagazineOwner * owner = magazine->owner_.load();
+		if ( nullptr != owner )
+		{
+			// The owner can't be destroyed while this holds the magazine mutex, so it is safe to flush.
+			owner->FlushMagazine( *magazine );
+			MagazineOwner::Magazines & owned = owner->magazines_;
+			owned.erase( std::remove( owned.begin(), owned.end(), magazine ), owned.end() );
+		}
+		delete magazine;
+	}
+	magazines_.clear();
+	recentMagazine = nullptr;
+}
+
+// ----------------------------------------------------------------------------
+
+Magazine * ThreadMagazines::Find( const MagazineOwner * owner )
+{
+	const MagazinesIter end( magazines_.end() );
+	for ( MagazinesIter it( magazines_.begin() ); it != end; ++it )
+	{
+		Magazine * magazine = *it;
+		if ( magazine->owner_.load( std::memory_order_relaxed ) == owner )
+		{
+			return magazine;
+		}
+	}
+	return nullptr;
+}
+
+// ----------------------------------------------------------------------------
+
+Magazine * ThreadMagazines::Add( MagazineOwner * owner )
+{
+	RemoveDetached();
+	Magazine * magazine = new Magazine( owner, owner->capacity_ );
+	try
+	{
+		LockGuard guard( GetMagazineMutex() );
+		magazines_.push_back( magazine );
+		owner->magazines_.push_back( magazine );
+	}
+	catch ( ... )
+	{
+		magazines_.erase( std::remove( magazines_.begin(), magazines_.end(), magazine ), magazines_.end() );
+		delete magazine;
+		throw std::bad_alloc();
+	}
+	return magazine;
+}
+
+// ----------------------------------------------------------------------------
+
+void ThreadMagazines::RemoveDetached()
+{
+	// A detached magazine is no longer referenced by any owner, so only this thread can see it.
+	MagazinesIter here( magazines_.begin() );
+	const MagazinesIter end( magazines_.end() );
+	for ( MagazinesIter it( here ); it != end; ++it )
+	{
+		Magazine * magazine = *it;
+		if ( nullptr == magazine->owner_.load() )
+		{
+			if ( recentMagazine == magazine )
+			{
+				recentMagazine = nullptr;
+			}
+			delete magazine;
+		}
+		else
+		{
+			*here = magazine;
+			++here;
+		}
+	}
+	magazines_.erase( here, end );
+}
+
+// ----------------------------------------------------------------------------
+
+MagazineOwner::MagazineOwner( unsigned int capacity ) :
+	magazines_(),
+	capacity_( capacity )
+{
+}
+
+// ----------------------------------------------------------------------------
+
+MagazineOwner::~MagazineOwner()
+{
+	DetachMagazines();
+}
+
+// ----------------------------------------------------------------------------
+
+Magazine * MagazineOwner::GetMagazine()
+{
+	Magazine * magazine = recentMagazine;
+	if ( ( nullptr != magazine ) && ( magazine->owner_.load( std::memory_order_relaxed ) == this ) )
+	{
+		return magazine;
+	}
+	magazine = threadMagazines.Find( this );
+	if ( nullptr == magazine )
+	{
+		magazine = threadMagazines.Add( this );
+	}
+	recentMagazine = magazine;
+	return magazine;
+}
+
+// ----------------------------------------------------------------------------
+
+bool MagazineOwner::FlushThreadMagazine()
+{
+	Magazine * magazine = threadMagazines.Find( this );
+	if ( ( nullptr == magazine ) || magazine->IsEmpty() )
+	{
+		return false;
+	}
+	FlushMagazine( *magazine );
+	return true;
+}
+
+// ----------------------------------------------------------------------------
+
+void MagazineOwner::DetachMagazines()
+{
+	LockGuard guard( GetMagazineMutex() );
+	const Magazines::iterator end( magazines_.end() );
+	for ( Magazines::iterator it( magazines_.begin() ); it != end; ++it )
+	{
+		Magazine * magazine = *it;
+		magazine->owner_.store( nullptr );
+	}
+	magazines_.clear();
+}
+
+// ----------------------------------------------------------------------------
+
+} // end internal namespace
+
+} // end project namespace
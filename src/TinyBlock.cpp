@@ -14,10 +14,9 @@ namespace memwa
 
 // ----------------------------------------------------------------------------
 
-TinyBlock::TinyBlock( std::size_t blockSize, std::size_t objectSize, std::size_t alignment, unsigned int objectsPerPool ) :
-    block_( static_cast< unsigned char * >( ::malloc( blockSize ) ) ),
-    freeSpot_( 0 ),
-    freeSpotCount_( UCHAR_MAX )
+TinyBlock::TinyBlock( std::size_t blockSize, std::size_t objectSize, std::size_t alignment, unsigned int objectsPerPool,
+    std::size_t blockAlignment, BlockSource * source ) :
+    impl::HotTinyBlock( static_cast< unsigned char * >( impl::AllocateBlock( blockSize, blockAlignment, source ) ) )
 {
 /*    std::cout << __FUNCTION__ << " : " << __LINE__ << "   blockSize:" << blockSize
         << "   objectsPerPool: " << objectsPerPool
@@ -32,11 +31,7 @@ TinyBlock::TinyBlock( std::size_t blockSize, std::size_t objectSize, std::size_t
     }
     std::size_t blockPlace = reinterpret_cast< std::size_t >( block_ );
     assert( blockPlace % alignment == 0 );
-    unsigned char i = 0;
-    for ( unsigned char * place = block_; i < UCHAR_MAX; place += objectSize )
-    {
-        *place = ++i;
-    }
+    (void)blockPlace;
     assert( IsValid() );
 //    std::cout << __FUNCTION__ << " : " << __LINE__ << std::endl;
 }
@@ -44,9 +39,7 @@ TinyBlock::TinyBlock( std::size_t blockSize, std::size_t objectSize, std::size_t
 // ----------------------------------------------------------------------------
 
 TinyBlock::TinyBlock( std::size_t objectSize ) :
-    block_( static_cast< unsigned char * >( ::malloc( objectSize * UCHAR_MAX ) ) ),
-    freeSpot_( 0 ),
-    freeSpotCount_( UCHAR_MAX )
+    impl::HotTinyBlock( static_cast< unsigned char * >( impl::AllocateBlock( objectSize * UCHAR_MAX, 0, nullptr ) ) )
 {
 //    std::cout << __FUNCTION__ << " : " << __LINE__ << std::endl;
     assert( nullptr != block_ );
@@ -55,85 +48,21 @@ TinyBlock::TinyBlock( std::size_t objectSize ) :
     {
         throw std::bad_alloc();
     }
-    unsigned char i = 0;
-    for ( unsigned char * place = block_; i != UCHAR_MAX; place += objectSize )
-    {
-        *place = ++i;
-    }
     assert( IsValid() );
 }
 
 // ----------------------------------------------------------------------------
 
-void TinyBlock::Destroy()
+void TinyBlock::Destroy( std::size_t blockSize, std::size_t blockAlignment, BlockSource * source )
 {
     assert( IsValid() );
     assert( nullptr != block_ );
-    ::free( static_cast< void * >( block_ ) );
+    impl::ReleaseBlock( block_, blockSize, blockAlignment, source );
     block_ = nullptr;
     freeSpot_ = 0;
     freeSpotCount_ = UCHAR_MAX;
-}
-
-// ----------------------------------------------------------------------------
-
-void * TinyBlock::Allocate( std::size_t objectSize )
-{
-    assert( IsValid() );
-    assert( nullptr != block_ );
-    assert( objectSize <= TinyBlock::MaxObjectSize );
-    if ( IsFull() )
-    {
-        return nullptr;
-    }
-
-    assert( ( freeSpot_ * objectSize ) / objectSize == freeSpot_ );
-    const std::size_t offset = freeSpot_ * objectSize;
-    unsigned char * pResult = block_ + offset;
-    freeSpot_ = *pResult;
-    --freeSpotCount_;
-
-    return pResult;
-}
-
-// ----------------------------------------------------------------------------
-
-void TinyBlock::Release( void * place, std::size_t objectSize )
-{
-    assert( IsValid() );
-    assert( nullptr != block_ );
-    assert( objectSize <= TinyBlock::MaxObjectSize );
-    assert( nullptr != place );
-    unsigned char * toRelease = static_cast< unsigned char * >( place );
-    assert( toRelease >= block_ );
-    const std::size_t offset = static_cast< std::size_t >( toRelease - block_ );
-/*
-    std::cout << __FUNCTION__ << " : " << __LINE__
-        << "   block: " << reinterpret_cast< std::size_t >( block_ )
-        << "  place: " << reinterpret_cast< std::size_t >( place )
-        << "   size: " << objectSize << "   offset: " << offset << std::endl;
-*/
-    // Alignment check
-    assert( offset % objectSize == 0 );
-    assert( offset / objectSize <= UCHAR_MAX );
-    unsigned char index = static_cast< unsigned char >( offset / objectSize );
-
-#if defined(DEBUG) || defined(_DEBUG)
-    // Check if block was already deleted.  Attempting to delete the same
-    // block more than once causes TinyBlock's linked-list of stealth indexes to
-    // become corrupt.  And causes count of freeSpotCount_ to be wrong.
-    if ( 0 < freeSpotCount_ )
-    {
-        assert( freeSpot_ != index );
-    }
-#endif
-
-    *toRelease = freeSpot_;
-    freeSpot_ = index;
-    // Truncation check
-    assert( freeSpot_ == offset / objectSize );
-
-    ++freeSpotCount_;
+    untouched_ = 0;
+    listPosition_ = NotListed;
 }
 
 // ----------------------------------------------------------------------------
@@ -154,7 +83,10 @@ bool TinyBlock::IsValid() const
     {
         assert( freeSpot_ == 0 );
         assert( freeSpotCount_ == UCHAR_MAX );
+        assert( untouched_ == 0 );
     }
+    assert( freeSpot_ <= untouched_ );
+    assert( UCHAR_MAX - untouched_ <= freeSpotCount_ );
     return true;
 }
 
@@ -176,31 +108,25 @@ bool TinyBlock::IsCorrupt( std::size_t objectSize ) const
      found on the linked-list.
      */
     std::bitset< UCHAR_MAX > foundBlocks;
-    unsigned char * nextBlock = nullptr;
 
     /* The loop goes along singly linked-list of stealth indexes and makes sure
-     that each index is within bounds (0 <= index < UCHAR_MAX) and that the
+     that each index is within bounds (0 <= index < untouched_) and that the
      index was not already found while traversing the linked-list.  The linked-
-     list should have exactly freeSpotCount_ nodes, so the for loop will not
-     check more than freeSpotCount_.  This loop can't check inside allocated
+     list ends at untouched_, and should have exactly as many nodes as there
+     are released blocks - which is freeSpotCount_ minus the number of blocks
+     which were never allocated.  This loop can't check inside allocated
      blocks for corruption since such blocks are not within the linked-list.
      Contents of allocated blocks are not changed by TinyBlock.
 
-      freeSpotCount_ == 5
+      freeSpotCount_ == 5, untouched_ == 60
       freeSpot_ -> 17 -> 29 -> 53 -> *17* -> 29 -> 53 ...
       No index should be repeated within the linked-list since that would
       indicate the presence of a loop in the linked-list.
      */
-    for ( unsigned char cc = 0; ; )
+    const unsigned int releasedCount = freeSpotCount_ - ( UCHAR_MAX - untouched_ );
+    for ( unsigned int cc = 0; cc < releasedCount; ++cc )
     {
-        nextBlock = block_ + ( index * objectSize );
-        foundBlocks.set( index, true );
-        ++cc;
-        if ( cc >= freeSpotCount_ )
-            // Successfully counted off number of nodes in linked-list.
-            break;
-        index = *nextBlock;
-        if ( foundBlocks.test( index ) )
+        if ( ( index >= untouched_ ) || foundBlocks.test( index ) )
         {
             /* This implies that a block was corrupted due to a stray pointer
              or an operation on a nearby block overran the size of the block.
@@ -209,8 +135,10 @@ bool TinyBlock::IsCorrupt( std::size_t objectSize ) const
             assert( false );
             return true;
         }
+        foundBlocks.set( index, true );
+        index = *( block_ + ( index * objectSize ) );
     }
-    if ( foundBlocks.count() != freeSpotCount_ )
+    if ( index != untouched_ )
     {
         /* This implies that the singly-linked-list of stealth indexes was
          corrupted.  Ideally, this should have been detected within the loop.
@@ -1,12 +1,16 @@
 
 #pragma once
 
+#include "HotBlock.hpp"
+
 #include <cstddef> // For std::size_t.
 #include <climits> // For UCHAR_MAX.
 
 namespace memwa
 {
 
+class BlockSource;
+
 // ----------------------------------------------------------------------------
 
 /** @struct TinyBlock
@@ -41,40 +45,42 @@ namespace memwa
  A TinyBlock is corrupt if this singly-linked list has a loop or is shorter
  than freeSpotCount_.  Much of the allocator's time and space efficiency
  comes from how these stealth indexes are implemented.
+
+ @par Untouched Blocks
+ Blocks at or above untouched_ were never allocated, so no stealth index is
+ written into them when the TinyBlock is made.  The linked-list of stealth
+ indexes only goes through released blocks, and always ends at untouched_.
+ Allocating the block at untouched_ just bumps untouched_ instead of reading
+ a stealth index.  This makes construction O(1), and blocks which are never
+ allocated are never touched.
+
+ @par Inline Functions
+ The fields and the constant time functions to allocate and release a block
+ are in impl::HotTinyBlock, so TinyObjectAllocator can inline them.
  */
-class TinyBlock
+class TinyBlock : public impl::HotTinyBlock
 {
 public:
 
     static const std::size_t MaxObjectSize = UCHAR_MAX;
 
+    /// Provides number of bytes in each block. Every TinyBlock holds UCHAR_MAX chunks, so blockSize is not used.
+    static std::size_t GetBlockSize( std::size_t blockSize, std::size_t objectSize )
+    {
+        (void)blockSize;
+        return objectSize * UCHAR_MAX;
+    }
+
     /** Initializes a TinyBlock.
      @param objectSize Number of bytes per object.
      */
     explicit TinyBlock( std::size_t objectSize );
 
-    TinyBlock( std::size_t blockSize, std::size_t alignedSize, std::size_t alignment, unsigned int objectsPerPool );
+    TinyBlock( std::size_t blockSize, std::size_t alignedSize, std::size_t alignment, unsigned int objectsPerPool,
+        std::size_t blockAlignment = 0, BlockSource * source = nullptr );
 
-    /** Allocate a block within the TinyBlock.  Complexity is always O(1), and
-     this will never throw.  Does not actually "allocate" by calling
-     malloc, new, or any other function, but merely adjusts some internal
-     indexes to indicate an already allocated block is no longer available.
-     @return Pointer to block within TinyBlock.
-     */
-    void * Allocate( std::size_t objectSize );
-
-    /** Deallocate a block within the TinyBlock. Complexity is always O(1), and
-     this will never throw.  For efficiency, this assumes the address is
-     within the block and aligned along the correct byte boundary.  An
-     assertion checks the alignment, and a call to HasBlock is done from
-     within VicinityFind.  Does not actually "deallocate" by calling free,
-     delete, or other function, but merely adjusts some internal indexes to
-     indicate a block is now available.
-     */
-    void Release( void * place, std::size_t objectSize );
-
-    /// Releases the allocated block of memory.
-    void Destroy();
+    /// Releases the allocated block of memory. Parameters must be the same ones passed to the constructor.
+    void Destroy( std::size_t blockSize = 0, std::size_t blockAlignment = 0, BlockSource * source = nullptr );
 
     /** Determines if the TinyBlock has been corrupted.
      @param objectSize # of bytes in each object.
@@ -84,13 +90,6 @@ public:
 
     bool IsValid() const;
 
-    /// Returns true if block at address P is inside this TinyBlock.
-    bool HasAddress( const void * place, std::size_t blockSize ) const
-    {
-        const unsigned char * const here = static_cast< const unsigned char * >( place );
-        return ( block_ <= here ) && ( here < block_ + blockSize );
-    }
-
     bool IsBelowAddress( const void * place, std::size_t blockSize ) const;
 
     bool operator < ( const TinyBlock & that ) const
@@ -103,27 +102,6 @@ public:
         return ( nullptr == block_ );
     }
 
-    bool IsEmpty() const
-    {
-        return ( UCHAR_MAX == freeSpotCount_ );
-    }
-
-    bool IsFull() const
-    {
-        return ( 0 == freeSpotCount_ );
-    }
-
-    unsigned int GetInUseCount() const
-    {
-        return ( UCHAR_MAX - freeSpotCount_ );
-    }
-
-    /// Pointer to array of allocated blocks.
-    unsigned char * block_;
-    /// Index of first empty block.
-    unsigned char freeSpot_;
-    /// Count of empty blocks.
-    unsigned char freeSpotCount_;
 };
 
 // ----------------------------------------------------------------------------
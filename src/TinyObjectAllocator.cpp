@@ -2,31 +2,92 @@
 #include <TinyObjectAllocator.hpp>
 
 #include "TinyBlock.hpp"
+#include "WideTinyObjectAllocator.hpp"
+#include "WideTinyBlock.hpp"
 #include "ManagerImpl.hpp"
 #include "LockGuard.hpp"
 
 #include <cassert>
 
+#include <atomic>
+#include <thread>
+
+#if defined( __linux__ )
+    #include <sched.h>
+    #if defined( __has_include ) && defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __aarch64__ ) )
+        #if __has_include( <sys/rseq.h> )
+            // Glibc 2.35 and later registers a restartable sequences area for each thread.
+            #include <sys/rseq.h>
+            #define MEMWA_HAS_RSEQ
+        #endif
+    #endif
+#endif
+
 namespace memwa
 {
 
+namespace
+{
+
 // ----------------------------------------------------------------------------
 
-TinyObjectAllocator::TinyObjectAllocator( unsigned int initialBlocks, std::size_t objectSize, std::size_t alignment ) :
-    info_( initialBlocks, objectSize * UCHAR_MAX, objectSize, alignment )
+/// Provides number of CPU the calling thread is running on, or some other small number which differs between threads.
+unsigned int GetCurrentCpu()
 {
-    assert( objectSize <= TinyBlock::MaxObjectSize );
+#if defined( MEMWA_HAS_RSEQ )
+    if ( 0 < __rseq_size )
+    {
+        // The kernel writes the current CPU into the area whenever it moves the thread, so reading it costs one load.
+        const volatile struct rseq * area = reinterpret_cast< const volatile struct rseq * >(
+            static_cast< char * >( __builtin_thread_pointer() ) + __rseq_offset );
+        const std::int32_t cpu = static_cast< std::int32_t >( area->cpu_id );
+        if ( 0 <= cpu )
+        {
+            return static_cast< unsigned int >( cpu );
+        }
+    }
+#endif
+#if defined( __linux__ )
+    const int cpu = ::sched_getcpu();
+    if ( 0 <= cpu )
+    {
+        return static_cast< unsigned int >( cpu );
+    }
+#endif
+    // Without a way to ask for the CPU, spread threads across shards in the order they first allocate.
+    static std::atomic< unsigned int > threadCount( 0 );
+    thread_local const unsigned int threadNumber = threadCount++;
+    return threadNumber;
 }
 
 // ----------------------------------------------------------------------------
 
-TinyObjectAllocator::~TinyObjectAllocator( void )
+} // end anonymous namespace
+
+// ----------------------------------------------------------------------------
+
+template < class BlockType, class BlockInfoType, class HotBlockType >
+AnyTinyObjectAllocator< BlockType, BlockInfoType, HotBlockType >::AnyTinyObjectAllocator( unsigned int initialBlocks, std::size_t blockSize,
+    std::size_t objectSize, std::size_t alignment, bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source ) :
+    info_( initialBlocks, BlockType::GetBlockSize( blockSize, objectSize ), objectSize, alignment,
+        alignedBlocks ? impl::CalculateBlockAlignment( BlockType::GetBlockSize( blockSize, objectSize ) ) : 0, retainedEmptyBlocks, source ),
+    hot_( nullptr ),
+    hotEnabled_( true )
 {
+    assert( objectSize <= BlockType::MaxObjectSize );
 }
 
 // ----------------------------------------------------------------------------
 
-void * TinyObjectAllocator::Allocate( std::size_t size, const void * hint )
+template < class BlockType, class BlockInfoType, class HotBlockType >
+AnyTinyObjectAllocator< BlockType, BlockInfoType, HotBlockType >::~AnyTinyObjectAllocator( void )
+{
+}
+
+// ----------------------------------------------------------------------------
+
+template < class BlockType, class BlockInfoType, class HotBlockType >
+void * AnyTinyObjectAllocator< BlockType, BlockInfoType, HotBlockType >::Allocate( std::size_t size, const void * hint )
 {
     const std::size_t alignedSize = memwa::impl::CalculateAlignedSize( size, info_.alignment_ );
     if ( info_.objectSize_ < alignedSize )
@@ -34,75 +95,78 @@ void * TinyObjectAllocator::Allocate( std::size_t size, const void * hint )
         throw std::invalid_argument( "Error! Requested size is too large for TinyObjectAllocator." );
     }
 
+    hot_ = nullptr;
     void * place = info_.Allocate( hint );
-    if ( nullptr != place )
+    // Call this class's TrimEmptyBlocks directly, since a thread-safe allocator already holds its lock.
+    if ( ( nullptr == place ) && AnyTinyObjectAllocator::TrimEmptyBlocks() )
     {
-        return place;
+        place = info_.Allocate( hint );
     }
-    if ( TrimEmptyBlocks() )
+    if ( nullptr == place )
     {
+        memwa::impl::ManagerImpl::GetManager()->TrimEmptyBlocks( this );
         place = info_.Allocate( hint );
-        if ( nullptr != place )
+        if ( nullptr == place )
         {
-            return place;
+            throw std::bad_alloc();
         }
     }
-    memwa::impl::ManagerImpl::GetManager()->TrimEmptyBlocks( this );
-    place = info_.Allocate( hint );
-    if ( nullptr == place )
-    {
-        throw std::bad_alloc();
-    }
+    SetHotBlock();
 
     return place;
 }
 
 // ----------------------------------------------------------------------------
 
+template < class BlockType, class BlockInfoType, class HotBlockType >
 #if __cplusplus > 201402L
-void * TinyObjectAllocator::Allocate( std::size_t size, std::align_val_t alignment, const void * hint )
+void * AnyTinyObjectAllocator< BlockType, BlockInfoType, HotBlockType >::Allocate( std::size_t size, std::align_val_t alignment, const void * hint )
 #else
-void * TinyObjectAllocator::Allocate( std::size_t size, std::size_t alignment, const void * hint )
+void * AnyTinyObjectAllocator< BlockType, BlockInfoType, HotBlockType >::Allocate( std::size_t size, std::size_t alignment, const void * hint )
 #endif
 {
-    if ( alignment > info_.alignment_ )
+    if ( impl::GetAlignmentSize( alignment ) > info_.alignment_ )
     {
         throw std::invalid_argument( "Requested alignment size must be less than or equal to initial alignment size." );
     }
-    void * place = TinyObjectAllocator::Allocate( size, hint );
+    void * place = AnyTinyObjectAllocator::Allocate( size, hint );
     return place;
 }
 
 // ----------------------------------------------------------------------------
 
-bool TinyObjectAllocator::Release( void * place, std::size_t objectSize )
+template < class BlockType, class BlockInfoType, class HotBlockType >
+bool AnyTinyObjectAllocator< BlockType, BlockInfoType, HotBlockType >::Release( void * place, std::size_t objectSize )
 {
     if ( nullptr == place )
     {
         return false;
     }
-    assert( objectSize <= TinyBlock::MaxObjectSize );
+    assert( objectSize <= BlockType::MaxObjectSize );
     if ( memwa::impl::CalculateAlignedSize( objectSize, info_.alignment_ ) != info_.objectSize_ )
     {
         throw std::invalid_argument( "Requested object size does not match pool object size." );
     }
+    hot_ = nullptr;
     const bool success = info_.Release( place );
+    SetHotBlock();
     return success;
 }
 
 // ----------------------------------------------------------------------------
 
+template < class BlockType, class BlockInfoType, class HotBlockType >
 #if __cplusplus > 201402L
-bool TinyObjectAllocator::Release( void * place, std::size_t size, std::align_val_t alignment )
+bool AnyTinyObjectAllocator< BlockType, BlockInfoType, HotBlockType >::Release( void * place, std::size_t size, std::align_val_t alignment )
 #else
-bool TinyObjectAllocator::Release( void * place, std::size_t size, std::size_t alignment )
+bool AnyTinyObjectAllocator< BlockType, BlockInfoType, HotBlockType >::Release( void * place, std::size_t size, std::size_t alignment )
 #endif
 {
     if ( nullptr == place )
     {
         return false;
     }
-    if ( alignment != info_.alignment_ )
+    if ( impl::GetAlignmentSize( alignment ) != info_.alignment_ )
     {
         throw std::invalid_argument( "Requested alignment must match initial alignment." );
     }
@@ -110,14 +174,57 @@ bool TinyObjectAllocator::Release( void * place, std::size_t size, std::size_t a
     {
         throw std::invalid_argument( "Requested object size does not match pool object size." );
     }
-    assert( size <= TinyBlock::MaxObjectSize );
+    assert( size <= BlockType::MaxObjectSize );
+    hot_ = nullptr;
     const bool success = info_.Release( place );
+    SetHotBlock();
     return success;
 }
 
 // ----------------------------------------------------------------------------
 
-unsigned long long TinyObjectAllocator::GetMaxSize( std::size_t objectSize ) const
+template < class BlockType, class BlockInfoType, class HotBlockType >
+void AnyTinyObjectAllocator< BlockType, BlockInfoType, HotBlockType >::AllocateBulk( void ** places, std::size_t count, std::size_t size,
+    const void * hint )
+{
+    const std::size_t alignedSize = memwa::impl::CalculateAlignedSize( size, info_.alignment_ );
+    if ( info_.objectSize_ < alignedSize )
+    {
+        throw std::invalid_argument( "Error! Requested size is too large for TinyObjectAllocator." );
+    }
+
+    hot_ = nullptr;
+    try
+    {
+        info_.AllocateBulk( places, count, hint );
+    }
+    catch ( const std::bad_alloc & )
+    {
+        memwa::impl::ManagerImpl::GetManager()->TrimEmptyBlocks( this );
+        info_.AllocateBulk( places, count, hint );
+    }
+    SetHotBlock();
+}
+
+// ----------------------------------------------------------------------------
+
+template < class BlockType, class BlockInfoType, class HotBlockType >
+bool AnyTinyObjectAllocator< BlockType, BlockInfoType, HotBlockType >::ReleaseBulk( void ** places, std::size_t count, std::size_t size )
+{
+    if ( memwa::impl::CalculateAlignedSize( size, info_.alignment_ ) != info_.objectSize_ )
+    {
+        throw std::invalid_argument( "Requested object size does not match pool object size." );
+    }
+    hot_ = nullptr;
+    const bool success = info_.ReleaseBulk( places, count );
+    SetHotBlock();
+    return success;
+}
+
+// ----------------------------------------------------------------------------
+
+template < class BlockType, class BlockInfoType, class HotBlockType >
+unsigned long long AnyTinyObjectAllocator< BlockType, BlockInfoType, HotBlockType >::GetMaxSize( std::size_t objectSize ) const
 {
     const unsigned long long bytesAvailable = memwa::impl::GetTotalAvailableMemory();
     const unsigned long long maxPossibleObjects = bytesAvailable / objectSize;
@@ -126,7 +233,8 @@ unsigned long long TinyObjectAllocator::GetMaxSize( std::size_t objectSize ) con
 
 // ----------------------------------------------------------------------------
 
-bool TinyObjectAllocator::HasAddress( void * place ) const
+template < class BlockType, class BlockInfoType, class HotBlockType >
+bool AnyTinyObjectAllocator< BlockType, BlockInfoType, HotBlockType >::HasAddress( void * place ) const
 {
     const bool hasIt = info_.HasAddress( place );
     return hasIt;
@@ -134,22 +242,43 @@ bool TinyObjectAllocator::HasAddress( void * place ) const
 
 // ----------------------------------------------------------------------------
 
-bool TinyObjectAllocator::TrimEmptyBlocks( void )
+template < class BlockType, class BlockInfoType, class HotBlockType >
+bool AnyTinyObjectAllocator< BlockType, BlockInfoType, HotBlockType >::TrimEmptyBlocks( void )
 {
+    hot_ = nullptr;
     const bool trimmed = info_.TrimEmptyBlocks();
+    SetHotBlock();
     return trimmed;
 }
 
 // ----------------------------------------------------------------------------
 
-void TinyObjectAllocator::Destroy()
+template < class BlockType, class BlockInfoType, class HotBlockType >
+void AnyTinyObjectAllocator< BlockType, BlockInfoType, HotBlockType >::Destroy()
 {
+    hot_ = nullptr;
     info_.Destroy();
 }
 
 // ----------------------------------------------------------------------------
 
-bool TinyObjectAllocator::IsCorrupt( void ) const
+template < class BlockType, class BlockInfoType, class HotBlockType >
+void AnyTinyObjectAllocator< BlockType, BlockInfoType, HotBlockType >::SetHotBlock()
+{
+    if ( hotEnabled_ && ( info_.recent_ != info_.blocks_.end() ) )
+    {
+        hot_ = &( *info_.recent_ );
+    }
+    else
+    {
+        hot_ = nullptr;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template < class BlockType, class BlockInfoType, class HotBlockType >
+bool AnyTinyObjectAllocator< BlockType, BlockInfoType, HotBlockType >::IsCorrupt( void ) const
 {
     assert( nullptr != this );
     const bool corrupt = info_.IsCorrupt();
@@ -158,7 +287,8 @@ bool TinyObjectAllocator::IsCorrupt( void ) const
 
 // ----------------------------------------------------------------------------
 
-float TinyObjectAllocator::GetFragmentationPercent() const
+template < class BlockType, class BlockInfoType, class HotBlockType >
+float AnyTinyObjectAllocator< BlockType, BlockInfoType, HotBlockType >::GetFragmentationPercent() const
 {
     const unsigned int poolCount = info_.blocks_.size();
     if ( 0 == poolCount )
@@ -166,14 +296,14 @@ float TinyObjectAllocator::GetFragmentationPercent() const
         return 0.0;
     }
     unsigned int objectCount = 0;
-    TinyBlockInfo::BlocksCIter end( info_.blocks_.end() );
-    for ( TinyBlockInfo::BlocksCIter it( info_.blocks_.begin() ); it != end; ++it )
+    typename BlockInfoType::BlocksCIter end( info_.blocks_.end() );
+    for ( typename BlockInfoType::BlocksCIter it( info_.blocks_.begin() ); it != end; ++it )
     {
-        const TinyBlock & block = *it;
+        const BlockType & block = *it;
         objectCount += block.GetInUseCount();
     }
 
-    const unsigned int objectsPerPool = ( info_.blockSize_ / info_.objectSize_ );
+    const unsigned int objectsPerPool = BlockType::GetObjectsPerBlock( info_.blockSize_, info_.objectSize_ );
     std::size_t poolsNeeded = objectCount / objectsPerPool;
     if ( objectCount % objectsPerPool != 0 )
     {
@@ -186,109 +316,555 @@ float TinyObjectAllocator::GetFragmentationPercent() const
 
 // ----------------------------------------------------------------------------
 
-ThreadSafeTinyObjectAllocator::ThreadSafeTinyObjectAllocator( unsigned int initialBlocks, std::size_t objectSize, std::size_t alignment ) :
-    TinyObjectAllocator( initialBlocks, objectSize, alignment ),
+template class AnyTinyObjectAllocator< TinyBlock, TinyBlockInfo, impl::HotTinyBlock >;
+template class AnyTinyObjectAllocator< WideTinyBlock, WideTinyBlockInfo, WideTinyBlock >;
+
+// ----------------------------------------------------------------------------
+
+TinyObjectAllocator::TinyObjectAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize, std::size_t alignment,
+    bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source ) :
+    AnyTinyObjectAllocator( initialBlocks, blockSize, objectSize, alignment, alignedBlocks, retainedEmptyBlocks, source )
+{
+}
+
+// ----------------------------------------------------------------------------
+
+TinyObjectAllocator::~TinyObjectAllocator( void )
+{
+}
+
+// ----------------------------------------------------------------------------
+
+template < class TinyType >
+AnyThreadSafeTinyObjectAllocator< TinyType >::AnyThreadSafeTinyObjectAllocator( unsigned int initialBlocks, std::size_t blockSize,
+    std::size_t objectSize, std::size_t alignment, bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source ) :
+    TinyType( initialBlocks, blockSize, objectSize, alignment, alignedBlocks, retainedEmptyBlocks, source ),
     mutex_()
 {
+    // Other threads may change the hot block, so FastAllocate and FastRelease always call the locking functions.
+    TinyType::hotEnabled_ = false;
 }
 
 // ----------------------------------------------------------------------------
 
-ThreadSafeTinyObjectAllocator::~ThreadSafeTinyObjectAllocator()
+template < class TinyType >
+AnyThreadSafeTinyObjectAllocator< TinyType >::~AnyThreadSafeTinyObjectAllocator()
 {
 }
 
 // ----------------------------------------------------------------------------
 
-void * ThreadSafeTinyObjectAllocator::Allocate( std::size_t size, const void * hint )
+template < class TinyType >
+void * AnyThreadSafeTinyObjectAllocator< TinyType >::Allocate( std::size_t size, const void * hint )
 {
     LockGuard guard( mutex_ );
     assert( guard.owns_lock() );
-    void * place = TinyObjectAllocator::Allocate( size, hint );
+    void * place = TinyType::Allocate( size, hint );
     return place;
 }
 
 // ----------------------------------------------------------------------------
 
+template < class TinyType >
 #if __cplusplus > 201402L
-void * ThreadSafeTinyObjectAllocator::Allocate( std::size_t size, std::align_val_t alignment, const void * hint )
+void * AnyThreadSafeTinyObjectAllocator< TinyType >::Allocate( std::size_t size, std::align_val_t alignment, const void * hint )
 #else
-void * ThreadSafeTinyObjectAllocator::Allocate( std::size_t size, std::size_t alignment, const void * hint )
+void * AnyThreadSafeTinyObjectAllocator< TinyType >::Allocate( std::size_t size, std::size_t alignment, const void * hint )
 #endif
 {
     LockGuard guard( mutex_ );
     assert( guard.owns_lock() );
-    void * place = TinyObjectAllocator::Allocate( size, alignment, hint );
+    void * place = TinyType::Allocate( size, alignment, hint );
     return place;
 }
 
 // ----------------------------------------------------------------------------
 
-bool ThreadSafeTinyObjectAllocator::Release( void * place, std::size_t size )
+template < class TinyType >
+bool AnyThreadSafeTinyObjectAllocator< TinyType >::Release( void * place, std::size_t size )
 {
     LockGuard guard( mutex_ );
     assert( guard.owns_lock() );
-    const bool released = TinyObjectAllocator::Release( place, size );
+    const bool released = TinyType::Release( place, size );
     return released;
 }
 
 // ----------------------------------------------------------------------------
 
+template < class TinyType >
 #if __cplusplus > 201402L
-bool ThreadSafeTinyObjectAllocator::Release( void * place, std::size_t size, std::align_val_t alignment )
+bool AnyThreadSafeTinyObjectAllocator< TinyType >::Release( void * place, std::size_t size, std::align_val_t alignment )
 #else
-bool ThreadSafeTinyObjectAllocator::Release( void * place, std::size_t size, std::size_t alignment )
+bool AnyThreadSafeTinyObjectAllocator< TinyType >::Release( void * place, std::size_t size, std::size_t alignment )
 #endif
 {
     LockGuard guard( mutex_ );
     assert( guard.owns_lock() );
-    const bool released = TinyObjectAllocator::Release( place, size, alignment );
+    const bool released = TinyType::Release( place, size, alignment );
     return released;
 }
 
 // ----------------------------------------------------------------------------
 
-bool ThreadSafeTinyObjectAllocator::HasAddress( void * place ) const
+template < class TinyType >
+void AnyThreadSafeTinyObjectAllocator< TinyType >::AllocateBulk( void ** places, std::size_t count, std::size_t size, const void * hint )
 {
     LockGuard guard( mutex_ );
     assert( guard.owns_lock() );
-    return TinyObjectAllocator::HasAddress( place );
+    TinyType::AllocateBulk( places, count, size, hint );
 }
 
 // ----------------------------------------------------------------------------
 
-bool ThreadSafeTinyObjectAllocator::TrimEmptyBlocks()
+template < class TinyType >
+bool AnyThreadSafeTinyObjectAllocator< TinyType >::ReleaseBulk( void ** places, std::size_t count, std::size_t size )
 {
     LockGuard guard( mutex_ );
     assert( guard.owns_lock() );
-    return TinyObjectAllocator::TrimEmptyBlocks();
+    const bool released = TinyType::ReleaseBulk( places, count, size );
+    return released;
 }
 
 // ----------------------------------------------------------------------------
 
-bool ThreadSafeTinyObjectAllocator::IsCorrupt() const
+template < class TinyType >
+bool AnyThreadSafeTinyObjectAllocator< TinyType >::HasAddress( void * place ) const
 {
     LockGuard guard( mutex_ );
     assert( guard.owns_lock() );
-    return TinyObjectAllocator::IsCorrupt();
+    return TinyType::HasAddress( place );
 }
 
 // ----------------------------------------------------------------------------
 
-float ThreadSafeTinyObjectAllocator::GetFragmentationPercent() const
+template < class TinyType >
+bool AnyThreadSafeTinyObjectAllocator< TinyType >::TrimEmptyBlocks()
 {
     LockGuard guard( mutex_ );
     assert( guard.owns_lock() );
-    return TinyObjectAllocator::GetFragmentationPercent();
+    return TinyType::TrimEmptyBlocks();
 }
 
 // ----------------------------------------------------------------------------
 
-void ThreadSafeTinyObjectAllocator::Destroy()
+template < class TinyType >
+bool AnyThreadSafeTinyObjectAllocator< TinyType >::IsCorrupt() const
 {
     LockGuard guard( mutex_ );
     assert( guard.owns_lock() );
-    TinyObjectAllocator::Destroy();
+    return TinyType::IsCorrupt();
+}
+
+// ----------------------------------------------------------------------------
+
+template < class TinyType >
+float AnyThreadSafeTinyObjectAllocator< TinyType >::GetFragmentationPercent() const
+{
+    LockGuard guard( mutex_ );
+    assert( guard.owns_lock() );
+    return TinyType::GetFragmentationPercent();
+}
+
+// ----------------------------------------------------------------------------
+
+template < class TinyType >
+void AnyThreadSafeTinyObjectAllocator< TinyType >::Destroy()
+{
+    LockGuard guard( mutex_ );
+    assert( guard.owns_lock() );
+    TinyType::Destroy();
+}
+
+// ----------------------------------------------------------------------------
+
+template class AnyThreadSafeTinyObjectAllocator< TinyObjectAllocator >;
+template class AnyThreadSafeTinyObjectAllocator< WideTinyObjectAllocator >;
+
+// ----------------------------------------------------------------------------
+
+ThreadSafeTinyObjectAllocator::ThreadSafeTinyObjectAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize,
+    std::size_t alignment, bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source ) :
+    AnyThreadSafeTinyObjectAllocator( initialBlocks, blockSize, objectSize, alignment, alignedBlocks, retainedEmptyBlocks, source )
+{
+}
+
+// ----------------------------------------------------------------------------
+
+ThreadSafeTinyObjectAllocator::~ThreadSafeTinyObjectAllocator()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+ShardedTinyObjectAllocator::Shard::Shard( unsigned int initialBlocks, std::size_t objectSize, std::size_t alignment,
+    std::size_t blockAlignment, unsigned int retainedEmptyBlocks, BlockSource * source ) :
+    mutex_(),
+    info_( initialBlocks, objectSize * UCHAR_MAX, objectSize, alignment, blockAlignment, retainedEmptyBlocks, source )
+{
+}
+
+// ----------------------------------------------------------------------------
+
+ShardedTinyObjectAllocator::ShardedTinyObjectAllocator( unsigned int initialBlocks, std::size_t objectSize, std::size_t alignment,
+    unsigned int retainedEmptyBlocks, unsigned int shardCount, BlockSource * source ) :
+    objectSize_( objectSize ),
+    alignment_( alignment ),
+    blockAlignment_( impl::CalculateBlockAlignment( objectSize * UCHAR_MAX ) ),
+    shards_()
+{
+    assert( objectSize <= TinyBlock::MaxObjectSize );
+    if ( AllocatorManager::OneShardPerCpu == shardCount )
+    {
+        shardCount = std::thread::hardware_concurrency();
+    }
+    if ( 0 == shardCount )
+    {
+        shardCount = 1;
+    }
+    else if ( MaxShardCount < shardCount )
+    {
+        shardCount = MaxShardCount;
+    }
+    const unsigned int blocksPerShard = ( initialBlocks + shardCount - 1 ) / shardCount;
+    try
+    {
+        shards_.reserve( shardCount );
+        for ( unsigned int ii = 0; ii < shardCount; ++ii )
+        {
+            shards_.push_back( new Shard( blocksPerShard, objectSize, alignment, blockAlignment_, retainedEmptyBlocks, source ) );
+        }
+    }
+    catch ( ... )
+    {
+        Destroy();
+        for ( Shard * shard : shards_ )
+        {
+            delete shard;
+        }
+        throw;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+ShardedTinyObjectAllocator::~ShardedTinyObjectAllocator()
+{
+    for ( Shard * shard : shards_ )
+    {
+        delete shard;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned int ShardedTinyObjectAllocator::GetShardIndex() const
+{
+    return GetCurrentCpu() % shards_.size();
+}
+
+// ----------------------------------------------------------------------------
+
+void * ShardedTinyObjectAllocator::AllocateFromShard( Shard & shard, unsigned int index, const void * hint )
+{
+    void * place = shard.info_.Allocate( hint );
+    if ( GetBlockStart( place ) == place )
+    {
+        // Chunks are handed out last-released-first, so the first chunk of a block is only free when the
+        // whole block is free, and it is always the first chunk allocated from the block.
+        *static_cast< unsigned char * >( place ) = static_cast< unsigned char >( index );
+        place = shard.info_.Allocate( hint );
+        assert( GetBlockStart( place ) != place );
+    }
+    return place;
+}
+
+// ----------------------------------------------------------------------------
+
+bool ShardedTinyObjectAllocator::ReleaseToShard( Shard & shard, void * place )
+{
+    if ( !shard.info_.Release( place ) )
+    {
+        return false;
+    }
+    unsigned char * start = GetBlockStart( place );
+    TinyBlockInfo::BlocksIter it( shard.info_.GetAlignedBlock( start ) );
+    assert( it != shard.info_.blocks_.end() );
+    if ( it->GetInUseCount() == 1 )
+    {
+        // Only the first chunk is left, so release it to let the block become empty.
+        shard.info_.Release( start );
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+ShardedTinyObjectAllocator::Shard * ShardedTinyObjectAllocator::FindOwner( void * place ) const
+{
+    const unsigned char * start = GetBlockStart( place );
+    if ( ( nullptr == place ) || ( start == place ) )
+    {
+        return nullptr;
+    }
+    const unsigned int index = *start;
+    if ( shards_.size() <= index )
+    {
+        return nullptr;
+    }
+    return shards_[ index ];
+}
+
+// ----------------------------------------------------------------------------
+
+void * ShardedTinyObjectAllocator::Allocate( std::size_t size, const void * hint )
+{
+    if ( objectSize_ < memwa::impl::CalculateAlignedSize( size, alignment_ ) )
+    {
+        throw std::invalid_argument( "Error! Requested size is too large for ShardedTinyObjectAllocator." );
+    }
+    const unsigned int index = GetShardIndex();
+    Shard & shard = *shards_[ index ];
+    LockGuard guard( shard.mutex_ );
+    assert( guard.owns_lock() );
+    try
+    {
+        return AllocateFromShard( shard, index, hint );
+    }
+    catch ( const std::bad_alloc & )
+    {
+        shard.info_.TrimEmptyBlocks();
+        memwa::impl::ManagerImpl::GetManager()->TrimEmptyBlocks( this );
+        return AllocateFromShard( shard, index, hint );
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+#if __cplusplus > 201402L
+void * ShardedTinyObjectAllocator::Allocate( std::size_t size, std::align_val_t alignment, const void * hint )
+#else
+void * ShardedTinyObjectAllocator::Allocate( std::size_t size, std::size_t alignment, const void * hint )
+#endif
+{
+    if ( impl::GetAlignmentSize( alignment ) > alignment_ )
+    {
+        throw std::invalid_argument( "Requested alignment size must be less than or equal to initial alignment size." );
+    }
+    void * place = ShardedTinyObjectAllocator::Allocate( size, hint );
+    return place;
+}
+
+// ----------------------------------------------------------------------------
+
+bool ShardedTinyObjectAllocator::Release( void * place, std::size_t size )
+{
+    if ( memwa::impl::CalculateAlignedSize( size, alignment_ ) != objectSize_ )
+    {
+        throw std::invalid_argument( "Requested object size does not match pool object size." );
+    }
+    Shard * shard = FindOwner( place );
+    if ( nullptr == shard )
+    {
+        return false;
+    }
+    LockGuard guard( shard->mutex_ );
+    assert( guard.owns_lock() );
+    const bool success = ReleaseToShard( *shard, place );
+    return success;
+}
+
+// ----------------------------------------------------------------------------
+
+#if __cplusplus > 201402L
+bool ShardedTinyObjectAllocator::Release( void * place, std::size_t size, std::align_val_t alignment )
+#else
+bool ShardedTinyObjectAllocator::Release( void * place, std::size_t size, std::size_t alignment )
+#endif
+{
+    if ( impl::GetAlignmentSize( alignment ) != alignment_ )
+    {
+        throw std::invalid_argument( "Requested alignment must match initial alignment." );
+    }
+    const bool success = ShardedTinyObjectAllocator::Release( place, size );
+    return success;
+}
+
+// ----------------------------------------------------------------------------
+
+void ShardedTinyObjectAllocator::AllocateBulk( void ** places, std::size_t count, std::size_t size, const void * hint )
+{
+    if ( objectSize_ < memwa::impl::CalculateAlignedSize( size, alignment_ ) )
+    {
+        throw std::invalid_argument( "Error! Requested size is too large for ShardedTinyObjectAllocator." );
+    }
+    const unsigned int index = GetShardIndex();
+    Shard & shard = *shards_[ index ];
+    LockGuard guard( shard.mutex_ );
+    assert( guard.owns_lock() );
+    std::size_t ii = 0;
+    try
+    {
+        for ( ; ii < count; ++ii )
+        {
+            places[ ii ] = AllocateFromShard( shard, index, hint );
+            hint = places[ ii ];
+        }
+    }
+    catch ( const std::bad_alloc & )
+    {
+        // Either all the chunks are allocated or none are.
+        while ( 0 < ii )
+        {
+            --ii;
+            ReleaseToShard( shard, places[ ii ] );
+            places[ ii ] = nullptr;
+        }
+        throw;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+bool ShardedTinyObjectAllocator::ReleaseBulk( void ** places, std::size_t count, std::size_t size )
+{
+    if ( memwa::impl::CalculateAlignedSize( size, alignment_ ) != objectSize_ )
+    {
+        throw std::invalid_argument( "Requested object size does not match pool object size." );
+    }
+    bool success = true;
+    Shard * locked = nullptr;
+    LockGuard guard;
+    for ( std::size_t ii = 0; ii < count; ++ii )
+    {
+        Shard * shard = FindOwner( places[ ii ] );
+        if ( nullptr == shard )
+        {
+            success = false;
+            continue;
+        }
+        if ( shard != locked )
+        {
+            // Chunks allocated together are usually owned by the same shard, so only lock when the owner changes.
+            guard = LockGuard( shard->mutex_ );
+            locked = shard;
+        }
+        if ( !ReleaseToShard( *shard, places[ ii ] ) )
+        {
+            success = false;
+        }
+    }
+    return success;
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned long long ShardedTinyObjectAllocator::GetMaxSize( std::size_t objectSize ) const
+{
+    const unsigned long long bytesAvailable = memwa::impl::GetTotalAvailableMemory();
+    const unsigned long long maxPossibleObjects = bytesAvailable / objectSize;
+    return maxPossibleObjects;
+}
+
+// ----------------------------------------------------------------------------
+
+bool ShardedTinyObjectAllocator::HasAddress( void * place ) const
+{
+    for ( const Shard * shard : shards_ )
+    {
+        LockGuard guard( shard->mutex_ );
+        if ( shard->info_.HasAddress( place ) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+
+bool ShardedTinyObjectAllocator::TrimEmptyBlocks()
+{
+    bool trimmed = false;
+    for ( Shard * shard : shards_ )
+    {
+        LockGuard guard( shard->mutex_ );
+        if ( shard->info_.TrimEmptyBlocks() )
+        {
+            trimmed = true;
+        }
+    }
+    return trimmed;
+}
+
+// ----------------------------------------------------------------------------
+
+bool ShardedTinyObjectAllocator::IsCorrupt() const
+{
+    assert( nullptr != this );
+    for ( ShardsCIter it( shards_.begin() ); it != shards_.end(); ++it )
+    {
+        const Shard * shard = *it;
+        LockGuard guard( shard->mutex_ );
+        if ( shard->info_.IsCorrupt() )
+        {
+            return true;
+        }
+        // The first chunk of every block in use must hold the index of its shard.
+        const unsigned int index = static_cast< unsigned int >( it - shards_.begin() );
+        const TinyBlockInfo::BlocksCIter end( shard->info_.blocks_.end() );
+        for ( TinyBlockInfo::BlocksCIter bit( shard->info_.blocks_.begin() ); bit != end; ++bit )
+        {
+            assert( bit->IsEmpty() || ( 1 < bit->GetInUseCount() ) );
+            assert( bit->IsEmpty() || ( *bit->GetAddress() == index ) );
+        }
+        (void)index;
+    }
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+
+float ShardedTinyObjectAllocator::GetFragmentationPercent() const
+{
+    unsigned int poolCount = 0;
+    unsigned int objectCount = 0;
+    for ( const Shard * shard : shards_ )
+    {
+        LockGuard guard( shard->mutex_ );
+        poolCount += shard->info_.blocks_.size();
+        const TinyBlockInfo::BlocksCIter end( shard->info_.blocks_.end() );
+        for ( TinyBlockInfo::BlocksCIter it( shard->info_.blocks_.begin() ); it != end; ++it )
+        {
+            // Don't count the first chunk, which each block in use keeps to hold its shard index.
+            objectCount += it->IsEmpty() ? 0 : it->GetInUseCount() - 1;
+        }
+    }
+    if ( 0 == poolCount )
+    {
+        return 0.0;
+    }
+
+    // Each block in use keeps its first chunk, so it holds one less object for the caller.
+    const unsigned int objectsPerPool = UCHAR_MAX - 1;
+    std::size_t poolsNeeded = objectCount / objectsPerPool;
+    if ( objectCount % objectsPerPool != 0 )
+    {
+        ++poolsNeeded;
+    }
+    const unsigned int excessPools = poolCount - poolsNeeded;
+    const float percent = (float)excessPools / (float)poolCount;
+    return percent;
+}
+
+// ----------------------------------------------------------------------------
+
+void ShardedTinyObjectAllocator::Destroy()
+{
+    for ( Shard * shard : shards_ )
+    {
+        LockGuard guard( shard->mutex_ );
+        shard->info_.Destroy();
+    }
 }
 
 // ----------------------------------------------------------------------------
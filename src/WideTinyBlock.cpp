@@ -0,0 +1,191 @@
+
+#include "WideTinyBlock.hpp"
+
+#include "ManagerImpl.hpp"
+
+#include <cassert>
+#include <cstring>
+
+#include <stdexcept>
+#include <vector>
+
+namespace memwa
+{
+
+// ----------------------------------------------------------------------------
+
+WideTinyBlock::WideTinyBlock( std::size_t blockSize, std::size_t objectSize, std::size_t alignment, unsigned int objectsPerPool,
+    std::size_t blockAlignment, BlockSource * source ) :
+    block_( static_cast< unsigned char * >( impl::AllocateBlock( blockSize, blockAlignment, source ) ) ),
+    freeSpot_( 0 ),
+    freeSpotCount_( static_cast< std::uint16_t >( objectsPerPool ) ),
+    untouched_( 0 ),
+    objectsPerPool_( static_cast< std::uint16_t >( objectsPerPool ) ),
+    listPosition_( NotListed )
+{
+    assert( blockSize == objectsPerPool * objectSize );
+    assert( 0 < objectsPerPool );
+    assert( objectsPerPool <= WideTinyBlock::MaxObjectsPerBlock );
+    assert( WideTinyBlock::MinObjectSize <= objectSize );
+    assert( objectSize <= WideTinyBlock::MaxObjectSize );
+    if ( nullptr == block_ )
+    {
+        throw std::bad_alloc();
+    }
+    std::size_t blockPlace = reinterpret_cast< std::size_t >( block_ );
+    assert( blockPlace % alignment == 0 );
+    (void)blockPlace;
+    (void)objectSize;
+    (void)alignment;
+    assert( IsValid() );
+}
+
+// ----------------------------------------------------------------------------
+
+void WideTinyBlock::Destroy( std::size_t blockSize, std::size_t blockAlignment, BlockSource * source )
+{
+    assert( IsValid() );
+    assert( nullptr != block_ );
+    impl::ReleaseBlock( block_, blockSize, blockAlignment, source );
+    block_ = nullptr;
+    freeSpot_ = 0;
+    freeSpotCount_ = objectsPerPool_;
+    untouched_ = 0;
+    listPosition_ = NotListed;
+}
+
+// ----------------------------------------------------------------------------
+
+std::uint16_t WideTinyBlock::GetStealthIndex( std::uint16_t index, std::size_t objectSize ) const
+{
+    std::uint16_t next = 0;
+    std::memcpy( &next, block_ + static_cast< std::size_t >( index ) * objectSize, sizeof(next) );
+    return next;
+}
+
+// ----------------------------------------------------------------------------
+
+void * WideTinyBlock::Allocate( std::size_t objectSize )
+{
+    assert( IsValid() );
+    assert( nullptr != block_ );
+    assert( WideTinyBlock::MinObjectSize <= objectSize );
+    if ( IsFull() )
+    {
+        return nullptr;
+    }
+
+    unsigned char * pResult = block_ + static_cast< std::size_t >( freeSpot_ ) * objectSize;
+    if ( freeSpot_ == untouched_ )
+    {
+        // Chunk was never allocated, so it has no stealth index. The next chunk was never allocated either.
+        ++untouched_;
+        freeSpot_ = untouched_;
+    }
+    else
+    {
+        freeSpot_ = GetStealthIndex( freeSpot_, objectSize );
+    }
+    --freeSpotCount_;
+
+    return pResult;
+}
+
+// ----------------------------------------------------------------------------
+
+void WideTinyBlock::Release( void * place, std::size_t objectSize )
+{
+    assert( IsValid() );
+    assert( nullptr != block_ );
+    assert( WideTinyBlock::MinObjectSize <= objectSize );
+    assert( nullptr != place );
+    unsigned char * toRelease = static_cast< unsigned char * >( place );
+    assert( toRelease >= block_ );
+    const std::size_t offset = static_cast< std::size_t >( toRelease - block_ );
+    // Alignment check
+    assert( offset % objectSize == 0 );
+    assert( offset / objectSize < untouched_ );
+    const std::uint16_t index = static_cast< std::uint16_t >( offset / objectSize );
+
+#if defined(DEBUG) || defined(_DEBUG)
+    // Releasing the same chunk twice would make a loop in the list of stealth indexes.
+    if ( 0 < freeSpotCount_ )
+    {
+        assert( freeSpot_ != index );
+    }
+#endif
+
+    std::memcpy( toRelease, &freeSpot_, sizeof(freeSpot_) );
+    freeSpot_ = index;
+    ++freeSpotCount_;
+}
+
+// ----------------------------------------------------------------------------
+
+bool WideTinyBlock::IsBelowAddress( const void * place, std::size_t blockSize ) const
+{
+    assert( IsValid() );
+    const bool below = ( block_ + blockSize <= place );
+    return below;
+}
+
+// ----------------------------------------------------------------------------
+
+bool WideTinyBlock::IsValid() const
+{
+    assert( nullptr != this );
+    if ( nullptr == block_ )
+    {
+        assert( freeSpot_ == 0 );
+        assert( freeSpotCount_ == objectsPerPool_ );
+        assert( untouched_ == 0 );
+    }
+    assert( freeSpot_ <= untouched_ );
+    assert( untouched_ <= objectsPerPool_ );
+    assert( freeSpotCount_ <= objectsPerPool_ );
+    assert( objectsPerPool_ - untouched_ <= freeSpotCount_ );
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool WideTinyBlock::IsCorrupt( std::size_t objectSize ) const
+{
+    assert( IsValid() );
+    assert( WideTinyBlock::MinObjectSize <= objectSize );
+    assert( nullptr != block_ );
+    if ( IsFull() )
+    {
+        // Useless to do further corruption checks if all chunks allocated.
+        return false;
+    }
+
+    /* Walk the list of stealth indexes the same way TinyBlock does. Each index must be below
+     untouched_ and found only once, and the list must end at untouched_ after visiting exactly as
+     many chunks as were released.
+     */
+    std::vector< bool > foundChunks( untouched_, false );
+    std::uint16_t index = freeSpot_;
+    const unsigned int releasedCount = freeSpotCount_ - ( objectsPerPool_ - untouched_ );
+    for ( unsigned int cc = 0; cc < releasedCount; ++cc )
+    {
+        if ( ( index >= untouched_ ) || foundChunks[ index ] )
+        {
+            assert( false );
+            return true;
+        }
+        foundChunks[ index ] = true;
+        index = GetStealthIndex( index, objectSize );
+    }
+    if ( index != untouched_ )
+    {
+        assert( false );
+        return true;
+    }
+
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+
+}
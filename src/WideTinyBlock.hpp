@@ -0,0 +1,157 @@
+
+#pragma once
+
+#include <cstddef> // For std::size_t.
+#include <cstdint>
+#include <climits> // For UCHAR_MAX, USHRT_MAX, and UINT_MAX.
+
+namespace memwa
+{
+
+class BlockSource;
+
+// ----------------------------------------------------------------------------
+
+/** @class WideTinyBlock
+ Works like TinyBlock, but uses 16-bit stealth indexes so one block may hold up to 65535 objects
+ instead of exactly 255. This lets a tiny allocator use page-sized blocks such as 4 KB or 64 KB, so
+ it needs far fewer blocks - and far fewer block records to search - for the same number of objects.
+
+ @par Stealth Indexes
+ The first two bytes of each released chunk contain the index of the next released chunk, so each
+ object must be at least two bytes. Chunks need not be aligned for a 16-bit value, so indexes are
+ copied in and out of chunks byte by byte instead of being read through a pointer.
+
+ @par Untouched Blocks
+ As with TinyBlock, chunks at or above untouched_ were never allocated, so the list of stealth
+ indexes only goes through released chunks and always ends at untouched_.
+ */
+class WideTinyBlock
+{
+public:
+
+    static const std::size_t MinObjectSize = sizeof(std::uint16_t);
+    static const std::size_t MaxObjectSize = UCHAR_MAX;
+    static const unsigned int MaxObjectsPerBlock = USHRT_MAX;
+    /// List position of a block which is not in its pool's list.
+    static const unsigned int NotListed = UINT_MAX;
+
+    /// Provides number of bytes used for chunks within a block, since blockSize need not be a multiple of objectSize.
+    static std::size_t GetBlockSize( std::size_t blockSize, std::size_t objectSize )
+    {
+        return ( blockSize / objectSize ) * objectSize;
+    }
+
+    /// Provides number of chunks which fit in a block of blockSize bytes.
+    static unsigned int GetObjectsPerBlock( std::size_t blockSize, std::size_t objectSize )
+    {
+        return static_cast< unsigned int >( blockSize / objectSize );
+    }
+
+    WideTinyBlock( std::size_t blockSize, std::size_t alignedSize, std::size_t alignment, unsigned int objectsPerPool,
+        std::size_t blockAlignment = 0, BlockSource * source = nullptr );
+
+    /** Allocates a chunk within the block. Complexity is always O(1), and this never throws.
+     @return Pointer to chunk, or nullptr if every chunk is in use.
+     */
+    void * Allocate( std::size_t objectSize );
+
+    /** Releases a chunk within the block. Complexity is always O(1), and this never throws. This
+     assumes the address is within the block and at the start of a chunk.
+     */
+    void Release( void * place, std::size_t objectSize );
+
+    /// Releases the allocated block of memory. Parameters must be the same ones passed to the constructor.
+    void Destroy( std::size_t blockSize = 0, std::size_t blockAlignment = 0, BlockSource * source = nullptr );
+
+    /** Determines if the block has been corrupted.
+     @param objectSize # of bytes in each object.
+     @return True if block is corrupt.
+     */
+    bool IsCorrupt( std::size_t objectSize ) const;
+
+    bool IsValid() const;
+
+    /// Returns true if chunk at address P is inside this block.
+    bool HasAddress( const void * place, std::size_t blockSize ) const
+    {
+        const unsigned char * const here = static_cast< const unsigned char * >( place );
+        return ( block_ <= here ) && ( here < block_ + blockSize );
+    }
+
+    bool IsBelowAddress( const void * place, std::size_t blockSize ) const;
+
+    bool operator < ( const WideTinyBlock & that ) const
+    {
+        return ( block_ < that.block_ );
+    }
+
+    bool IsDestroyed() const
+    {
+        return ( nullptr == block_ );
+    }
+
+    bool IsEmpty() const
+    {
+        return ( objectsPerPool_ == freeSpotCount_ );
+    }
+
+    bool IsFull() const
+    {
+        return ( 0 == freeSpotCount_ );
+    }
+
+    unsigned int GetInUseCount() const
+    {
+        return ( objectsPerPool_ - freeSpotCount_ );
+    }
+
+    unsigned char * GetAddress() const
+    {
+        return block_;
+    }
+
+    /// Returns true if block is in its pool's list of blocks which may have free chunks.
+    bool IsListed() const
+    {
+        return ( NotListed != listPosition_ );
+    }
+
+    /// Provides position of block within its pool's list, so it can be removed without searching the list.
+    unsigned int GetListPosition() const
+    {
+        return listPosition_;
+    }
+
+    void SetListPosition( unsigned int position )
+    {
+        listPosition_ = position;
+    }
+
+    void Unlist()
+    {
+        listPosition_ = NotListed;
+    }
+
+private:
+
+    /// Provides stealth index stored in chunk at index.
+    std::uint16_t GetStealthIndex( std::uint16_t index, std::size_t objectSize ) const;
+
+    /// Pointer to array of allocated chunks.
+    unsigned char * block_;
+    /// Index of first empty chunk.
+    std::uint16_t freeSpot_;
+    /// Count of empty chunks.
+    std::uint16_t freeSpotCount_;
+    /// Index of first chunk which was never allocated.
+    std::uint16_t untouched_;
+    /// Number of chunks in block.
+    std::uint16_t objectsPerPool_;
+    /// Position of block in its pool's list of blocks which may have free chunks, or NotListed.
+    unsigned int listPosition_;
+};
+
+// ----------------------------------------------------------------------------
+
+}
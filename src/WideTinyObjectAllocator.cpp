@@ -0,0 +1,44 @@
+#include <WideTinyObjectAllocator.hpp>
+
+#include "WideTinyBlock.hpp"
+
+#include <cassert>
+
+namespace memwa
+{
+
+// ----------------------------------------------------------------------------
+
+WideTinyObjectAllocator::WideTinyObjectAllocator( unsigned int initialBlocks, std::size_t blockSize, std::size_t objectSize,
+    std::size_t alignment, bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source ) :
+    AnyTinyObjectAllocator( initialBlocks, blockSize, objectSize, alignment, alignedBlocks, retainedEmptyBlocks, source )
+{
+    assert( WideTinyBlock::MinObjectSize <= objectSize );
+    assert( blockSize / objectSize <= WideTinyBlock::MaxObjectsPerBlock );
+    // Wide blocks are not inlined by any FastAllocate or FastRelease, so there is no need to track the hot block.
+    hotEnabled_ = false;
+}
+
+// ----------------------------------------------------------------------------
+
+WideTinyObjectAllocator::~WideTinyObjectAllocator( void )
+{
+}
+
+// ----------------------------------------------------------------------------
+
+ThreadSafeWideTinyObjectAllocator::ThreadSafeWideTinyObjectAllocator( unsigned int initialBlocks, std::size_t blockSize,
+    std::size_t objectSize, std::size_t alignment, bool alignedBlocks, unsigned int retainedEmptyBlocks, BlockSource * source ) :
+    AnyThreadSafeTinyObjectAllocator( initialBlocks, blockSize, objectSize, alignment, alignedBlocks, retainedEmptyBlocks, source )
+{
+}
+
+// ----------------------------------------------------------------------------
+
+ThreadSafeWideTinyObjectAllocator::~ThreadSafeWideTinyObjectAllocator()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+} // end project namespace
@@ -11,7 +11,17 @@ echo "Compile PoolBlock.cpp";           g++ -std=c++14 -Wall -I../include -c Poo
 echo "Compile StackBlock.cpp";          g++ -std=c++14 -Wall -I../include -c StackBlock.cpp          -o ./obj/StackBlock.o
 echo "Compile LinearBlock.cpp";         g++ -std=c++14 -Wall -I../include -c LinearBlock.cpp         -o ./obj/LinearBlock.o
 echo "Compile PoolAllocator.cpp";       g++ -std=c++14 -Wall -I../include -c PoolAllocator.cpp       -o ./obj/PoolAllocator.o
+echo "Compile BitmapBlock.cpp";         g++ -std=c++14 -Wall -I../include -c BitmapBlock.cpp         -o ./obj/BitmapBlock.o
+echo "Compile BitmapPoolAllocator.cpp"; g++ -std=c++14 -Wall -I../include -c BitmapPoolAllocator.cpp -o ./obj/BitmapPoolAllocator.o
 echo "Compile StackAllocator.cpp";      g++ -std=c++14 -Wall -I../include -c StackAllocator.cpp      -o ./obj/StackAllocator.o
 echo "Compile LinearAllocator.cpp";     g++ -std=c++14 -Wall -I../include -c LinearAllocator.cpp     -o ./obj/LinearAllocator.o
+echo "Compile FrameAllocator.cpp";      g++ -std=c++14 -Wall -I../include -c FrameAllocator.cpp      -o ./obj/FrameAllocator.o
 echo "Compile TinyObjectAllocator.cpp"; g++ -std=c++14 -Wall -I../include -c TinyObjectAllocator.cpp -o ./obj/TinyObjectAllocator.o
+echo "Compile WideTinyBlock.cpp";       g++ -std=c++14 -Wall -I../include -c WideTinyBlock.cpp       -o ./obj/WideTinyBlock.o
+echo "Compile WideTinyObjectAllocator.cpp"; g++ -std=c++14 -Wall -I../include -c WideTinyObjectAllocator.cpp -o ./obj/WideTinyObjectAllocator.o
+echo "Compile SizeClassAllocator.cpp";  g++ -std=c++14 -Wall -I../include -c SizeClassAllocator.cpp  -o ./obj/SizeClassAllocator.o
+echo "Compile ThreadCache.cpp";         g++ -std=c++14 -Wall -I../include -c ThreadCache.cpp         -o ./obj/ThreadCache.o
+echo "Compile BlockSource.cpp";         g++ -std=c++14 -Wall -I../include -c BlockSource.cpp         -o ./obj/BlockSource.o
+echo "Compile SizedAllocators.cpp";     g++ -std=c++14 -Wall -I../include -c SizedAllocators.cpp     -o ./obj/SizedAllocators.o
+echo "Compile MemoryResource.cpp";      g++ -std=c++14 -Wall -I../include -c MemoryResource.cpp      -o ./obj/MemoryResource.o
 echo "Done!"
@@ -0,0 +1,530 @@
+
+/** @file MemwaNewDelete.cpp
+ Replaces the global operator new and operator delete, and optionally malloc and friends, so a whole
+ program uses Memwa without changing any call sites. Link libmemwa_replace.a into the program, or load
+ libmemwa_replace.so with LD_PRELOAD.
+
+ Chunks of up to 4096 bytes, including a small header, come from one SizeClassAllocator made when the
+ first chunk is requested. It makes a multithreaded manager if the program has not made one yet, and
+ leaves every chunk to the system allocator if the program made a single-threaded manager. Bigger chunks, chunks with alignment above
+ 16 bytes, and chunks requested by Memwa itself come from the system allocator. Every chunk has a
+ header just below it which records where it came from, so operator delete and free never need to
+ search for the owner.
+
+ Define MEMWA_REPLACE_MALLOC when compiling this file to also replace malloc, free, calloc, realloc,
+ and the aligned forms of malloc. This needs glibc, whose __libc_ functions are the system allocator.
+
+ @note The front end is never destroyed, so a program using this library must not call
+  AllocatorManager::DestroyManager. Since the library usually makes the manager before main starts,
+  AllocatorManager::CreateManager may return false in such a program.
+ */
+
+#include "AllocatorManager.hpp"
+#include "SizeClassAllocator.hpp"
+
+#include "../LockGuard.hpp"
+#include "../ManagerImpl.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#include <new>
+
+#if defined( MEMWA_REPLACE_MALLOC )
+	#include <malloc.h>
+	#include <unistd.h>
+
+extern "C"
+{
+	void * __libc_malloc( std::size_t size );
+	void * __libc_memalign( std::size_t alignment, std::size_t size );
+	void __libc_free( void * place );
+}
+
+#endif
+
+#if defined( __GNUC__ )
+	#define MEMWA_TLS_MODEL __attribute__(( tls_model( "initial-exec" ) ))
+#else
+	#define MEMWA_TLS_MODEL
+#endif
+
+using namespace memwa;
+
+namespace
+{
+
+// ----------------------------------------------------------------------------
+
+/// Placed just below every chunk given to the program.
+struct ChunkHeader
+{
+	/// Number of bytes requested by the program.
+	std::size_t size;
+	/// Address returned by the system allocator, or nullptr if the chunk came from Memwa.
+	void * base;
+};
+
+/// Bytes reserved below each chunk. This keeps chunks aligned the same as the block they came from.
+const std::size_t HeaderSize = 16;
+
+/// Alignment of every chunk, unless the program asks for more.
+const std::size_t ChunkAlignment = 16;
+
+/// Number of bytes in each block of the front end's allocators.
+const std::size_t FrontEndBlockSize = 65536;
+
+static_assert( sizeof(ChunkHeader) <= HeaderSize, "Header must fit in space reserved for it." );
+
+/** True while this thread is inside Memwa, so allocations made by Memwa itself go straight to the system
+ allocator instead of coming back into Memwa. Uses the initial-exec model so reading it never allocates.
+ */
+thread_local bool insideMemwa MEMWA_TLS_MODEL = false;
+
+// ----------------------------------------------------------------------------
+
+ChunkHeader * GetHeader( void * place )
+{
+	return reinterpret_cast< ChunkHeader * >( reinterpret_cast< unsigned char * >( place ) - HeaderSize );
+}
+
+// ----------------------------------------------------------------------------
+
+void * SystemAllocate( std::size_t bytes, std::size_t alignment )
+{
+#if defined( MEMWA_REPLACE_MALLOC )
+	return ( alignment <= ChunkAlignment ) ? __libc_malloc( bytes ) : __libc_memalign( alignment, bytes );
+#else
+	if ( alignment <= ChunkAlignment )
+	{
+		return std::malloc( bytes );
+	}
+	void * place = nullptr;
+	if ( ::posix_memalign( &place, alignment, bytes ) != 0 )
+	{
+		return nullptr;
+	}
+	return place;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+void SystemRelease( void * place )
+{
+#if defined( MEMWA_REPLACE_MALLOC )
+	__libc_free( place );
+#else
+	std::free( place );
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+Allocator * MakeFrontEnd()
+{
+	// The program may have made the manager already. Its allocators must be thread-safe to share it.
+	AllocatorManager::CreateManager( true );
+	if ( !impl::ManagerImpl::GetManager()->IsMultithreaded() )
+	{
+		return nullptr;
+	}
+	AllocatorManager::AllocatorParameters info;
+	info.type = AllocatorManager::SizeClass;
+	info.initialBlocks = 1;
+	info.blockSize = FrontEndBlockSize;
+	info.objectSize = 0;
+	info.alignment = static_cast< decltype( info.alignment ) >( ChunkAlignment );
+	info.wideTinyBlocks = true;
+	return AllocatorManager::CreateAllocator( info );
+}
+
+// ----------------------------------------------------------------------------
+
+/// Provides the allocator for small chunks, or nullptr if it could not be made. Caller must be inside Memwa.
+Allocator * GetFrontEnd()
+{
+	static Allocator * const frontEnd = MakeFrontEnd();
+	return frontEnd;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Allocates a chunk with a header, or returns nullptr without calling the new_handler.
+void * AllocateChunk( std::size_t size, std::size_t alignment )
+{
+	if ( alignment <= ChunkAlignment && size <= SizeClassAllocator::MaxObjectSize - HeaderSize && !insideMemwa )
+	{
+		ReentryGuard guard( insideMemwa );
+		try
+		{
+			Allocator * frontEnd = GetFrontEnd();
+			void * chunk = ( frontEnd == nullptr ) ? nullptr : frontEnd->Allocate( size + HeaderSize );
+			if ( chunk != nullptr )
+			{
+				ChunkHeader * header = reinterpret_cast< ChunkHeader * >( chunk );
+				header->size = size;
+				header->base = nullptr;
+				return reinterpret_cast< unsigned char * >( chunk ) + HeaderSize;
+			}
+		}
+		catch ( ... )
+		{
+		}
+	}
+
+	// The system allocator is used for big or overaligned chunks, or when Memwa could not provide one.
+	if ( alignment < ChunkAlignment )
+	{
+		alignment = ChunkAlignment;
+	}
+	if ( size > static_cast< std::size_t >( -1 ) - alignment )
+	{
+		return nullptr;
+	}
+	void * base = SystemAllocate( size + alignment, alignment );
+	if ( base == nullptr )
+	{
+		return nullptr;
+	}
+	void * place = reinterpret_cast< unsigned char * >( base ) + alignment;
+	ChunkHeader * header = GetHeader( place );
+	header->size = size;
+	header->base = base;
+	return place;
+}
+
+// ----------------------------------------------------------------------------
+
+void ReleaseChunk( void * place )
+{
+	if ( place == nullptr )
+	{
+		return;
+	}
+	ChunkHeader * header = GetHeader( place );
+	if ( header->base != nullptr )
+	{
+		SystemRelease( header->base );
+		return;
+	}
+	// Only Memwa chunks have no base, so the front end must exist.
+	ReentryGuard guard( insideMemwa );
+	GetFrontEnd()->Release( header, header->size + HeaderSize );
+}
+
+// ----------------------------------------------------------------------------
+
+/// Allocates chunk for operator new, calling the new_handler until it succeeds or there is no handler.
+void * NewChunk( std::size_t size, std::size_t alignment )
+{
+	if ( size == 0 )
+	{
+		size = 1;
+	}
+	for ( ;; )
+	{
+		void * place = AllocateChunk( size, alignment );
+		if ( place != nullptr )
+		{
+			return place;
+		}
+		std::new_handler handler = std::get_new_handler();
+		if ( handler == nullptr )
+		{
+			throw std::bad_alloc();
+		}
+		if ( insideMemwa )
+		{
+			handler();
+		}
+		else
+		{
+			// The manager's handler trims blocks while holding allocator locks, so anything it allocates
+			// must go to the system allocator.
+			ReentryGuard guard( insideMemwa );
+			handler();
+		}
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+void * NewChunk( std::size_t size, std::size_t alignment, const std::nothrow_t & ) noexcept
+{
+	try
+	{
+		return NewChunk( size, alignment );
+	}
+	catch ( ... )
+	{
+		return nullptr;
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+} // end anonymous namespace
+
+// ----------------------------------------------------------------------------
+
+void * operator new( std::size_t size )
+{
+	return NewChunk( size, ChunkAlignment );
+}
+
+void * operator new[]( std::size_t size )
+{
+	return NewChunk( size, ChunkAlignment );
+}
+
+void * operator new( std::size_t size, const std::nothrow_t & nothrow ) noexcept
+{
+	return NewChunk( size, ChunkAlignment, nothrow );
+}
+
+void * operator new[]( std::size_t size, const std::nothrow_t & nothrow ) noexcept
+{
+	return NewChunk( size, ChunkAlignment, nothrow );
+}
+
+void operator delete( void * place ) noexcept
+{
+	ReleaseChunk( place );
+}
+
+void operator delete[]( void * place ) noexcept
+{
+	ReleaseChunk( place );
+}
+
+void operator delete( void * place, const std::nothrow_t & ) noexcept
+{
+	ReleaseChunk( place );
+}
+
+void operator delete[]( void * place, const std::nothrow_t & ) noexcept
+{
+	ReleaseChunk( place );
+}
+
+// The header already knows the size, so sized forms ignore it.
+
+void operator delete( void * place, std::size_t ) noexcept
+{
+	ReleaseChunk( place );
+}
+
+void operator delete[]( void * place, std::size_t ) noexcept
+{
+	ReleaseChunk( place );
+}
+
+// ----------------------------------------------------------------------------
+
+#if defined( __cpp_aligned_new )
+// Declared by C++ 2017, or by C++ 2014 compilers given -faligned-new.
+
+void * operator new( std::size_t size, std::align_val_t alignment )
+{
+	return NewChunk( size, static_cast< std::size_t >( alignment ) );
+}
+
+void * operator new[]( std::size_t size, std::align_val_t alignment )
+{
+	return NewChunk( size, static_cast< std::size_t >( alignment ) );
+}
+
+void * operator new( std::size_t size, std::align_val_t alignment, const std::nothrow_t & nothrow ) noexcept
+{
+	return NewChunk( size, static_cast< std::size_t >( alignment ), nothrow );
+}
+
+void * operator new[]( std::size_t size, std::align_val_t alignment, const std::nothrow_t & nothrow ) noexcept
+{
+	return NewChunk( size, static_cast< std::size_t >( alignment ), nothrow );
+}
+
+void operator delete( void * place, std::align_val_t ) noexcept
+{
+	ReleaseChunk( place );
+}
+
+void operator delete[]( void * place, std::align_val_t ) noexcept
+{
+	ReleaseChunk( place );
+}
+
+void operator delete( void * place, std::align_val_t, const std::nothrow_t & ) noexcept
+{
+	ReleaseChunk( place );
+}
+
+void operator delete[]( void * place, std::align_val_t, const std::nothrow_t & ) noexcept
+{
+	ReleaseChunk( place );
+}
+
+void operator delete( void * place, std::size_t, std::align_val_t ) noexcept
+{
+	ReleaseChunk( place );
+}
+
+void operator delete[]( void * place, std::size_t, std::align_val_t ) noexcept
+{
+	ReleaseChunk( place );
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+
+#if defined( MEMWA_REPLACE_MALLOC )
+
+namespace
+{
+
+/// Allocates chunk for the aligned forms of malloc, which must return nullptr for bad alignments.
+void * AlignedChunk( std::size_t alignment, std::size_t size )
+{
+	if ( alignment == 0 || ( alignment & ( alignment - 1 ) ) != 0 )
+	{
+		errno = EINVAL;
+		return nullptr;
+	}
+	void * place = AllocateChunk( size, alignment );
+	if ( place == nullptr )
+	{
+		errno = ENOMEM;
+	}
+	return place;
+}
+
+} // end anonymous namespace
+
+extern "C"
+{
+
+void * malloc( std::size_t size )
+{
+	void * place = AllocateChunk( size, ChunkAlignment );
+	if ( place == nullptr )
+	{
+		errno = ENOMEM;
+	}
+	return place;
+}
+
+void free( void * place )
+{
+	ReleaseChunk( place );
+}
+
+void * calloc( std::size_t count, std::size_t size )
+{
+	if ( size != 0 && count > static_cast< std::size_t >( -1 ) / size )
+	{
+		errno = ENOMEM;
+		return nullptr;
+	}
+	const std::size_t bytes = count * size;
+	void * place = malloc( bytes );
+	if ( place != nullptr )
+	{
+		std::memset( place, 0, bytes );
+	}
+	return place;
+}
+
+void * realloc( void * place, std::size_t size )
+{
+	if ( place == nullptr )
+	{
+		return malloc( size );
+	}
+	if ( size == 0 )
+	{
+		free( place );
+		return nullptr;
+	}
+	ChunkHeader * header = GetHeader( place );
+	const std::size_t oldSize = header->size;
+	// A Memwa chunk already holds the new size if both sizes are in the same class.
+	if ( header->base == nullptr && size <= SizeClassAllocator::MaxObjectSize - HeaderSize
+		&& SizeClassAllocator::GetClassSize( size + HeaderSize ) == SizeClassAllocator::GetClassSize( oldSize + HeaderSize ) )
+	{
+		header->size = size;
+		return place;
+	}
+	void * newPlace = malloc( size );
+	if ( newPlace == nullptr )
+	{
+		return nullptr;
+	}
+	std::memcpy( newPlace, place, ( oldSize < size ) ? oldSize : size );
+	free( place );
+	return newPlace;
+}
+
+void * reallocarray( void * place, std::size_t count, std::size_t size )
+{
+	if ( size != 0 && count > static_cast< std::size_t >( -1 ) / size )
+	{
+		errno = ENOMEM;
+		return nullptr;
+	}
+	return realloc( place, count * size );
+}
+
+int posix_memalign( void ** place, std::size_t alignment, std::size_t size )
+{
+	if ( alignment < sizeof(void *) || ( alignment & ( alignment - 1 ) ) != 0 )
+	{
+		return EINVAL;
+	}
+	void * chunk = AllocateChunk( size, alignment );
+	if ( chunk == nullptr )
+	{
+		return ENOMEM;
+	}
+	*place = chunk;
+	return 0;
+}
+
+void * aligned_alloc( std::size_t alignment, std::size_t size )
+{
+	return AlignedChunk( alignment, size );
+}
+
+void * memalign( std::size_t alignment, std::size_t size )
+{
+	return AlignedChunk( alignment, size );
+}
+
+void * valloc( std::size_t size )
+{
+	return AlignedChunk( static_cast< std::size_t >( ::sysconf( _SC_PAGESIZE ) ), size );
+}
+
+void * pvalloc( std::size_t size )
+{
+	const std::size_t pageSize = static_cast< std::size_t >( ::sysconf( _SC_PAGESIZE ) );
+	if ( size > static_cast< std::size_t >( -1 ) - pageSize )
+	{
+		errno = ENOMEM;
+		return nullptr;
+	}
+	return AlignedChunk( pageSize, ( size + pageSize - 1 ) / pageSize * pageSize );
+}
+
+std::size_t malloc_usable_size( void * place ) noexcept
+{
+	return ( place == nullptr ) ? 0 : GetHeader( place )->size;
+}
+
+} // end extern "C"
+
+#endif
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,44 @@
+#!/bin/bash
+
+# Builds libmemwa_replace.a to link into a program, and libmemwa_replace.so to load with LD_PRELOAD.
+# Both replace the global operator new and operator delete. Pass -DMEMWA_REPLACE_MALLOC as the first
+# argument to also replace malloc, free, calloc, and realloc.
+
+rm ./obj/*.o
+rm libmemwa_replace.a libmemwa_replace.so
+
+if [ ! -d "obj" ]; then
+	mkdir obj
+fi
+
+FLAGS="-std=c++14 -faligned-new -Wall -O2 -fPIC -I../../include $1"
+
+for file in \
+	AllocatorManager \
+	TinyBlock \
+	PoolBlock \
+	StackBlock \
+	LinearBlock \
+	PoolAllocator \
+	BitmapBlock \
+	BitmapPoolAllocator \
+	StackAllocator \
+	LinearAllocator \
+	FrameAllocator \
+	TinyObjectAllocator \
+	WideTinyBlock \
+	WideTinyObjectAllocator \
+	SizeClassAllocator \
+	ThreadCache \
+	BlockSource \
+	SizedAllocators
+do
+	echo "Compile $file.cpp"; g++ $FLAGS -c ../$file.cpp -o ./obj/$file.o
+done
+echo "Compile MemwaNewDelete.cpp"; g++ $FLAGS -c MemwaNewDelete.cpp -o ./obj/MemwaNewDelete.o
+
+echo "Archiving"
+ar rcs libmemwa_replace.a ./obj/*.o
+echo "Linking"
+g++ -shared -pthread -o libmemwa_replace.so ./obj/*.o
+echo "Done!"
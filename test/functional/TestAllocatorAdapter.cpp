@@ -0,0 +1,159 @@
+
+#include "../../include/AllocatorManager.hpp"
+#include "../../include/AllocatorAdapter.hpp"
+#include "../../include/SizedAllocators.hpp"
+
+#include "UnitTest.hpp"
+
+#include <iostream>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+using namespace memwa;
+
+// ----------------------------------------------------------------------------
+
+typedef AllocatorAdapter< int, SizedAllocators > IntAdapter;
+typedef AllocatorAdapter< std::pair< const int, double >, SizedAllocators > PairAdapter;
+typedef std::list< int, IntAdapter > IntList;
+typedef std::map< int, double, std::less< int >, PairAdapter > IntMap;
+typedef std::unordered_map< int, double, std::hash< int >, std::equal_to< int >, PairAdapter > IntHashMap;
+typedef std::vector< double, AllocatorAdapter< double > > DoubleVector;
+
+static_assert( sizeof(IntAdapter) == sizeof(void *), "AllocatorAdapter should be as small as a pointer." );
+static_assert( std::is_same< std::allocator_traits< IntAdapter >::rebind_alloc< double >,
+	AllocatorAdapter< double, SizedAllocators > >::value, "AllocatorAdapter should rebind to the same allocator type." );
+
+// ----------------------------------------------------------------------------
+
+void TestAllocatorAdapter( bool multithreaded )
+{
+	const char * threadType = ( multithreaded ) ? "Multi-Threaded" : "Single-Threaded";
+	std::cout << "Basic Functionality " << threadType << " Allocator Adapter Test" << std::endl;
+	ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+	ut::UnitTest * u = uts.AddUnitTest( "Test Allocator Adapter" );
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::CreateManager( multithreaded, 4096 ), "Creation should pass since AllocatorManager does not exist yet." );
+
+	AllocatorManager::AllocatorParameters allocatorInfo;
+	allocatorInfo.type = AllocatorManager::AllocatorType::Pool;
+	allocatorInfo.objectSize = 0;
+	allocatorInfo.alignment = 3;
+	allocatorInfo.blockSize = 4096;
+	allocatorInfo.initialBlocks = 1;
+	UNIT_TEST_FOR_EXCEPTION( u, SizedAllocators{ allocatorInfo }, std::invalid_argument );
+	allocatorInfo.alignment = 8;
+
+	{
+		SizedAllocators sized( allocatorInfo );
+		IntAdapter adapter( &sized );
+		UNIT_TEST( u, adapter.get() == &sized );
+		UNIT_TEST( u, adapter == PairAdapter( adapter ) );
+		UNIT_TEST( u, adapter != IntAdapter() );
+
+		// Each node type gets an allocator of exactly its size when the container rebinds the adapter.
+		IntList numbers( adapter );
+		for ( int ii = 0; ii < 1000; ++ii )
+		{
+			numbers.push_back( ii );
+		}
+		UNIT_TEST( u, sized.HasAddress( &numbers.front() ) );
+		UNIT_TEST( u, sized.HasAddress( &numbers.back() ) );
+		numbers.remove_if( []( int value ) { return ( value % 2 ) == 0; } );
+		UNIT_TEST( u, numbers.size() == 500 );
+		UNIT_TEST( u, numbers.front() == 1 );
+
+		IntMap table( ( PairAdapter( &sized ) ) );
+		for ( int ii = 0; ii < 1000; ++ii )
+		{
+			table[ ii ] = ii / 2.0;
+		}
+		UNIT_TEST( u, sized.HasAddress( &( *table.find( 500 ) ) ) );
+		table.erase( table.begin(), table.find( 900 ) );
+		UNIT_TEST( u, table.size() == 100 );
+		UNIT_TEST( u, table.begin()->second == 450.0 );
+
+		// Bucket arrays bigger than SizedAllocators::MaxObjectSize come from operator new.
+		IntHashMap hashed( 0, std::hash< int >(), std::equal_to< int >(), PairAdapter( &sized ) );
+		for ( int ii = 0; ii < 1000; ++ii )
+		{
+			hashed.emplace( ii, ii * 2.0 );
+		}
+		UNIT_TEST( u, sized.HasAddress( &( *hashed.find( 10 ) ) ) );
+		UNIT_TEST( u, hashed.at( 999 ) == 1998.0 );
+		hashed.clear();
+
+		// Copies of a container share the allocator, and moves take the original's nodes.
+		IntList copied( numbers );
+		UNIT_TEST( u, copied.get_allocator() == numbers.get_allocator() );
+		IntList moved( std::move( copied ) );
+		UNIT_TEST( u, moved.size() == 500 );
+		UNIT_TEST( u, sized.GetAllocator( 0 ) != nullptr );
+		UNIT_TEST( u, sized.GetAllocator( SizedAllocators::MaxObjectSize + 1 ) == nullptr );
+		UNIT_TEST( u, !sized.IsCorrupt() );
+	}
+
+	// Chunks too big for their own allocator still get the alignment the caller asked for.
+	allocatorInfo.alignment = 32;
+	{
+		SizedAllocators sized( allocatorInfo );
+		void * places[ 8 ];
+		for ( unsigned int ii = 0; ii < 8; ++ii )
+		{
+			const std::size_t size = SizedAllocators::MaxObjectSize + 1 + ii * 40;
+			UNIT_TEST( u, ( places[ ii ] = sized.Allocate( size, allocatorInfo.alignment ) ) != nullptr );
+			UNIT_TEST( u, reinterpret_cast< std::size_t >( places[ ii ] ) % 32 == 0 );
+		}
+		for ( unsigned int ii = 0; ii < 8; ++ii )
+		{
+			UNIT_TEST( u, sized.Release( places[ ii ], SizedAllocators::MaxObjectSize + 1 + ii * 40 ) );
+		}
+	}
+
+	// Pool allocators can't have alignment below 4, so sizes above MaxTinyObjectSize get a bigger alignment.
+	allocatorInfo.alignment = 1;
+	{
+		SizedAllocators sized( allocatorInfo );
+		std::vector< void * > places( SizedAllocators::MaxObjectSize, nullptr );
+		for ( std::size_t size = 1; size <= SizedAllocators::MaxObjectSize; ++size )
+		{
+			UNIT_TEST( u, ( places[ size - 1 ] = sized.Allocate( size, allocatorInfo.alignment ) ) != nullptr );
+		}
+		for ( std::size_t size = 1; size <= SizedAllocators::MaxObjectSize; ++size )
+		{
+			UNIT_TEST( u, sized.HasAddress( places[ size - 1 ] ) );
+			UNIT_TEST( u, sized.Release( places[ size - 1 ], size ) );
+		}
+		UNIT_TEST( u, !sized.IsCorrupt() );
+	}
+	allocatorInfo.alignment = 8;
+
+	// A container whose chunks vary in size, and are not released in reverse order, can use a LinearAllocator.
+	allocatorInfo.type = AllocatorManager::AllocatorType::Linear;
+	Allocator * allocator = nullptr;
+	UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+	{
+		DoubleVector values( ( AllocatorAdapter< double >( allocator ) ) );
+		for ( int ii = 0; ii < 100; ++ii )
+		{
+			values.push_back( ii );
+		}
+		UNIT_TEST( u, allocator->HasAddress( values.data() ) );
+		UNIT_TEST( u, values[ 99 ] == 99.0 );
+		UNIT_TEST( u, values.max_size() != 0 );
+		UNIT_TEST_FOR_EXCEPTION( u, values.get_allocator().allocate( std::numeric_limits< std::size_t >::max() ), std::bad_alloc );
+	}
+	UNIT_TEST( u, !allocator->IsCorrupt() );
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyManager( true ), "Destruction should pass since AllocatorManager exists." );
+}
+
+// ----------------------------------------------------------------------------
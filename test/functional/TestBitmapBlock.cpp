@@ -0,0 +1,185 @@
+
+#include "../../src/BitmapBlock.hpp"
+
+#include "UnitTest.hpp"
+
+#include <iostream>
+
+#include <cstdlib>
+
+using namespace std;
+using namespace memwa;
+
+// ----------------------------------------------------------------------------
+
+void TestBitmapBlock( ut::UnitTest * u, const std::size_t blockSize, const std::size_t alignedSize, const std::size_t alignment )
+{
+	const unsigned int objectsPerPool = BitmapBlock::GetObjectsPerBlock( blockSize, alignedSize );
+	BitmapBlock block( blockSize, alignedSize, alignment, objectsPerPool );
+
+	// First do basic tests of empty block.
+	UNIT_TEST_WITH_MSG( u, block.IsEmpty(), "new block should be empty." );
+	UNIT_TEST_WITH_MSG( u, !block.IsFull(), "new block should not be full." );
+	UNIT_TEST_WITH_MSG( u, block.GetInUseCount() == 0, "new block should have no chunks in use." );
+	UNIT_TEST( u, !block.IsCorrupt( blockSize, alignment, alignedSize ) );
+
+	// Do tests while allocating chunks til block is full.
+	void * holder[ objectsPerPool ];
+	void * chunk = nullptr;
+	for ( unsigned int ii = 0; ii < objectsPerPool; ++ii )
+	{
+		chunk = block.Allocate( alignedSize );
+		unsigned char * tooHigh = reinterpret_cast< unsigned char * >( chunk ) + blockSize;
+		unsigned char * tooLow = reinterpret_cast< unsigned char * >( chunk ) - blockSize;
+		holder[ ii ] = chunk;
+		UNIT_TEST( u, chunk != nullptr );
+		UNIT_TEST( u, reinterpret_cast< std::size_t >( chunk ) % alignment == 0 );
+		UNIT_TEST( u, !block.IsEmpty() );
+		UNIT_TEST( u, block.HasAddress( chunk, blockSize ) );
+		UNIT_TEST( u, !block.HasAddress( tooLow, blockSize ) );
+		UNIT_TEST( u, !block.HasAddress( nullptr, blockSize ) );
+		UNIT_TEST( u, !block.HasAddress( tooHigh, blockSize ) );
+		UNIT_TEST( u, block.IsBelowAddress( tooHigh, blockSize ) );
+		UNIT_TEST( u, block.GetInUseCount() == 1 + ii );
+		// An empty block hands out chunks in address order.
+		UNIT_TEST( u, reinterpret_cast< unsigned char * >( block.GetAddress() ) + ii * alignedSize == chunk );
+	}
+	UNIT_TEST( u, !block.IsCorrupt( blockSize, alignment, alignedSize ) );
+	UNIT_TEST( u, !block.IsEmpty() );
+	UNIT_TEST( u, block.IsFull() );
+	UNIT_TEST( u, block.GetInUseCount() == objectsPerPool );
+	chunk = block.Allocate( alignedSize );
+	UNIT_TEST( u, chunk == nullptr );
+
+	// Release chunks from the top down, then check the lowest free chunk is always allocated next.
+	for ( unsigned int ii = objectsPerPool - 1; ii >= objectsPerPool / 2; --ii )
+	{
+		UNIT_TEST( u, block.Release( holder[ ii ] ) );
+	}
+	UNIT_TEST( u, block.Release( holder[ 1 ] ) );
+	UNIT_TEST_WITH_MSG( u, !block.Release( holder[ 1 ] ), "block should not release a chunk twice." );
+	UNIT_TEST_WITH_MSG( u, !block.Release( reinterpret_cast< unsigned char * >( holder[ 0 ] ) + 1 ),
+		"block should not release an address within a chunk." );
+	UNIT_TEST( u, !block.IsCorrupt( blockSize, alignment, alignedSize ) );
+	UNIT_TEST( u, block.Allocate( alignedSize ) == holder[ 1 ] );
+	for ( unsigned int ii = objectsPerPool / 2; ii < objectsPerPool; ++ii )
+	{
+		UNIT_TEST( u, block.Allocate( alignedSize ) == holder[ ii ] );
+	}
+	UNIT_TEST( u, block.IsFull() );
+
+	// Do tests while releasing chunks til block is empty.
+	for ( unsigned int ii = 0; ii < objectsPerPool; ++ii )
+	{
+		chunk = holder[ ii ];
+		UNIT_TEST( u, !block.IsEmpty() );
+		UNIT_TEST( u, block.HasAddress( chunk, blockSize ) );
+		UNIT_TEST( u, block.Release( chunk ) );
+		UNIT_TEST( u, block.GetInUseCount() == objectsPerPool - 1 - ii );
+		holder[ ii ] = nullptr;
+	}
+	UNIT_TEST( u, block.IsEmpty() );
+	UNIT_TEST( u, !block.IsCorrupt( blockSize, alignment, alignedSize ) );
+
+	for ( unsigned int ii = 0; ii < 1000; ++ii )
+	{
+		const unsigned int index = rand() % objectsPerPool;
+		void * chunk = holder[ index ];
+		if ( chunk == nullptr )
+		{
+			const unsigned int countBefore = block.GetInUseCount();
+			chunk = block.Allocate( alignedSize );
+			const unsigned int countAfter = block.GetInUseCount();
+			UNIT_TEST( u, countAfter - 1 == countBefore );
+			UNIT_TEST( u, chunk != nullptr );
+			UNIT_TEST( u, reinterpret_cast< std::size_t >( chunk ) % alignment == 0 );
+			UNIT_TEST( u, block.HasAddress( chunk, blockSize ) );
+			// The chunk is the lowest free one, so no chunk below it may be free.
+			const unsigned int spot = ( reinterpret_cast< unsigned char * >( chunk ) - reinterpret_cast< unsigned char * >( block.GetAddress() ) ) / alignedSize;
+			for ( unsigned int jj = 0; jj < spot; ++jj )
+			{
+				UNIT_TEST( u, holder[ jj ] != nullptr );
+			}
+			holder[ spot ] = chunk;
+		}
+		else
+		{
+			UNIT_TEST( u, block.HasAddress( chunk, blockSize ) );
+			const unsigned int countBefore = block.GetInUseCount();
+			UNIT_TEST( u, block.Release( chunk ) );
+			const unsigned int countAfter = block.GetInUseCount();
+			UNIT_TEST( u, countAfter + 1 == countBefore );
+			holder[ index ] = nullptr;
+			chunk = nullptr;
+		}
+		UNIT_TEST( u, !block.IsCorrupt( blockSize, alignment, alignedSize ) );
+	}
+
+	block.Destroy();
+}
+
+// ----------------------------------------------------------------------------
+
+void TestBitmapScan( ut::UnitTest * u )
+{
+	// Put one set bit in each position of an array long enough to use every vector width.
+	const unsigned int wordCount = 13;
+	std::uint64_t words[ wordCount ] = { 0 };
+	UNIT_TEST( u, BitmapBlock::FindNonZeroWord( words, wordCount ) == wordCount );
+	UNIT_TEST( u, BitmapBlock::FindNonZeroWord( words, 0 ) == 0 );
+	for ( unsigned int ii = 0; ii < wordCount; ++ii )
+	{
+		words[ ii ] = std::uint64_t( 1 ) << ( ( ii * 7 ) % BitmapBlock::BitsPerWord );
+		UNIT_TEST( u, BitmapBlock::FindNonZeroWord( words, wordCount ) == ii );
+		for ( unsigned int jj = 0; jj <= ii; ++jj )
+		{
+			UNIT_TEST( u, BitmapBlock::FindNonZeroWord( words + jj, wordCount - jj ) == ii - jj );
+		}
+		words[ ii ] = 0;
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+void TestBitmapBlock()
+{
+	ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+	ut::UnitTest * u = uts.AddUnitTest( "Test BitmapBlock" );
+
+	TestBitmapScan( u );
+
+	// The bitmap is kept inside the block, so it takes room from the chunks.
+	UNIT_TEST( u, BitmapBlock::GetObjectsPerBlock( 80, 8 ) == 9 );
+	UNIT_TEST( u, BitmapBlock::GetObjectsPerBlock( 4096, 16 ) == 254 );
+	UNIT_TEST( u, BitmapBlock::GetObjectsPerBlock( 4096, 4096 ) == 0 );
+
+	std::cout << std::endl << "Testing Various BlockSizes and Alignments with BitmapBlock." << std::endl
+		<< "Block Size \t Object Size \t Alignment" << std::endl
+		<< "=========================================" << std::endl;
+
+	std::size_t blockSize = 80;
+	std::size_t alignedSize = 8;
+	std::size_t alignment = 4;
+	TestBitmapBlock( u, blockSize, alignedSize, alignment );
+	std::cout << blockSize << "\t\t" << alignedSize << "\t\t" << alignment << std::endl;
+
+	blockSize = 400;
+	alignedSize = 4;
+	alignment = 4;
+	TestBitmapBlock( u, blockSize, alignedSize, alignment );
+	std::cout << blockSize << "\t\t" << alignedSize << "\t\t" << alignment << std::endl;
+
+	blockSize = 1024;
+	alignedSize = 16;
+	alignment = 8;
+	TestBitmapBlock( u, blockSize, alignedSize, alignment );
+	std::cout << blockSize << "\t\t" << alignedSize << "\t\t" << alignment << std::endl;
+
+	blockSize = 4800;
+	alignedSize = 16;
+	alignment = 16;
+	TestBitmapBlock( u, blockSize, alignedSize, alignment );
+	std::cout << blockSize << "\t\t" << alignedSize << "\t\t" << alignment << std::endl;
+}
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,392 @@
+
+#include "../../include/AllocatorManager.hpp"
+#include "../../include/BlockSource.hpp"
+#include "../../src/WideTinyBlock.hpp"
+
+#include "UnitTest.hpp"
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <cstdint>
+
+using namespace std;
+using namespace memwa;
+
+// ----------------------------------------------------------------------------
+
+/// Gets blocks from malloc, and counts how many blocks it provided are still in use.
+class CountingBlockSource : public MallocBlockSource
+{
+public:
+
+	CountingBlockSource() : MallocBlockSource(), blockCount_( 0 ), allocateCount_( 0 ) {}
+
+	virtual ~CountingBlockSource() {}
+
+	virtual void * AllocateBlock( std::size_t blockSize, std::size_t blockAlignment ) override
+	{
+		void * block = MallocBlockSource::AllocateBlock( blockSize, blockAlignment );
+		if ( nullptr != block )
+		{
+			++blockCount_;
+			++allocateCount_;
+		}
+		return block;
+	}
+
+	virtual void ReleaseBlock( void * block, std::size_t blockSize, std::size_t blockAlignment ) override
+	{
+		--blockCount_;
+		MallocBlockSource::ReleaseBlock( block, blockSize, blockAlignment );
+	}
+
+	/// Number of blocks allocated and not yet released.
+	unsigned int blockCount_;
+	/// Number of blocks allocated since this was made.
+	unsigned int allocateCount_;
+};
+
+// ----------------------------------------------------------------------------
+
+/// Allocates enough chunks to need several blocks, releases them, and then destroys the allocator.
+void AllocateFromSource( ut::UnitTest * u, AllocatorManager::AllocatorParameters & allocatorInfo, CountingBlockSource & source )
+{
+	source.allocateCount_ = 0;
+	allocatorInfo.blockSource = &source;
+	Allocator * allocator = nullptr;
+	UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+	UNIT_TEST_WITH_MSG( u, source.blockCount_ != 0, "Initial blocks should come from the source." );
+
+	const unsigned int chunkCount = 2000;
+	std::vector< void * > places( chunkCount, nullptr );
+	for ( unsigned int ii = 0; ii < chunkCount; ++ii )
+	{
+		places[ ii ] = allocator->Allocate( allocatorInfo.objectSize );
+		UNIT_TEST( u, places[ ii ] != nullptr );
+		UNIT_TEST( u, allocator->HasAddress( places[ ii ] ) );
+	}
+	UNIT_TEST_WITH_MSG( u, source.allocateCount_ > allocatorInfo.initialBlocks, "Every new block should come from the source." );
+	UNIT_TEST( u, !allocator->IsCorrupt() );
+
+	// Release in reverse order so a StackAllocator can release each chunk.
+	for ( unsigned int ii = chunkCount; ii != 0; --ii )
+	{
+		UNIT_TEST( u, allocator->Release( places[ ii - 1 ], allocatorInfo.objectSize ) );
+	}
+	allocator->TrimEmptyBlocks();
+	UNIT_TEST( u, !allocator->IsCorrupt() );
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+	UNIT_TEST_WITH_MSG( u, source.blockCount_ == 0, "Every block should be returned to its source." );
+	allocatorInfo.blockSource = nullptr;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Checks blocks are carved only from the region, and that the region grows no more than allowed.
+void TestRegionBlockSource( ut::UnitTest * u )
+{
+	const std::size_t regionSize = 1024 * 64;
+	static unsigned char region[ regionSize + 1 ];
+	// Start one byte past the array to check the region is trimmed to aligned addresses.
+	unsigned char * const start = region + 1;
+	unsigned char * const end = region + regionSize + 1;
+	UNIT_TEST_FOR_EXCEPTION( u, RegionBlockSource( nullptr, 100 ), std::invalid_argument );
+
+	{
+		RegionBlockSource source( start, regionSize );
+		const std::size_t freeBytes = source.GetFreeBytes();
+		UNIT_TEST( u, freeBytes == regionSize - RegionBlockSource::Granularity );
+		void * block = source.AllocateBlock( 100, 0 );
+		UNIT_TEST( u, block != nullptr );
+		UNIT_TEST( u, reinterpret_cast< std::uintptr_t >( block ) % RegionBlockSource::Granularity == 0 );
+		void * aligned = source.AllocateBlock( 4096, 4096 );
+		UNIT_TEST( u, aligned != nullptr );
+		UNIT_TEST( u, reinterpret_cast< std::uintptr_t >( aligned ) % 4096 == 0 );
+		UNIT_TEST( u, source.AllocateBlock( regionSize, 0 ) == nullptr );
+		source.ReleaseBlock( block, 100, 0 );
+		source.ReleaseBlock( aligned, 4096, 4096 );
+		UNIT_TEST_WITH_MSG( u, source.GetFreeBytes() == freeBytes, "Released blocks should be merged back into the region." );
+		block = source.AllocateBlock( freeBytes, 0 );
+		UNIT_TEST_WITH_MSG( u, block != nullptr, "Merged ranges should hold a block as big as the region." );
+		source.ReleaseBlock( block, freeBytes, 0 );
+
+		AllocatorManager::AllocatorParameters allocatorInfo;
+		allocatorInfo.objectSize = 16;
+		allocatorInfo.alignment = 8;
+		allocatorInfo.blockSize = 4096;
+		allocatorInfo.initialBlocks = 1;
+		allocatorInfo.blockSource = &source;
+		const AllocatorManager::AllocatorType types[] = { AllocatorManager::AllocatorType::Linear,
+			AllocatorManager::AllocatorType::Stack, AllocatorManager::AllocatorType::Pool, AllocatorManager::AllocatorType::Tiny };
+		for ( AllocatorManager::AllocatorType type : types )
+		{
+			allocatorInfo.type = type;
+			Allocator * allocator = nullptr;
+			UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+			for ( unsigned int ii = 0; ii < 600; ++ii )
+			{
+				unsigned char * place = static_cast< unsigned char * >( allocator->Allocate( allocatorInfo.objectSize ) );
+				UNIT_TEST_WITH_MSG( u, ( start <= place ) && ( place < end ), "Every chunk should be within the region." );
+			}
+			UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+			UNIT_TEST( u, source.GetFreeBytes() == freeBytes );
+		}
+
+		// A region which is used up can't provide any more blocks.
+		allocatorInfo.type = AllocatorManager::AllocatorType::Pool;
+		allocatorInfo.objectSize = 1024;
+		Allocator * allocator = nullptr;
+		UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+		const unsigned int chunkCount = regionSize / allocatorInfo.objectSize - 4;
+		for ( unsigned int ii = 0; ii < chunkCount; ++ii )
+		{
+			UNIT_TEST( u, allocator->Allocate( allocatorInfo.objectSize ) != nullptr );
+		}
+		UNIT_TEST_FOR_EXCEPTION( u, allocator->Allocate( allocatorInfo.objectSize ), std::bad_alloc );
+		UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+		UNIT_TEST( u, source.GetFreeBytes() == freeBytes );
+	}
+
+	// A region which grows from another source, but no more than allowed.
+	CountingBlockSource counter;
+	{
+		const std::size_t maxGrowth = 4096 * 8;
+		UNIT_TEST_FOR_EXCEPTION( u, RegionBlockSource( start, regionSize, &counter, 4096, 0 ), std::invalid_argument );
+		RegionBlockSource source( start, 4096, &counter, 4096 * 2, maxGrowth );
+		AllocatorManager::AllocatorParameters allocatorInfo;
+		allocatorInfo.type = AllocatorManager::AllocatorType::Stack;
+		allocatorInfo.objectSize = 1024;
+		allocatorInfo.alignment = 8;
+		allocatorInfo.blockSize = 4096;
+		allocatorInfo.initialBlocks = 1;
+		allocatorInfo.blockSource = &source;
+		Allocator * allocator = nullptr;
+		UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+		std::vector< void * > places;
+		try
+		{
+			for ( unsigned int ii = 0; ii < 100; ++ii )
+			{
+				places.push_back( allocator->Allocate( allocatorInfo.objectSize ) );
+			}
+		}
+		catch ( const std::bad_alloc & )
+		{
+		}
+		UNIT_TEST_WITH_MSG( u, places.size() > 4, "The region should have grown." );
+		UNIT_TEST_WITH_MSG( u, places.size() < 100, "The region should not grow more than allowed." );
+		UNIT_TEST( u, source.GetGrowthBytes() != 0 );
+		UNIT_TEST( u, source.GetGrowthBytes() <= maxGrowth );
+		UNIT_TEST( u, counter.blockCount_ != 0 );
+		while ( !places.empty() )
+		{
+			UNIT_TEST( u, allocator->Release( places.back(), allocatorInfo.objectSize ) );
+			places.pop_back();
+		}
+		UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+	}
+	UNIT_TEST_WITH_MSG( u, counter.blockCount_ == 0, "Growth chunks should be released with the region." );
+}
+
+// ----------------------------------------------------------------------------
+
+void TestBlockSource( bool multithreaded )
+{
+	const char * threadType = ( multithreaded ) ? "Multi-Threaded" : "Single-Threaded";
+	std::cout << "Basic Functionality " << threadType << " Block Source Test" << std::endl;
+	ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+	ut::UnitTest * u = uts.AddUnitTest( "Test Block Source" );
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::CreateManager( multithreaded, 4096 ), "Creation should pass since AllocatorManager does not exist yet." );
+
+	CountingBlockSource counter;
+	AllocatorManager::AllocatorParameters allocatorInfo;
+	allocatorInfo.objectSize = 16;
+	allocatorInfo.alignment = 8;
+	allocatorInfo.blockSize = 4096;
+	allocatorInfo.initialBlocks = 2;
+
+	// A LinearAllocator can't release chunks, so just check its blocks are returned when it is destroyed.
+	allocatorInfo.type = AllocatorManager::AllocatorType::Linear;
+	allocatorInfo.blockSource = &counter;
+	Allocator * allocator = nullptr;
+	UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+	UNIT_TEST( u, counter.blockCount_ == allocatorInfo.initialBlocks );
+	for ( unsigned int ii = 0; ii < 1000; ++ii )
+	{
+		UNIT_TEST( u, allocator->Allocate( allocatorInfo.objectSize ) != nullptr );
+	}
+	UNIT_TEST( u, counter.blockCount_ > allocatorInfo.initialBlocks );
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+	UNIT_TEST_WITH_MSG( u, counter.blockCount_ == 0, "Every block should be returned to its source." );
+	allocatorInfo.blockSource = nullptr;
+
+	allocatorInfo.type = AllocatorManager::AllocatorType::Stack;
+	AllocateFromSource( u, allocatorInfo, counter );
+	allocatorInfo.type = AllocatorManager::AllocatorType::Pool;
+	AllocateFromSource( u, allocatorInfo, counter );
+	allocatorInfo.bitmapBlocks = true;
+	AllocateFromSource( u, allocatorInfo, counter );
+	allocatorInfo.bitmapBlocks = false;
+	allocatorInfo.type = AllocatorManager::AllocatorType::Tiny;
+	AllocateFromSource( u, allocatorInfo, counter );
+	allocatorInfo.wideTinyBlocks = true;
+	AllocateFromSource( u, allocatorInfo, counter );
+	allocatorInfo.wideTinyBlocks = false;
+	allocatorInfo.type = AllocatorManager::AllocatorType::SizeClass;
+	AllocateFromSource( u, allocatorInfo, counter );
+	allocatorInfo.alignedBlocks = true;
+	allocatorInfo.type = AllocatorManager::AllocatorType::Pool;
+	AllocateFromSource( u, allocatorInfo, counter );
+	allocatorInfo.alignedBlocks = false;
+	if ( multithreaded )
+	{
+		allocatorInfo.threadCacheSize = 16;
+		AllocateFromSource( u, allocatorInfo, counter );
+		allocatorInfo.threadCacheSize = 0;
+		allocatorInfo.remoteFree = true;
+		AllocateFromSource( u, allocatorInfo, counter );
+		allocatorInfo.remoteFree = false;
+		allocatorInfo.type = AllocatorManager::AllocatorType::Tiny;
+		allocatorInfo.tinyShards = 2;
+		AllocateFromSource( u, allocatorInfo, counter );
+		allocatorInfo.tinyShards = 0;
+	}
+
+	// Blocks straight from the operating system, with and without alignment bigger than a page.
+	MmapBlockSource mmapSource;
+	const std::size_t pageSize = MmapBlockSource::GetPageSize();
+	UNIT_TEST( u, pageSize != 0 );
+	UNIT_TEST( u, ( pageSize & ( pageSize - 1 ) ) == 0 );
+	void * block = mmapSource.AllocateBlock( 100, 0 );
+	UNIT_TEST( u, block != nullptr );
+	UNIT_TEST( u, reinterpret_cast< std::uintptr_t >( block ) % pageSize == 0 );
+	mmapSource.ReleaseBlock( block, 100, 0 );
+	const std::size_t bigAlignment = pageSize * 16;
+	block = mmapSource.AllocateBlock( bigAlignment, bigAlignment );
+	UNIT_TEST( u, block != nullptr );
+	UNIT_TEST( u, reinterpret_cast< std::uintptr_t >( block ) % bigAlignment == 0 );
+	mmapSource.ReleaseBlock( block, bigAlignment, bigAlignment );
+
+	allocatorInfo.type = AllocatorManager::AllocatorType::Pool;
+	allocatorInfo.alignedBlocks = true;
+	allocatorInfo.blockSize = pageSize * 4;
+	allocatorInfo.blockSource = &mmapSource;
+	UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+	void * place = allocator->Allocate( allocatorInfo.objectSize );
+	UNIT_TEST( u, place != nullptr );
+	UNIT_TEST( u, allocator->HasAddress( place ) );
+	UNIT_TEST( u, allocator->Release( place, allocatorInfo.objectSize ) );
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+	allocatorInfo.alignedBlocks = false;
+
+	// Blocks backed by huge pages, or by ordinary pages on machines which have none to give.
+	HugePageBlockSource hugeSource;
+	const std::size_t hugePageSize = HugePageBlockSource::HugePageSize;
+	UNIT_TEST( u, HugePageBlockSource::RoundBlockSize( 0 ) == hugePageSize );
+	UNIT_TEST( u, HugePageBlockSource::RoundBlockSize( 1 ) == hugePageSize );
+	UNIT_TEST( u, HugePageBlockSource::RoundBlockSize( hugePageSize ) == hugePageSize );
+	UNIT_TEST( u, HugePageBlockSource::RoundBlockSize( hugePageSize + 1 ) == hugePageSize * 2 );
+	block = hugeSource.AllocateBlock( 100, 0 );
+	UNIT_TEST( u, block != nullptr );
+	UNIT_TEST( u, hugeSource.GetHugeTlbBlockCount() + hugeSource.GetAdvisedBlockCount() + hugeSource.GetSmallPageBlockCount() == 1 );
+	if ( hugeSource.GetSmallPageBlockCount() == 0 )
+	{
+		UNIT_TEST( u, reinterpret_cast< std::uintptr_t >( block ) % hugePageSize == 0 );
+	}
+	static_cast< unsigned char * >( block )[ hugePageSize - 1 ] = 1;
+	hugeSource.ReleaseBlock( block, 100, 0 );
+
+	allocatorInfo.type = AllocatorManager::AllocatorType::Pool;
+	allocatorInfo.blockSize = HugePageBlockSource::RoundBlockSize( 1 );
+	allocatorInfo.initialBlocks = 1;
+	allocatorInfo.blockSource = &hugeSource;
+	UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+	UNIT_TEST( u, hugeSource.GetHugeTlbBlockCount() + hugeSource.GetAdvisedBlockCount() + hugeSource.GetSmallPageBlockCount() == 2 );
+	place = allocator->Allocate( allocatorInfo.objectSize );
+	UNIT_TEST( u, place != nullptr );
+	UNIT_TEST( u, allocator->HasAddress( place ) );
+	UNIT_TEST( u, allocator->Release( place, allocatorInfo.objectSize ) );
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+
+	// A small blockSize is rounded up so each block fills its huge page.
+	allocatorInfo.objectSize = 24;
+	allocatorInfo.blockSize = 4096;
+	UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+	UNIT_TEST( u, hugeSource.GetHugeTlbBlockCount() + hugeSource.GetAdvisedBlockCount() + hugeSource.GetSmallPageBlockCount() == 3 );
+	for ( std::size_t ii = 0; ii < hugePageSize / allocatorInfo.objectSize; ++ii )
+	{
+		UNIT_TEST( u, allocator->Allocate( allocatorInfo.objectSize ) != nullptr );
+	}
+	UNIT_TEST( u, hugeSource.GetHugeTlbBlockCount() + hugeSource.GetAdvisedBlockCount() + hugeSource.GetSmallPageBlockCount() == 3 );
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+	allocatorInfo.objectSize = 16;
+
+	// Allocators which pick their own small blocks would waste most of each huge page.
+	allocatorInfo.type = AllocatorManager::AllocatorType::Tiny;
+	UNIT_TEST_FOR_EXCEPTION( u, AllocatorManager::CreateAllocator( allocatorInfo ), std::invalid_argument );
+	allocatorInfo.type = AllocatorManager::AllocatorType::SizeClass;
+	UNIT_TEST_FOR_EXCEPTION( u, AllocatorManager::CreateAllocator( allocatorInfo ), std::invalid_argument );
+	allocatorInfo.type = AllocatorManager::AllocatorType::Tiny;
+	allocatorInfo.wideTinyBlocks = true;
+	// A wide tiny block of 16 byte objects can't fill even one huge page.
+	UNIT_TEST_FOR_EXCEPTION( u, AllocatorManager::CreateAllocator( allocatorInfo ), std::invalid_argument );
+	allocatorInfo.objectSize = 32;
+	UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+	const std::size_t hugeBlocks = hugeSource.GetHugeTlbBlockCount() + hugeSource.GetAdvisedBlockCount() + hugeSource.GetSmallPageBlockCount();
+	for ( std::size_t ii = 0; ii < WideTinyBlock::MaxObjectsPerBlock; ++ii )
+	{
+		UNIT_TEST( u, allocator->Allocate( allocatorInfo.objectSize ) != nullptr );
+	}
+	UNIT_TEST_WITH_MSG( u, hugeSource.GetHugeTlbBlockCount() + hugeSource.GetAdvisedBlockCount() + hugeSource.GetSmallPageBlockCount() == hugeBlocks,
+		"One huge page should hold a full wide tiny block." );
+	place = allocator->Allocate( allocatorInfo.objectSize );
+	UNIT_TEST( u, place != nullptr );
+	UNIT_TEST( u, allocator->Release( place, allocatorInfo.objectSize ) );
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+	allocatorInfo.objectSize = 16;
+	allocatorInfo.wideTinyBlocks = false;
+	allocatorInfo.initialBlocks = 2;
+
+	TestRegionBlockSource( u );
+
+	// Blocks from a parent pool allocator whose objects are as big as the blocks.
+	UNIT_TEST_FOR_EXCEPTION( u, AllocatorBlockSource( nullptr ), std::invalid_argument );
+	AllocatorManager::AllocatorParameters parentInfo;
+	parentInfo.type = AllocatorManager::AllocatorType::Pool;
+	parentInfo.objectSize = 1024;
+	parentInfo.alignment = 8;
+	parentInfo.blockSize = 1024 * 16;
+	parentInfo.initialBlocks = 1;
+	Allocator * parent = nullptr;
+	UNIT_TEST_WITH_MSG( u, ( parent = AllocatorManager::CreateAllocator( parentInfo ) ) != nullptr, "allocator should not be nullptr." );
+	{
+		AllocatorBlockSource parentSource( parent );
+		UNIT_TEST( u, parentSource.GetParent() == parent );
+		allocatorInfo.type = AllocatorManager::AllocatorType::Stack;
+		allocatorInfo.blockSize = parentInfo.objectSize;
+		allocatorInfo.blockSource = &parentSource;
+		UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+		std::vector< void * > places;
+		for ( unsigned int ii = 0; ii < 500; ++ii )
+		{
+			places.push_back( allocator->Allocate( allocatorInfo.objectSize ) );
+			UNIT_TEST( u, parent->HasAddress( places.back() ) );
+		}
+		while ( !places.empty() )
+		{
+			UNIT_TEST( u, allocator->Release( places.back(), allocatorInfo.objectSize ) );
+			places.pop_back();
+		}
+		UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+		parent->TrimEmptyBlocks();
+		UNIT_TEST_WITH_MSG( u, parent->GetFragmentationPercent() == 0.0, "Every block should be returned to the parent." );
+	}
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( parent, true ), "DestroyAllocator should pass since parameter is valid." );
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyManager( true ), "Destruction should pass since AllocatorManager exists." );
+}
+
+// ----------------------------------------------------------------------------
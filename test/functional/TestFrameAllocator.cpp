@@ -0,0 +1,102 @@
+
+#include "../../include/AllocatorManager.hpp"
+#include "../../include/FrameAllocator.hpp"
+#include "../../include/BlockSource.hpp"
+
+#include "UnitTest.hpp"
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <cstring>
+
+using namespace std;
+using namespace memwa;
+
+// ----------------------------------------------------------------------------
+
+void TestFrameAllocator( bool multithreaded )
+{
+	const char * threadType = ( multithreaded ) ? "Multi-Threaded" : "Single-Threaded";
+	std::cout << "Basic Functionality " << threadType << " Frame Allocator Test" << std::endl;
+	ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+	ut::UnitTest * u = uts.AddUnitTest( "Test Frame Allocator" );
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::CreateManager( multithreaded, 4096 ), "Creation should pass since AllocatorManager does not exist yet." );
+
+	AllocatorManager::AllocatorParameters allocatorInfo;
+	allocatorInfo.type = AllocatorManager::AllocatorType::Frame;
+	allocatorInfo.objectSize = 32;
+	allocatorInfo.alignment = 8;
+	allocatorInfo.blockSize = 4096;
+	allocatorInfo.initialBlocks = 1;
+	Allocator * allocator = nullptr;
+
+	allocatorInfo.frameCount = 1;
+	UNIT_TEST_FOR_EXCEPTION( u, AllocatorManager::CreateAllocator( allocatorInfo ), std::invalid_argument );
+	allocatorInfo.frameCount = FrameAllocator::MaxFrameCount + 1;
+	UNIT_TEST_FOR_EXCEPTION( u, AllocatorManager::CreateAllocator( allocatorInfo ), std::invalid_argument );
+
+	// Chunks live until AdvanceFrame is called frameCount times, and then their memory is reused.
+	for ( unsigned int frameCount = 2; frameCount <= 3; ++frameCount )
+	{
+		allocatorInfo.frameCount = frameCount;
+		UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+		FrameAllocator * frames = dynamic_cast< FrameAllocator * >( allocator );
+		UNIT_TEST( u, frames != nullptr );
+		UNIT_TEST( u, frames->GetFrameCount() == frameCount );
+		std::vector< void * > firsts;
+		for ( unsigned int ii = 0; ii < frameCount; ++ii )
+		{
+			void * place = allocator->Allocate( 100 );
+			UNIT_TEST( u, place != nullptr );
+			std::memset( place, static_cast< int >( ii ), 100 );
+			firsts.push_back( place );
+			frames->AdvanceFrame();
+		}
+		for ( unsigned int ii = 0; ii < frameCount; ++ii )
+		{
+			UNIT_TEST( u, allocator->HasAddress( firsts[ ii ] ) );
+			if ( ii != 0 )
+			{
+				UNIT_TEST_WITH_MSG( u, static_cast< unsigned char * >( firsts[ ii ] )[ 99 ] == ii, "Chunks of recent frames should be untouched." );
+			}
+		}
+		UNIT_TEST_WITH_MSG( u, allocator->Allocate( 100 ) == firsts[ 0 ], "The oldest frame's memory should be reused." );
+		UNIT_TEST( u, !allocator->Release( firsts[ 0 ], 100 ) );
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+		UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+	}
+
+	// Blocks are kept when each frame is reset, so a fixed region holds any number of frames.
+	const std::size_t regionSize = 4096 * 16;
+	alignas( 16 ) static unsigned char region[ regionSize ];
+	{
+		RegionBlockSource source( region, regionSize );
+		allocatorInfo.frameCount = 2;
+		allocatorInfo.blockSource = &source;
+		UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+		FrameAllocator * frames = dynamic_cast< FrameAllocator * >( allocator );
+		for ( unsigned int frame = 0; frame < 200; ++frame )
+		{
+			for ( unsigned int ii = 0; ii < 100; ++ii )
+			{
+				void * place = allocator->Allocate( 150 + ( ii % 7 ) * 16 );
+				UNIT_TEST( u, place != nullptr );
+				UNIT_TEST( u, ( region <= place ) && ( place < region + regionSize ) );
+			}
+			frames->AdvanceFrame();
+		}
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+		UNIT_TEST( u, allocator->TrimEmptyBlocks() );
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+		UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+		UNIT_TEST( u, source.GetFreeBytes() == regionSize );
+		allocatorInfo.blockSource = nullptr;
+	}
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyManager( true ), "Destruction should pass since AllocatorManager exists." );
+}
+
+// ----------------------------------------------------------------------------
@@ -1,5 +1,6 @@
 
 #include "../../include/AllocatorManager.hpp"
+#include "../../include/LinearAllocator.hpp"
 
 #include "ChunkList.hpp"
 
@@ -163,6 +164,87 @@ void TestLinearAllocator( bool multithreaded, bool showProximityCounts )
 		UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
 	}
 
+	{
+		UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+		LinearAllocator * linear = dynamic_cast< LinearAllocator * >( allocator );
+		UNIT_TEST( u, linear != nullptr );
+		const LinearAllocator::Marker start = linear->GetMarker();
+		UNIT_TEST( u, start.usedBlocks_ == 0 );
+		unsigned char * first = static_cast< unsigned char * >( allocator->Allocate( 100 ) );
+		UNIT_TEST( u, first != nullptr );
+		const LinearAllocator::Marker marker = linear->GetMarker();
+		UNIT_TEST( u, marker.usedBlocks_ == 1 );
+
+		// Fill several blocks after the marker, then rewind so the next chunk is where the first one after the marker was.
+		void * afterMarker = allocator->Allocate( 100 );
+		for ( unsigned int ii = 0; ii < 100; ++ii )
+		{
+			UNIT_TEST( u, allocator->Allocate( 500 ) != nullptr );
+		}
+		UNIT_TEST( u, linear->GetMarker().usedBlocks_ > 10 );
+		UNIT_TEST( u, !linear->IsCorrupt() );
+		const LinearAllocator::Marker later = linear->GetMarker();
+		UNIT_TEST( u, linear->RewindTo( marker ) );
+		UNIT_TEST( u, !linear->IsCorrupt() );
+		UNIT_TEST_WITH_MSG( u, !linear->RewindTo( later ), "Rewinding to a position after the current one should fail." );
+		UNIT_TEST( u, linear->GetMarker().usedBlocks_ == marker.usedBlocks_ );
+		UNIT_TEST( u, linear->GetMarker().freeSpot_ == marker.freeSpot_ );
+		UNIT_TEST( u, allocator->Allocate( 100 ) == afterMarker );
+
+		// Kept blocks are reused instead of making new ones, so fragmentation shows them as excess.
+		for ( unsigned int ii = 0; ii < 100; ++ii )
+		{
+			UNIT_TEST( u, allocator->Allocate( 500 ) != nullptr );
+		}
+		UNIT_TEST( u, !linear->IsCorrupt() );
+		linear->Reset();
+		UNIT_TEST( u, !linear->IsCorrupt() );
+		UNIT_TEST( u, linear->GetMarker().usedBlocks_ == 0 );
+		UNIT_TEST( u, allocator->GetFragmentationPercent() == 1.0F );
+		UNIT_TEST( u, allocator->Allocate( 100 ) != nullptr );
+		UNIT_TEST( u, allocator->HasAddress( first ) );
+
+		// Blocks which are not kept are destroyed.
+		linear->Reset( false );
+		UNIT_TEST( u, !linear->IsCorrupt() );
+		UNIT_TEST( u, !allocator->HasAddress( first ) );
+		UNIT_TEST( u, allocator->GetFragmentationPercent() == 0.0F );
+		UNIT_TEST( u, allocator->Allocate( 100 ) != nullptr );
+		UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+	}
+
+	{
+		UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+		LinearAllocator * linear = dynamic_cast< LinearAllocator * >( allocator );
+		UNIT_TEST( u, linear != nullptr );
+		// The inline path stays within the most recently used block, so chunks from both paths never overlap.
+		ChunkList chunks( chunkCount );
+		for ( unsigned int ii = 0; ii < chunkCount; ++ii )
+		{
+			bytes = ( ii % 100 ) + 1;
+			void * place = ( ii % 5 == 0 ) ? allocator->Allocate( bytes ) : linear->FastAllocate( bytes );
+			UNIT_TEST( u, place != nullptr );
+			UNIT_TEST( u, reinterpret_cast< std::size_t >( place ) % allocatorInfo.alignment == 0 );
+			std::memset( place, static_cast< int >( ii ), bytes );
+			chunks.AddChunk( place );
+		}
+		UNIT_TEST( u, chunks.AreUnique() );
+		UNIT_TEST( u, !linear->IsCorrupt() );
+
+		// Rewinding moves the free spot, and the inline path must continue from there.
+		const LinearAllocator::Marker marker = linear->GetMarker();
+		void * afterMarker = linear->FastAllocate( 100 );
+		UNIT_TEST( u, linear->FastAllocate( 1000 ) != nullptr );
+		UNIT_TEST( u, linear->FastAllocate( 2000 ) != nullptr );
+		UNIT_TEST( u, linear->RewindTo( marker ) );
+		UNIT_TEST( u, linear->FastAllocate( 100 ) == afterMarker );
+		linear->Reset( false );
+		UNIT_TEST( u, allocator->GetFragmentationPercent() == 0.0F );
+		UNIT_TEST( u, linear->FastAllocate( 100 ) != nullptr );
+		UNIT_TEST( u, !linear->IsCorrupt() );
+		UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+	}
+
 	if ( showProximityCounts )
 	{
 		unsigned int percent = ( hintProximityCount * 100 ) / hintTestCount;
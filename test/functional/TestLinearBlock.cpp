@@ -57,7 +57,7 @@ void TestLinearBlock( ut::UnitTest * u, const std::size_t blockSize, const std::
 		}
 		std::size_t bytesAfter = block.GetFreeBytes( blockSize );
 		UNIT_TEST( u, bytesAfter < bytesBefore );
-		UNIT_TEST( u, !block.IsEmpty( blockSize ) );
+		UNIT_TEST( u, !block.IsEmpty( alignment ) );
 		UNIT_TEST( u, chunk != nullptr );
 		UNIT_TEST( u, reinterpret_cast< std::size_t >( chunk ) % alignment == 0 );
 		UNIT_TEST( u, !block.IsCorrupt( blockSize, alignment ) );
@@ -80,7 +80,7 @@ void TestLinearBlock( ut::UnitTest * u, const std::size_t blockSize, const std::
 	}
 	if ( alignmentSupported )
 	{
-		UNIT_TEST( u, !block.IsEmpty( blockSize ) );
+		UNIT_TEST( u, !block.IsEmpty( alignment ) );
 	}
 
 	block.Destroy();
@@ -8,9 +8,12 @@
 #include <chrono>
 #include <iostream>
 #include <mutex>
+#include <stdexcept>
 #include <thread>
+#include <vector>
 
 #include <cassert>
+#include <cstring>
 
 using namespace memwa;
 
@@ -170,6 +173,240 @@ void DoSimplePoolThreadTest( bool showProximityCounts )
 
 // ----------------------------------------------------------------------------
 
+void DoSimpleCachedPoolThreadTest( bool showProximityCounts )
+{
+	std::cout << "Simple Cached Pool Allocator Thread-Safety Functionality Test" << std::endl; 
+	ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+	ut::UnitTest * u = uts.AddUnitTest( "Cached Pool Thread Test" );
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::CreateManager( true, 4096 ), "Creation should pass since AllocatorManager does not exist yet." );
+
+	AllocatorManager::AllocatorParameters allocatorInfo;
+	allocatorInfo.type = AllocatorManager::AllocatorType::Pool;
+	allocatorInfo.objectSize = 16;
+	allocatorInfo.alignment = 8;
+	allocatorInfo.blockSize = 2048;
+	allocatorInfo.initialBlocks = 1;
+	allocatorInfo.threadCacheSize = 64;
+	Allocator * allocator = nullptr;
+	UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+
+	showProximityCounts_ = showProximityCounts;
+	RunSimpleThreadTest( u, allocator, allocatorInfo );
+	UNIT_TEST_WITH_MSG( u, allocator->GetFragmentationPercent() == 0.0F, "Each thread should flush its magazine when it exits." );
+
+	void * place = allocator->Allocate( allocatorInfo.objectSize );
+	UNIT_TEST_WITH_MSG( u, place != nullptr, "Allocation should pass since magazine gets refilled." );
+	UNIT_TEST_WITH_MSG( u, allocator->Release( place, allocatorInfo.objectSize ), "Release should pass since chunk goes into magazine." );
+	UNIT_TEST_WITH_MSG( u, allocator->HasAddress( place ), "Chunk should still be inside a block while it is cached." );
+	allocator->TrimEmptyBlocks();
+	UNIT_TEST_WITH_MSG( u, !allocator->HasAddress( place ), "TrimEmptyBlocks should flush magazine so the block can be released." );
+
+	void * places[ 200 ];
+	allocator->AllocateBulk( places, 200, allocatorInfo.objectSize );
+	UNIT_TEST_WITH_MSG( u, allocator->HasAddress( places[ 199 ] ), "Bulk allocation should pass since magazine and blocks have chunks." );
+	UNIT_TEST_WITH_MSG( u, allocator->ReleaseBulk( places, 200, allocatorInfo.objectSize ), "Bulk release should pass since chunks came from allocator." );
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyManager( true ), "Destruction should pass since AllocatorManager exists." );
+}
+
+// ----------------------------------------------------------------------------
+
+void DoSimpleLockFreePoolThreadTest( bool showProximityCounts )
+{
+	std::cout << "Simple Lock-Free Pool Allocator Thread-Safety Functionality Test" << std::endl; 
+	ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+	ut::UnitTest * u = uts.AddUnitTest( "Lock-Free Pool Thread Test" );
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::CreateManager( true, 4096 ), "Creation should pass since AllocatorManager does not exist yet." );
+
+	AllocatorManager::AllocatorParameters allocatorInfo;
+	allocatorInfo.type = AllocatorManager::AllocatorType::Pool;
+	allocatorInfo.objectSize = 16;
+	allocatorInfo.alignment = 8;
+	allocatorInfo.blockSize = 2048;
+	allocatorInfo.initialBlocks = 1;
+	allocatorInfo.lockFree = true;
+	allocatorInfo.threadCacheSize = 16;
+	Allocator * allocator = nullptr;
+	UNIT_TEST_FOR_EXCEPTION( u, AllocatorManager::CreateAllocator( allocatorInfo ), std::invalid_argument );
+	allocatorInfo.threadCacheSize = 0;
+	UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+
+	showProximityCounts_ = showProximityCounts;
+	RunSimpleThreadTest( u, allocator, allocatorInfo );
+
+	void * place = allocator->Allocate( allocatorInfo.objectSize );
+	UNIT_TEST_WITH_MSG( u, place != nullptr, "Allocation should pass since free stack has chunks." );
+	UNIT_TEST_WITH_MSG( u, allocator->HasAddress( place ), "Chunk should be inside a block." );
+	UNIT_TEST_WITH_MSG( u, allocator->Release( place, allocatorInfo.objectSize ), "Release should pass since chunk came from allocator." );
+	UNIT_TEST_WITH_MSG( u, !allocator->IsCorrupt(), "Allocator should not be corrupt." );
+
+	void * places[ 200 ];
+	allocator->AllocateBulk( places, 200, allocatorInfo.objectSize );
+	UNIT_TEST_WITH_MSG( u, allocator->HasAddress( places[ 199 ] ), "Bulk allocation should pass since free stack has chunks." );
+	UNIT_TEST_WITH_MSG( u, allocator->ReleaseBulk( places, 200, allocatorInfo.objectSize ), "Bulk release should pass since chunks came from allocator." );
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+
+	// A refill only takes a batch of chunks from one block, so the other initial block is never used and can be trimmed.
+	allocatorInfo.initialBlocks = 2;
+	UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+	place = allocator->Allocate( allocatorInfo.objectSize );
+	UNIT_TEST_WITH_MSG( u, allocator->HasAddress( place ), "Chunk should be inside a block." );
+	UNIT_TEST_WITH_MSG( u, allocator->TrimEmptyBlocks(), "Trim should release the block which never gave out a chunk." );
+	UNIT_TEST_WITH_MSG( u, !allocator->TrimEmptyBlocks(), "Trim should keep the block whose chunks are on the free stack." );
+	UNIT_TEST_WITH_MSG( u, allocator->HasAddress( place ), "Chunk should still be inside a block." );
+	UNIT_TEST_WITH_MSG( u, allocator->Release( place, allocatorInfo.objectSize ), "Release should pass since chunk came from allocator." );
+	UNIT_TEST_WITH_MSG( u, !allocator->IsCorrupt(), "Allocator should not be corrupt." );
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyManager( true ), "Destruction should pass since AllocatorManager exists." );
+}
+
+// ----------------------------------------------------------------------------
+
+/// Passes chunks from threads which allocate them to threads which release them.
+struct ChunkQueue
+{
+	std::mutex mutex_;
+	std::vector< void * > chunks_;
+	unsigned int producersLeft_;
+};
+
+// ----------------------------------------------------------------------------
+
+void ProduceChunks( ut::UnitTest * u, Allocator * allocator, unsigned int objectSize, ChunkQueue & queue, std::mutex & mutex )
+{
+	const unsigned int loopCount = 2000;
+	try
+	{
+		for ( unsigned int ii = 0; ii < loopCount; ++ii )
+		{
+			void * place = allocator->Allocate( objectSize );
+			// Write to the whole chunk so a chunk handed out twice would be noticed by the consumer.
+			std::memset( place, 0x5A, objectSize );
+			MyLockGuard lock( queue.mutex_ );
+			queue.chunks_.push_back( place );
+		}
+	}
+	catch ( const std::exception & ex )
+	{
+		MyLockGuard lock( mutex );
+		UNIT_TEST_WITH_MSG( u, false, ex.what() );
+	}
+	MyLockGuard lock( queue.mutex_ );
+	--queue.producersLeft_;
+}
+
+// ----------------------------------------------------------------------------
+
+void ConsumeChunks( ut::UnitTest * u, Allocator * allocator, unsigned int objectSize, ChunkQueue & queue, std::mutex & mutex )
+{
+	std::vector< void * > taken;
+	for ( ;; )
+	{
+		MyLockGuard queueLock( queue.mutex_ );
+		if ( queue.chunks_.empty() )
+		{
+			if ( 0 == queue.producersLeft_ )
+			{
+				return;
+			}
+			queueLock.unlock();
+			std::this_thread::yield();
+			continue;
+		}
+		taken.swap( queue.chunks_ );
+		queueLock.unlock();
+		bool allReleased = true;
+		for ( void * place : taken )
+		{
+			const unsigned char * bytes = reinterpret_cast< const unsigned char * >( place );
+			if ( ( bytes[ 0 ] != 0x5A ) || ( bytes[ objectSize - 1 ] != 0x5A ) || !allocator->Release( place, objectSize ) )
+			{
+				allReleased = false;
+			}
+		}
+		taken.clear();
+		MyLockGuard lock( mutex );
+		UNIT_TEST( u, allReleased );
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+void DoRemoteFreePoolThreadTest( bool showProximityCounts )
+{
+	std::cout << "Remote-Free Pool Allocator Thread-Safety Functionality Test" << std::endl; 
+	ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+	ut::UnitTest * u = uts.AddUnitTest( "Remote-Free Pool Thread Test" );
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::CreateManager( true, 4096 ), "Creation should pass since AllocatorManager does not exist yet." );
+
+	AllocatorManager::AllocatorParameters allocatorInfo;
+	allocatorInfo.type = AllocatorManager::AllocatorType::Pool;
+	allocatorInfo.objectSize = 16;
+	allocatorInfo.alignment = 8;
+	allocatorInfo.blockSize = 2048;
+	allocatorInfo.initialBlocks = 1;
+	allocatorInfo.remoteFree = true;
+	Allocator * allocator = nullptr;
+	allocatorInfo.lockFree = true;
+	UNIT_TEST_FOR_EXCEPTION( u, AllocatorManager::CreateAllocator( allocatorInfo ), std::invalid_argument );
+	allocatorInfo.lockFree = false;
+	allocatorInfo.blockSize = allocatorInfo.objectSize;
+	UNIT_TEST_FOR_EXCEPTION( u, AllocatorManager::CreateAllocator( allocatorInfo ), std::invalid_argument );
+	allocatorInfo.blockSize = 2048;
+	UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+
+	showProximityCounts_ = showProximityCounts;
+	// Each thread releases its own chunks, and leaves its blocks for the next thread when it exits.
+	RunSimpleThreadTest( u, allocator, allocatorInfo );
+
+	// Producers allocate chunks which consumers release, so every release is from a thread which does not own the block.
+	{
+		std::mutex unitTestMutex;
+		const unsigned int producerCount = 4;
+		const unsigned int consumerCount = 2;
+		ChunkQueue queue;
+		queue.producersLeft_ = producerCount;
+		std::vector< std::thread > threads;
+		for ( unsigned int ii = 0; ii < producerCount; ++ii )
+		{
+			threads.emplace_back( ProduceChunks, u, allocator, allocatorInfo.objectSize, std::ref( queue ), std::ref( unitTestMutex ) );
+		}
+		for ( unsigned int ii = 0; ii < consumerCount; ++ii )
+		{
+			threads.emplace_back( ConsumeChunks, u, allocator, allocatorInfo.objectSize, std::ref( queue ), std::ref( unitTestMutex ) );
+		}
+		for ( std::thread & t : threads )
+		{
+			t.join();
+		}
+		UNIT_TEST( u, queue.chunks_.empty() );
+	}
+
+	// Every thread which owned blocks has exited, so this thread can take back their remote chunks and trim them.
+	UNIT_TEST_WITH_MSG( u, !allocator->IsCorrupt(), "Allocator should not be corrupt." );
+	allocator->TrimEmptyBlocks();
+	UNIT_TEST_WITH_MSG( u, allocator->GetFragmentationPercent() == 0.0, "No blocks should be left since every chunk was released." );
+
+	void * place = allocator->Allocate( allocatorInfo.objectSize );
+	UNIT_TEST_WITH_MSG( u, place != nullptr, "Allocation should pass since a new block can be made." );
+	UNIT_TEST_WITH_MSG( u, allocator->HasAddress( place ), "Chunk should be inside a block." );
+	UNIT_TEST_WITH_MSG( u, !allocator->HasAddress( reinterpret_cast< unsigned char * >( place ) + allocatorInfo.blockSize ),
+		"Address past end of block should not be inside a block." );
+	UNIT_TEST_WITH_MSG( u, allocator->Release( place, allocatorInfo.objectSize ), "Release should pass since chunk came from allocator." );
+	UNIT_TEST_WITH_MSG( u, !allocator->HasAddress( place ), "Block should not be in use once its last chunk is released." );
+	UNIT_TEST_WITH_MSG( u, !allocator->IsCorrupt(), "Allocator should not be corrupt." );
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyManager( true ), "Destruction should pass since AllocatorManager exists." );
+}
+
+// ----------------------------------------------------------------------------
+
 void DoSimpleTinyThreadTest( bool showProximityCounts )
 {
 	std::cout << "Simple Tiny Allocator Thread-Safety Functionality Test" << std::endl; 
@@ -196,6 +433,85 @@ void DoSimpleTinyThreadTest( bool showProximityCounts )
 
 // ----------------------------------------------------------------------------
 
+void DoShardedTinyThreadTest( bool showProximityCounts )
+{
+	std::cout << "Sharded Tiny Allocator Thread-Safety Functionality Test" << std::endl; 
+	ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+	ut::UnitTest * u = uts.AddUnitTest( "Sharded Tiny Thread Test" );
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::CreateManager( true, 4096 ), "Creation should pass since AllocatorManager does not exist yet." );
+
+	AllocatorManager::AllocatorParameters allocatorInfo;
+	allocatorInfo.type = AllocatorManager::AllocatorType::Tiny;
+	allocatorInfo.objectSize = 16;
+	allocatorInfo.alignment = 8;
+	allocatorInfo.blockSize = 16 * 256;
+	allocatorInfo.initialBlocks = 1;
+	allocatorInfo.tinyShards = AllocatorManager::OneShardPerCpu;
+	allocatorInfo.wideTinyBlocks = true;
+	UNIT_TEST_FOR_EXCEPTION( u, AllocatorManager::CreateAllocator( allocatorInfo ), std::invalid_argument );
+	allocatorInfo.wideTinyBlocks = false;
+	Allocator * allocator = nullptr;
+	UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+
+	showProximityCounts_ = showProximityCounts;
+	RunSimpleThreadTest( u, allocator, allocatorInfo );
+
+	// Threads may move between CPUs, and consumers release chunks allocated from other shards.
+	{
+		std::mutex unitTestMutex;
+		const unsigned int producerCount = 4;
+		const unsigned int consumerCount = 2;
+		ChunkQueue queue;
+		queue.producersLeft_ = producerCount;
+		std::vector< std::thread > threads;
+		for ( unsigned int ii = 0; ii < producerCount; ++ii )
+		{
+			threads.emplace_back( ProduceChunks, u, allocator, allocatorInfo.objectSize, std::ref( queue ), std::ref( unitTestMutex ) );
+		}
+		for ( unsigned int ii = 0; ii < consumerCount; ++ii )
+		{
+			threads.emplace_back( ConsumeChunks, u, allocator, allocatorInfo.objectSize, std::ref( queue ), std::ref( unitTestMutex ) );
+		}
+		for ( std::thread & t : threads )
+		{
+			t.join();
+		}
+		UNIT_TEST( u, queue.chunks_.empty() );
+	}
+
+	UNIT_TEST_WITH_MSG( u, !allocator->IsCorrupt(), "Allocator should not be corrupt." );
+	allocator->TrimEmptyBlocks();
+	UNIT_TEST_WITH_MSG( u, allocator->GetFragmentationPercent() == 0.0, "No blocks should be left since every chunk was released." );
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+
+	// Objects of one byte still have room for the shard index in the first chunk of each block.
+	allocatorInfo.objectSize = 1;
+	allocatorInfo.alignment = 1;
+	allocatorInfo.blockSize = 255;
+	allocatorInfo.tinyShards = 4;
+	UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+	const unsigned int chunkCount = 600;
+	void * places[ chunkCount ];
+	allocator->AllocateBulk( places, chunkCount, allocatorInfo.objectSize );
+	for ( unsigned int ii = 0; ii < chunkCount; ++ii )
+	{
+		UNIT_TEST( u, allocator->HasAddress( places[ ii ] ) );
+	}
+	UNIT_TEST_WITH_MSG( u, !allocator->IsCorrupt(), "Allocator should not be corrupt." );
+	RunSimpleThreadTest( u, allocator, allocatorInfo );
+	UNIT_TEST_WITH_MSG( u, allocator->ReleaseBulk( places, chunkCount, allocatorInfo.objectSize ), "ReleaseBulk should pass since chunks came from allocator." );
+	UNIT_TEST_WITH_MSG( u, !allocator->IsCorrupt(), "Allocator should not be corrupt." );
+	allocator->TrimEmptyBlocks();
+	UNIT_TEST_WITH_MSG( u, !allocator->HasAddress( places[ 0 ] ), "Block should not be in use once its last chunk is released." );
+	UNIT_TEST_WITH_MSG( u, allocator->GetFragmentationPercent() == 0.0, "No blocks should be left since every chunk was released." );
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyManager( true ), "Destruction should pass since AllocatorManager exists." );
+}
+
+// ----------------------------------------------------------------------------
+
 void DoSimpleStackThreadTest( bool showProximityCounts )
 {
 	std::cout << "Simple Stack Allocator Thread-Safety Functionality Test" << std::endl; 
@@ -1,12 +1,17 @@
 
 #include "../../include/AllocatorManager.hpp"
+#include "../../include/PoolAllocator.hpp"
+#include "../../src/BitmapBlock.hpp"
 
 #include "ChunkList.hpp"
 
 #include "UnitTest.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <stdexcept>
 #include <typeinfo>
+#include <vector>
 
 #include <cassert>
 #include <cstring>
@@ -49,10 +54,11 @@ void AllocatePoolChunks( ut::UnitTest * u, Allocator * allocator, unsigned int c
 
 // ----------------------------------------------------------------------------
 
-void TestPoolAllocator( bool multithreaded, bool showProximityCounts )
+void TestPoolAllocator( bool multithreaded, bool showProximityCounts, bool bitmapBlocks )
 {
 	const char * threadType = ( multithreaded ) ? "Multi-Threaded" : "Single-Threaded";
-	std::cout << "Basic Functionality " << threadType << " Pool Allocator Test" << std::endl; 
+	const char * blockType = ( bitmapBlocks ) ? " Bitmap" : "";
+	std::cout << "Basic Functionality " << threadType << blockType << " Pool Allocator Test" << std::endl; 
 	ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
 	ut::UnitTest * u = uts.AddUnitTest( "Test Pool Allocator" );
 
@@ -64,7 +70,17 @@ void TestPoolAllocator( bool multithreaded, bool showProximityCounts )
 	allocatorInfo.alignment = 8;
 	allocatorInfo.blockSize = 2048;
 	allocatorInfo.initialBlocks = 1;
+	allocatorInfo.bitmapBlocks = bitmapBlocks;
 	Allocator * allocator = nullptr;
+	if ( multithreaded && bitmapBlocks )
+	{
+		allocatorInfo.lockFree = true;
+		UNIT_TEST_FOR_EXCEPTION( u, AllocatorManager::CreateAllocator( allocatorInfo ), std::invalid_argument );
+		allocatorInfo.lockFree = false;
+		allocatorInfo.threadCacheSize = 16;
+		UNIT_TEST_FOR_EXCEPTION( u, AllocatorManager::CreateAllocator( allocatorInfo ), std::invalid_argument );
+		allocatorInfo.threadCacheSize = 0;
+	}
 	UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
 //	std::cout << "Allocator Type: " << typeid( *allocator ).name() << std::endl;
 
@@ -193,6 +209,98 @@ void TestPoolAllocator( bool multithreaded, bool showProximityCounts )
 		UNIT_TEST( u, chunks.GetCount() == 0 );
 	}
 
+	{
+		// Allocate and release in bulk, with and without hints, spanning several blocks.
+		std::vector< void * > places( chunkCount, nullptr );
+		allocator->AllocateBulk( &places[ 0 ], chunkCount, allocatorInfo.objectSize );
+		ChunkList chunks( chunkCount );
+		for ( unsigned int ii = 0; ii < chunkCount; ++ii )
+		{
+			UNIT_TEST( u, places[ ii ] != nullptr );
+			UNIT_TEST( u, allocator->HasAddress( places[ ii ] ) );
+			chunks.AddChunk( places[ ii ] );
+		}
+		UNIT_TEST( u, chunks.AreUnique() );
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+		UNIT_TEST( u, allocator->ReleaseBulk( &places[ 0 ], chunkCount / 2, allocatorInfo.objectSize ) );
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+		allocator->AllocateBulk( &places[ 0 ], chunkCount / 2, allocatorInfo.objectSize, places[ chunkCount - 1 ] );
+		UNIT_TEST( u, allocator->ReleaseBulk( &places[ 0 ], chunkCount, allocatorInfo.objectSize ) );
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+		UNIT_TEST_FOR_EXCEPTION( u, allocator->AllocateBulk( &places[ 0 ], 4, allocatorInfo.objectSize * 2 ), std::invalid_argument );
+		UNIT_TEST_FOR_EXCEPTION( u, allocator->ReleaseBulk( &places[ 0 ], 4, allocatorInfo.objectSize * 2 ), std::invalid_argument );
+	}
+
+	{
+		// Fill many blocks, then release a few chunks spread across them. Later allocations should reuse
+		// those chunks instead of making a new block.
+		const unsigned int objectsPerBlock = ( allocatorInfo.bitmapBlocks )
+			? BitmapBlock::GetObjectsPerBlock( allocatorInfo.blockSize, allocatorInfo.objectSize )
+			: allocatorInfo.blockSize / allocatorInfo.objectSize;
+		const unsigned int fullCount = ( chunkCount / objectsPerBlock ) * objectsPerBlock;
+		std::vector< void * > places( fullCount, nullptr );
+		std::vector< void * > released;
+		for ( unsigned int ii = 0; ii < fullCount; ++ii )
+		{
+			UNIT_TEST( u, ( places[ ii ] = allocator->Allocate( allocatorInfo.objectSize ) ) != nullptr );
+		}
+		for ( unsigned int ii = 0; ii < fullCount; ii += 97 )
+		{
+			UNIT_TEST( u, allocator->Release( places[ ii ], allocatorInfo.objectSize ) );
+			released.push_back( places[ ii ] );
+		}
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+		for ( unsigned int ii = 0; ii < fullCount; ii += 97 )
+		{
+			void * place = allocator->Allocate( allocatorInfo.objectSize );
+			UNIT_TEST( u, std::find( released.begin(), released.end(), place ) != released.end() );
+			places[ ii ] = place;
+		}
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+		UNIT_TEST( u, allocator->ReleaseBulk( &places[ 0 ], fullCount, allocatorInfo.objectSize ) );
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+	}
+
+	PoolAllocator * pool = dynamic_cast< PoolAllocator * >( allocator );
+	if ( nullptr != pool )
+	{
+		// Mix inline and virtual calls, so each one sees blocks the other made, filled, or emptied.
+		std::vector< void * > places( chunkCount, nullptr );
+		for ( unsigned int ii = 0; ii < chunkCount; ++ii )
+		{
+			void * place = ( ii % 3 == 0 ) ? allocator->Allocate( allocatorInfo.objectSize ) : pool->FastAllocate( allocatorInfo.objectSize );
+			UNIT_TEST( u, place != nullptr );
+			UNIT_TEST( u, reinterpret_cast< std::size_t >( place ) % allocatorInfo.alignment == 0 );
+			std::memset( place, static_cast< int >( ii ), allocatorInfo.objectSize );
+			places[ ii ] = place;
+		}
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+		std::vector< void * > sorted( places );
+		std::sort( sorted.begin(), sorted.end() );
+		UNIT_TEST( u, std::adjacent_find( sorted.begin(), sorted.end() ) == sorted.end() );
+		UNIT_TEST_FOR_EXCEPTION( u, pool->FastRelease( places[ 0 ], allocatorInfo.objectSize * 2 ), std::invalid_argument );
+		UNIT_TEST( u, !pool->FastRelease( nullptr, allocatorInfo.objectSize ) );
+
+		// Newest chunks are mostly in the hot block, while the oldest ones are spread across other blocks.
+		for ( unsigned int ii = chunkCount; chunkCount / 2 < ii; --ii )
+		{
+			UNIT_TEST( u, pool->FastRelease( places[ ii - 1 ], allocatorInfo.objectSize ) );
+		}
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+		for ( unsigned int ii = 0; ii < chunkCount / 2; ++ii )
+		{
+			UNIT_TEST( u, ( ii % 2 == 0 ) ? pool->FastRelease( places[ ii ], allocatorInfo.objectSize )
+				: allocator->Release( places[ ii ], allocatorInfo.objectSize ) );
+		}
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+		allocator->TrimEmptyBlocks();
+		UNIT_TEST( u, allocator->GetFragmentationPercent() == 0.0F );
+		void * place = pool->FastAllocate( allocatorInfo.objectSize );
+		UNIT_TEST( u, place != nullptr );
+		UNIT_TEST( u, pool->FastRelease( place, allocatorInfo.objectSize ) );
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+	}
+
 	if ( showProximityCounts )
 	{
 		const unsigned int percent = ( hintProximityCount * 100 ) / hintTestCount;
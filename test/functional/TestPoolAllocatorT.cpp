@@ -0,0 +1,170 @@
+
+#include "../../include/PoolAllocatorT.hpp"
+#include "../../include/BlockSource.hpp"
+
+#include "UnitTest.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <cstdint>
+#include <cstring>
+
+using namespace std;
+using namespace memwa;
+
+// ----------------------------------------------------------------------------
+
+typedef PoolAllocatorT< 24, 8, 4096 > Pool24;
+typedef PoolAllocatorT< 3, 1, 1024 > Pool3;
+typedef PoolAllocatorT< 40, 32, 4096, MultiThreaded > SharedPool40;
+
+static_assert( Pool24::ChunkSize == 24, "Chunks of PoolAllocatorT should be object size rounded up to the alignment." );
+static_assert( Pool3::ChunkSize == sizeof(void *), "Chunks of PoolAllocatorT should be big enough to hold a pointer." );
+static_assert( SharedPool40::ChunkSize == 64, "Chunks of PoolAllocatorT should be object size rounded up to the alignment." );
+static_assert( Pool24::ObjectsPerBlock == ( 4096 - Pool24::HeaderSize ) / 24, "Header should take whole chunks." );
+static_assert( sizeof(Pool24) == 4 * sizeof(void *), "SingleThreaded policy should take no space." );
+
+// ----------------------------------------------------------------------------
+
+template < class Pool >
+void TestPoolT( ut::UnitTest * u, Pool & pool, std::size_t objectSize, std::size_t alignment )
+{
+	const unsigned int count = 5000;
+	std::vector< void * > places;
+	places.reserve( count );
+	for ( unsigned int ii = 0; ii < count; ++ii )
+	{
+		void * place = pool.Allocate();
+		UNIT_TEST( u, place != nullptr );
+		UNIT_TEST( u, reinterpret_cast< std::uintptr_t >( place ) % alignment == 0 );
+		std::memset( place, static_cast< int >( ii ), objectSize );
+		places.push_back( place );
+	}
+	UNIT_TEST( u, pool.HasAddress( places[ 0 ] ) );
+	UNIT_TEST( u, pool.HasAddress( places[ count - 1 ] ) );
+	UNIT_TEST( u, !pool.IsCorrupt() );
+	std::vector< void * > sorted( places );
+	std::sort( sorted.begin(), sorted.end() );
+	UNIT_TEST_WITH_MSG( u, std::adjacent_find( sorted.begin(), sorted.end() ) == sorted.end(), "Every chunk should be unique." );
+
+	// Release half in random order, and the freed chunks should be reused before making new blocks.
+	std::mt19937 generator( 17 );
+	std::shuffle( places.begin(), places.end(), generator );
+	std::size_t blockCount = 0;
+	std::size_t emptyCount = 0;
+	pool.GetBlockCounts( blockCount, emptyCount );
+	for ( unsigned int ii = 0; ii < count / 2; ++ii )
+	{
+		UNIT_TEST( u, pool.Release( places.back() ) );
+		places.pop_back();
+	}
+	UNIT_TEST( u, !pool.IsCorrupt() );
+	for ( unsigned int ii = 0; ii < count / 2; ++ii )
+	{
+		places.push_back( pool.Allocate() );
+	}
+	std::size_t newBlockCount = 0;
+	pool.GetBlockCounts( newBlockCount, emptyCount );
+	UNIT_TEST( u, newBlockCount <= blockCount );
+	UNIT_TEST( u, !pool.IsCorrupt() );
+
+	// Only one empty block is kept after every chunk is released.
+	for ( void * place : places )
+	{
+		UNIT_TEST( u, pool.Release( place ) );
+	}
+	UNIT_TEST( u, !pool.Release( nullptr ) );
+	pool.GetBlockCounts( blockCount, emptyCount );
+	UNIT_TEST( u, blockCount == 1 );
+	UNIT_TEST( u, emptyCount == 1 );
+	UNIT_TEST( u, !pool.IsCorrupt() );
+	UNIT_TEST( u, pool.TrimEmptyBlocks() );
+	UNIT_TEST( u, !pool.TrimEmptyBlocks() );
+	pool.GetBlockCounts( blockCount, emptyCount );
+	UNIT_TEST( u, blockCount == 0 );
+	UNIT_TEST( u, !pool.IsCorrupt() );
+}
+
+// ----------------------------------------------------------------------------
+
+void TestPoolAllocatorT()
+{
+	std::cout << "Basic Functionality Compile-Time Pool Allocator Test" << std::endl;
+	ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+	ut::UnitTest * u = uts.AddUnitTest( "Test Compile-Time Pool Allocator" );
+
+	{
+		Pool24 pool( 2 );
+		std::size_t blockCount = 0;
+		std::size_t emptyCount = 0;
+		pool.GetBlockCounts( blockCount, emptyCount );
+		UNIT_TEST( u, blockCount == 2 );
+		UNIT_TEST( u, emptyCount == 2 );
+		TestPoolT( u, pool, 24, 8 );
+	}
+	{
+		Pool3 pool;
+		TestPoolT( u, pool, 3, 1 );
+	}
+
+	// Blocks may come from any source which supports aligned blocks.
+	const std::size_t regionSize = 4096 * 8;
+	alignas( 16 ) static unsigned char region[ regionSize ];
+	{
+		RegionBlockSource source( region, regionSize );
+		Pool24 pool( 0, &source );
+		void * place = pool.Allocate();
+		UNIT_TEST( u, ( region <= place ) && ( place < region + regionSize ) );
+		UNIT_TEST( u, pool.Release( place ) );
+		UNIT_TEST( u, pool.TrimEmptyBlocks() );
+		UNIT_TEST( u, source.GetFreeBytes() == regionSize );
+	}
+
+	// Many threads may share an allocator with the MultiThreaded policy.
+	{
+		SharedPool40 pool;
+		std::vector< std::thread > threads;
+		std::vector< unsigned int > failures( 4, 0 );
+		for ( unsigned int tt = 0; tt < failures.size(); ++tt )
+		{
+			threads.emplace_back( [ &pool, &failures, tt ]()
+			{
+				std::vector< void * > places;
+				for ( unsigned int loop = 0; loop < 20; ++loop )
+				{
+					for ( unsigned int ii = 0; ii < 500; ++ii )
+					{
+						void * place = pool.Allocate();
+						std::memset( place, static_cast< int >( tt ), 40 );
+						places.push_back( place );
+					}
+					for ( void * place : places )
+					{
+						if ( static_cast< unsigned char * >( place )[ 39 ] != tt )
+						{
+							++failures[ tt ];
+						}
+						pool.Release( place );
+					}
+					places.clear();
+				}
+			} );
+		}
+		for ( std::thread & thread : threads )
+		{
+			thread.join();
+		}
+		for ( unsigned int failed : failures )
+		{
+			UNIT_TEST_WITH_MSG( u, failed == 0, "No other thread should write to a thread's chunks." );
+		}
+		UNIT_TEST( u, !pool.IsCorrupt() );
+		TestPoolT( u, pool, 40, 32 );
+	}
+}
+
+// ----------------------------------------------------------------------------
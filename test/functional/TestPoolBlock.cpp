@@ -28,7 +28,7 @@ void TestPoolBlock( ut::UnitTest * u, const std::size_t blockSize, const std::si
 	void * chunk = nullptr;
 	for ( unsigned int ii = 0; ii < objectsPerPool; ++ii )
 	{
-		chunk = block.Allocate();
+		chunk = block.Allocate( alignedSize );
 		// This for loop checks that each chunk allocated from the same block has a unique address.
 		for ( unsigned int jj = 0; jj < ii; ++jj )
 		{
@@ -47,12 +47,17 @@ void TestPoolBlock( ut::UnitTest * u, const std::size_t blockSize, const std::si
 		UNIT_TEST( u, !block.HasAddress( tooHigh, blockSize ) );
 		UNIT_TEST( u, block.IsBelowAddress( tooHigh, blockSize ) );
 		UNIT_TEST( u, block.GetInUseCount() == 1 + ii );
+		// Chunks which were never used are handed out in address order.
+		if ( 0 < ii )
+		{
+			UNIT_TEST( u, reinterpret_cast< unsigned char * >( holder[ ii - 1 ] ) + alignedSize == chunk );
+		}
 	}
 	UNIT_TEST( u, !block.IsCorrupt( blockSize, alignment, alignedSize ) );
 	UNIT_TEST( u, !block.IsEmpty() );
 	UNIT_TEST( u, block.IsFull() );
 	UNIT_TEST( u, block.GetInUseCount() == objectsPerPool );
-	chunk = block.Allocate();
+	chunk = block.Allocate( alignedSize );
 	UNIT_TEST( u, chunk == nullptr );
 
 	// Do tests while releasing chunks til block is empty.
@@ -78,7 +83,7 @@ void TestPoolBlock( ut::UnitTest * u, const std::size_t blockSize, const std::si
 		if ( chunk == nullptr )
 		{
 			const unsigned int countBefore = block.GetInUseCount();
-			chunk = block.Allocate();
+			chunk = block.Allocate( alignedSize );
 			const unsigned int countAfter = block.GetInUseCount();
 			UNIT_TEST( u, countAfter - 1 == countBefore );
 			UNIT_TEST( u, chunk != nullptr );
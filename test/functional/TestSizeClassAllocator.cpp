@@ -0,0 +1,187 @@
+#include "../../include/AllocatorManager.hpp"
+#include "../../include/SizeClassAllocator.hpp"
+
+#include "ChunkList.hpp"
+
+#include "UnitTest.hpp"
+
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+using namespace memwa;
+
+
+// ----------------------------------------------------------------------------
+
+void TestSizeClasses( ut::UnitTest * u )
+{
+	UNIT_TEST( u, SizeClassAllocator::GetClassSize( 0 ) == 8 );
+	UNIT_TEST( u, SizeClassAllocator::GetClassSize( 1 ) == 8 );
+	UNIT_TEST( u, SizeClassAllocator::GetClassSize( 8 ) == 8 );
+	UNIT_TEST( u, SizeClassAllocator::GetClassSize( 9 ) == 16 );
+	UNIT_TEST( u, SizeClassAllocator::GetClassSize( 64 ) == 64 );
+	UNIT_TEST( u, SizeClassAllocator::GetClassSize( 65 ) == 80 );
+	UNIT_TEST( u, SizeClassAllocator::GetClassSize( 1000 ) == 1024 );
+	UNIT_TEST( u, SizeClassAllocator::GetClassSize( 4095 ) == 4096 );
+	UNIT_TEST( u, SizeClassAllocator::GetClassSize( SizeClassAllocator::MaxObjectSize ) == SizeClassAllocator::MaxObjectSize );
+	UNIT_TEST_FOR_EXCEPTION( u, SizeClassAllocator::GetClassSize( SizeClassAllocator::MaxObjectSize + 1 ), std::invalid_argument );
+
+	// Each size maps to the smallest class which holds it, and wastes no more than a quarter of the class.
+	std::size_t previous = 0;
+	for ( std::size_t size = 1; size <= SizeClassAllocator::MaxObjectSize; ++size )
+	{
+		const std::size_t classSize = SizeClassAllocator::GetClassSize( size );
+		UNIT_TEST( u, size <= classSize );
+		UNIT_TEST( u, previous <= classSize );
+		UNIT_TEST( u, SizeClassAllocator::GetClassSize( classSize ) == classSize );
+		UNIT_TEST( u, ( classSize <= 64 ) || ( ( classSize - size ) * 4 < classSize ) );
+		previous = classSize;
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+/** Allocates chunks of random sizes, fills each with a pattern, then releases them in random order.
+ @return True if every chunk was aligned, kept its contents, and was released.
+ */
+bool AllocateRandomSizes( Allocator * allocator, unsigned int chunkCount, std::size_t alignment )
+{
+	bool success = true;
+	std::vector< std::pair< void *, std::size_t > > chunks;
+	chunks.reserve( chunkCount );
+	for ( unsigned int ii = 0; ii < chunkCount; ++ii )
+	{
+		// Favor small sizes the way programs do.
+		const std::size_t size = 1 + ( ( ii % 4 == 0 ) ? rand() % SizeClassAllocator::MaxObjectSize : rand() % 128 );
+		void * place = allocator->Allocate( size );
+		if ( ( nullptr == place ) || ( reinterpret_cast< std::size_t >( place ) % alignment != 0 ) )
+		{
+			return false;
+		}
+		std::memset( place, static_cast< int >( size ), size );
+		chunks.push_back( std::make_pair( place, size ) );
+	}
+
+	while ( !chunks.empty() )
+	{
+		const std::size_t index = rand() % chunks.size();
+		void * place = chunks[ index ].first;
+		const std::size_t size = chunks[ index ].second;
+		const unsigned char * bytes = reinterpret_cast< const unsigned char * >( place );
+		if ( ( bytes[ 0 ] != static_cast< unsigned char >( size ) ) || ( bytes[ size - 1 ] != static_cast< unsigned char >( size ) ) )
+		{
+			success = false;
+		}
+		if ( !allocator->Release( place, size ) )
+		{
+			success = false;
+		}
+		chunks[ index ] = chunks.back();
+		chunks.pop_back();
+	}
+	return success;
+}
+
+// ----------------------------------------------------------------------------
+
+void SizeClassThreadTest( ut::UnitTest * u, Allocator * allocator, unsigned int chunkCount, std::size_t alignment, std::mutex & mutex )
+{
+	const bool success = AllocateRandomSizes( allocator, chunkCount, alignment );
+	std::unique_lock< std::mutex > lock( mutex );
+	UNIT_TEST( u, success );
+}
+
+// ----------------------------------------------------------------------------
+
+void TestSizeClassAllocator( bool multithreaded )
+{
+	const char * threadType = ( multithreaded ) ? "Multi-Threaded" : "Single-Threaded";
+	std::cout << "Basic Functionality " << threadType << " Size Class Allocator Test" << std::endl;
+	ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+	ut::UnitTest * u = uts.AddUnitTest( "Test Size Class Allocator" );
+
+	TestSizeClasses( u );
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::CreateManager( multithreaded, 4096 ), "Creation should pass since AllocatorManager does not exist yet." );
+
+	AllocatorManager::AllocatorParameters allocatorInfo;
+	allocatorInfo.type = AllocatorManager::AllocatorType::SizeClass;
+	allocatorInfo.objectSize = 0;
+	allocatorInfo.alignment = 8;
+	allocatorInfo.blockSize = 4096;
+	allocatorInfo.initialBlocks = 1;
+	Allocator * allocator = nullptr;
+	UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+
+	const unsigned int chunkCount = 10000;
+	UNIT_TEST( u, AllocateRandomSizes( allocator, chunkCount, allocatorInfo.alignment ) );
+	UNIT_TEST( u, !allocator->IsCorrupt() );
+
+	// Sizes which share a class share an allocator, and chunks of every size are owned by this allocator.
+	void * place = nullptr;
+	UNIT_TEST( u, ( place = allocator->Allocate( 20 ) ) != nullptr );
+	UNIT_TEST( u, allocator->HasAddress( place ) );
+	UNIT_TEST( u, allocator->Resize( place, 20, 24 ) );
+	UNIT_TEST( u, allocator->Resize( place, 20, 17 ) );
+	UNIT_TEST( u, !allocator->Resize( place, 20, 25 ) );
+	UNIT_TEST( u, !allocator->Resize( place, 20, SizeClassAllocator::MaxObjectSize + 1 ) );
+	UNIT_TEST( u, allocator->Release( place, 24 ) );
+	UNIT_TEST( u, ( place = allocator->Allocate( 3000, allocatorInfo.alignment ) ) != nullptr );
+	UNIT_TEST( u, allocator->HasAddress( place ) );
+	UNIT_TEST( u, allocator->Release( place, 3000, allocatorInfo.alignment ) );
+	UNIT_TEST( u, !allocator->Release( nullptr, 8 ) );
+	UNIT_TEST_FOR_EXCEPTION( u, allocator->Allocate( SizeClassAllocator::MaxObjectSize + 1 ), std::invalid_argument );
+	UNIT_TEST_FOR_EXCEPTION( u, allocator->Allocate( 8, allocatorInfo.alignment * 2 ), std::invalid_argument );
+
+	{
+		std::vector< void * > places( chunkCount, nullptr );
+		allocator->AllocateBulk( &places[ 0 ], chunkCount, 100 );
+		ChunkList chunks( chunkCount );
+		for ( unsigned int ii = 0; ii < chunkCount; ++ii )
+		{
+			UNIT_TEST( u, allocator->HasAddress( places[ ii ] ) );
+			chunks.AddChunk( places[ ii ] );
+		}
+		UNIT_TEST( u, chunks.AreUnique() );
+		UNIT_TEST( u, allocator->ReleaseBulk( &places[ 0 ], chunkCount, 110 ) );
+	}
+
+	if ( multithreaded )
+	{
+		std::mutex mutex;
+		std::vector< std::thread > threads;
+		for ( unsigned int ii = 0; ii < 4; ++ii )
+		{
+			threads.push_back( std::thread( SizeClassThreadTest, u, allocator, chunkCount, std::size_t( allocatorInfo.alignment ),
+				std::ref( mutex ) ) );
+		}
+		for ( std::thread & thread : threads )
+		{
+			thread.join();
+		}
+	}
+
+	UNIT_TEST( u, !allocator->IsCorrupt() );
+	allocator->TrimEmptyBlocks();
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+
+	// Tiny size classes may use wide blocks, and alignments smaller than a pointer still work.
+	allocatorInfo.alignment = 1;
+	allocatorInfo.wideTinyBlocks = true;
+	UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+	UNIT_TEST( u, AllocateRandomSizes( allocator, chunkCount, allocatorInfo.alignment ) );
+	UNIT_TEST( u, !allocator->IsCorrupt() );
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyManager( true ), "Destruction should pass since AllocatorManager exists." );
+}
+
+// ----------------------------------------------------------------------------
@@ -1,12 +1,15 @@
 
 #include "../../include/AllocatorManager.hpp"
+#include "../../include/StackAllocator.hpp"
 
 #include "ChunkList.hpp"
 
 #include "UnitTest.hpp"
 
 #include <iostream>
+#include <stdexcept>
 #include <typeinfo>
+#include <vector>
 
 #include <cassert>
 #include <cstring>
@@ -193,6 +196,47 @@ void TestStackAllocator( bool multithreaded, bool showProximityCounts )
 		UNIT_TEST( u, chunks.GetCount() == 0 );
 	}
 
+	{
+		StackAllocator * stack = dynamic_cast< StackAllocator * >( allocator );
+		UNIT_TEST( u, stack != nullptr );
+		// Mix inline and virtual calls across many blocks, then release in reverse order with both.
+		SizedChunkList chunks( chunkCount );
+		for ( unsigned int ii = 0; ii < chunkCount; ++ii )
+		{
+			bytes = ( ii % 120 ) + 1;
+			place = ( ii % 5 == 0 ) ? allocator->Allocate( bytes ) : stack->FastAllocate( bytes );
+			UNIT_TEST( u, place != nullptr );
+			UNIT_TEST( u, reinterpret_cast< std::size_t >( place ) % allocatorInfo.alignment == 0 );
+			std::memset( place, static_cast< int >( ii ), bytes );
+			chunks.AddChunk( place, bytes );
+		}
+		UNIT_TEST( u, chunks.AreUnique() );
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+
+		// Releasing the top chunk with the wrong size must still throw.
+		const ChunkInfo * top = chunks.GetTopChunk();
+		UNIT_TEST_FOR_EXCEPTION( u, stack->FastRelease( top->GetPlace(), top->GetSize() + 64 ), std::invalid_argument );
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+
+		unsigned int ii = 0;
+		while ( chunks.GetCount() != 0 )
+		{
+			const ChunkInfo * info = chunks.GetTopChunk();
+			assert( nullptr != info );
+			place = info->GetPlace();
+			bytes = info->GetSize();
+			UNIT_TEST( u, ( ++ii % 3 == 0 ) ? allocator->Release( place, bytes ) : stack->FastRelease( place, bytes ) );
+			chunks.RemoveTopChunk();
+		}
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+		UNIT_TEST( u, allocator->GetFragmentationPercent() >= 0.0F );
+		allocator->TrimEmptyBlocks();
+		place = stack->FastAllocate( 24 );
+		UNIT_TEST( u, place != nullptr );
+		UNIT_TEST( u, stack->FastRelease( place, 24 ) );
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+	}
+
 	if ( showProximityCounts )
 	{
 		const unsigned int percent = ( hintProximityCount * 100 ) / hintTestCount;
@@ -206,6 +250,175 @@ void TestStackAllocator( bool multithreaded, bool showProximityCounts )
 
 // ----------------------------------------------------------------------------
 
+void TestStackHeaders( bool multithreaded )
+{
+	const char * threadType = ( multithreaded ) ? "Multi-Threaded" : "Single-Threaded";
+	std::cout << "Compact and Headerless " << threadType << " Stack Allocator Test" << std::endl;
+	ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+	ut::UnitTest * u = uts.AddUnitTest( "Test Stack Allocator Headers" );
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::CreateManager( multithreaded, 4096 ), "Creation should pass since AllocatorManager does not exist yet." );
+
+	AllocatorManager::AllocatorParameters allocatorInfo;
+	allocatorInfo.type = AllocatorManager::AllocatorType::Stack;
+	allocatorInfo.objectSize = 32;
+	allocatorInfo.alignment = 8;
+	allocatorInfo.blockSize = 2048;
+	allocatorInfo.initialBlocks = 1;
+	allocatorInfo.retainedEmptyBlocks = 1;
+
+	const AllocatorManager::StackHeader headers[] = { AllocatorManager::Compact, AllocatorManager::Headerless };
+	const std::size_t blockSizes[] = { 2048, 128 * 1024 };
+	const unsigned int chunkCount = 2000;
+	for ( AllocatorManager::StackHeader header : headers )
+	{
+		for ( std::size_t blockSize : blockSizes )
+		{
+			allocatorInfo.stackHeader = header;
+			allocatorInfo.blockSize = blockSize;
+			Allocator * allocator = nullptr;
+			UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+			StackAllocator * stack = dynamic_cast< StackAllocator * >( allocator );
+			UNIT_TEST( u, stack != nullptr );
+
+			SizedChunkList chunks( chunkCount );
+			for ( unsigned int ii = 0; ii < chunkCount; ++ii )
+			{
+				const std::size_t bytes = ( ii % 200 ) + 1;
+				void * place = ( ii % 4 == 0 ) ? allocator->Allocate( bytes ) : stack->FastAllocate( bytes );
+				UNIT_TEST( u, place != nullptr );
+				UNIT_TEST( u, reinterpret_cast< std::size_t >( place ) % allocatorInfo.alignment == 0 );
+				std::memset( place, static_cast< int >( ii ), bytes );
+				chunks.AddChunk( place, bytes );
+			}
+			UNIT_TEST( u, chunks.AreUnique() );
+			UNIT_TEST( u, !allocator->IsCorrupt() );
+
+			if ( AllocatorManager::Compact == header )
+			{
+				// Compact headers still find a chunk released out of order.
+				const ChunkInfo * top = chunks.GetTopChunk();
+				void * inside = reinterpret_cast< unsigned char * >( top->GetPlace() ) + allocatorInfo.alignment;
+				UNIT_TEST_FOR_EXCEPTION( u, allocator->Release( inside, top->GetSize() ), std::invalid_argument );
+			}
+
+			unsigned int ii = 0;
+			while ( chunks.GetCount() != 0 )
+			{
+				const ChunkInfo * info = chunks.GetTopChunk();
+				void * place = info->GetPlace();
+				const std::size_t bytes = info->GetSize();
+				UNIT_TEST( u, ( ++ii % 3 == 0 ) ? allocator->Release( place, bytes ) : stack->FastRelease( place, bytes ) );
+				chunks.RemoveTopChunk();
+			}
+			UNIT_TEST( u, !allocator->IsCorrupt() );
+			UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+		}
+	}
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyManager( true ), "Destruction should pass since AllocatorManager exists." );
+}
+
+// ----------------------------------------------------------------------------
+
+void TestStackSegments( bool multithreaded )
+{
+	const char * threadType = ( multithreaded ) ? "Multi-Threaded" : "Single-Threaded";
+	std::cout << "Segmented " << threadType << " Stack Allocator Test" << std::endl;
+	ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+	ut::UnitTest * u = uts.AddUnitTest( "Test Stack Allocator Segments" );
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::CreateManager( multithreaded, 4096 ), "Creation should pass since AllocatorManager does not exist yet." );
+
+	AllocatorManager::AllocatorParameters allocatorInfo;
+	allocatorInfo.type = AllocatorManager::AllocatorType::Stack;
+	allocatorInfo.objectSize = 32;
+	allocatorInfo.alignment = 8;
+	allocatorInfo.blockSize = 1024;
+	allocatorInfo.initialBlocks = 1;
+	Allocator * allocator = nullptr;
+	UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+
+	// The third chunk fits in the room left in the first block, but that block is below the top segment.
+	void * bottom = allocator->Allocate( 600 );
+	void * middle = allocator->Allocate( 900 );
+	void * top = allocator->Allocate( 300 );
+	UNIT_TEST( u, ( nullptr != bottom ) && ( nullptr != middle ) && ( nullptr != top ) );
+	const unsigned char * bottomBlock = reinterpret_cast< const unsigned char * >( bottom );
+	const unsigned char * topPlace = reinterpret_cast< const unsigned char * >( top );
+	UNIT_TEST( u, ( topPlace < bottomBlock ) || ( bottomBlock + allocatorInfo.blockSize <= topPlace ) );
+	UNIT_TEST( u, !allocator->IsCorrupt() );
+
+	// Only chunks in the top segment may be released or resized.
+	UNIT_TEST_FOR_EXCEPTION( u, allocator->Release( middle, 900 ), std::invalid_argument );
+	UNIT_TEST_FOR_EXCEPTION( u, allocator->Resize( middle, 900, 100 ), std::invalid_argument );
+	UNIT_TEST( u, !allocator->IsCorrupt() );
+	UNIT_TEST( u, allocator->Release( top, 300 ) );
+	UNIT_TEST( u, !allocator->IsCorrupt() );
+
+	// Going back and forth across a segment boundary reuses the spare segment instead of making a new block.
+	for ( unsigned int ii = 0; ii < 10; ++ii )
+	{
+		void * place = allocator->Allocate( 300 );
+		UNIT_TEST( u, nullptr != place );
+		if ( 0 < ii )
+		{
+			UNIT_TEST( u, top == place );
+		}
+		top = place;
+		UNIT_TEST( u, allocator->Release( place, 300 ) );
+		UNIT_TEST( u, allocator->HasAddress( place ) );
+	}
+	UNIT_TEST( u, !allocator->IsCorrupt() );
+
+	UNIT_TEST( u, allocator->Release( middle, 900 ) );
+	UNIT_TEST( u, allocator->Release( bottom, 600 ) );
+	UNIT_TEST( u, !allocator->IsCorrupt() );
+	UNIT_TEST( u, allocator->TrimEmptyBlocks() );
+	UNIT_TEST( u, !allocator->HasAddress( top ) );
+	UNIT_TEST( u, !allocator->IsCorrupt() );
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+
+	// Push more segments than there are spares, then pop them all, so popped segments are destroyed while
+	// spares sit above them in the container.
+	allocatorInfo.initialBlocks = 3;
+	allocatorInfo.retainedEmptyBlocks = 2;
+	for ( const bool alignedBlocks : { false, true } )
+	{
+		allocatorInfo.alignedBlocks = alignedBlocks;
+		UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+		for ( unsigned int round = 0; round < 3; ++round )
+		{
+			std::vector< void * > places;
+			for ( unsigned int ii = 0; ii < 8; ++ii )
+			{
+				places.push_back( allocator->Allocate( 900 ) );
+				UNIT_TEST( u, nullptr != places.back() );
+				UNIT_TEST( u, !allocator->IsCorrupt() );
+			}
+			for ( void * place : places )
+			{
+				UNIT_TEST( u, allocator->HasAddress( place ) );
+			}
+			UNIT_TEST_FOR_EXCEPTION( u, allocator->Release( places.front(), 900 ), std::invalid_argument );
+			while ( !places.empty() )
+			{
+				UNIT_TEST( u, allocator->Release( places.back(), 900 ) );
+				places.pop_back();
+				UNIT_TEST( u, !allocator->IsCorrupt() );
+			}
+		}
+		UNIT_TEST( u, allocator->TrimEmptyBlocks() );
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+		UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+	}
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyManager( true ), "Destruction should pass since AllocatorManager exists." );
+}
+
+// ----------------------------------------------------------------------------
+
 void ComplexTestStackAllocator( bool multithreaded, bool showProximityCounts )
 {
 	const char * threadType = ( multithreaded ) ? "Multi-Threaded" : "Single-Threaded";
@@ -580,3 +580,108 @@ void TestStackExceptions()
 }
 
 // ----------------------------------------------------------------------------
+
+void TestStackBlockHeaders( ut::UnitTest * u, const std::size_t blockSize, const std::size_t alignment, const std::size_t headerSize )
+{
+	StackBlock block( blockSize, alignment );
+	UNIT_TEST( u, block.IsEmpty( alignment ) );
+	UNIT_TEST( u, !block.IsCorrupt( blockSize, alignment, headerSize ) );
+
+	// Fill the block with chunks of random sizes, and write a pattern into each one.
+	void * holder[ 200 ];
+	std::size_t sizes[ 200 ];
+	unsigned int count = 0;
+	for ( ; count < 200; ++count )
+	{
+		const std::size_t objectSize = rand() % 40 + 1;
+		void * chunk = block.Allocate( objectSize, blockSize, alignment, headerSize );
+		if ( nullptr == chunk )
+		{
+			break;
+		}
+		UNIT_TEST( u, reinterpret_cast< std::size_t >( chunk ) % alignment == 0 );
+		UNIT_TEST( u, block.HasAddress( chunk, blockSize ) );
+		UNIT_TEST( u, block.IsTopChunk( chunk, objectSize, alignment, headerSize ) );
+		if ( 0 < count )
+		{
+			UNIT_TEST( u, !block.IsTopChunk( holder[ count - 1 ], sizes[ count - 1 ], alignment, headerSize ) );
+		}
+		std::memset( chunk, static_cast< int >( count ), objectSize );
+		holder[ count ] = chunk;
+		sizes[ count ] = objectSize;
+		UNIT_TEST( u, !block.IsCorrupt( blockSize, alignment, headerSize ) );
+	}
+	UNIT_TEST( u, 0 < count );
+	UNIT_TEST( u, !block.IsEmpty( alignment ) );
+	if ( StackBlock::NoHeaderSize != headerSize )
+	{
+		UNIT_TEST( u, count == block.GetObjectCount( blockSize, alignment, headerSize ) );
+		// A chunk below the top may not be released, whether or not its size is right.
+		if ( 1 < count )
+		{
+			UNIT_TEST_FOR_EXCEPTION( u, block.Release( holder[ count - 2 ], sizes[ count - 2 ], blockSize, alignment, headerSize ),
+				std::invalid_argument );
+		}
+	}
+
+	// Smaller headers fit more chunks into the same block.
+	if ( StackBlock::FullHeaderSize != headerSize )
+	{
+		const std::size_t fullSize = StackBlock::GetBytesNeeded( 1, alignment, StackBlock::FullHeaderSize );
+		UNIT_TEST( u, StackBlock::GetBytesNeeded( 1, alignment, headerSize ) <= fullSize );
+	}
+
+	// Release every chunk in reverse order, and check nothing wrote over the chunks below it.
+	for ( unsigned int ii = count; 0 < ii; --ii )
+	{
+		const unsigned char * bytes = reinterpret_cast< const unsigned char * >( holder[ ii - 1 ] );
+		bool intact = true;
+		for ( std::size_t jj = 0; jj < sizes[ ii - 1 ]; ++jj )
+		{
+			intact = intact && ( bytes[ jj ] == static_cast< unsigned char >( ii - 1 ) );
+		}
+		UNIT_TEST( u, intact );
+		UNIT_TEST( u, block.Release( holder[ ii - 1 ], sizes[ ii - 1 ], blockSize, alignment, headerSize ) );
+		UNIT_TEST( u, !block.IsCorrupt( blockSize, alignment, headerSize ) );
+	}
+	UNIT_TEST( u, block.IsEmpty( alignment ) );
+
+	// Resize a chunk to grow and shrink it in place.
+	void * place = block.Allocate( 24, blockSize, alignment, headerSize );
+	UNIT_TEST( u, nullptr != place );
+	UNIT_TEST( u, block.Resize( place, 24, 100, blockSize, alignment, headerSize ) );
+	UNIT_TEST( u, block.IsTopChunk( place, 100, alignment, headerSize ) );
+	UNIT_TEST( u, block.Resize( place, 100, 8, blockSize, alignment, headerSize ) );
+	UNIT_TEST( u, !block.Resize( place, 8, blockSize + 1, blockSize, alignment, headerSize ) );
+	UNIT_TEST( u, block.Release( place, 8, blockSize, alignment, headerSize ) );
+	UNIT_TEST( u, block.IsEmpty( alignment ) );
+	block.Destroy();
+}
+
+// ----------------------------------------------------------------------------
+
+void TestStackBlockHeaders()
+{
+	ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+	ut::UnitTest * u = uts.AddUnitTest( "Test StackBlock Headers" );
+
+	std::cout << std::endl << "Testing Full, Compact, and No Chunk Headers with StackBlock." << std::endl
+		<< "Block Size \t Alignment \t Header Size" << std::endl
+		<< "=========================================" << std::endl;
+
+	const std::size_t headerSizes[] =
+	{
+		StackBlock::FullHeaderSize, StackBlock::WideHeaderSize, StackBlock::NarrowHeaderSize, StackBlock::NoHeaderSize
+	};
+	const std::size_t blockSize = 1024;
+	for ( std::size_t headerSize : headerSizes )
+	{
+		for ( std::size_t alignment = 1; alignment <= 16; alignment *= 2 )
+		{
+			TestStackBlockHeaders( u, blockSize, alignment, headerSize );
+			std::cout << blockSize << "\t\t" << alignment << "\t\t" << headerSize << std::endl;
+		}
+	}
+}
+
+// ----------------------------------------------------------------------------
@@ -1,12 +1,15 @@
 
 #include "../../include/AllocatorManager.hpp"
+#include "../../include/TinyObjectAllocator.hpp"
 
 #include "ChunkList.hpp"
 
 #include "UnitTest.hpp"
 
 #include <iostream>
+#include <stdexcept>
 #include <typeinfo>
+#include <vector>
 
 #include <cassert>
 #include <climits> // For UCHAR_MAX.
@@ -194,6 +197,61 @@ void TestTinyAllocator( bool multithreaded, bool showProximityCounts )
 		UNIT_TEST( u, chunks.GetCount() == 0 );
 	}
 
+	{
+		// Allocate and release in bulk, with and without hints, spanning several blocks.
+		std::vector< void * > places( chunkCount, nullptr );
+		allocator->AllocateBulk( &places[ 0 ], chunkCount, allocatorInfo.objectSize );
+		ChunkList chunks( chunkCount );
+		for ( unsigned int ii = 0; ii < chunkCount; ++ii )
+		{
+			UNIT_TEST( u, places[ ii ] != nullptr );
+			UNIT_TEST( u, allocator->HasAddress( places[ ii ] ) );
+			chunks.AddChunk( places[ ii ] );
+		}
+		UNIT_TEST( u, chunks.AreUnique() );
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+		UNIT_TEST( u, allocator->ReleaseBulk( &places[ 0 ], chunkCount / 2, allocatorInfo.objectSize ) );
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+		allocator->AllocateBulk( &places[ 0 ], chunkCount / 2, allocatorInfo.objectSize, places[ chunkCount - 1 ] );
+		UNIT_TEST( u, allocator->ReleaseBulk( &places[ 0 ], chunkCount, allocatorInfo.objectSize ) );
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+		UNIT_TEST_FOR_EXCEPTION( u, allocator->AllocateBulk( &places[ 0 ], 4, allocatorInfo.objectSize * 2 ), std::invalid_argument );
+		UNIT_TEST_FOR_EXCEPTION( u, allocator->ReleaseBulk( &places[ 0 ], 4, allocatorInfo.objectSize * 2 ), std::invalid_argument );
+	}
+
+	TinyObjectAllocator * tiny = dynamic_cast< TinyObjectAllocator * >( allocator );
+	if ( nullptr != tiny )
+	{
+		// Mix inline and virtual calls, and release in random order so many releases miss the hot block.
+		ChunkList chunks( chunkCount );
+		for ( unsigned int ii = 0; ii < chunkCount; ++ii )
+		{
+			void * place = ( ii % 4 == 0 ) ? allocator->Allocate( allocatorInfo.objectSize ) : tiny->FastAllocate( allocatorInfo.objectSize );
+			UNIT_TEST( u, place != nullptr );
+			UNIT_TEST( u, reinterpret_cast< std::size_t >( place ) % allocatorInfo.alignment == 0 );
+			std::memset( place, static_cast< int >( ii ), allocatorInfo.objectSize );
+			chunks.AddChunk( place );
+		}
+		UNIT_TEST( u, chunks.AreUnique() );
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+		UNIT_TEST( u, !tiny->FastRelease( nullptr, allocatorInfo.objectSize ) );
+		for ( unsigned int ii = 0; ii < chunkCount; ++ii )
+		{
+			const ChunkList::ChunkSpot spot = ( ii % 3 == 0 ) ? chunks.GetRandomChunk()
+				: ChunkList::ChunkSpot( chunks.GetTopChunk(), chunks.GetCount() - 1 );
+			UNIT_TEST( u, ( ii % 2 == 0 ) ? tiny->FastRelease( spot.first, allocatorInfo.objectSize )
+				: allocator->Release( spot.first, allocatorInfo.objectSize ) );
+			chunks.RemoveChunk( spot.second );
+		}
+		UNIT_TEST( u, chunks.GetCount() == 0 );
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+		allocator->TrimEmptyBlocks();
+		void * place = tiny->FastAllocate( allocatorInfo.objectSize );
+		UNIT_TEST( u, place != nullptr );
+		UNIT_TEST( u, tiny->FastRelease( place, allocatorInfo.objectSize ) );
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+	}
+
 	if ( showProximityCounts )
 	{
 		const unsigned int percent = ( hintProximityCount * 100 ) / hintTestCount;
@@ -424,3 +482,99 @@ void ComplexTestTinyAllocator( bool multithreaded, bool showProximityCounts )
 }
 
 // ----------------------------------------------------------------------------
+
+void TestWideTinyAllocator( ut::UnitTest * u, std::size_t blockSize, std::size_t objectSize, std::size_t alignment )
+{
+	AllocatorManager::AllocatorParameters allocatorInfo;
+	allocatorInfo.type = AllocatorManager::AllocatorType::Tiny;
+	allocatorInfo.objectSize = objectSize;
+	allocatorInfo.alignment = alignment;
+	allocatorInfo.blockSize = blockSize;
+	allocatorInfo.initialBlocks = 1;
+	allocatorInfo.wideTinyBlocks = true;
+	Allocator * allocator = nullptr;
+	UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+
+	// An empty allocator hands out every chunk of its first block in address order, so a block holds many more than 255 objects.
+	const unsigned int chunkCount = 20000;
+	const unsigned int objectsPerPool = ( 1 < objectSize ) ? blockSize / objectSize : UCHAR_MAX;
+	std::vector< void * > places( chunkCount, nullptr );
+	ChunkList chunks( chunkCount );
+	for ( unsigned int ii = 0; ii < chunkCount; ++ii )
+	{
+		UNIT_TEST( u, ( places[ ii ] = allocator->Allocate( objectSize ) ) != nullptr );
+		UNIT_TEST( u, reinterpret_cast< std::size_t >( places[ ii ] ) % alignment == 0 );
+		if ( ( 0 < ii ) && ( ii < objectsPerPool ) )
+		{
+			UNIT_TEST( u, reinterpret_cast< unsigned char * >( places[ ii - 1 ] ) + objectSize == places[ ii ] );
+		}
+		std::memset( places[ ii ], static_cast< int >( ii ), objectSize );
+		chunks.AddChunk( places[ ii ] );
+	}
+	UNIT_TEST( u, chunks.AreUnique() );
+	UNIT_TEST( u, !allocator->IsCorrupt() );
+	UNIT_TEST( u, allocator->GetFragmentationPercent() < 0.01 );
+
+	// Release every other chunk, then check the chunks still in use were not touched.
+	for ( unsigned int ii = 0; ii < chunkCount; ii += 2 )
+	{
+		UNIT_TEST( u, allocator->Release( places[ ii ], objectSize ) );
+	}
+	UNIT_TEST( u, !allocator->IsCorrupt() );
+	for ( unsigned int ii = 1; ii < chunkCount; ii += 2 )
+	{
+		const unsigned char * bytes = reinterpret_cast< const unsigned char * >( places[ ii ] );
+		UNIT_TEST( u, bytes[ 0 ] == static_cast< unsigned char >( ii ) );
+		UNIT_TEST( u, bytes[ objectSize - 1 ] == static_cast< unsigned char >( ii ) );
+		UNIT_TEST( u, allocator->HasAddress( places[ ii ] ) );
+	}
+	std::vector< void * > bulk( chunkCount / 2, nullptr );
+	allocator->AllocateBulk( &bulk[ 0 ], bulk.size(), objectSize );
+	UNIT_TEST( u, !allocator->IsCorrupt() );
+	UNIT_TEST( u, allocator->ReleaseBulk( &bulk[ 0 ], bulk.size(), objectSize ) );
+	for ( unsigned int ii = 1; ii < chunkCount; ii += 2 )
+	{
+		UNIT_TEST( u, allocator->Release( places[ ii ], objectSize ) );
+	}
+	UNIT_TEST( u, !allocator->IsCorrupt() );
+	allocator->TrimEmptyBlocks();
+	UNIT_TEST( u, allocator->GetFragmentationPercent() == 0.0 );
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+}
+
+// ----------------------------------------------------------------------------
+
+void TestWideTinyAllocator( bool multithreaded )
+{
+	const char * threadType = ( multithreaded ) ? "Multi-Threaded" : "Single-Threaded";
+	std::cout << "Basic Functionality " << threadType << " Wide Tiny Allocator Test" << std::endl;
+	ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+	ut::UnitTest * u = uts.AddUnitTest( "Test Wide Tiny Allocator" );
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::CreateManager( multithreaded, 4096 ), "Creation should pass since AllocatorManager does not exist yet." );
+
+	// One-byte objects can't hold a 16-bit index, so they fall back to blocks of 255 objects.
+	TestWideTinyAllocator( u, 4096, 1, 1 );
+	TestWideTinyAllocator( u, 4096, 2, 2 );
+	TestWideTinyAllocator( u, 65536, 2, 1 );
+	TestWideTinyAllocator( u, 4096, 4, 4 );
+	TestWideTinyAllocator( u, 65536, 4, 4 );
+	TestWideTinyAllocator( u, 4096, 12, 4 );
+	TestWideTinyAllocator( u, 65536, 24, 8 );
+
+	// Blocks must hold from 2 through 65535 objects.
+	AllocatorManager::AllocatorParameters allocatorInfo;
+	allocatorInfo.type = AllocatorManager::AllocatorType::Tiny;
+	allocatorInfo.objectSize = 4;
+	allocatorInfo.alignment = 4;
+	allocatorInfo.blockSize = 4;
+	allocatorInfo.initialBlocks = 1;
+	allocatorInfo.wideTinyBlocks = true;
+	UNIT_TEST_FOR_EXCEPTION( u, AllocatorManager::CreateAllocator( allocatorInfo ), std::invalid_argument );
+	allocatorInfo.blockSize = 4 * 65536;
+	UNIT_TEST_FOR_EXCEPTION( u, AllocatorManager::CreateAllocator( allocatorInfo ), std::invalid_argument );
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyManager( true ), "Destruction should pass since AllocatorManager exists." );
+}
+
+// ----------------------------------------------------------------------------
@@ -1,9 +1,10 @@
-
 #include "../../src/TinyBlock.hpp"
+#include "../../src/WideTinyBlock.hpp"
 
 #include "UnitTest.hpp"
 
 #include <iostream>
+#include <vector>
 
 #include <cstdlib>
 
@@ -13,11 +14,12 @@ using namespace memwa;
 
 // ----------------------------------------------------------------------------
 
-void TestTinyBlock( ut::UnitTest * u, const std::size_t objectSize, const std::size_t alignment )
+/// Does the same tests on TinyBlock and WideTinyBlock, since both hand out chunks the same way.
+template < class BlockType >
+void TestAnyTinyBlock( ut::UnitTest * u, const std::size_t objectsPerPool, const std::size_t objectSize, const std::size_t alignment )
 {
-	const std::size_t objectsPerPool = UCHAR_MAX;
 	const std::size_t blockSize = objectsPerPool * objectSize;
-	TinyBlock block( blockSize, objectSize, alignment, objectsPerPool );
+	BlockType block( blockSize, objectSize, alignment, objectsPerPool );
 
 	// First do basic tests of empty block.
 	UNIT_TEST_WITH_MSG( u, block.IsEmpty(), "new block should be empty." );
@@ -26,17 +28,11 @@ void TestTinyBlock( ut::UnitTest * u, const std::size_t objectSize, const std::s
 	UNIT_TEST( u, !block.IsCorrupt( objectSize ) );
 
 	// Do tests while allocating chunks til block is full.
-	void * holder[ objectsPerPool ];
+	std::vector< void * > holder( objectsPerPool, nullptr );
 	void * chunk = nullptr;
 	for ( unsigned int ii = 0; ii < objectsPerPool; ++ii )
 	{
 		chunk = block.Allocate( objectSize );
-		// This for loop checks that each chunk allocated from the same block has a unique address.
-		for ( unsigned int jj = 0; jj < ii; ++jj )
-		{
-			void * c = holder[ jj ];
-			UNIT_TEST( u, chunk != c );
-		}
 		unsigned char * tooHigh = reinterpret_cast< unsigned char * >( chunk ) + blockSize;
 		unsigned char * tooLow = reinterpret_cast< unsigned char * >( chunk ) - blockSize;
 		holder[ ii ] = chunk;
@@ -49,13 +45,27 @@ void TestTinyBlock( ut::UnitTest * u, const std::size_t objectSize, const std::s
 		UNIT_TEST( u, !block.HasAddress( tooHigh, blockSize ) );
 		UNIT_TEST( u, block.IsBelowAddress( tooHigh, blockSize ) );
 		UNIT_TEST( u, block.GetInUseCount() == 1 + ii );
+		// Nothing was released yet, so each allocation bumps untouched_ to the next object. That also makes
+		// every chunk unique without comparing it to all the earlier ones.
+		UNIT_TEST( u, block.GetAddress() + ii * objectSize == chunk );
 	}
 	UNIT_TEST( u, !block.IsCorrupt( objectSize ) );
 	UNIT_TEST( u, !block.IsEmpty() );
 	UNIT_TEST( u, block.IsFull() );
 	UNIT_TEST( u, block.GetInUseCount() == objectsPerPool );
-	chunk = block.Allocate( objectSize );
-	UNIT_TEST( u, chunk == nullptr );
+	UNIT_TEST( u, block.Allocate( objectSize ) == nullptr );
+
+	// Released chunks are reused in the reverse order they were released. Wide blocks also reuse chunks above index 255.
+	for ( unsigned int ii = 0; ii < objectsPerPool; ii += 3 )
+	{
+		block.Release( holder[ ii ], objectSize );
+	}
+	UNIT_TEST( u, !block.IsCorrupt( objectSize ) );
+	for ( int ii = ( ( objectsPerPool - 1 ) / 3 ) * 3; ii >= 0; ii -= 3 )
+	{
+		UNIT_TEST( u, block.Allocate( objectSize ) == holder[ ii ] );
+	}
+	UNIT_TEST( u, block.IsFull() );
 
 	// Do tests while releasing chunks til block is empty.
 	for ( unsigned int ii = 0; ii < objectsPerPool; ++ii )
@@ -73,6 +83,10 @@ void TestTinyBlock( ut::UnitTest * u, const std::size_t objectSize, const std::s
 	UNIT_TEST( u, block.IsEmpty() );
 	UNIT_TEST( u, !block.IsCorrupt( objectSize ) );
 
+	// IsCorrupt walks every released chunk, so blocks with more than UCHAR_MAX objects check it less often.
+	// That keeps the run time of the random test about the same per object as for a TinyBlock, which checks
+	// it after every call.
+	const std::size_t corruptCheckInterval = ( objectsPerPool + UCHAR_MAX - 1 ) / UCHAR_MAX;
 	for ( unsigned int ii = 0; ii < objectsPerPool * 10; ++ii )
 	{
 		const unsigned int index = rand() % objectsPerPool;
@@ -81,33 +95,28 @@ void TestTinyBlock( ut::UnitTest * u, const std::size_t objectSize, const std::s
 		{
 			const unsigned int countBefore = block.GetInUseCount();
 			chunk = block.Allocate( objectSize );
-			const unsigned int countAfter = block.GetInUseCount();
-			UNIT_TEST( u, countAfter - 1 == countBefore );
+			UNIT_TEST( u, block.GetInUseCount() - 1 == countBefore );
 			UNIT_TEST( u, chunk != nullptr );
-			const std::size_t chunkAddress = reinterpret_cast< std::size_t >( chunk );
-			UNIT_TEST( u, chunkAddress % alignment == 0 );
-/*			if ( chunkAddress % alignment != 0 )
-			{
-				std::cout << "\t chunk: " << chunkAddress
-					<< "  objectSize: " << objectSize
-					<< "  alignment: " << alignment
-					<< "  offset: " << chunkAddress % alignment << std::endl;
-			} */
+			UNIT_TEST( u, reinterpret_cast< std::size_t >( chunk ) % alignment == 0 );
 			UNIT_TEST( u, block.HasAddress( chunk, blockSize ) );
-			holder[ index ] = chunk;
+			const std::size_t spot = ( reinterpret_cast< unsigned char * >( chunk ) - block.GetAddress() ) / objectSize;
+			UNIT_TEST( u, holder[ spot ] == nullptr );
+			holder[ spot ] = chunk;
 		}
 		else
 		{
 			UNIT_TEST( u, block.HasAddress( chunk, blockSize ) );
 			const unsigned int countBefore = block.GetInUseCount();
 			block.Release( chunk, objectSize );
-			const unsigned int countAfter = block.GetInUseCount();
-			UNIT_TEST( u, countAfter + 1 == countBefore );
+			UNIT_TEST( u, block.GetInUseCount() + 1 == countBefore );
 			holder[ index ] = nullptr;
-			chunk = nullptr;
 		}
-		UNIT_TEST( u, !block.IsCorrupt( objectSize ) );
+		if ( ii % corruptCheckInterval == 0 )
+		{
+			UNIT_TEST( u, !block.IsCorrupt( objectSize ) );
+		}
 	}
+	UNIT_TEST( u, !block.IsCorrupt( objectSize ) );
 
 	block.Destroy();
 }
@@ -123,116 +132,63 @@ void TestTinyBlock()
 		<< "Object Size \t Alignment" << std::endl
 		<< "==========================" << std::endl;
 
-	std::size_t objectSize = 1;
-	std::size_t alignment = 1;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-	objectSize = 2;
-	alignment = 1;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-	objectSize = 2;
-	alignment = 2;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-	objectSize = 4;
-	alignment = 1;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-	objectSize = 4;
-	alignment = 2;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-	objectSize = 4;
-	alignment = 4;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-	objectSize = 8;
-	alignment = 1;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-	objectSize = 8;
-	alignment = 2;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-	objectSize = 8;
-	alignment = 4;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-	objectSize = 8;
-	alignment = 8;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-	objectSize = 16;
-	alignment = 1;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-	objectSize = 16;
-	alignment = 2;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-	objectSize = 16;
-	alignment = 4;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-	objectSize = 16;
-	alignment = 8;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-	objectSize = 16;
-	alignment = 16;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-	objectSize = 12;
-	alignment = 4;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-	objectSize = 32;
-	alignment = 1;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-	objectSize = 32;
-	alignment = 2;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-	objectSize = 32;
-	alignment = 4;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-	objectSize = 32;
-	alignment = 8;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-	objectSize = 32;
-	alignment = 16;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-
-/*	objectSize = 32;
-	alignment = 32;
-	TestTinyBlock( u, objectSize, alignment );
-	std::cout << objectSize << "\t\t" << alignment << std::endl;
-*/
+	const std::size_t sizes[][ 2 ] =
+	{
+		{ 1, 1 },
+		{ 2, 1 },
+		{ 2, 2 },
+		{ 4, 1 },
+		{ 4, 2 },
+		{ 4, 4 },
+		{ 8, 1 },
+		{ 8, 2 },
+		{ 8, 4 },
+		{ 8, 8 },
+		{ 16, 1 },
+		{ 16, 2 },
+		{ 16, 4 },
+		{ 16, 8 },
+		{ 16, 16 },
+		{ 12, 4 },
+		{ 32, 1 },
+		{ 32, 2 },
+		{ 32, 4 },
+		{ 32, 8 },
+		{ 32, 16 },
+	};
+	for ( const std::size_t * size : sizes )
+	{
+		TestAnyTinyBlock< TinyBlock >( u, UCHAR_MAX, size[ 0 ], size[ 1 ] );
+		std::cout << size[ 0 ] << "\t\t" << size[ 1 ] << std::endl;
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+void TestWideTinyBlock()
+{
+	ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+	ut::UnitTest * u = uts.AddUnitTest( "Test WideTinyBlock" );
+
+	std::cout << std::endl << "Testing Various BlockSizes and Alignments with WideTinyBlock." << std::endl
+		<< "Objects Per Block \t Object Size \t Alignment" << std::endl
+		<< "=================================================" << std::endl;
+
+	const std::size_t sizes[][ 3 ] =
+	{
+		{ 2048, 2, 1 },
+		{ 32768, 2, 2 },
+		{ 1365, 3, 1 },
+		{ 1024, 4, 4 },
+		{ 65535, 4, 4 },
+		{ 341, 12, 4 },
+		{ 4096, 16, 16 },
+	};
+	for ( const std::size_t * size : sizes )
+	{
+		TestAnyTinyBlock< WideTinyBlock >( u, size[ 0 ], size[ 1 ], size[ 2 ] );
+		std::cout << size[ 0 ] << "\t\t\t" << size[ 1 ] << "\t\t" << size[ 2 ] << std::endl;
+	}
 }
 
 // ----------------------------------------------------------------------------
@@ -18,24 +18,39 @@ using namespace std;
 using namespace memwa;
 
 extern void TestPoolBlock();
+extern void TestBitmapBlock();
 extern void TestTinyBlock();
+extern void TestWideTinyBlock();
 extern void TestLinearBlock();
 extern void TestStackBlock();
 extern void TestStackBlockResize();
 extern void TestStackBlockComplex();
 extern void TestStackExceptions();
+extern void TestStackBlockHeaders();
 
 extern void TestLinearAllocator( bool multithreaded, bool showProximityCounts );
+extern void TestFrameAllocator( bool multithreaded );
+extern void TestAllocatorAdapter( bool multithreaded );
+extern void TestPoolAllocatorT();
 extern void TestStackAllocator( bool multithreaded, bool showProximityCounts );
+extern void TestStackHeaders( bool multithreaded );
+extern void TestStackSegments( bool multithreaded );
 extern void TestTinyAllocator( bool multithreaded, bool showProximityCounts );
-extern void TestPoolAllocator( bool multithreaded, bool showProximityCounts );
+extern void TestWideTinyAllocator( bool multithreaded );
+extern void TestSizeClassAllocator( bool multithreaded );
+extern void TestBlockSource( bool multithreaded );
+extern void TestPoolAllocator( bool multithreaded, bool showProximityCounts, bool bitmapBlocks );
 
 extern void ComplexTestStackAllocator( bool multithreaded, bool showProximityCounts );
 extern void ComplexTestTinyAllocator( bool multithreaded, bool showProximityCounts );
 extern void ComplexTestPoolAllocator( bool multithreaded, bool showProximityCounts );
 
 extern void DoSimplePoolThreadTest( bool showProximityCounts );
+extern void DoSimpleCachedPoolThreadTest( bool showProximityCounts );
+extern void DoSimpleLockFreePoolThreadTest( bool showProximityCounts );
+extern void DoRemoteFreePoolThreadTest( bool showProximityCounts );
 extern void DoSimpleTinyThreadTest( bool showProximityCounts );
+extern void DoShardedTinyThreadTest( bool showProximityCounts );
 extern void DoSimpleStackThreadTest( bool showProximityCounts );
 extern void DoSimpleLinearThreadTest( bool showProximityCounts );
 
@@ -737,6 +752,152 @@ void TestAlignment( bool multithreaded )
 
 // ----------------------------------------------------------------------------
 
+void TestAlignedBlocks( bool multithreaded )
+{
+	// These tests check allocators whose blocks are aligned to their size, so they find the block
+	// owning a chunk by masking its address instead of searching.
+
+	ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+	ut::UnitTest * u = uts.AddUnitTest( "Test Aligned Blocks" );
+
+	UNIT_TEST_WITH_MSG( u,  AllocatorManager::CreateManager( multithreaded, 4096 ), "Creation should pass since AllocatorManager does exist." );
+
+	const AllocatorManager::AllocatorType types[] =
+	{
+		AllocatorManager::AllocatorType::Pool,
+		AllocatorManager::AllocatorType::Tiny,
+		AllocatorManager::AllocatorType::Stack,
+	};
+	const unsigned int chunkCount = 2000;
+	void * places[ chunkCount ];
+	int notOwned = 0;
+
+	for ( AllocatorManager::AllocatorType type : types )
+	{
+		AllocatorManager::AllocatorParameters allocatorInfo;
+		allocatorInfo.type = type;
+		allocatorInfo.initialBlocks = 2;
+		allocatorInfo.blockSize = 1024;
+		allocatorInfo.objectSize = 16;
+		allocatorInfo.alignment = 8;
+		allocatorInfo.alignedBlocks = true;
+		Allocator * allocator = nullptr;
+		UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+		for ( unsigned int ii = 0; ii < chunkCount; ++ii )
+		{
+			UNIT_TEST( u, ( places[ ii ] = allocator->Allocate( allocatorInfo.objectSize ) ) != nullptr );
+			UNIT_TEST( u, reinterpret_cast< std::size_t >( places[ ii ] ) % allocatorInfo.alignment == 0 );
+			UNIT_TEST( u, allocator->HasAddress( places[ ii ] ) );
+		}
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+		UNIT_TEST_WITH_MSG( u, !allocator->HasAddress( &notOwned ), "Allocator should not own an address on the stack." );
+		UNIT_TEST_WITH_MSG( u, !allocator->HasAddress( nullptr ), "Allocator should not own nullptr." );
+
+		// Release chunks in reverse order since the stack allocator requires it.
+		for ( int ii = chunkCount - 1; ii >= 0; --ii )
+		{
+			UNIT_TEST( u, allocator->Release( places[ ii ], allocatorInfo.objectSize ) );
+			if ( ii % 100 == 0 )
+			{
+				UNIT_TEST( u, !allocator->IsCorrupt() );
+			}
+		}
+		UNIT_TEST( u, !allocator->Release( &notOwned, allocatorInfo.objectSize ) );
+		UNIT_TEST( u, !allocator->IsCorrupt() );
+		allocator->TrimEmptyBlocks();
+		UNIT_TEST( u, !allocator->HasAddress( places[ 0 ] ) );
+		UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+	}
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyManager( true ), "Destruction should pass since AllocatorManager exists." );
+}
+
+// ----------------------------------------------------------------------------
+
+void TestRetainedEmptyBlocks( bool multithreaded )
+{
+	// These tests check allocators which keep some empty blocks for reuse instead of destroying each
+	// block as soon as its last chunk is released.
+
+	ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+	ut::UnitTest * u = uts.AddUnitTest( "Test Retained Empty Blocks" );
+
+	UNIT_TEST_WITH_MSG( u,  AllocatorManager::CreateManager( multithreaded, 4096 ), "Creation should pass since AllocatorManager does exist." );
+
+	const AllocatorManager::AllocatorType types[] =
+	{
+		AllocatorManager::AllocatorType::Pool,
+		AllocatorManager::AllocatorType::Tiny,
+		AllocatorManager::AllocatorType::Stack,
+	};
+	const unsigned int chunkCount = 600;
+	void * places[ chunkCount ];
+
+	for ( AllocatorManager::AllocatorType type : types )
+	{
+		for ( unsigned int retained = 0; retained < 2; ++retained )
+		{
+			AllocatorManager::AllocatorParameters allocatorInfo;
+			allocatorInfo.type = type;
+			allocatorInfo.initialBlocks = 1;
+			allocatorInfo.blockSize = 1024;
+			allocatorInfo.objectSize = 16;
+			allocatorInfo.alignment = 8;
+			allocatorInfo.retainedEmptyBlocks = retained;
+			Allocator * allocator = nullptr;
+			UNIT_TEST_WITH_MSG( u, ( allocator = AllocatorManager::CreateAllocator( allocatorInfo ) ) != nullptr, "allocator should not be nullptr." );
+			for ( unsigned int ii = 0; ii < chunkCount; ++ii )
+			{
+				UNIT_TEST( u, ( places[ ii ] = allocator->Allocate( allocatorInfo.objectSize ) ) != nullptr );
+			}
+			UNIT_TEST( u, !allocator->IsCorrupt() );
+
+			// Release chunks in reverse order since the stack allocator requires it.
+			for ( int ii = chunkCount - 1; ii >= 0; --ii )
+			{
+				UNIT_TEST( u, allocator->Release( places[ ii ], allocatorInfo.objectSize ) );
+				if ( ii % 100 == 0 )
+				{
+					UNIT_TEST( u, !allocator->IsCorrupt() );
+				}
+			}
+			UNIT_TEST( u, !allocator->IsCorrupt() );
+			if ( 0 == retained )
+			{
+				UNIT_TEST_WITH_MSG( u, !allocator->HasAddress( places[ 0 ] ), "Allocator should destroy blocks once they are empty." );
+				if ( AllocatorManager::AllocatorType::Stack == type )
+				{
+					// The stack allocator always keeps one spare segment, so it has one empty block to trim.
+					UNIT_TEST_WITH_MSG( u, allocator->HasAddress( places[ chunkCount - 1 ] ), "Allocator should keep a spare segment." );
+					UNIT_TEST_WITH_MSG( u, allocator->TrimEmptyBlocks(), "Allocator should trim its spare segment." );
+				}
+				UNIT_TEST_WITH_MSG( u, !allocator->TrimEmptyBlocks(), "Allocator should have no empty blocks to trim." );
+			}
+			else
+			{
+				// Only one block should have been kept, and allocating from it again should not make a new block.
+				UNIT_TEST_WITH_MSG( u, allocator->HasAddress( places[ chunkCount - 1 ] ), "Allocator should keep first block to become empty." );
+				UNIT_TEST_WITH_MSG( u, !allocator->HasAddress( places[ 0 ] ), "Allocator should destroy other empty blocks." );
+				void * p = nullptr;
+				UNIT_TEST( u, ( p = allocator->Allocate( allocatorInfo.objectSize ) ) != nullptr );
+				UNIT_TEST( u, allocator->HasAddress( p ) );
+				UNIT_TEST( u, !allocator->IsCorrupt() );
+				UNIT_TEST( u, allocator->Release( p, allocatorInfo.objectSize ) );
+				UNIT_TEST( u, !allocator->IsCorrupt() );
+				UNIT_TEST_WITH_MSG( u, allocator->TrimEmptyBlocks(), "Allocator should trim the empty block it kept." );
+				UNIT_TEST( u, !allocator->HasAddress( places[ chunkCount - 1 ] ) );
+				UNIT_TEST( u, !allocator->TrimEmptyBlocks() );
+				UNIT_TEST( u, !allocator->IsCorrupt() );
+			}
+			UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyAllocator( allocator, true ), "DestroyAllocator should pass since parameter is valid." );
+		}
+	}
+
+	UNIT_TEST_WITH_MSG( u, AllocatorManager::DestroyManager( true ), "Destruction should pass since AllocatorManager exists." );
+}
+
+// ----------------------------------------------------------------------------
+
 void PrintDataTypeSizes()
 {
     std::cout << "sizeof(char) = " << sizeof(char) << std::endl;
@@ -800,13 +961,18 @@ int main( int argc, const char * const argv[] )
 		TestStackBlockResize();
 		TestStackBlockComplex();
 		TestStackExceptions();
+		TestStackBlockHeaders();
 		TestPoolBlock();
+		TestBitmapBlock();
 		TestTinyBlock();
+		TestWideTinyBlock();
 	}
 
 	if ( args.RunManagerTests() )
 	{
 		TestAllocatorManager();
+		TestRetainedEmptyBlocks( false );
+		TestRetainedEmptyBlocks( true );
 	}
 	if ( args.RunExceptionTests() )
 	{
@@ -819,19 +985,38 @@ int main( int argc, const char * const argv[] )
 	{
 		TestAlignment( false );
 		TestAlignment( true );
+		TestAlignedBlocks( false );
+		TestAlignedBlocks( true );
 	}
 
 	if ( args.RunSimpleTests() )
 	{
 		TestLinearAllocator( false, showProximityCounts );
+		TestFrameAllocator( false );
+		TestAllocatorAdapter( false );
+		TestPoolAllocatorT();
 		TestStackAllocator( false, showProximityCounts );
+		TestStackHeaders( false );
+		TestStackSegments( false );
 		TestTinyAllocator( false, showProximityCounts );
-		TestPoolAllocator( false, showProximityCounts );
+		TestWideTinyAllocator( false );
+		TestPoolAllocator( false, showProximityCounts, false );
+		TestPoolAllocator( false, showProximityCounts, true );
+		TestSizeClassAllocator( false );
+		TestBlockSource( false );
 
 		TestLinearAllocator( true, showProximityCounts );
+		TestFrameAllocator( true );
+		TestAllocatorAdapter( true );
 		TestStackAllocator( true, showProximityCounts );
+		TestStackHeaders( true );
+		TestStackSegments( true );
 		TestTinyAllocator( true, showProximityCounts );
-		TestPoolAllocator( true, showProximityCounts );
+		TestWideTinyAllocator( true );
+		TestPoolAllocator( true, showProximityCounts, false );
+		TestPoolAllocator( true, showProximityCounts, true );
+		TestSizeClassAllocator( true );
+		TestBlockSource( true );
 	}
 
 	if ( args.RunComplexTests() )
@@ -848,7 +1033,11 @@ int main( int argc, const char * const argv[] )
 	if ( args.runThreadTests() )
 	{
 		DoSimplePoolThreadTest( showProximityCounts );
+		DoSimpleCachedPoolThreadTest( showProximityCounts );
+		DoSimpleLockFreePoolThreadTest( showProximityCounts );
+		DoRemoteFreePoolThreadTest( showProximityCounts );
 		DoSimpleTinyThreadTest( showProximityCounts );
+		DoShardedTinyThreadTest( showProximityCounts );
 		DoSimpleStackThreadTest( showProximityCounts );
 		DoSimpleLinearThreadTest( showProximityCounts );
 
@@ -8,12 +8,18 @@ echo "Compile ChunkList.cpp";       g++ -std=c++14 -Wall -o ChunkList.o -c Chunk
 echo "Compile CommandLineArgs.cpp"; g++ -std=c++14 -Wall -I../../include -I../../../Hestia/CppUnitTest/include -c CommandLineArgs.cpp -o CommandLineArgs.o
 echo "Compile TestTinyBlock.cpp";   g++ -std=c++14 -Wall -I../../include -I../../../Hestia/CppUnitTest/include -c TestTinyBlock.cpp -o TestTinyBlock.o
 echo "Compile TestPoolBlock.cpp";   g++ -std=c++14 -Wall -I../../include -I../../../Hestia/CppUnitTest/include -c TestPoolBlock.cpp -o TestPoolBlock.o
+echo "Compile TestBitmapBlock.cpp"; g++ -std=c++14 -Wall -I../../include -I../../../Hestia/CppUnitTest/include -c TestBitmapBlock.cpp -o TestBitmapBlock.o
 echo "Compile TestStackBlock.cpp";  g++ -std=c++14 -Wall -I../../include -I../../../Hestia/CppUnitTest/include -c TestStackBlock.cpp -o TestStackBlock.o
 echo "Compile TestLinearBlock.cpp"; g++ -std=c++14 -Wall -I../../include -I../../../Hestia/CppUnitTest/include -c TestLinearBlock.cpp -o TestLinearBlock.o
 echo "Compile TestTinyAllocator.cpp"; g++ -std=c++14 -Wall -I../../include -I../../../Hestia/CppUnitTest/include -c TestTinyAllocator.cpp -o TestTinyAllocator.o
 echo "Compile TestPoolAllocator.cpp"; g++ -std=c++14 -Wall -I../../include -I../../../Hestia/CppUnitTest/include -c TestPoolAllocator.cpp -o TestPoolAllocator.o
+echo "Compile TestSizeClassAllocator.cpp"; g++ -std=c++14 -Wall -I../../include -I../../../Hestia/CppUnitTest/include -c TestSizeClassAllocator.cpp -o TestSizeClassAllocator.o
+echo "Compile TestBlockSource.cpp"; g++ -std=c++14 -Wall -I../../include -I../../../Hestia/CppUnitTest/include -c TestBlockSource.cpp -o TestBlockSource.o
 echo "Compile TestStackAllocator.cpp"; g++ -std=c++14 -Wall -I../../include -I../../../Hestia/CppUnitTest/include -c TestStackAllocator.cpp -o TestStackAllocator.o
 echo "Compile TestLinearAllocator.cpp"; g++ -std=c++14 -Wall -I../../include -I../../../Hestia/CppUnitTest/include -c TestLinearAllocator.cpp -o TestLinearAllocator.o
+echo "Compile TestFrameAllocator.cpp"; g++ -std=c++14 -Wall -I../../include -I../../../Hestia/CppUnitTest/include -c TestFrameAllocator.cpp -o TestFrameAllocator.o
+echo "Compile TestAllocatorAdapter.cpp"; g++ -std=c++14 -Wall -I../../include -I../../../Hestia/CppUnitTest/include -c TestAllocatorAdapter.cpp -o TestAllocatorAdapter.o
+echo "Compile TestPoolAllocatorT.cpp"; g++ -std=c++14 -Wall -I../../include -I../../../Hestia/CppUnitTest/include -c TestPoolAllocatorT.cpp -o TestPoolAllocatorT.o
 echo "Compile TestMultithreaded.cpp"; g++ -std=c++14 -Wall -I../../include -I../../../Hestia/CppUnitTest/include -c TestMultithreaded.cpp -o TestMultithreaded.o
 echo "Compile ComplexMultithreadedTest.cpp"; g++ -std=c++14 -Wall -I../../include -I../../../Hestia/CppUnitTest/include -c ComplexMultithreadedTest.cpp -o ComplexMultithreadedTest.o
 echo "Compile TestMultithreadedDuplicates.cpp"; g++ -std=c++14 -Wall -I../../include -I../../../Hestia/CppUnitTest/include -c TestMultithreadedDuplicates.cpp -o TestMultithreadedDuplicates.o
@@ -24,14 +30,20 @@ g++ -std=c++14 -Wall -o functionality_test.exe \
 	ChunkList.o \
 	TestTinyBlock.o \
 	TestPoolBlock.o \
+	TestBitmapBlock.o \
 	TestStackBlock.o \
 	TestLinearBlock.o \
 	CommandLineArgs.o \
 	TestMultithreaded.o \
 	TestPoolAllocator.o \
+	TestSizeClassAllocator.o \
+	TestBlockSource.o \
 	TestTinyAllocator.o \
 	TestStackAllocator.o \
 	TestLinearAllocator.o \
+	TestFrameAllocator.o \
+	TestAllocatorAdapter.o \
+	TestPoolAllocatorT.o \
 	ComplexMultithreadedTest.o \
 	TestMultithreadedDuplicates.o \
 	../../src/obj/AllocatorManager.o \
@@ -40,8 +52,17 @@ g++ -std=c++14 -Wall -o functionality_test.exe \
 	../../src/obj/StackBlock.o \
 	../../src/obj/LinearBlock.o \
 	../../src/obj/PoolAllocator.o \
+	../../src/obj/BitmapBlock.o \
+	../../src/obj/BitmapPoolAllocator.o \
 	../../src/obj/StackAllocator.o \
 	../../src/obj/LinearAllocator.o \
+	../../src/obj/FrameAllocator.o \
 	../../src/obj/TinyObjectAllocator.o \
+	../../src/obj/WideTinyBlock.o \
+	../../src/obj/WideTinyObjectAllocator.o \
+	../../src/obj/SizeClassAllocator.o \
+	../../src/obj/ThreadCache.o \
+	../../src/obj/BlockSource.o \
+	../../src/obj/SizedAllocators.o \
 	../../../Hestia/CppUnitTest/src/obj/UnitTest.o
 echo "Done!"
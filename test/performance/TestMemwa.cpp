@@ -12,7 +12,7 @@ typedef Thingy< 256 > Thingy256;
 // ----------------------------------------------------------------------------
 
 template< class Object >
-bool TestMemwaPoolForward( StopwatchPair & timers )
+bool TestMemwaPoolForward( StopwatchPair & timers, bool bitmapBlocks )
 {
 
 	const bool created = memwa::AllocatorManager::CreateManager( false, 4096 );
@@ -23,6 +23,7 @@ bool TestMemwaPoolForward( StopwatchPair & timers )
 
 	memwa::AllocatorManager::AllocatorParameters allocatorInfo;
 	allocatorInfo.type = memwa::AllocatorManager::AllocatorType::Pool;
+	allocatorInfo.bitmapBlocks = bitmapBlocks;
 	allocatorInfo.objectSize = sizeof( Object );
 	allocatorInfo.alignment = 8;
 	allocatorInfo.blockSize = 2000 * sizeof( Object );
@@ -72,7 +73,7 @@ bool TestMemwaTinyForward( StopwatchPair & timers )
 // ----------------------------------------------------------------------------
 
 template< class Object >
-bool TestMemwaPoolReverse( StopwatchPair & timers )
+bool TestMemwaPoolReverse( StopwatchPair & timers, bool bitmapBlocks )
 {
 
 	const bool created = memwa::AllocatorManager::CreateManager( false, 4096 );
@@ -83,6 +84,7 @@ bool TestMemwaPoolReverse( StopwatchPair & timers )
 
 	memwa::AllocatorManager::AllocatorParameters allocatorInfo;
 	allocatorInfo.type = memwa::AllocatorManager::AllocatorType::Pool;
+	allocatorInfo.bitmapBlocks = bitmapBlocks;
 	allocatorInfo.objectSize = sizeof( Object );
 	allocatorInfo.alignment = 8;
 	allocatorInfo.blockSize = 2000 * sizeof( Object );
@@ -102,7 +104,7 @@ bool TestMemwaPoolReverse( StopwatchPair & timers )
 // ----------------------------------------------------------------------------
 
 template< class Object >
-bool TestMemwaPoolRandom( StopwatchPair & timers )
+bool TestMemwaPoolRandom( StopwatchPair & timers, bool bitmapBlocks )
 {
 
 	const bool created = memwa::AllocatorManager::CreateManager( false, 4096 );
@@ -113,6 +115,7 @@ bool TestMemwaPoolRandom( StopwatchPair & timers )
 
 	memwa::AllocatorManager::AllocatorParameters allocatorInfo;
 	allocatorInfo.type = memwa::AllocatorManager::AllocatorType::Pool;
+	allocatorInfo.bitmapBlocks = bitmapBlocks;
 	allocatorInfo.objectSize = sizeof( Object );
 	allocatorInfo.alignment = 8;
 	allocatorInfo.blockSize = 2000 * sizeof( Object );
@@ -223,7 +226,7 @@ bool TestMemwaStackReverse( StopwatchPair & timers )
 
 bool TestMemwaPoolForward8( StopwatchPair & timers )
 {
-	const bool okay = TestMemwaPoolForward< Thingy8 >( timers );
+	const bool okay = TestMemwaPoolForward< Thingy8 >( timers, false );
 	return okay;
 }
 
@@ -231,7 +234,7 @@ bool TestMemwaPoolForward8( StopwatchPair & timers )
 
 bool TestMemwaPoolForward64( StopwatchPair & timers )
 {
-	const bool okay = TestMemwaPoolForward< Thingy64 >( timers );
+	const bool okay = TestMemwaPoolForward< Thingy64 >( timers, false );
 	return okay;
 }
 
@@ -239,7 +242,7 @@ bool TestMemwaPoolForward64( StopwatchPair & timers )
 
 bool TestMemwaPoolForward256( StopwatchPair & timers )
 {
-	const bool okay = TestMemwaPoolForward< Thingy256 >( timers );
+	const bool okay = TestMemwaPoolForward< Thingy256 >( timers, false );
 	return okay;
 }
 
@@ -247,7 +250,7 @@ bool TestMemwaPoolForward256( StopwatchPair & timers )
 
 bool TestMemwaPoolReverse8( StopwatchPair & timers )
 {
-	const bool okay = TestMemwaPoolReverse< Thingy8 >( timers );
+	const bool okay = TestMemwaPoolReverse< Thingy8 >( timers, false );
 	return okay;
 }
 
@@ -255,7 +258,7 @@ bool TestMemwaPoolReverse8( StopwatchPair & timers )
 
 bool TestMemwaPoolReverse64( StopwatchPair & timers )
 {
-	const bool okay = TestMemwaPoolReverse< Thingy64 >( timers );
+	const bool okay = TestMemwaPoolReverse< Thingy64 >( timers, false );
 	return okay;
 }
 
@@ -263,7 +266,7 @@ bool TestMemwaPoolReverse64( StopwatchPair & timers )
 
 bool TestMemwaPoolReverse256( StopwatchPair & timers )
 {
-	const bool okay = TestMemwaPoolReverse< Thingy256 >( timers );
+	const bool okay = TestMemwaPoolReverse< Thingy256 >( timers, false );
 	return okay;
 }
 
@@ -271,7 +274,7 @@ bool TestMemwaPoolReverse256( StopwatchPair & timers )
 
 bool TestMemwaPoolRandom8( StopwatchPair & timers )
 {
-	const bool okay = TestMemwaPoolRandom< Thingy8 >( timers );
+	const bool okay = TestMemwaPoolRandom< Thingy8 >( timers, false );
 	return okay;
 }
 
@@ -279,7 +282,7 @@ bool TestMemwaPoolRandom8( StopwatchPair & timers )
 
 bool TestMemwaPoolRandom64( StopwatchPair & timers )
 {
-	const bool okay = TestMemwaPoolRandom< Thingy64 >( timers );
+	const bool okay = TestMemwaPoolRandom< Thingy64 >( timers, false );
 	return okay;
 }
 
@@ -287,7 +290,79 @@ bool TestMemwaPoolRandom64( StopwatchPair & timers )
 
 bool TestMemwaPoolRandom256( StopwatchPair & timers )
 {
-	const bool okay = TestMemwaPoolRandom< Thingy256 >( timers );
+	const bool okay = TestMemwaPoolRandom< Thingy256 >( timers, false );
+	return okay;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TestMemwaBitmapForward8( StopwatchPair & timers )
+{
+	const bool okay = TestMemwaPoolForward< Thingy8 >( timers, true );
+	return okay;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TestMemwaBitmapForward64( StopwatchPair & timers )
+{
+	const bool okay = TestMemwaPoolForward< Thingy64 >( timers, true );
+	return okay;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TestMemwaBitmapForward256( StopwatchPair & timers )
+{
+	const bool okay = TestMemwaPoolForward< Thingy256 >( timers, true );
+	return okay;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TestMemwaBitmapReverse8( StopwatchPair & timers )
+{
+	const bool okay = TestMemwaPoolReverse< Thingy8 >( timers, true );
+	return okay;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TestMemwaBitmapReverse64( StopwatchPair & timers )
+{
+	const bool okay = TestMemwaPoolReverse< Thingy64 >( timers, true );
+	return okay;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TestMemwaBitmapReverse256( StopwatchPair & timers )
+{
+	const bool okay = TestMemwaPoolReverse< Thingy256 >( timers, true );
+	return okay;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TestMemwaBitmapRandom8( StopwatchPair & timers )
+{
+	const bool okay = TestMemwaPoolRandom< Thingy8 >( timers, true );
+	return okay;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TestMemwaBitmapRandom64( StopwatchPair & timers )
+{
+	const bool okay = TestMemwaPoolRandom< Thingy64 >( timers, true );
+	return okay;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TestMemwaBitmapRandom256( StopwatchPair & timers )
+{
+	const bool okay = TestMemwaPoolRandom< Thingy256 >( timers, true );
 	return okay;
 }
 
@@ -23,6 +23,18 @@ extern bool TestMemwaPoolRandom8( StopwatchPair & timers );
 extern bool TestMemwaPoolRandom64( StopwatchPair & timers );
 extern bool TestMemwaPoolRandom256( StopwatchPair & timers );
 
+extern bool TestMemwaBitmapForward8( StopwatchPair & timers );
+extern bool TestMemwaBitmapForward64( StopwatchPair & timers );
+extern bool TestMemwaBitmapForward256( StopwatchPair & timers );
+
+extern bool TestMemwaBitmapReverse8( StopwatchPair & timers );
+extern bool TestMemwaBitmapReverse64( StopwatchPair & timers );
+extern bool TestMemwaBitmapReverse256( StopwatchPair & timers );
+
+extern bool TestMemwaBitmapRandom8( StopwatchPair & timers );
+extern bool TestMemwaBitmapRandom64( StopwatchPair & timers );
+extern bool TestMemwaBitmapRandom256( StopwatchPair & timers );
+
 
 extern bool TestMemwaTinyForward8( StopwatchPair & timers );
 extern bool TestMemwaTinyForward64( StopwatchPair & timers );
@@ -71,8 +83,10 @@ void DoForwardTests8()
 {
 	StopwatchPair defaultTimers;
 	StopwatchPair memwaPoolTimers;
+	StopwatchPair memwaBitmapTimers;
 	StopwatchPair memwaTinyTimers;
 	TestMemwaPoolForward8( memwaPoolTimers );
+	TestMemwaBitmapForward8( memwaBitmapTimers );
 	TestMemwaTinyForward8( memwaTinyTimers );
 	TestDefaultForward8( defaultTimers );
 
@@ -92,7 +106,10 @@ void DoForwardTests8()
 	std::cout << "Memwa Tiny:  " << memwaTinyTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaTinyTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl;
 	allocateRatio = static_cast< float > ( memwaPoolTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
 	releaseRatio  = static_cast< float > ( memwaPoolTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
-	std::cout << "Memwa Pool:  " << memwaPoolTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaPoolTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl << std::endl;
+	std::cout << "Memwa Pool:  " << memwaPoolTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaPoolTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl;
+	allocateRatio = static_cast< float > ( memwaBitmapTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
+	releaseRatio  = static_cast< float > ( memwaBitmapTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
+	std::cout << "Memwa Bitmap:" << memwaBitmapTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaBitmapTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl << std::endl;
 }
 
 // ----------------------------------------------------------------------------
@@ -101,9 +118,11 @@ void DoReverseTests8()
 {
 	StopwatchPair defaultTimers;
 	StopwatchPair memwaPoolTimers;
+	StopwatchPair memwaBitmapTimers;
 	StopwatchPair memwaTinyTimers;
 	StopwatchPair memwaStackTimers;
 	TestMemwaPoolReverse8( memwaPoolTimers );
+	TestMemwaBitmapReverse8( memwaBitmapTimers );
 	TestMemwaTinyReverse8( memwaTinyTimers );
 	TestMemwaStackReverse8( memwaStackTimers );
 	TestDefaultReverse8( defaultTimers );
@@ -125,6 +144,9 @@ void DoReverseTests8()
 	allocateRatio = static_cast< float > ( memwaPoolTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
 	releaseRatio  = static_cast< float > ( memwaPoolTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
 	std::cout << "Memwa Pool:  " << memwaPoolTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaPoolTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl;
+	allocateRatio = static_cast< float > ( memwaBitmapTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
+	releaseRatio  = static_cast< float > ( memwaBitmapTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
+	std::cout << "Memwa Bitmap:" << memwaBitmapTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaBitmapTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl;
 	allocateRatio = static_cast< float > ( memwaStackTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
 	releaseRatio  = static_cast< float > ( memwaStackTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
 	std::cout << "Memwa Stack: " << memwaStackTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaStackTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl << std::endl;
@@ -136,8 +158,10 @@ void DoForwardTests64()
 {
 	StopwatchPair defaultTimers;
 	StopwatchPair memwaPoolTimers;
+	StopwatchPair memwaBitmapTimers;
 	StopwatchPair memwaTinyTimers;
 	TestMemwaPoolForward64( memwaPoolTimers );
+	TestMemwaBitmapForward64( memwaBitmapTimers );
 	TestMemwaTinyForward64( memwaTinyTimers );
 	TestDefaultForward64( defaultTimers );
 
@@ -157,7 +181,10 @@ void DoForwardTests64()
 	std::cout << "Memwa Tiny:  " << memwaTinyTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaTinyTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl;
 	allocateRatio = static_cast< float > ( memwaPoolTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
 	releaseRatio  = static_cast< float > ( memwaPoolTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
-	std::cout << "Memwa Pool:  " << memwaPoolTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaPoolTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl << std::endl;
+	std::cout << "Memwa Pool:  " << memwaPoolTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaPoolTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl;
+	allocateRatio = static_cast< float > ( memwaBitmapTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
+	releaseRatio  = static_cast< float > ( memwaBitmapTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
+	std::cout << "Memwa Bitmap:" << memwaBitmapTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaBitmapTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl << std::endl;
 }
 
 // ----------------------------------------------------------------------------
@@ -166,9 +193,11 @@ void DoReverseTests64()
 {
 	StopwatchPair defaultTimers;
 	StopwatchPair memwaPoolTimers;
+	StopwatchPair memwaBitmapTimers;
 	StopwatchPair memwaTinyTimers;
 	StopwatchPair memwaStackTimers;
 	TestMemwaPoolReverse64( memwaPoolTimers );
+	TestMemwaBitmapReverse64( memwaBitmapTimers );
 	TestMemwaTinyReverse64( memwaTinyTimers );
 	TestMemwaStackReverse64( memwaStackTimers );
 	TestDefaultReverse64( defaultTimers );
@@ -190,6 +219,9 @@ void DoReverseTests64()
 	allocateRatio = static_cast< float > ( memwaPoolTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
 	releaseRatio  = static_cast< float > ( memwaPoolTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
 	std::cout << "Memwa Pool:  " << memwaPoolTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaPoolTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl;
+	allocateRatio = static_cast< float > ( memwaBitmapTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
+	releaseRatio  = static_cast< float > ( memwaBitmapTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
+	std::cout << "Memwa Bitmap:" << memwaBitmapTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaBitmapTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl;
 	allocateRatio = static_cast< float > ( memwaStackTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
 	releaseRatio  = static_cast< float > ( memwaStackTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
 	std::cout << "Memwa Stack: " << memwaStackTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaStackTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl << std::endl;
@@ -201,7 +233,9 @@ void DoForwardTests256()
 {
 	StopwatchPair defaultTimers;
 	StopwatchPair memwaPoolTimers;
+	StopwatchPair memwaBitmapTimers;
 	TestMemwaPoolForward256( memwaPoolTimers );
+	TestMemwaBitmapForward256( memwaBitmapTimers );
 	TestDefaultForward256( defaultTimers );
 
 	float allocateRatio = 1.0F;
@@ -217,7 +251,10 @@ void DoForwardTests256()
 	std::cout << "Default:     " << defaultTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << defaultTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl;
 	allocateRatio = static_cast< float > ( memwaPoolTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
 	releaseRatio  = static_cast< float > ( memwaPoolTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
-	std::cout << "Memwa Pool:  " << memwaPoolTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaPoolTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl << std::endl;
+	std::cout << "Memwa Pool:  " << memwaPoolTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaPoolTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl;
+	allocateRatio = static_cast< float > ( memwaBitmapTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
+	releaseRatio  = static_cast< float > ( memwaBitmapTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
+	std::cout << "Memwa Bitmap:" << memwaBitmapTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaBitmapTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl << std::endl;
 }
 
 // ----------------------------------------------------------------------------
@@ -226,8 +263,10 @@ void DoReverseTests256()
 {
 	StopwatchPair defaultTimers;
 	StopwatchPair memwaPoolTimers;
+	StopwatchPair memwaBitmapTimers;
 	StopwatchPair memwaStackTimers;
 	TestMemwaPoolReverse256( memwaPoolTimers );
+	TestMemwaBitmapReverse256( memwaBitmapTimers );
 	TestMemwaStackReverse256( memwaStackTimers );
 	TestDefaultReverse256( defaultTimers );
 
@@ -245,6 +284,9 @@ void DoReverseTests256()
 	allocateRatio = static_cast< float > ( memwaPoolTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
 	releaseRatio  = static_cast< float > ( memwaPoolTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
 	std::cout << "Memwa Pool:  " << memwaPoolTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaPoolTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl;
+	allocateRatio = static_cast< float > ( memwaBitmapTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
+	releaseRatio  = static_cast< float > ( memwaBitmapTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
+	std::cout << "Memwa Bitmap:" << memwaBitmapTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaBitmapTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl;
 	allocateRatio = static_cast< float > ( memwaStackTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
 	releaseRatio  = static_cast< float > ( memwaStackTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
 	std::cout << "Memwa Stack: " << memwaStackTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaStackTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl << std::endl;
@@ -256,8 +298,10 @@ void DoRandomTests8()
 {
 	StopwatchPair defaultTimers;
 	StopwatchPair memwaPoolTimers;
+	StopwatchPair memwaBitmapTimers;
 	StopwatchPair memwaTinyTimers;
 	TestMemwaPoolRandom8( memwaPoolTimers );
+	TestMemwaBitmapRandom8( memwaBitmapTimers );
 	TestMemwaTinyRandom8( memwaTinyTimers );
 	TestDefaultRandom8( defaultTimers );
 
@@ -275,6 +319,9 @@ void DoRandomTests8()
 	allocateRatio = static_cast< float > ( memwaPoolTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
 	releaseRatio  = static_cast< float > ( memwaPoolTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
 	std::cout << "Memwa Pool:  " << memwaPoolTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaPoolTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl;
+	allocateRatio = static_cast< float > ( memwaBitmapTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
+	releaseRatio  = static_cast< float > ( memwaBitmapTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
+	std::cout << "Memwa Bitmap:" << memwaBitmapTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaBitmapTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl;
 	allocateRatio = static_cast< float > ( memwaTinyTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
 	releaseRatio  = static_cast< float > ( memwaTinyTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
 	std::cout << "Memwa Tiny:  " << memwaTinyTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaTinyTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl << std::endl;
@@ -286,8 +333,10 @@ void DoRandomTests64()
 {
 	StopwatchPair defaultTimers;
 	StopwatchPair memwaPoolTimers;
+	StopwatchPair memwaBitmapTimers;
 	StopwatchPair memwaTinyTimers;
 	TestMemwaPoolRandom64( memwaPoolTimers );
+	TestMemwaBitmapRandom64( memwaBitmapTimers );
 	TestMemwaTinyRandom64( memwaTinyTimers );
 	TestDefaultRandom64( defaultTimers );
 
@@ -305,6 +354,9 @@ void DoRandomTests64()
 	allocateRatio = static_cast< float > ( memwaPoolTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
 	releaseRatio  = static_cast< float > ( memwaPoolTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
 	std::cout << "Memwa Pool:  " << memwaPoolTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaPoolTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl;
+	allocateRatio = static_cast< float > ( memwaBitmapTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
+	releaseRatio  = static_cast< float > ( memwaBitmapTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
+	std::cout << "Memwa Bitmap:" << memwaBitmapTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaBitmapTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl;
 	allocateRatio = static_cast< float > ( memwaTinyTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
 	releaseRatio  = static_cast< float > ( memwaTinyTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
 	std::cout << "Memwa Tiny:  " << memwaTinyTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaTinyTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl << std::endl;
@@ -316,7 +368,9 @@ void DoRandomTests256()
 {
 	StopwatchPair defaultTimers;
 	StopwatchPair memwaPoolTimers;
+	StopwatchPair memwaBitmapTimers;
 	TestMemwaPoolRandom256( memwaPoolTimers );
+	TestMemwaBitmapRandom256( memwaBitmapTimers );
 	TestDefaultRandom256( defaultTimers );
 
 	float allocateRatio = 1.0F;
@@ -333,6 +387,9 @@ void DoRandomTests256()
 	allocateRatio = static_cast< float > ( memwaPoolTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
 	releaseRatio  = static_cast< float > ( memwaPoolTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
 	std::cout << "Memwa Pool:  " << memwaPoolTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaPoolTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl;
+	allocateRatio = static_cast< float > ( memwaBitmapTimers.allocateTimer.GetDuration() ) / static_cast< float > ( defaultTimers.allocateTimer.GetDuration() );
+	releaseRatio  = static_cast< float > ( memwaBitmapTimers.releaseTimer.GetDuration()  ) / static_cast< float > ( defaultTimers.releaseTimer.GetDuration() );
+	std::cout << "Memwa Bitmap:" << memwaBitmapTimers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t' << memwaBitmapTimers.releaseTimer.GetDuration() << '\t' << releaseRatio << std::endl;
 }
 
 // ----------------------------------------------------------------------------
@@ -24,8 +24,16 @@ g++ -std=c++14 -Wall -o performance_test.exe \
 	../../src/obj/StackBlock.o \
 	../../src/obj/LinearBlock.o \
 	../../src/obj/PoolAllocator.o \
+	../../src/obj/BitmapBlock.o \
+	../../src/obj/BitmapPoolAllocator.o \
 	../../src/obj/StackAllocator.o \
 	../../src/obj/LinearAllocator.o \
+	../../src/obj/FrameAllocator.o \
 	../../src/obj/TinyObjectAllocator.o \
+	../../src/obj/WideTinyBlock.o \
+	../../src/obj/WideTinyObjectAllocator.o \
+	../../src/obj/SizeClassAllocator.o \
+	../../src/obj/ThreadCache.o \
+	../../src/obj/BlockSource.o \
 	CommandLineArgs.o
 echo "Done!"
@@ -0,0 +1,225 @@
+
+/** @file main.cpp
+ Checks that libmemwa_replace replaces every form of operator new and operator delete, and malloc and
+ friends if the library was built with MEMWA_REPLACE_MALLOC. Returns zero if all checks passed.
+ */
+
+#include "AllocatorManager.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+
+unsigned int failures = 0;
+
+// ----------------------------------------------------------------------------
+
+void Check( bool passed, const char * message )
+{
+	if ( !passed )
+	{
+		++failures;
+		cout << "Failed: " << message << endl;
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+bool IsAligned( const void * place, std::size_t alignment )
+{
+	return ( reinterpret_cast< std::uintptr_t >( place ) % alignment == 0 );
+}
+
+// ----------------------------------------------------------------------------
+
+struct alignas( 64 ) OverAligned
+{
+	unsigned char bytes[ 64 ];
+};
+
+// ----------------------------------------------------------------------------
+
+void TestOperatorNew()
+{
+	// Sizes on both sides of the 4096 byte limit for Memwa chunks.
+	const std::size_t sizes[] = { 0, 1, 7, 16, 33, 100, 1000, 4000, 4080, 4081, 5000, 100000 };
+	for ( std::size_t size : sizes )
+	{
+		unsigned char * place = static_cast< unsigned char * >( ::operator new( size ) );
+		Check( place != nullptr, "operator new should not return nullptr." );
+		Check( IsAligned( place, 16 ), "operator new should return 16 byte aligned chunks." );
+		std::memset( place, 0xA5, size );
+		::operator delete( place );
+
+		unsigned char * array = new unsigned char[ size + 1 ];
+		std::memset( array, 0x5A, size + 1 );
+		delete [] array;
+
+		place = static_cast< unsigned char * >( ::operator new( size, std::nothrow ) );
+		Check( place != nullptr, "nothrow operator new should not fail for small sizes." );
+		::operator delete( place, std::nothrow );
+		place = static_cast< unsigned char * >( ::operator new[]( size, std::nothrow ) );
+		::operator delete[]( place, std::nothrow );
+
+		place = static_cast< unsigned char * >( ::operator new( size ) );
+		::operator delete( place, size );
+		place = static_cast< unsigned char * >( ::operator new[]( size ) );
+		::operator delete[]( place, size );
+	}
+
+	// Volatile so the compiler doesn't warn that the size is too big, which is the point of this test.
+	volatile std::size_t tooBig = static_cast< std::size_t >( -1 ) - 8;
+	Check( ::operator new( tooBig, std::nothrow ) == nullptr, "nothrow operator new should return nullptr when it fails." );
+	bool threw = false;
+	try
+	{
+		::operator delete( ::operator new( tooBig ) );
+	}
+	catch ( const std::bad_alloc & )
+	{
+		threw = true;
+	}
+	Check( threw, "operator new should throw bad_alloc when it fails." );
+}
+
+// ----------------------------------------------------------------------------
+
+void TestAlignedNew()
+{
+#if defined( __cpp_aligned_new )
+	OverAligned * object = new OverAligned;
+	Check( IsAligned( object, 64 ), "new should honor alignment of overaligned types." );
+	delete object;
+
+	OverAligned * array = new OverAligned[ 10 ];
+	Check( IsAligned( array, 64 ), "new[] should honor alignment of overaligned types." );
+	delete [] array;
+
+	const std::size_t alignments[] = { 8, 16, 32, 128, 4096 };
+	for ( std::size_t alignment : alignments )
+	{
+		const std::align_val_t align = static_cast< std::align_val_t >( alignment );
+		void * place = ::operator new( 40, align );
+		Check( IsAligned( place, alignment ), "aligned operator new should honor alignment." );
+		::operator delete( place, align );
+		place = ::operator new[]( 40, align, std::nothrow );
+		Check( IsAligned( place, alignment ), "aligned nothrow operator new should honor alignment." );
+		::operator delete[]( place, align, std::nothrow );
+		place = ::operator new( 40, align );
+		::operator delete( place, 40, align );
+	}
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+void TestMalloc()
+{
+#if defined( MEMWA_REPLACE_MALLOC )
+	unsigned char * place = static_cast< unsigned char * >( std::calloc( 100, 3 ) );
+	bool zeroed = true;
+	for ( std::size_t ii = 0; ii < 300; ++ii )
+	{
+		zeroed = zeroed && ( place[ ii ] == 0 );
+		place[ ii ] = static_cast< unsigned char >( ii );
+	}
+	Check( zeroed, "calloc should zero the chunk." );
+
+	// Grow through several size classes and then past the Memwa limit, checking contents survive.
+	const std::size_t sizes[] = { 301, 310, 1000, 5000, 20000, 200 };
+	for ( std::size_t size : sizes )
+	{
+		place = static_cast< unsigned char * >( std::realloc( place, size ) );
+		bool kept = true;
+		for ( std::size_t ii = 0; ii < 200; ++ii )
+		{
+			kept = kept && ( place[ ii ] == static_cast< unsigned char >( ii ) );
+		}
+		Check( kept, "realloc should keep contents of the chunk." );
+	}
+	std::free( place );
+
+	// Volatile so the compiler doesn't warn that the size overflows, which is the point of this test.
+	volatile std::size_t tooBig = static_cast< std::size_t >( -1 ) / 2;
+	Check( std::calloc( tooBig, 4 ) == nullptr, "calloc should fail when count times size overflows." );
+	std::free( nullptr );
+
+	void * aligned = nullptr;
+	Check( ::posix_memalign( &aligned, 256, 1000 ) == 0, "posix_memalign should succeed." );
+	Check( IsAligned( aligned, 256 ), "posix_memalign should honor alignment." );
+	std::free( aligned );
+	Check( ::posix_memalign( &aligned, 3, 1000 ) != 0, "posix_memalign should reject alignment which is not a power of two." );
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+void ThreadTest( unsigned int seed )
+{
+	std::vector< std::string > strings;
+	for ( unsigned int ii = 0; ii < 20000; ++ii )
+	{
+		seed = seed * 1103515245 + 12345;
+		const std::size_t length = ( seed >> 16 ) % 600;
+		if ( !strings.empty() && ( seed & 0x300 ) == 0 )
+		{
+			strings.pop_back();
+		}
+		strings.push_back( std::string( length, static_cast< char >( 'a' + length % 26 ) ) );
+	}
+	bool intact = true;
+	for ( const std::string & text : strings )
+	{
+		intact = intact && ( text.find_first_not_of( static_cast< char >( 'a' + text.size() % 26 ) ) == std::string::npos );
+	}
+	Check( intact, "chunks used by different threads should not overlap." );
+}
+
+// ----------------------------------------------------------------------------
+
+void TestThreads()
+{
+	std::vector< std::thread > threads;
+	for ( unsigned int ii = 0; ii < 4; ++ii )
+	{
+		threads.push_back( std::thread( ThreadTest, ii + 1 ) );
+	}
+	for ( std::thread & thread : threads )
+	{
+		thread.join();
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+} // end anonymous namespace
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+	// The library makes a multithreaded manager for the first allocation, unless the program made one first.
+	delete new int( 0 );
+	Check( !memwa::AllocatorManager::CreateManager( false ), "manager should already exist." );
+
+	TestOperatorNew();
+	TestAlignedNew();
+	TestMalloc();
+	TestThreads();
+
+	cout << ( ( failures == 0 ) ? "All replacement tests passed." : "Some replacement tests failed." ) << endl;
+	return ( failures == 0 ) ? 0 : 1;
+}
+
+// ----------------------------------------------------------------------------
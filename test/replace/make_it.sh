@@ -0,0 +1,17 @@
+#!/bin/bash
+
+# Builds the replacement library and links the test program to its static archive. Pass
+# -DMEMWA_REPLACE_MALLOC as the first argument to also test the malloc replacement.
+
+rm replace_test.exe
+rm *.o
+
+cd ../../src/replace
+./make_it.sh $1
+cd ../../test/replace
+
+echo "Compile main.cpp"; g++ -std=c++14 -faligned-new -Wall -I../../include $1 -c main.cpp -o main.o
+
+echo "Linking"
+g++ -std=c++14 -pthread -o replace_test.exe main.o ../../src/replace/libmemwa_replace.a
+echo "Done!"
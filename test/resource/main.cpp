@@ -0,0 +1,329 @@
+/** @file main.cpp
+ Checks that memwa::MemoryResource lets std::pmr containers use Memwa allocators, and then compares how
+ long pmr::list takes to add and remove nodes with Memwa allocators and with the standard memory
+ resources. Pass the number of nodes as the only argument. Returns zero if all checks passed.
+ */
+
+#include "AllocatorManager.hpp"
+#include "MemoryResource.hpp"
+
+#include "../performance/Stopwatch.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+
+#include <iostream>
+#include <list>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+
+unsigned int failures = 0;
+
+typedef std::pmr::list< std::uint64_t > NodeList;
+
+// ----------------------------------------------------------------------------
+
+void Check( bool passed, const char * message )
+{
+	if ( !passed )
+	{
+		++failures;
+		cout << "Failed: " << message << endl;
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+/** @class SizeProbe Records the size of the first chunk a container asks for, so a PoolAllocator or
+ TinyObjectAllocator can be made with the same object size as the container's nodes.
+ */
+class SizeProbe : public std::pmr::memory_resource
+{
+public:
+
+	std::size_t size_ = 0;
+
+private:
+
+	virtual void * do_allocate( std::size_t bytes, std::size_t alignment ) override
+	{
+		if ( 0 == size_ )
+		{
+			size_ = bytes;
+		}
+		return std::pmr::new_delete_resource()->allocate( bytes, alignment );
+	}
+
+	virtual void do_deallocate( void * place, std::size_t bytes, std::size_t alignment ) override
+	{
+		std::pmr::new_delete_resource()->deallocate( place, bytes, alignment );
+	}
+
+	virtual bool do_is_equal( const std::pmr::memory_resource & that ) const noexcept override
+	{
+		return ( this == &that );
+	}
+
+};
+
+// ----------------------------------------------------------------------------
+
+std::size_t GetNodeSize()
+{
+	SizeProbe probe;
+	{
+		NodeList nodes( &probe );
+		nodes.push_back( 0 );
+	}
+	return probe.size_;
+}
+
+// ----------------------------------------------------------------------------
+
+memwa::Allocator * MakeAllocator( memwa::AllocatorManager::AllocatorType type, std::size_t objectSize,
+	unsigned int loopCount )
+{
+	memwa::AllocatorManager::AllocatorParameters info;
+	info.type = type;
+	info.objectSize = objectSize;
+	info.alignment = static_cast< std::align_val_t >( alignof( std::uint64_t ) );
+	info.blockSize = 64 * 1024;
+	if ( type == memwa::AllocatorManager::AllocatorType::Pool )
+	{
+		info.blockSize -= info.blockSize % objectSize;
+	}
+	// Let Release find the owning block by masking the chunk's address instead of searching.
+	info.alignedBlocks = true;
+	info.wideTinyBlocks = true;
+	info.initialBlocks = static_cast< unsigned int >( ( loopCount * objectSize ) / info.blockSize ) + 1;
+	return memwa::AllocatorManager::CreateAllocator( info );
+}
+
+// ----------------------------------------------------------------------------
+
+void TestContainers( bool multithreaded, std::size_t nodeSize )
+{
+	Check( memwa::AllocatorManager::CreateManager( multithreaded, 4096 ), "CreateManager should pass." );
+
+	// Containers whose chunks vary in size work with Linear and Stack allocators.
+	memwa::Allocator * linear = MakeAllocator( memwa::AllocatorManager::AllocatorType::Linear, 0, 0 );
+	{
+		memwa::MemoryResource resource( linear );
+		std::pmr::vector< std::pmr::string > words( &resource );
+		for ( unsigned int ii = 0; ii < 1000; ++ii )
+		{
+			// Each string is too long for the small string buffer, so it allocates too.
+			words.emplace_back( ii % 40 + 20, 'w' );
+		}
+		Check( words.get_allocator().resource() == &resource, "Vector should use the Memwa resource." );
+		Check( words[ 999 ].get_allocator().resource() == &resource, "Strings should use the Memwa resource." );
+		Check( linear->HasAddress( words.data() ), "Vector storage should come from the LinearAllocator." );
+		Check( linear->HasAddress( &words[ 500 ][ 0 ] ), "String storage should come from the LinearAllocator." );
+		Check( words[ 999 ] == std::pmr::string( 39 + 20, 'w' ), "Strings should hold their values." );
+	}
+	Check( !linear->IsCorrupt(), "LinearAllocator should not be corrupt." );
+	Check( memwa::AllocatorManager::DestroyAllocator( linear, true ), "DestroyAllocator should pass." );
+
+	memwa::Allocator * stack = MakeAllocator( memwa::AllocatorManager::AllocatorType::Stack, 0, 0 );
+	{
+		memwa::MemoryResource resource( stack );
+		NodeList nodes( &resource );
+		for ( std::uint64_t ii = 0; ii < 1000; ++ii )
+		{
+			nodes.push_back( ii );
+		}
+		Check( stack->HasAddress( &nodes.back() ), "List nodes should come from the StackAllocator." );
+		while ( !nodes.empty() )
+		{
+			nodes.pop_back();
+		}
+	}
+	Check( !stack->IsCorrupt(), "StackAllocator should not be corrupt." );
+	Check( memwa::AllocatorManager::DestroyAllocator( stack, true ), "DestroyAllocator should pass." );
+
+	// Node based containers work with Pool and Tiny allocators whose object size matches the nodes.
+	const memwa::AllocatorManager::AllocatorType fixedTypes[] =
+	{
+		memwa::AllocatorManager::AllocatorType::Pool,
+		memwa::AllocatorManager::AllocatorType::Tiny
+	};
+	for ( memwa::AllocatorManager::AllocatorType type : fixedTypes )
+	{
+		memwa::Allocator * pool = MakeAllocator( type, nodeSize, 0 );
+		{
+			memwa::MemoryResource resource( pool );
+			memwa::MemoryResource other( pool );
+			Check( resource == other, "Adapters for the same allocator should be equal." );
+			Check( resource != *std::pmr::new_delete_resource(), "Adapters should not equal other resources." );
+			NodeList nodes( &resource );
+			NodeList moved( &other );
+			for ( std::uint64_t ii = 0; ii < 1000; ++ii )
+			{
+				nodes.push_back( ii );
+			}
+			Check( pool->HasAddress( &nodes.front() ), "List nodes should come from the allocator." );
+			// Equal resources let splice move nodes without copying them.
+			moved.splice( moved.end(), nodes, nodes.begin() );
+			Check( moved.front() == 0, "Spliced node should keep its value." );
+			nodes.remove_if( []( std::uint64_t value ) { return ( value % 3 ) == 0; } );
+			Check( nodes.size() == 666, "List should hold the nodes which were not removed." );
+		}
+		Check( !pool->IsCorrupt(), "Allocator should not be corrupt." );
+		Check( memwa::AllocatorManager::DestroyAllocator( pool, true ), "DestroyAllocator should pass." );
+	}
+
+	bool threw = false;
+	memwa::Allocator * pool = MakeAllocator( memwa::AllocatorManager::AllocatorType::Pool, nodeSize, 0 );
+	{
+		memwa::MemoryResource resource( pool );
+		try
+		{
+			void * place = resource.allocate( nodeSize, 4 * alignof( std::uint64_t ) );
+			resource.deallocate( place, nodeSize, 4 * alignof( std::uint64_t ) );
+		}
+		catch ( const std::invalid_argument & )
+		{
+			threw = true;
+		}
+		Check( threw, "Allocate should throw if the alignment is bigger than the allocator's alignment." );
+	}
+	Check( memwa::AllocatorManager::DestroyAllocator( pool, true ), "DestroyAllocator should pass." );
+
+	threw = false;
+	try
+	{
+		memwa::MemoryResource resource( nullptr );
+	}
+	catch ( const std::invalid_argument & )
+	{
+		threw = true;
+	}
+	Check( threw, "MemoryResource should throw if it has no allocator." );
+
+	Check( memwa::AllocatorManager::DestroyManager( true ), "DestroyManager should pass." );
+}
+
+// ----------------------------------------------------------------------------
+
+void TimeList( std::pmr::memory_resource * resource, unsigned int loopCount, StopwatchPair & timers )
+{
+	NodeList nodes( resource );
+	timers.allocateTimer.Start();
+	for ( unsigned int ii = 0; ii < loopCount; ++ii )
+	{
+		nodes.push_back( ii );
+	}
+	timers.allocateTimer.Stop();
+	timers.releaseTimer.Start();
+	for ( unsigned int ii = 0; ii < loopCount; ++ii )
+	{
+		nodes.pop_back();
+	}
+	timers.releaseTimer.Stop();
+}
+
+// ----------------------------------------------------------------------------
+
+void ShowTimes( const char * name, const StopwatchPair & timers, const StopwatchPair & baseTimers )
+{
+	const float allocateRatio = static_cast< float >( timers.allocateTimer.GetDuration() )
+		/ static_cast< float >( baseTimers.allocateTimer.GetDuration() );
+	const float releaseRatio = static_cast< float >( timers.releaseTimer.GetDuration() )
+		/ static_cast< float >( baseTimers.releaseTimer.GetDuration() );
+	cout << name << timers.allocateTimer.GetDuration() << '\t' << allocateRatio << '\t'
+		<< timers.releaseTimer.GetDuration() << '\t' << releaseRatio << endl;
+}
+
+// ----------------------------------------------------------------------------
+
+void TimeMemwa( const char * name, memwa::AllocatorManager::AllocatorType type, std::size_t nodeSize,
+	unsigned int loopCount, const StopwatchPair & baseTimers )
+{
+	memwa::Allocator * allocator = MakeAllocator( type, nodeSize, loopCount );
+	StopwatchPair timers;
+	{
+		memwa::MemoryResource resource( allocator );
+		TimeList( &resource, loopCount, timers );
+	}
+	memwa::AllocatorManager::DestroyAllocator( allocator, true );
+	ShowTimes( name, timers, baseTimers );
+}
+
+// ----------------------------------------------------------------------------
+
+void DoTimingTests( bool multithreaded, std::size_t nodeSize, unsigned int loopCount )
+{
+	StopwatchPair baseTimers;
+	StopwatchPair newDeleteTimers;
+	if ( multithreaded )
+	{
+		std::pmr::synchronized_pool_resource base;
+		TimeList( &base, loopCount, baseTimers );
+	}
+	else
+	{
+		std::pmr::unsynchronized_pool_resource base;
+		TimeList( &base, loopCount, baseTimers );
+	}
+	TimeList( std::pmr::new_delete_resource(), loopCount, newDeleteTimers );
+
+	cout << ( multithreaded ? "Multi-Threaded" : "Single-Threaded" ) << " pmr::list Performance Test." << endl
+		<< "\t Node size is " << nodeSize << " bytes." << endl
+		<< "\t Nodes are added at the back and then removed from the back." << endl
+		<< "\t Times are in microseconds, and ratios are to the standard pool resource." << endl;
+	cout << "Resource       Allocate           Release" << endl;
+	cout << "               Time      Ratio    Time     Ratio" << endl;
+	cout << "------------------------------------------------" << endl;
+	ShowTimes( multithreaded ? "std sync pool: " : "std pool:      ", baseTimers, baseTimers );
+	ShowTimes( "new/delete:    ", newDeleteTimers, baseTimers );
+
+	memwa::AllocatorManager::CreateManager( multithreaded, 4096 );
+	TimeMemwa( "Memwa Linear:  ", memwa::AllocatorManager::AllocatorType::Linear, 0, loopCount, baseTimers );
+	TimeMemwa( "Memwa Stack:   ", memwa::AllocatorManager::AllocatorType::Stack, 0, loopCount, baseTimers );
+	TimeMemwa( "Memwa Pool:    ", memwa::AllocatorManager::AllocatorType::Pool, nodeSize, loopCount, baseTimers );
+	TimeMemwa( "Memwa Tiny:    ", memwa::AllocatorManager::AllocatorType::Tiny, nodeSize, loopCount, baseTimers );
+	memwa::AllocatorManager::DestroyManager( true );
+	cout << endl;
+}
+
+// ----------------------------------------------------------------------------
+
+} // end anonymous namespace
+
+// ----------------------------------------------------------------------------
+
+int main( int argc, const char * const argv[] )
+{
+	unsigned int loopCount = 1000000;
+	if ( 1 < argc )
+	{
+		loopCount = static_cast< unsigned int >( std::strtoul( argv[ 1 ], nullptr, 10 ) );
+	}
+	const std::size_t nodeSize = GetNodeSize();
+
+	TestContainers( false, nodeSize );
+	TestContainers( true, nodeSize );
+	if ( 0 != failures )
+	{
+		cout << failures << " checks failed." << endl;
+		return 1;
+	}
+	cout << "All checks passed." << endl << endl;
+
+	cout << "Allocating " << loopCount << " nodes per test." << endl << endl;
+	cout.precision( 2 );
+	cout.setf( std::ios::fixed );
+	DoTimingTests( false, nodeSize, loopCount );
+	DoTimingTests( true, nodeSize, loopCount );
+
+	return 0;
+}
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,65 @@
+#!/bin/bash
+
+# Builds the library as C++17 without asserts, since std::pmr needs C++17 and asserts would skew the
+# times, and links the memory resource test program to those objects. Pass the number of nodes for
+# each timing test to resource_test.exe. Before that, this builds resource_check.exe with asserts
+# enabled and runs it once with a few nodes, so asserts hidden by NDEBUG still get a chance to fire.
+
+rm resource_test.exe resource_check.exe
+rm *.o
+rm ./obj/*.o ./obj_check/*.o
+
+for dir in obj obj_check
+do
+	if [ ! -d "$dir" ]; then
+		mkdir $dir
+	fi
+done
+
+CHECK_FLAGS="-std=c++17 -Wall -O2 -I../../include"
+FLAGS="$CHECK_FLAGS -DNDEBUG"
+
+FILES="\
+	AllocatorManager \
+	TinyBlock \
+	PoolBlock \
+	StackBlock \
+	LinearBlock \
+	PoolAllocator \
+	BitmapBlock \
+	BitmapPoolAllocator \
+	StackAllocator \
+	LinearAllocator \
+	FrameAllocator \
+	TinyObjectAllocator \
+	WideTinyBlock \
+	WideTinyObjectAllocator \
+	SizeClassAllocator \
+	ThreadCache \
+	BlockSource \
+	SizedAllocators \
+	MemoryResource"
+
+echo "Building with asserts"
+for file in $FILES
+do
+	echo "Compile $file.cpp"; g++ $CHECK_FLAGS -c ../../src/$file.cpp -o ./obj_check/$file.o
+done
+echo "Compile Stopwatch.cpp"; g++ $CHECK_FLAGS -c ../performance/Stopwatch.cpp -o Stopwatch_check.o
+echo "Compile main.cpp";      g++ $CHECK_FLAGS -c main.cpp -o main_check.o
+echo "Linking"
+g++ -std=c++17 -pthread -o resource_check.exe main_check.o Stopwatch_check.o ./obj_check/*.o
+echo "Running with asserts"
+./resource_check.exe 100 > /dev/null || exit 1
+
+echo "Building without asserts"
+for file in $FILES
+do
+	echo "Compile $file.cpp"; g++ $FLAGS -c ../../src/$file.cpp -o ./obj/$file.o
+done
+echo "Compile Stopwatch.cpp"; g++ $FLAGS -c ../performance/Stopwatch.cpp -o Stopwatch.o
+echo "Compile main.cpp";      g++ $FLAGS -c main.cpp -o main.o
+
+echo "Linking"
+g++ -std=c++17 -pthread -o resource_test.exe main.o Stopwatch.o ./obj/*.o
+echo "Done!"